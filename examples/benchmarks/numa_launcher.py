@@ -0,0 +1,27 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Micro benchmark example for the NUMA-partitioned concurrent launcher.
+
+Commands to run:
+  python3 examples/benchmarks/numa_launcher.py
+"""
+
+from superbench.benchmarks import BenchmarkRegistry, Platform
+from superbench.common.utils import logger
+
+if __name__ == '__main__':
+    context = BenchmarkRegistry.create_benchmark_context(
+        'numa-launcher',
+        platform=Platform.CPU,
+        parameters='--jobs "stream nodes=1 membw=exclusive -- host_runner --cpus {cpus} --run stream" '
+        '"gemm cores=8 -- host_runner --cpus {cpus} --run gemm" --calibrate'
+    )
+
+    benchmark = BenchmarkRegistry.launch_benchmark(context)
+    if benchmark:
+        logger.info(
+            'benchmark: {}, return code: {}, result: {}'.format(
+                benchmark.name, benchmark.return_code, benchmark.result
+            )
+        )
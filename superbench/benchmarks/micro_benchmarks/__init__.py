@@ -39,9 +39,23 @@
 from superbench.benchmarks.micro_benchmarks.directx_mem_bw_performance import DirectXGPUMemBw
 from superbench.benchmarks.micro_benchmarks.directx_gemm_flops_performance import DirectXGPUCoreFlops
 from superbench.benchmarks.micro_benchmarks.nvbandwidth import NvBandwidthBenchmark
+from superbench.benchmarks.micro_benchmarks.udp_packet_rate_performance import UdpPacketRateBenchmark
+from superbench.benchmarks.micro_benchmarks.tcp_connection_storm_performance import TcpConnectionStormBenchmark
+from superbench.benchmarks.micro_benchmarks.tcp_loaded_latency_performance import TcpLoadedLatencyBenchmark
+from superbench.benchmarks.micro_benchmarks.checkpoint_write_performance import CheckpointWriteBenchmark
+from superbench.benchmarks.micro_benchmarks.dataloader_read_performance import DataLoaderReadBenchmark
+from superbench.benchmarks.micro_benchmarks.fs_metadata_performance import FsMetadataBenchmark
+from superbench.benchmarks.micro_benchmarks.weight_load_performance import WeightLoadBenchmark
+from superbench.benchmarks.micro_benchmarks.shm_collective_performance import ShmCollectiveBenchmark
+from superbench.benchmarks.micro_benchmarks.mpi_collective_performance import MpiCollectiveBenchmark
+from superbench.benchmarks.micro_benchmarks.moe_alltoallv_performance import MoeAlltoallvBenchmark
+from superbench.benchmarks.micro_benchmarks.mpi_overlap_performance import MpiOverlapBenchmark
+from superbench.benchmarks.micro_benchmarks.host_runner import HostRunnerBenchmark
+from superbench.benchmarks.micro_benchmarks.numa_launcher import NumaLauncherBenchmark
 
 __all__ = [
     'BlasLtBaseBenchmark',
+    'CheckpointWriteBenchmark',
     'ComputationCommunicationOverlap',
     'CpuMemBwLatencyBenchmark',
     'CpuHplBenchmark',
@@ -52,9 +66,12 @@
     'CudaMemBwBenchmark',
     'CudaNcclBwBenchmark',
     'CudnnBenchmark',
+    'DataLoaderReadBenchmark',
     'DiskBenchmark',
     'DistInference',
+    'FsMetadataBenchmark',
     'HipBlasLtBenchmark',
+    'HostRunnerBenchmark',
     'GPCNetBenchmark',
     'GemmFlopsBenchmark',
     'GpuBurnBenchmark',
@@ -66,15 +83,24 @@
     'MemBwBenchmark',
     'MicroBenchmark',
     'MicroBenchmarkWithInvoke',
+    'MoeAlltoallvBenchmark',
+    'MpiCollectiveBenchmark',
+    'MpiOverlapBenchmark',
+    'NumaLauncherBenchmark',
     'ORTInferenceBenchmark',
     'RocmGemmFlopsBenchmark',
     'RocmMemBwBenchmark',
     'ShardingMatmul',
+    'ShmCollectiveBenchmark',
     'TCPConnectivityBenchmark',
+    'TcpConnectionStormBenchmark',
+    'TcpLoadedLatencyBenchmark',
     'TensorRTInferenceBenchmark',
     'DirectXGPUEncodingLatency',
     'DirectXGPUCopyBw',
     'DirectXGPUMemBw',
     'DirectXGPUCoreFlops',
     'NvBandwidthBenchmark',
+    'UdpPacketRateBenchmark',
+    'WeightLoadBenchmark',
 ]
@@ -0,0 +1,131 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the checkpoint write benchmark."""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class CheckpointWriteBenchmark(MicroBenchmarkWithInvoke):
+    """The checkpoint write benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'checkpoint_write'
+        self._methods = ['buffered', 'direct', 'io_uring']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--methods',
+            type=str,
+            nargs='+',
+            default=self._methods,
+            help='Write methods to test. E.g. {}.'.format(' '.join(self._methods)),
+        )
+        self._parser.add_argument(
+            '--dir',
+            type=str,
+            default='.',
+            required=False,
+            help='Directory to write the checkpoint shards to.',
+        )
+        self._parser.add_argument(
+            '--writers',
+            type=int,
+            default=4,
+            required=False,
+            help='Number of writers, each writes one shard.',
+        )
+        self._parser.add_argument(
+            '--shard_size',
+            type=str,
+            default='1G',
+            required=False,
+            help='Size of each shard, e.g. 4G.',
+        )
+        self._parser.add_argument(
+            '--chunk_size',
+            type=str,
+            default='4M',
+            required=False,
+            help='Size of each write, must be a multiple of 4KiB, e.g. 4M.',
+        )
+        self._parser.add_argument(
+            '--iodepth',
+            type=int,
+            default=4,
+            required=False,
+            help='Number of writes in flight per writer with io_uring.',
+        )
+        self._parser.add_argument(
+            '--serialize',
+            action='store_true',
+            help='Copy the model state into staging buffers in a serialize stage running in parallel with writes.',
+        )
+        self._parser.add_argument(
+            '--processes',
+            action='store_true',
+            help='Run writers as processes emulating ranks instead of threads.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for method in self._args.methods:
+            if method not in self._methods:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid method - benchmark: {}, method: {}.'.format(self._name, method))
+                return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ' '.join('--%s' % method for method in self._args.methods)
+        args += ' --dir %s --writers %d --shard_size %s --chunk_size %s --iodepth %d' % (
+            self._args.dir, self._args.writers, self._args.shard_size, self._args.chunk_size, self._args.iodepth
+        )
+        if self._args.serialize:
+            args += ' --serialize'
+        if self._args.processes:
+            args += ' --processes'
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('checkpoint-write', CheckpointWriteBenchmark)
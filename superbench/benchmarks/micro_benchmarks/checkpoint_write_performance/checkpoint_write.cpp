@@ -0,0 +1,648 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Checkpoint write benchmark.
+// N writers, threads or processes emulating ranks, each save one shard of a model checkpoint in fixed size chunks
+// and make it durable, using buffered writes with fsync, O_DIRECT writes with fsync, or O_DIRECT io_uring writes
+// with an fsync linked to the last write. An optional serialize stage copies the model state into staging buffers
+// in parallel with the writes, as torch.save does. The time to durable of every shard and the aggregate bandwidth
+// are reported per method, to tune the checkpoint strategy of each storage SKU.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../host_utils/io_uring_utils.h"
+#include "../host_utils/io_utils.h"
+#include "../host_utils/result_emitter.h"
+#include "../host_utils/stats_utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Largest model state copied by the serialize stage, larger shards cycle over it.
+constexpr uint64_t kMaxSerializeSource = 256ULL << 20;
+
+// Ways to write a shard and make it durable.
+enum class Method { kBuffered, kDirect, kIoUring };
+
+// Options accepted by this program.
+struct Opts {
+    // Write methods to test.
+    std::vector<Method> methods;
+
+    // Directory to write the shards to.
+    std::string dir = ".";
+
+    // Number of writers, each writes one shard.
+    int writers = 4;
+
+    // Size in bytes of each shard.
+    uint64_t shard_size = 1ULL << 30;
+
+    // Size in bytes of each write.
+    uint64_t chunk_size = 4ULL << 20;
+
+    // Number of writes in flight per writer with io_uring.
+    int iodepth = 4;
+
+    // Whether to copy the model state into staging buffers in a parallel serialize stage.
+    bool serialize = false;
+
+    // Whether to run writers as processes instead of threads.
+    bool processes = false;
+
+    // Whether to keep the shards after the test.
+    bool keep_files = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Timestamps of one shard in nanoseconds of the steady clock, comparable across processes.
+struct ShardTiming {
+    int64_t write_done = 0;
+    int64_t durable = 0;
+    int error = 0;
+};
+
+/**
+ * @brief Get the name of a write method used in metric and file names.
+ *
+ * @param method The write method.
+ * @return The name of the method.
+ */
+const char *MethodName(Method method) {
+    switch (method) {
+    case Method::kBuffered:
+        return "buffered";
+    case Method::kDirect:
+        return "direct";
+    case Method::kIoUring:
+        return "io_uring";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: checkpoint_write "
+              << "[--buffered] [--direct] [--io_uring] "
+              << "[--dir <path>] "
+              << "[--writers <num>] "
+              << "[--shard_size <bytes>] "
+              << "[--chunk_size <bytes>] "
+              << "[--iodepth <num>] "
+              << "[--serialize] "
+              << "[--processes] "
+              << "[--keep_files] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the checkpoint write benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kBuffered,
+        kDirect,
+        kIoUring,
+        kDir,
+        kWriters,
+        kShardSize,
+        kChunkSize,
+        kIodepth,
+        kSerialize,
+        kProcesses,
+        kKeepFiles
+    };
+    const struct option options[] = {
+        {"buffered", no_argument, nullptr, static_cast<int>(OptIdx::kBuffered)},
+        {"direct", no_argument, nullptr, static_cast<int>(OptIdx::kDirect)},
+        {"io_uring", no_argument, nullptr, static_cast<int>(OptIdx::kIoUring)},
+        {"dir", required_argument, nullptr, static_cast<int>(OptIdx::kDir)},
+        {"writers", required_argument, nullptr, static_cast<int>(OptIdx::kWriters)},
+        {"shard_size", required_argument, nullptr, static_cast<int>(OptIdx::kShardSize)},
+        {"chunk_size", required_argument, nullptr, static_cast<int>(OptIdx::kChunkSize)},
+        {"iodepth", required_argument, nullptr, static_cast<int>(OptIdx::kIodepth)},
+        {"serialize", no_argument, nullptr, static_cast<int>(OptIdx::kSerialize)},
+        {"processes", no_argument, nullptr, static_cast<int>(OptIdx::kProcesses)},
+        {"keep_files", no_argument, nullptr, static_cast<int>(OptIdx::kKeepFiles)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kWriters), {&opts->writers, 1}},
+        {static_cast<int>(OptIdx::kIodepth), {&opts->iodepth, 1}}};
+    // Flags, indexed by OptIdx
+    std::map<int, bool *> flag_opts = {{static_cast<int>(OptIdx::kSerialize), &opts->serialize},
+                                       {static_cast<int>(OptIdx::kProcesses), &opts->processes},
+                                       {static_cast<int>(OptIdx::kKeepFiles), &opts->keep_files}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        auto flag_opt = flag_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (flag_opt != flag_opts.end()) {
+            *flag_opt->second = true;
+        } else if (opt_idx == static_cast<int>(OptIdx::kBuffered)) {
+            opts->methods.push_back(Method::kBuffered);
+        } else if (opt_idx == static_cast<int>(OptIdx::kDirect)) {
+            opts->methods.push_back(Method::kDirect);
+        } else if (opt_idx == static_cast<int>(OptIdx::kIoUring)) {
+            opts->methods.push_back(Method::kIoUring);
+        } else if (opt_idx == static_cast<int>(OptIdx::kDir)) {
+            opts->dir = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kShardSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->shard_size) || opts->shard_size == 0;
+        } else if (opt_idx == static_cast<int>(OptIdx::kChunkSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->chunk_size) || opts->chunk_size == 0 ||
+                        opts->chunk_size % host_utils::kDirectAlignment != 0;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (!parse_err && opts->shard_size % opts->chunk_size != 0) {
+        std::cerr << "The shard size must be a multiple of the chunk size." << std::endl;
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    if (opts->methods.empty()) {
+        opts->methods = {Method::kBuffered, Method::kDirect, Method::kIoUring};
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Staging buffers cycled between the optional serialize stage and the writer.
+ *
+ * Without the serialize stage the buffers are filled once and the writer takes them from the free list directly.
+ * With it, a producer thread copies the next part of the model state into every free buffer before the writer can
+ * take it, so the copy overlaps with the writes of earlier chunks.
+ */
+class StagingPipeline {
+  public:
+    /**
+     * @brief Constructor.
+     *
+     * @param opts The benchmark options.
+     * @param depth The number of staging buffers.
+     * @param source The model state to serialize, nullptr to disable the serialize stage.
+     * @param source_size The size of the model state in bytes.
+     */
+    StagingPipeline(const Opts &opts, int depth, const char *source, uint64_t source_size)
+        : chunk_size_(opts.chunk_size), source_(source), source_size_(source_size) {
+        std::mt19937_64 rng(0);
+        for (int i = 0; i < depth; i++) {
+            char *buffer = static_cast<char *>(aligned_alloc(host_utils::kDirectAlignment, chunk_size_));
+            std::generate(buffer, buffer + chunk_size_, [&rng]() { return static_cast<char>(rng()); });
+            buffers_.push_back(buffer);
+            free_.push_back(buffer);
+        }
+        if (source_ != nullptr) {
+            producer_ = std::thread(&StagingPipeline::Produce, this, opts.shard_size / opts.chunk_size);
+        }
+    }
+
+    ~StagingPipeline() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        if (producer_.joinable()) {
+            producer_.join();
+        }
+        for (char *buffer : buffers_) {
+            free(buffer);
+        }
+    }
+
+    /**
+     * @brief Take the next buffer to write, waiting for the serialize stage if needed.
+     *
+     * @return The buffer holding the next chunk.
+     */
+    char *Acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        std::deque<char *> &queue = source_ != nullptr ? ready_ : free_;
+        cv_.wait(lock, [&queue]() { return !queue.empty(); });
+        char *buffer = queue.front();
+        queue.pop_front();
+        return buffer;
+    }
+
+    /**
+     * @brief Give back a buffer once its write completed.
+     *
+     * @param buffer The buffer.
+     */
+    void Release(char *buffer) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(buffer);
+        }
+        cv_.notify_all();
+    }
+
+  private:
+    void Produce(uint64_t chunks) {
+        uint64_t offset = 0;
+        for (uint64_t i = 0; i < chunks; i++) {
+            char *buffer = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stop_ || !free_.empty(); });
+                if (stop_) {
+                    return;
+                }
+                buffer = free_.front();
+                free_.pop_front();
+            }
+            // Copy the next part of the model state, wrapping around when the shard is larger than the state
+            for (uint64_t copied = 0; copied < chunk_size_;) {
+                uint64_t len = std::min(chunk_size_ - copied, source_size_ - offset);
+                memcpy(buffer + copied, source_ + offset, len);
+                copied += len;
+                offset = (offset + len) % source_size_;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ready_.push_back(buffer);
+            }
+            cv_.notify_all();
+        }
+    }
+
+    uint64_t chunk_size_;
+    const char *source_;
+    uint64_t source_size_;
+    std::vector<char *> buffers_;
+    std::deque<char *> free_;
+    std::deque<char *> ready_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread producer_;
+    bool stop_ = false;
+};
+
+/**
+ * @brief Get the current time in nanoseconds of the steady clock.
+ *
+ * @return The current time.
+ */
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Get the path of one shard.
+ *
+ * @param opts The benchmark options.
+ * @param method The write method.
+ * @param shard The index of the shard.
+ * @return The path of the shard.
+ */
+std::string ShardPath(const Opts &opts, Method method, int shard) {
+    return opts.dir + "/checkpoint_" + MethodName(method) + "_shard" + std::to_string(shard) + ".bin";
+}
+
+/**
+ * @brief Write a shard with blocking writes, then fsync it.
+ *
+ * @param opts The benchmark options.
+ * @param fd The shard file.
+ * @param pipeline The staging buffers.
+ * @param timing The timestamps of the shard.
+ * @return 0 on success, errno on failure.
+ */
+int WriteShardSync(const Opts &opts, int fd, StagingPipeline *pipeline, ShardTiming *timing) {
+    for (uint64_t offset = 0; offset < opts.shard_size; offset += opts.chunk_size) {
+        char *buffer = pipeline->Acquire();
+        ssize_t written = pwrite(fd, buffer, opts.chunk_size, offset);
+        pipeline->Release(buffer);
+        if (written != static_cast<ssize_t>(opts.chunk_size)) {
+            return written < 0 ? errno : EIO;
+        }
+    }
+    timing->write_done = NowNs();
+    if (fsync(fd) != 0) {
+        return errno;
+    }
+    timing->durable = NowNs();
+    return 0;
+}
+
+/**
+ * @brief Write a shard with io_uring, keeping iodepth writes in flight, and link an fsync to the last write.
+ *
+ * The last write drains all earlier writes before it starts, so the linked fsync covers the whole shard.
+ *
+ * @param opts The benchmark options.
+ * @param fd The shard file.
+ * @param pipeline The staging buffers.
+ * @param timing The timestamps of the shard.
+ * @return 0 on success, errno on failure.
+ */
+int WriteShardIoUring(const Opts &opts, int fd, StagingPipeline *pipeline, ShardTiming *timing) {
+    host_utils::IoUring ring;
+    int ret = ring.Init(opts.iodepth + 1);
+    if (ret != 0) {
+        return -ret;
+    }
+    uint64_t chunks = opts.shard_size / opts.chunk_size;
+    // User data of the fsync, the other completions carry their buffer
+    const uint64_t fsync_tag = 0;
+    uint64_t submitted = 0;
+    int inflight = 0;
+    bool synced = false;
+    while (!synced) {
+        while (submitted < chunks && inflight < opts.iodepth) {
+            char *buffer = pipeline->Acquire();
+            io_uring_sqe *sqe = ring.GetSqe();
+            host_utils::PrepRw(sqe, IORING_OP_WRITE, fd, buffer, opts.chunk_size, submitted * opts.chunk_size,
+                               reinterpret_cast<uint64_t>(buffer));
+            inflight++;
+            if (++submitted == chunks) {
+                sqe->flags = IOSQE_IO_DRAIN | IOSQE_IO_LINK;
+                host_utils::PrepRw(ring.GetSqe(), IORING_OP_FSYNC, fd, nullptr, 0, 0, fsync_tag);
+                inflight++;
+            }
+        }
+        ret = ring.Submit(1);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            return -ret;
+        }
+        io_uring_cqe *cqe = nullptr;
+        if ((ret = ring.WaitCqe(&cqe)) != 0) {
+            return -ret;
+        }
+        for (; cqe != nullptr; cqe = ring.PeekCqe()) {
+            uint64_t tag = cqe->user_data;
+            int res = cqe->res;
+            ring.SeenCqe();
+            inflight--;
+            if (tag == fsync_tag) {
+                if (res < 0) {
+                    return -res;
+                }
+                timing->durable = NowNs();
+                synced = true;
+                continue;
+            }
+            pipeline->Release(reinterpret_cast<char *>(tag));
+            if (res != static_cast<int>(opts.chunk_size)) {
+                return res < 0 ? -res : EIO;
+            }
+            timing->write_done = NowNs();
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Writer body, writes and syncs one shard once the start signal is given.
+ *
+ * @param opts The benchmark options.
+ * @param method The write method.
+ * @param shard The index of the shard.
+ * @param source The model state for the serialize stage, nullptr if disabled.
+ * @param source_size The size of the model state in bytes.
+ * @param wait_start Blocks until all writers are ready to start.
+ * @return The timestamps of the shard.
+ */
+template <typename WaitStart>
+ShardTiming WriteShard(const Opts &opts, Method method, int shard, const char *source, uint64_t source_size,
+                       WaitStart wait_start) {
+    ShardTiming timing;
+    std::string path = ShardPath(opts, method, shard);
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | (method == Method::kBuffered ? 0 : O_DIRECT);
+    int fd = open(path.c_str(), flags, 0644);
+    // Serialization overlaps with one write in flight, or with all of them with io_uring
+    int depth = method == Method::kIoUring ? opts.iodepth + 1 : 2;
+    StagingPipeline pipeline(opts, depth, source, source_size);
+    wait_start();
+    if (fd < 0) {
+        timing.error = errno;
+    } else {
+        timing.error = method == Method::kIoUring ? WriteShardIoUring(opts, fd, &pipeline, &timing)
+                                                  : WriteShardSync(opts, fd, &pipeline, &timing);
+        close(fd);
+    }
+    if (timing.error != 0) {
+        std::cerr << "Failed to write " << path << ". ERROR: " << strerror(timing.error) << std::endl;
+    }
+    return timing;
+}
+
+/**
+ * @brief Run all writers of one method as threads, released together by a start flag.
+ *
+ * @param opts The benchmark options.
+ * @param method The write method.
+ * @param source The model state for the serialize stage, nullptr if disabled.
+ * @param source_size The size of the model state in bytes.
+ * @param timings The timestamps of every shard.
+ * @return The start time in nanoseconds of the steady clock.
+ */
+int64_t RunThreads(const Opts &opts, Method method, const char *source, uint64_t source_size,
+                   std::vector<ShardTiming> *timings) {
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    auto wait_start = [&ready, &go]() {
+        ready++;
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < opts.writers; i++) {
+        threads.emplace_back(
+            [&, i]() { (*timings)[i] = WriteShard(opts, method, i, source, source_size, wait_start); });
+    }
+    while (ready.load() < opts.writers) {
+        std::this_thread::yield();
+    }
+    int64_t start = NowNs();
+    go = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return start;
+}
+
+/**
+ * @brief Run all writers of one method as processes, released together by closing a pipe.
+ *
+ * @param opts The benchmark options.
+ * @param method The write method.
+ * @param source The model state for the serialize stage, nullptr if disabled.
+ * @param source_size The size of the model state in bytes.
+ * @param timings The timestamps of every shard.
+ * @return The start time in nanoseconds of the steady clock, -1 on failure.
+ */
+int64_t RunProcesses(const Opts &opts, Method method, const char *source, uint64_t source_size,
+                     std::vector<ShardTiming> *timings) {
+    int start_pipe[2], ready_pipe[2];
+    if (pipe(start_pipe) != 0 || pipe(ready_pipe) != 0) {
+        return -1;
+    }
+    std::vector<std::pair<pid_t, int>> children;
+    for (int i = 0; i < opts.writers; i++) {
+        int result_pipe[2];
+        if (pipe(result_pipe) != 0) {
+            return -1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(start_pipe[1]);
+            close(result_pipe[0]);
+            auto wait_start = [&]() {
+                char c = 0;
+                ssize_t ret = write(ready_pipe[1], &c, 1);
+                // Returns once the parent closes its end of the pipe
+                ret = read(start_pipe[0], &c, 1);
+                (void)ret;
+            };
+            ShardTiming timing = WriteShard(opts, method, i, source, source_size, wait_start);
+            _exit(write(result_pipe[1], &timing, sizeof(timing)) == sizeof(timing) ? 0 : 1);
+        }
+        close(result_pipe[1]);
+        children.emplace_back(pid, result_pipe[0]);
+    }
+    close(start_pipe[0]);
+    close(ready_pipe[1]);
+    char c = 0;
+    for (int i = 0; i < opts.writers; i++) {
+        if (read(ready_pipe[0], &c, 1) != 1) {
+            break;
+        }
+    }
+    close(ready_pipe[0]);
+    int64_t start = NowNs();
+    close(start_pipe[1]);
+    for (int i = 0; i < opts.writers; i++) {
+        if (read(children[i].second, &(*timings)[i], sizeof(ShardTiming)) != sizeof(ShardTiming)) {
+            (*timings)[i].error = EPIPE;
+        }
+        close(children[i].second);
+        waitpid(children[i].first, nullptr, 0);
+    }
+    return start;
+}
+
+/**
+ * @brief Emit the metrics of one method.
+ *
+ * @param emitter The result emitter.
+ * @param opts The benchmark options.
+ * @param method The write method.
+ * @param start The start time in nanoseconds of the steady clock.
+ * @param timings The timestamps of every shard.
+ */
+void EmitResult(host_utils::ResultEmitter *emitter, const Opts &opts, Method method, int64_t start,
+                const std::vector<ShardTiming> &timings) {
+    std::string tag = MethodName(method);
+    host_utils::ResultTags tags = {{"method", tag}};
+    std::vector<double> durable_s, fsync_s;
+    for (size_t i = 0; i < timings.size(); i++) {
+        durable_s.push_back((timings[i].durable - start) / 1e9);
+        fsync_s.push_back((timings[i].durable - timings[i].write_done) / 1e9);
+        emitter->Metric(tag + "_shard" + std::to_string(i) + "_time_to_durable", durable_s.back(), "s",
+                        {{"method", tag}, {"shard", std::to_string(i)}});
+    }
+    double total_s = *std::max_element(durable_s.begin(), durable_s.end());
+    emitter->Metric(tag + "_time_to_durable_avg", host_utils::Mean(durable_s), "s", tags);
+    emitter->Metric(tag + "_time_to_durable_max", total_s, "s", tags);
+    emitter->Metric(tag + "_fsync_time_avg", host_utils::Mean(fsync_s), "s", tags);
+    emitter->Metric(tag + "_bw", opts.writers * opts.shard_size / total_s / 1e9, "GB/s", tags);
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    // The model state serialized by every writer, shared read only
+    std::vector<char> source;
+    if (opts.serialize) {
+        source.resize(std::min(opts.shard_size, kMaxSerializeSource));
+        std::mt19937_64 rng(1);
+        std::generate(source.begin(), source.end(), [&rng]() { return static_cast<char>(rng()); });
+    }
+
+    host_utils::ResultEmitter emitter(opts.result);
+    for (Method method : opts.methods) {
+        std::vector<ShardTiming> timings(opts.writers);
+        const char *source_data = source.empty() ? nullptr : source.data();
+        int64_t start = opts.processes ? RunProcesses(opts, method, source_data, source.size(), &timings)
+                                       : RunThreads(opts, method, source_data, source.size(), &timings);
+        bool ok = start >= 0 && std::all_of(timings.begin(), timings.end(), [](const ShardTiming &timing) {
+                      return timing.error == 0;
+                  });
+        if (!opts.keep_files) {
+            for (int i = 0; i < opts.writers; i++) {
+                unlink(ShardPath(opts, method, i).c_str());
+            }
+        }
+        if (!ok) {
+            std::cerr << "Checkpoint write failed - method: " << MethodName(method) << std::endl;
+            return 1;
+        }
+        EmitResult(&emitter, opts, method, start, timings);
+        if (emitter.Stopped()) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
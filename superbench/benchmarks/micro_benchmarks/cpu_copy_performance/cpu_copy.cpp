@@ -1,12 +1,15 @@
 #include <chrono>
 #include <cstring> // for memcpy
 #include <getopt.h>
-#include <iomanip> // for setting precision
 #include <iostream>
 #include <numa.h>
 #include <numeric>
+#include <string>
 #include <vector>
 
+#include "../host_utils/numa_copy_utils.h"
+#include "../host_utils/result_emitter.h"
+
 // Options accepted by this program.
 struct Opts {
     // Data buffer size for copy benchmark.
@@ -20,6 +23,12 @@ struct Opts {
 
     // Whether check data after copy.
     bool check_data = false;
+
+    // Whether to copy with a thread on every NUMA node with CPUs, instead of the source or destination node only.
+    bool sweep_exec_node = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
 };
 
 /**
@@ -33,7 +42,8 @@ void PrintUsage() {
               << "--size <size> "
               << "--num_warm_up <num_warm_up> "
               << "--num_loops <num_loops> "
-              << "[--check_data]" << std::endl;
+              << "[--check_data] "
+              << "[--sweep_exec_node] " << host_utils::kResultOptsUsage << std::endl;
 }
 
 /**
@@ -100,11 +110,15 @@ bool HasCPUsForNumaNode(int node) {
  */
 /**/
 int ParseOpts(int argc, char **argv, Opts *opts) {
-    enum class OptIdx { kSize, kNumWarmUp, kNumLoops, kEnableCheckData };
-    const struct option options[] = {{"size", required_argument, nullptr, static_cast<int>(OptIdx::kSize)},
-                                     {"num_warm_up", required_argument, nullptr, static_cast<int>(OptIdx::kNumWarmUp)},
-                                     {"num_loops", required_argument, nullptr, static_cast<int>(OptIdx::kNumLoops)},
-                                     {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)}};
+    enum class OptIdx { kSize, kNumWarmUp, kNumLoops, kEnableCheckData, kEnableSweepExecNode };
+    const struct option options[] = {
+        {"size", required_argument, nullptr, static_cast<int>(OptIdx::kSize)},
+        {"num_warm_up", required_argument, nullptr, static_cast<int>(OptIdx::kNumWarmUp)},
+        {"num_loops", required_argument, nullptr, static_cast<int>(OptIdx::kNumLoops)},
+        {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)},
+        {"sweep_exec_node", no_argument, nullptr, static_cast<int>(OptIdx::kEnableSweepExecNode)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
     int getopt_ret = 0;
     int opt_idx = 0;
     bool size_specified = false;
@@ -122,6 +136,13 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
         } else if (getopt_ret == '?') {
             parse_err = true;
             break;
+        } else if (host_utils::IsResultOpt(getopt_ret)) {
+            if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+                break;
+            }
+            continue;
         }
         switch (opt_idx) {
         case static_cast<int>(OptIdx::kSize):
@@ -151,6 +172,9 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
         case static_cast<int>(OptIdx::kEnableCheckData):
             opts->check_data = true;
             break;
+        case static_cast<int>(OptIdx::kEnableSweepExecNode):
+            opts->sweep_exec_node = true;
+            break;
         default:
             parse_err = true;
         }
@@ -172,32 +196,31 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
  *
  * This function measures the performance of copying memory from a source NUMA node to a destination NUMA node.
  *
- * @param src_node The source NUMA node from which memory will be copied.
- * @param dst_node The destination NUMA node to which memory will be copied.
+ * @param copy The copy of the NUMA copy matrix, with its source, destination and executing nodes.
  * @param opts A reference to an Opts structure containing various options and configurations for the benchmark.
- * @return The performance metric of the memory copy operation, typically in terms of bandwidth or latency.
+ * @return The time of the copy in nanoseconds, -1 if the data check failed.
  */
-double BenchmarkNUMACopy(int src_node, int dst_node, Opts &opts) {
+double BenchmarkNUMACopy(const host_utils::NumaCopy &copy, Opts &opts) {
     int ret = 0;
 
-    // Set CPU affinity to the NUMA node with CPU cores assoiated
-    int affinity_node = HasCPUsForNumaNode(src_node) ? src_node : dst_node;
-    ret = numa_run_on_node(affinity_node);
+    // Set CPU affinity to the executing NUMA node
+    ret = numa_run_on_node(copy.exec_node);
     if (ret != 0) {
-        std::cerr << "Failed to set CPU affinity to NUMA node " << src_node << std::endl;
+        std::cerr << "Failed to set CPU affinity to NUMA node " << copy.exec_node << std::endl;
         return 0;
     }
 
     // Allocate memory on the source and destination NUMA nodes
-    char *src = (char *)numa_alloc_onnode(opts.size, src_node);
+    char *src = (char *)numa_alloc_onnode(opts.size, copy.src_node);
     if (!src) {
-        std::cerr << "Memory allocation failed on node" << src_node << std::endl;
+        std::cerr << "Memory allocation failed on node" << copy.src_node << std::endl;
         return 0;
     }
 
-    char *dst = (char *)numa_alloc_onnode(opts.size, dst_node);
+    char *dst = (char *)numa_alloc_onnode(opts.size, copy.dst_node);
     if (!dst) {
-        std::cerr << "Memory allocation failed on node" << dst_node << std::endl;
+        std::cerr << "Memory allocation failed on node" << copy.dst_node << std::endl;
+        numa_free(src, opts.size);
         return 0;
     }
 
@@ -207,8 +230,8 @@ double BenchmarkNUMACopy(int src_node, int dst_node, Opts &opts) {
     // Measure the time taken for memcpy between nodes
     auto start = std::chrono::high_resolution_clock::now();
 
-    // Perform the memory copy
-    memcpy(dst, src, opts.size);
+    // Perform the memory copy with this thread alone
+    host_utils::NumaCopySlice(dst, src, opts.size, 0, 1);
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> diff = end - start;
@@ -216,47 +239,67 @@ double BenchmarkNUMACopy(int src_node, int dst_node, Opts &opts) {
     // Calculate the latency (nanoseconds per byte)
     double total_time_ns = diff.count() * 1e9; // Convert seconds to nanoseconds
 
+    // Check the data integrity after the copy, before the buffers are freed
+    bool data_ok = !opts.check_data || host_utils::NumaCopyCheck(copy, dst, src, opts.size);
+
     // Free the allocated memory
     numa_free(src, opts.size);
     numa_free(dst, opts.size);
 
-    if (opts.check_data) {
-        // Check the data integrity after the copy
-        if (memcmp(src, dst, opts.size) != 0) {
-            std::cerr << "Data integrity check failed!" << dst_node << std::endl;
-
-            return -1;
-        }
-    }
-
-    return total_time_ns;
+    return data_ok ? total_time_ns : -1;
 }
 
 /**
- * @brief Runs the CPU copy benchmark between all pairs of NUMA nodes.
+ * @brief Runs the CPU copy benchmark for one copy of the NUMA copy matrix.
  *
- * This function runs the CPU copy benchmark between all pairs of NUMA nodes in the system.
- * It calculates the average bandwidth and latency for each pair of nodes and outputs the results.
+ * This function runs the warm up and timed rounds of a copy and calculates the average time of one copy.
  *
- * @param src_node The source NUMA node from which data will be copied.
- * @param dst_node The destination NUMA node to which data will be copied.
+ * @param copy The copy of the NUMA copy matrix, with its source, destination and executing nodes.
  * @param opts A reference to an Opts object containing various options and configurations for the benchmark.
+ * @return The average time of one copy in nanoseconds, negative if the data check failed.
  */
-double RunCPUCopyBenchmark(int src_node, int dst_node, Opts &opts) {
+double RunCPUCopyBenchmark(const host_utils::NumaCopy &copy, Opts &opts) {
     // Run warm up rounds
-    for (int i = 0; i < opts.num_warm_up; i++) {
-        BenchmarkNUMACopy(src_node, dst_node, opts);
+    for (uint64_t i = 0; i < opts.num_warm_up; i++) {
+        BenchmarkNUMACopy(copy, opts);
     }
 
     double time_used_ns = 0;
 
-    for (int i = 0; i < opts.num_loops; i++) {
-        time_used_ns += BenchmarkNUMACopy(src_node, dst_node, opts);
+    for (uint64_t i = 0; i < opts.num_loops; i++) {
+        double copy_time_ns = BenchmarkNUMACopy(copy, opts);
+        if (copy_time_ns < 0) {
+            // The data check failed
+            return -1;
+        }
+        time_used_ns += copy_time_ns;
     }
 
     return time_used_ns / opts.num_loops;
 }
 
+/**
+ * @brief Emits the bandwidth and latency of a copy.
+ *
+ * @param copy The copy of the NUMA copy matrix, naming the metrics.
+ * @param time_used_ns The average time of one copy in nanoseconds.
+ * @param opts A reference to an Opts object containing various options and configurations for the benchmark.
+ * @param emitter The emitter of the results.
+ */
+void EmitResult(const host_utils::NumaCopy &copy, double time_used_ns, const Opts &opts,
+                 host_utils::ResultEmitter *emitter) {
+    double bw = host_utils::NumaCopyBandwidth(opts.size, time_used_ns);    // MB/s
+    double latency = host_utils::NumaCopyLatency(opts.size, time_used_ns); // ns/byte
+
+    // Output the result
+    host_utils::ResultTags tags = {{"src", std::to_string(copy.src_node)}, {"dst", std::to_string(copy.dst_node)}};
+    if (copy.sweep_exec) {
+        tags.push_back({"exec", std::to_string(copy.exec_node)});
+    }
+    emitter->Metric(copy.Name() + "_bw", bw, "MB/s", tags);
+    emitter->Metric(copy.Name() + "_lat", latency, "ns/byte", tags);
+}
+
 int main(int argc, char **argv) {
     Opts opts;
     int ret = -1;
@@ -278,39 +321,28 @@ int main(int argc, char **argv) {
         return 1;
     }
 
-    // Run the benchmark
-    for (int src_node = 0; src_node < num_of_numa_nodes; src_node++) {
-        if (!HasMemForNumaNode(src_node)) {
-            // Skip the NUMA node if there are no memory available
-            continue;
+    // Nodes with memory to copy between and with CPUs to copy with, empty NUMA nodes in Grace CPU being reserved for
+    // multi-instance GPUs and memory-only ones being for GPUs
+    std::vector<int> mem_nodes, cpu_nodes;
+    for (int node = 0; node < num_of_numa_nodes; node++) {
+        if (HasMemForNumaNode(node)) {
+            mem_nodes.push_back(node);
         }
+        if (HasCPUsForNumaNode(node)) {
+            cpu_nodes.push_back(node);
+        }
+    }
 
-        for (int dst_node = 0; dst_node < num_of_numa_nodes; dst_node++) {
-            if (src_node == dst_node) {
-                // Skip the same NUMA node
-                continue;
-            }
-
-            if (!HasMemForNumaNode(dst_node)) {
-                // Skip the NUMA node if there are no memory available
-                continue;
-            }
-
-            //
-            if (!HasCPUsForNumaNode(src_node) && !HasCPUsForNumaNode(dst_node)) {
-                // Skip the process if there are no CPUs available on both NUMA nodes
-                continue;
-            }
-
-            double time_used_ns = RunCPUCopyBenchmark(src_node, dst_node, opts);
-            double bw = opts.size / (time_used_ns / 1e9) / 1e6; // MB/s
-            double latency = time_used_ns / opts.size;          // ns/byte
-
-            // Output the result
-            std::cout << "mem_bandwidth_matrix_numa_" << src_node << "_" << dst_node << "_bw: " << std::setprecision(9)
-                      << bw << std::endl;
-            std::cout << "mem_bandwidth_matrix_numa_" << src_node << "_" << dst_node << "_lat: " << std::setprecision(9)
-                      << latency << std::endl;
+    // Run the benchmark, stopping at the first copy failing the baseline with --fail_fast
+    host_utils::ResultEmitter emitter(opts.result);
+    for (const auto &copy : host_utils::NumaCopyMatrix(mem_nodes, cpu_nodes, false, opts.sweep_exec_node)) {
+        double time_used_ns = RunCPUCopyBenchmark(copy, opts);
+        if (time_used_ns < 0) {
+            return 1;
+        }
+        EmitResult(copy, time_used_ns, opts, &emitter);
+        if (emitter.Stopped()) {
+            return 1;
         }
     }
 
@@ -70,6 +70,14 @@ def add_parser_arguments(self):
             help='Enable data checking for non mlc benchmark. Default is False.',
         )
 
+        self._parser.add_argument(
+            '--sweep_exec_node',
+            action='store_true',
+            help='Copy with a thread on every NUMA node for non mlc benchmark, giving a source x destination x '
+            'executing node matrix. Default is False.',
+        )
+        self._add_result_record_arguments()
+
     def _preprocess_mlc(self):
         """Preprocess/preparation operations for the Intel MLC tool."""
         mlc_path = os.path.join(self._args.bin_dir, self._bin_name)
@@ -105,6 +113,11 @@ def _preprocess_general(self):
         if self._args.check_data:
             args += ' --check_data'
 
+        if self._args.sweep_exec_node:
+            args += ' --sweep_exec_node'
+
+        args += self._result_record_args()
+
         self._commands = ['%s %s' % (self.__bin_path, args)]
 
         return True
@@ -164,24 +177,8 @@ def _process_raw_result_mlc(self, cmd_idx, raw_output):
         return True
 
     def _process_raw_result_general(self, cmd_idx, raw_output):
-        """Function to parse raw results for the general CPU copy benchmark and save the summarized results."""
-        self._result.add_raw_data('raw_output_' + str(cmd_idx), raw_output, self._args.log_raw_data)
-
-        try:
-            for output_line in raw_output.strip().splitlines():
-                name, value = output_line.split(':')
-                self._result.add_result(name.strip(), float(value.strip()))
-        except BaseException as e:
-            self._result.set_return_code(ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
-            logger.error(
-                'The result format is invalid - round: {}, benchmark: {}, raw output: {}, message: {}.'.format(
-                    self._curr_run_index, self._name, raw_output, str(e)
-                )
-            )
-
-            return False
-
-        return True
+        """Function to parse the result records of the general CPU copy benchmark and save the summarized results."""
+        return self._process_result_records(cmd_idx, raw_output)
 
     def _process_raw_result(self, cmd_idx, raw_output):
         """Function to parse raw results and save the summarized results.
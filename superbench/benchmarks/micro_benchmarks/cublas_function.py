@@ -6,7 +6,6 @@
 import os
 import json
 import yaml
-import statistics
 
 from superbench.common.utils import logger
 from superbench.benchmarks import Platform, BenchmarkRegistry, ReturnCode
@@ -246,6 +245,7 @@ def add_parser_arguments(self):
             help='Enable random data generation for performance test. ' +
             'By default, the data is filled with fixed value for performance test.',
         )
+        self._add_result_record_arguments()
 
     def _preprocess(self):
         """Preprocess/preparation operations before the benchmarking.
@@ -264,6 +264,7 @@ def _preprocess(self):
         command += ' --correctness' if self._args.correctness else ''
         command += (' --eps ' + str(self._args.eps)) if self._args.eps is not None else ''
         command += ' --random_data' if self._args.random_data else ''
+        command += self._result_record_args()
 
         try:
             if not self._args.config_json_str:
@@ -286,7 +287,7 @@ def _preprocess(self):
             return False
         return True
 
-    def _process_raw_result(self, cmd_idx, raw_output):    # noqa: C901
+    def _process_raw_result(self, cmd_idx, raw_output):
         """Function to process raw results and save the summarized results.
 
           self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
@@ -298,57 +299,15 @@ def _process_raw_result(self, cmd_idx, raw_output):    # noqa: C901
         Return:
             True if the raw output string is valid and result can be extracted.
         """
-        self._result.add_raw_data('raw_output_' + str(cmd_idx), raw_output, self._args.log_raw_data)
-
-        try:
-            lines = raw_output.splitlines()
-            metric = ''
-            error = False
-            raw_data = []
-            for line in lines:
-                if '[function config]' in line:
-                    metric = ''
-                    metric_json_str = line[line.index('[function config]: ') +
-                                           len('[function config]: '):].replace(' ', '').replace(':', '_')[1:-1]
-                    metric_list = metric_json_str.split(',')
-                    for key in metric_list:
-                        if 'name' in key:
-                            metric = key + metric
-                        else:
-                            metric = metric + '_' + key
-                if '[raw_data]' in line:
-                    raw_data = line[line.index('[raw_data]: ') + len('[raw_data]: '):]
-                    raw_data = raw_data.split(',')
-                    raw_data.pop()
-                    raw_data = [float(item) for item in raw_data]
-                    self._result.add_result(metric.lower() + '_time', statistics.mean(raw_data))
-                    self._result.add_raw_data(metric.lower() + '_time', raw_data, self._args.log_raw_data)
-                if 'Error' in line:
-                    error = True
-                if '[correctness]' in line:
-                    if 'PASS' in line:
-                        self._result.add_result(metric.lower() + '_correctness', 1)
-                    elif 'FAIL' in line:
-                        self._result.add_result(metric.lower() + '_correctness', 0)
-                    error_rate = float(line.split(' ')[-1])
-                    self._result.add_result(metric.lower() + '_error_rate', error_rate)
-
-        except BaseException as e:
-            logger.error(
-                'Cannot extract results from cublas functions - round: {}, index of cmd: {}, \
-                benchmark: {}, raw data: {}, message: {}'.format(
-                    self._curr_run_index, cmd_idx, self._name, raw_output, str(e)
-                )
-            )
-            return False
-        if error:
+        if 'Error' in raw_output:
+            self._result.add_raw_data('raw_output_' + str(cmd_idx), raw_output, self._args.log_raw_data)
             logger.error(
                 'Error in running cublas test - round: {}, index of cmd: {}, benchmark: {}, raw data: {}'.format(
                     self._curr_run_index, cmd_idx, self._name, raw_output
                 )
             )
             return False
-        return True
+        return self._process_result_records(cmd_idx, raw_output)
 
 
 BenchmarkRegistry.register_benchmark('cublas-function', CublasBenchmark, platform=Platform.CUDA)
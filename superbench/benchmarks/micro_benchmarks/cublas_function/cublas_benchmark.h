@@ -8,15 +8,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <complex>
 #include <iostream>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <stdlib.h>
 #include <time.h>
 #include <unordered_map>
 #include <vector>
 
+#include "../host_utils/result_emitter.h"
 #include "cublas_helper.h"
 
 /**
@@ -219,11 +224,28 @@ class CublasFunction {
             throw "invalid input function name";
         }
     }
+    /**
+     * @brief Get the metric name of the function, name_<function name>_<param>_<value>... in lower case
+     * @return std::string the metric name without the suffix of the metric
+     */
+    std::string get_metric_name() {
+        std::string str = this->function_str_;
+        str.erase(std::remove(str.begin(), str.end(), ' '), str.end());
+        std::replace(str.begin(), str.end(), ':', '_');
+        std::string metric, key;
+        std::istringstream keys(str.substr(1, str.size() - 2));
+        while (std::getline(keys, key, ',')) {
+            metric = key.find("name") != std::string::npos ? key + metric : metric + "_" + key;
+        }
+        std::transform(metric.begin(), metric.end(), metric.begin(), ::tolower);
+        return metric;
+    }
     /**
      * @brief The main procedure for cublas function test, includingwarmup, function test, time measurement
      * and output raw data results
+     * @param  emitter          the emitter of the results
      */
-    void benchmark();
+    void benchmark(host_utils::ResultEmitter *emitter);
     /**
      * @brief Destroy the Cublas Function object
      */
@@ -233,7 +255,8 @@ class CublasFunction {
 /**
  * @brief Fill the random data into the input in float type
  */
-template <> void CublasFunction::fill_data(float *Parameter_0_0_host, float *Parameter_1_0_host, bool random) {
+template <>
+inline void CublasFunction::fill_data(float *Parameter_0_0_host, float *Parameter_1_0_host, bool random) {
     if (random) {
         srand(random_seed);
         for (int i = 0; i < m_ * k_ * batch_count_; i++) {
@@ -253,7 +276,8 @@ template <> void CublasFunction::fill_data(float *Parameter_0_0_host, float *Par
 /**
  * @brief Fill the random data into the input in half type
  */
-template <> void CublasFunction::fill_data(half *Parameter_0_0_host, half *Parameter_1_0_host, bool random) {
+template <>
+inline void CublasFunction::fill_data(half *Parameter_0_0_host, half *Parameter_1_0_host, bool random) {
     if (random) {
         srand(random_seed);
         for (int i = 0; i < m_ * k_ * batch_count_; i++) {
@@ -271,7 +295,9 @@ template <> void CublasFunction::fill_data(half *Parameter_0_0_host, half *Param
 /**
  * @brief Fill the random data into the input in cuComplex type
  */
-template <> void CublasFunction::fill_data(cuComplex *Parameter_0_0_host, cuComplex *Parameter_1_0_host, bool random) {
+template <>
+inline void CublasFunction::fill_data(cuComplex *Parameter_0_0_host, cuComplex *Parameter_1_0_host,
+                                      bool random) {
     if (random) {
         srand(random_seed);
         for (int i = 0; i < m_ * k_ * batch_count_; i++) {
@@ -381,10 +407,11 @@ void CublasFunction::matrix_calculation_on_cpu_with_data(const T1 *Parameter_0_0
  * @brief Transpose the colomn-order stored matrix with complex datatype
  */
 template <>
-void CublasFunction::matrix_calculation_on_cpu_with_data(const cuComplex *Parameter_0_0_host,
-                                                         const cuComplex *Parameter_1_0_host,
-                                                         const cuComplex *Result_3_0, std::complex<float> **Result_cpu,
-                                                         std::complex<float> alpha, std::complex<float> beta) {
+inline void CublasFunction::matrix_calculation_on_cpu_with_data(const cuComplex *Parameter_0_0_host,
+                                                                const cuComplex *Parameter_1_0_host,
+                                                                const cuComplex *Result_3_0,
+                                                                std::complex<float> **Result_cpu,
+                                                                std::complex<float> alpha, std::complex<float> beta) {
     int m = this->m_, n = this->n_, k = this->k_, batch_count = this->batch_count_;
     // Copy result from device to host
     std::complex<float> *Result_3_0_host;
@@ -462,7 +489,8 @@ int CublasFunction::check_result(int batch_count, T1 *Result_3_0, T2 *Result_cpu
  * @brief Check if the error < eps between the calculation result of GPU and CPU for each element in the matrix
  */
 template <>
-int CublasFunction::check_result(int batch_count, cuComplex *Result_3_0, std::complex<float> *Result_cpu, double eps) {
+inline int CublasFunction::check_result(int batch_count, cuComplex *Result_3_0, std::complex<float> *Result_cpu,
+                                         double eps) {
     int m = this->m_, n = this->n_, k = this->k_;
     // Copy result from device to host
     std::complex<float> *Result_3_0_host;
@@ -490,9 +518,9 @@ int CublasFunction::check_result(int batch_count, cuComplex *Result_3_0, std::co
 }
 /**
  * @brief The main procedure for cublas function test, including warmup, function test, time measurement and output raw
- * data results
+ * data results, stopping at the first step failing the baseline with --fail_fast
  */
-void CublasFunction::benchmark() {
+inline void CublasFunction::benchmark(host_utils::ResultEmitter *emitter) {
     // Malloc memory for input and output data
     bool random = this->correctness ? true : this->random_data;
     this->prepare_tensor(random);
@@ -504,7 +532,8 @@ void CublasFunction::benchmark() {
     CUDA_SAFE_CALL(cudaDeviceSynchronize());
 
     // Prepare some varibles for time measurement
-    std::vector<float> iteration_time;
+    std::string metric = this->get_metric_name();
+    std::vector<double> iteration_time;
     int errors = 0;
     // Benchmark in range of steps
     for (int i_ = 0; i_ < num_test; i_++) {
@@ -524,18 +553,31 @@ void CublasFunction::benchmark() {
         // Convert step time to single function duration and update min and max duration
         float i = static_cast<float>(std::chrono::duration<double, std::micro>(end - start).count() / num_in_step);
         iteration_time.emplace_back(i);
+        if (emitter->Observe(metric + "_time", i)) {
+            break;
+        }
     }
 
     // Output results
     std::cout << "[function config]: " << this->function_str_ << std::endl;
-    std::cout << "[raw_data]: ";
-    for (int i = 0; i < iteration_time.size(); i++) {
-        std::cout << iteration_time[i] << ",";
+    host_utils::ResultTags tags = {{"function", this->name_}};
+    // The text output keeps its "[raw_data]: " and "[correctness]: " lines
+    std::ostringstream raw_data;
+    raw_data << "[raw_data]: ";
+    for (double time : iteration_time) {
+        raw_data << time << ",";
     }
-    std::cout << std::endl;
+    emitter->Samples(metric + "_time", iteration_time, "us", tags);
+    emitter->Metric(metric + "_time",
+                    std::accumulate(iteration_time.begin(), iteration_time.end(), 0.0) / iteration_time.size(), "us",
+                    tags, raw_data.str());
     if (this->correctness) {
-        std::string correctness_str = errors == 0 ? "Result = PASS" : "Result = FAIL";
-        std::cout << "[correctness]: " << correctness_str
-                  << ", error rate: " << errors / (num_in_step * num_test * this->m_ * this->n_) << std::endl;
+        // Over the elements of the steps actually run, fewer than num_test if stopped at a baseline failure
+        double elements = static_cast<double>(iteration_time.size()) * num_in_step * this->m_ * this->n_;
+        std::ostringstream correctness;
+        correctness << "[correctness]: " << (errors == 0 ? "Result = PASS" : "Result = FAIL")
+                    << ", error rate: " << errors / elements;
+        emitter->Metric(metric + "_correctness", errors == 0 ? 1 : 0, "", tags, correctness.str());
+        emitter->Metric(metric + "_error_rate", errors / elements, "", tags, "");
     }
 }
@@ -99,6 +99,7 @@ class Options {
     bool correctness_check;
     double eps;
     bool random_data;
+    host_utils::ResultOpts result;
 
     /**
      * @brief Construct a options object according to cmd or set a default value used to test
@@ -122,6 +123,18 @@ class Options {
         correctness_check = get_cmd_line_argument_bool("--correctness");
         eps = get_cmd_line_argument_double("--eps");
         random_data = get_cmd_line_argument_bool("--random_data");
+        const std::pair<std::string, int> result_opts[] = {
+            {"--result_format", host_utils::kResultFormatOpt},
+            {"--result_fd", host_utils::kResultFdOpt},
+            {"--baseline", host_utils::kBaselineOpt},
+            {"--baseline_confidence", host_utils::kBaselineConfidenceOpt}};
+        for (const auto &opt : result_opts) {
+            char *value = get_cmd_option(opt.first);
+            if (value && !host_utils::ParseResultOpt(opt.second, value, &result)) {
+                throw std::runtime_error("invalid " + opt.first + ": " + value);
+            }
+        }
+        result.fail_fast = get_cmd_line_argument_bool("--fail_fast");
     }
 };
 
@@ -232,8 +245,10 @@ CublasFunction *get_cublas_function_pointer(CublasFunction &function) {
  * finally run the benchmark of the funcion
  *
  * @param  options  the cmd arguments of the application
+ * @return int      1 if stopped at a baseline failure with --fail_fast, otherwise 0
  */
-void run_benchmark(Options &options) {
+int run_benchmark(Options &options) {
+    host_utils::ResultEmitter emitter(options.result);
     try {
         json function_config = json::parse(options.para_info_json);
         CublasFunction function = function_config.get<CublasFunction>();
@@ -245,9 +260,10 @@ void run_benchmark(Options &options) {
         function.set_eps(options.eps);
         function.set_random_data(options.random_data);
         CublasFunction *p_function = get_cublas_function_pointer(function);
-        p_function->benchmark();
+        p_function->benchmark(&emitter);
         delete p_function;
     } catch (std::exception &e) {
         std::cout << "Error: " << e.what() << std::endl;
     }
+    return emitter.Stopped() ? 1 : 0;
 }
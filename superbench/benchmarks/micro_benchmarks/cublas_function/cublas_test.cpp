@@ -36,7 +36,7 @@ int main(int argc, char *argv[]) {
         // parse arguments from cmd
         Options options(argc, argv);
         // benchmark each function defined in 'para_info.json'
-        run_benchmark(options);
+        return run_benchmark(options);
     } catch (std::exception &e) {
         std::cout << "Error: " << e.what() << std::endl;
         exit(-1);
@@ -7,7 +7,7 @@
 
 from superbench.common.utils import logger
 from superbench.benchmarks import BenchmarkRegistry, Platform, ReturnCode
-from superbench.benchmarks.micro_benchmarks import BlasLtBaseBenchmark
+from superbench.benchmarks.micro_benchmarks import BlasLtBaseBenchmark, result_records
 
 
 class CublasLtBenchmark(BlasLtBaseBenchmark):
@@ -70,6 +70,7 @@ def add_parser_arguments(self):
             required=False,
             help='List of ncu profiling metrics, support all ncu metrics.',
         )
+        self._add_result_record_arguments()
 
     def _preprocess(self):
         """Preprocess/preparation operations before the benchmarking.
@@ -91,7 +92,8 @@ def _preprocess(self):
             ) if self._args.enable_autotune else ''
             command = f'{self.__bin_path} -m {_m} -n {_n} -k {_k} -b {_b} ' + \
                 f'-w {self._args.num_warmup} -i {self._args.num_steps} -t {_in_type}' + \
-                f'{(" " + autotune_args) if autotune_args else ""}'
+                f'{(" " + autotune_args) if autotune_args else ""}' + \
+                self._result_record_args()
             if self._args.enable_ncu_profiling:
                 skip_num = self._args.num_warmup - 1 if self._args.num_warmup > 1 else 0
                 command = f'ncu --set full --launch-skip {skip_num} --launch-count 1 --csv ' + command
@@ -111,37 +113,19 @@ def _process_raw_result(self, cmd_idx, raw_output):    # noqa: C901
         Return:
             True if the raw output string is valid and result can be extracted.
         """
-        self._result.add_raw_data(f'raw_output_{cmd_idx}', raw_output, self._args.log_raw_data)
+        if not self._process_result_records(cmd_idx, raw_output):
+            return False
 
         try:
-            if not self._args.enable_ncu_profiling:
-                fields = raw_output.strip().split()
-                if len(fields) != 6 or not all(x.isdigit() for x in fields[:4]):
-                    raise ValueError('Invalid result.')
-                self._result.add_result(
-                    f'{self._commands[cmd_idx].split()[-1]}_{fields[3]}_{"_".join(fields[:3])}_flops',
-                    float(fields[-1])
-                )
-            else:
+            if self._args.enable_ncu_profiling:
                 lines = raw_output.strip().split('\n')
                 # find line index of the line that starts with "ID","Process ID"
                 start_idx = next(i for i, line in enumerate(lines) if 'Metric Name' in line)
                 if start_idx == 0 or start_idx == len(lines) - 1:
                     raise ValueError('Invalid result.')
-                result_lines = lines[0:start_idx - 1]
-                result = False
-                size = ''
-                for line in result_lines:
-                    fields = line.strip().split()
-                    if len(fields) == 6 and all(x.isdigit() for x in fields[:4]):
-                        result = True
-                        size = f'{fields[3]}_{"_".join(fields[:3])}'
-                        self._result.add_result(
-                            f'{self._commands[cmd_idx].split()[-1]}_{fields[3]}_{"_".join(fields[:3])}_flops',
-                            float(fields[-1])
-                        )
-                if not result:
-                    raise ValueError('Invalid result.')
+                # name the profiling metrics after the flops metric, <in_type>_<batch>_<m>_<n>_<k>
+                records = result_records.decode_jsonl('\n'.join(lines[0:start_idx]))
+                size = records[-1]['name'][:-len('_flops')]
                 metric_name_index = lines[start_idx].strip().split(',').index('"Metric Name"')
                 metric_value_index = lines[start_idx].strip().split(',').index('"Metric Value"')
                 if metric_name_index < 0 or metric_value_index < 0:
@@ -155,9 +139,7 @@ def _process_raw_result(self, cmd_idx, raw_output):    # noqa: C901
                         value = fields[metric_value_index].strip(',').strip('"')
                         try:
                             float_value = float(value)
-                            self._result.add_result(
-                                f'{self._commands[cmd_idx].split()[-1]}_{size}_{metric_name}', float_value
-                            )
+                            self._result.add_result(f'{size}_{metric_name}', float_value)
                         except ValueError:
                             pass
         except BaseException as e:
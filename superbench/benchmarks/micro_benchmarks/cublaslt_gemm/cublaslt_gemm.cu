@@ -4,6 +4,7 @@
 #include <getopt.h>
 #include <memory>
 #include <stdio.h>
+#include <string>
 
 #include <cuda.h>
 #include <cuda_fp16.h>
@@ -14,6 +15,7 @@
 using fp4e2m1 = __nv_fp4_e2m1;
 #endif
 
+#include "../host_utils/result_emitter.h"
 #include "cublaslt_utils.h"
 
 using fp64 = double;
@@ -37,6 +39,8 @@ struct Args {
     int iter_autotune = 50;
     std::string in_type = "fp8e4m3";
     bool autotune = false;
+    // Format and file descriptor of the results
+    host_utils::ResultOpts result;
 };
 
 void process_args(int argc, char **argv, Args *args) {
@@ -49,6 +53,8 @@ void process_args(int argc, char **argv, Args *args) {
         {"autotune", no_argument, nullptr, 'a'},
         {"iter-autotune", required_argument, nullptr, 'I'},
         {"warmup-autotune", required_argument, nullptr, 'W'},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0},
     };
 
     int opt = 0;
@@ -84,6 +90,10 @@ void process_args(int argc, char **argv, Args *args) {
         case 'W':
             args->warmup_autotune = std::stoi(optarg);
             break;
+        default:
+            if (host_utils::IsResultOpt(opt) && !host_utils::ParseResultOpt(opt, optarg, &args->result)) {
+                throw std::invalid_argument("Invalid result option " + std::string(optarg));
+            }
         }
     }
 }
@@ -182,38 +192,45 @@ float timing_matmul_tn(size_t m, size_t n, size_t k, size_t batch, int warmup, i
     return (time * 1e3 / iter);
 }
 
-template <typename Ta, typename Tb = Ta, typename Tout = Ta, typename Tc = Tout> void run(const Args *args) {
+template <typename Ta, typename Tb = Ta, typename Tout = Ta, typename Tc = Tout>
+void run(const Args *args, host_utils::ResultEmitter *emitter) {
     float time_us = timing_matmul_tn<Ta, Tb, Tout, Tc>(args->m, args->n, args->k, args->batch, args->warmup, args->iter,
                                                        args->autotune, args->iter_autotune, args->warmup_autotune);
-    // m n k batch time_us tflops
-    printf("%d\t%d\t%d\t%d\t%f\t%f\n", args->m, args->n, args->k, args->batch, time_us,
-           float(args->m) * float(args->n) * float(2 * args->k - 1) / 1e6 / time_us * std::max(args->batch, 1));
+    float tflops = float(args->m) * float(args->n) * float(2 * args->k - 1) / 1e6 / time_us * std::max(args->batch, 1);
+    // <in_type>_<batch>_<m>_<n>_<k>_flops in TFLOPS, the text output keeping its "m n k batch time_us tflops" lines
+    std::string batch = std::to_string(args->batch), m = std::to_string(args->m), n = std::to_string(args->n),
+                k = std::to_string(args->k);
+    char text[256];
+    snprintf(text, sizeof(text), "%d\t%d\t%d\t%d\t%f\t%f", args->m, args->n, args->k, args->batch, time_us, tflops);
+    emitter->Metric(args->in_type + "_" + batch + "_" + m + "_" + n + "_" + k + "_flops", tflops, "TFLOPS",
+                    {{"in_type", args->in_type}, {"batch", batch}, {"m", m}, {"n", n}, {"k", k}}, text);
 }
 
 int main(int argc, char **argv) {
     Args args;
     process_args(argc, argv, &args);
+    host_utils::ResultEmitter emitter(args.result);
 
     if (args.in_type == "fp64")
-        run<fp64>(&args);
+        run<fp64>(&args, &emitter);
     else if (args.in_type == "fp32")
-        run<fp32>(&args);
+        run<fp32>(&args, &emitter);
     else if (args.in_type == "fp16")
-        run<fp16>(&args);
+        run<fp16>(&args, &emitter);
     else if (args.in_type == "bf16")
-        run<bf16>(&args);
+        run<bf16>(&args, &emitter);
     else if (args.in_type == "fp8e4m3")
-        run<fp8e4m3, fp8e4m3, fp16>(&args);
+        run<fp8e4m3, fp8e4m3, fp16>(&args, &emitter);
     else if (args.in_type == "fp8e5m2")
-        run<fp8e5m2, fp8e4m3, fp16>(&args);
+        run<fp8e5m2, fp8e4m3, fp16>(&args, &emitter);
 #if CUDA_VERSION >= 12080
     else if (args.in_type == "fp4e2m1")
-        run<fp4e2m1, fp4e2m1, fp4e2m1, fp16>(&args);
+        run<fp4e2m1, fp4e2m1, fp4e2m1, fp16>(&args, &emitter);
 #endif
     else if (args.in_type == "int8")
-        run<int8>(&args);
+        run<int8>(&args, &emitter);
     else
         throw std::invalid_argument("Unknown type " + args.in_type);
 
-    return 0;
+    return emitter.Stopped() ? 1 : 0;
 }
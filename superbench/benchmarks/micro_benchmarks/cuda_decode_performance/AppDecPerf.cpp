@@ -16,6 +16,7 @@
 
 #include "../Utils/FFmpegDemuxer.h"
 #include "../Utils/NvCodecUtils.h"
+#include "MetricsUtils.h"
 #include "OptimizedNvDecoder.h"
 #include "ThreadPoolUtils.h"
 
@@ -301,24 +302,6 @@ void WriteRawData(std::vector<OptimizedNvDecoder *> &vDec, int nThread, const st
     outputFile.close();
 }
 
-/**
- * @brief  Function to calculate the statistical metrics
- */
-std::tuple<double, double, double, double, double, double, double, double>
-CalMetrics(const std::vector<double> &originData) {
-    std::vector<double> data = originData;
-    double sum = std::accumulate(data.begin(), data.end(), 0.0);
-    double mean = sum / data.size();
-    double min = *std::min_element(data.begin(), data.end());
-    double max = *std::max_element(data.begin(), data.end());
-    std::sort(data.begin(), data.end());
-    double p50 = data[data.size() / 2];
-    double p90 = data[static_cast<size_t>(data.size() * 0.9)];
-    double p95 = data[static_cast<size_t>(data.size() * 0.95)];
-    double p99 = data[static_cast<size_t>(data.size() * 0.99)];
-    return std::make_tuple(sum, mean, min, max, p50, p90, p95, p99);
-}
-
 /**
  * @brief  Function to generate the total file list for the given total number of videos.
  *        If the number of videos is less than the total number of videos, the list will be repeated.
@@ -0,0 +1,27 @@
+// Copyright(c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+#pragma once
+
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+/**
+ * @brief  Function to calculate the statistical metrics
+ */
+inline std::tuple<double, double, double, double, double, double, double, double>
+CalMetrics(const std::vector<double> &originData) {
+    std::vector<double> data = originData;
+    double sum = std::accumulate(data.begin(), data.end(), 0.0);
+    double mean = sum / data.size();
+    double min = *std::min_element(data.begin(), data.end());
+    double max = *std::max_element(data.begin(), data.end());
+    std::sort(data.begin(), data.end());
+    double p50 = data[data.size() / 2];
+    double p90 = data[static_cast<size_t>(data.size() * 0.9)];
+    double p95 = data[static_cast<size_t>(data.size() * 0.95)];
+    double p99 = data[static_cast<size_t>(data.size() * 0.99)];
+    return std::make_tuple(sum, mean, min, max, p50, p90, p95, p99);
+}
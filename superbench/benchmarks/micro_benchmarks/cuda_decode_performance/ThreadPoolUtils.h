@@ -1,6 +1,8 @@
 // Copyright(c) Microsoft Corporation.
 // Licensed under the MIT License.
 
+#pragma once
+
 #include <condition_variable>
 #include <functional>
 #include <future>
@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the single precision complex type of CUDA.
+
+#pragma once
+
+#include "cuda_runtime.h"
+
+typedef float2 cuFloatComplex;
+typedef cuFloatComplex cuComplex;
+
+inline cuFloatComplex make_cuFloatComplex(float r, float i) { return make_float2(r, i); }
+inline cuComplex make_cuComplex(float r, float i) { return make_float2(r, i); }
+inline float cuCrealf(cuFloatComplex x) { return x.x; }
+inline float cuCimagf(cuFloatComplex x) { return x.y; }
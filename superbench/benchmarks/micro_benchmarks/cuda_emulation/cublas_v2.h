@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the subset of cuBLAS used by the GPU micro-benchmarks, see cuda_runtime.h.
+// The GEMMs are computed naively in column-major order on the stream of the handle, in float or complex float for
+// half and float data, so that the results are checked as on the GPU.
+
+#pragma once
+
+#include <algorithm>
+#include <complex>
+
+#include "cuComplex.h"
+#include "cuda_fp16.h"
+#include "cuda_runtime.h"
+
+typedef enum {
+    CUBLAS_STATUS_SUCCESS = 0,
+    CUBLAS_STATUS_NOT_INITIALIZED = 1,
+    CUBLAS_STATUS_INVALID_VALUE = 7,
+    CUBLAS_STATUS_NOT_SUPPORTED = 15
+} cublasStatus_t;
+
+typedef enum { CUBLAS_OP_N = 0, CUBLAS_OP_T = 1, CUBLAS_OP_C = 2 } cublasOperation_t;
+
+typedef enum { CUBLAS_COMPUTE_32F = 68 } cublasComputeType_t;
+
+typedef enum { CUBLAS_GEMM_DFALT = -1, CUBLAS_GEMM_DEFAULT = -1, CUBLAS_GEMM_DFALT_TENSOR_OP = 99 } cublasGemmAlgo_t;
+
+struct cublasContext {
+    cudaStream_t stream = nullptr;
+};
+typedef struct cublasContext *cublasHandle_t;
+
+namespace cuda_emu {
+
+// Conversions between the data types and the compute types.
+inline float ToCompute(float x) { return x; }
+inline float ToCompute(__half x) { return static_cast<float>(x); }
+inline std::complex<float> ToCompute(cuComplex x) { return {x.x, x.y}; }
+template <typename T> T FromCompute(float x) { return T(x); }
+template <typename T> T FromCompute(std::complex<float> x) { return make_cuComplex(x.real(), x.imag()); }
+
+template <typename C> C Op(cublasOperation_t op, C x) { return x; }
+template <> inline std::complex<float> Op(cublasOperation_t op, std::complex<float> x) {
+    return op == CUBLAS_OP_C ? std::conj(x) : x;
+}
+
+/**
+ * @brief Enqueue the batched GEMM C = alpha * op(A) * op(B) + beta * C of column-major matrices on the handle stream.
+ *
+ * @tparam T The data type.
+ * @tparam C The compute type.
+ * @return The status of the arguments.
+ */
+template <typename T, typename C>
+cublasStatus_t Gemm(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m, int n, int k,
+                    C alpha, const T *a, int lda, long long stride_a, const T *b, int ldb, long long stride_b, C beta,
+                    T *c, int ldc, long long stride_c, int batch_count) {
+    if (handle == nullptr) {
+        return CUBLAS_STATUS_NOT_INITIALIZED;
+    }
+    if (m < 0 || n < 0 || k < 0 || batch_count < 0 || ldc < std::max(1, m) ||
+        lda < std::max(1, transa == CUBLAS_OP_N ? m : k) || ldb < std::max(1, transb == CUBLAS_OP_N ? k : n)) {
+        return CUBLAS_STATUS_INVALID_VALUE;
+    }
+    Runtime::Get().Resolve(handle->stream)->Enqueue([=] {
+        for (int batch = 0; batch < batch_count; batch++) {
+            const T *batch_a = a + batch * stride_a;
+            const T *batch_b = b + batch * stride_b;
+            T *batch_c = c + batch * stride_c;
+            for (int j = 0; j < n; j++) {
+                for (int i = 0; i < m; i++) {
+                    C sum = C(0);
+                    for (int p = 0; p < k; p++) {
+                        T ea = transa == CUBLAS_OP_N ? batch_a[i + static_cast<long long>(p) * lda]
+                                                     : batch_a[p + static_cast<long long>(i) * lda];
+                        T eb = transb == CUBLAS_OP_N ? batch_b[p + static_cast<long long>(j) * ldb]
+                                                     : batch_b[j + static_cast<long long>(p) * ldb];
+                        sum += Op(transa, ToCompute(ea)) * Op(transb, ToCompute(eb));
+                    }
+                    T &out = batch_c[i + static_cast<long long>(j) * ldc];
+                    // C is not read when beta is zero
+                    out = FromCompute<T>(alpha * sum + (beta == C(0) ? C(0) : beta * ToCompute(out)));
+                }
+            }
+        }
+    });
+    return CUBLAS_STATUS_SUCCESS;
+}
+
+/**
+ * @brief Enqueue a GEMM of the data types of cublasGemmEx, all of A, B and C being of the same type.
+ */
+inline cublasStatus_t GemmEx(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m, int n,
+                             int k, const void *alpha, const void *a, cudaDataType_t a_type, int lda,
+                             long long stride_a, const void *b, cudaDataType_t b_type, int ldb, long long stride_b,
+                             const void *beta, void *c, cudaDataType_t c_type, int ldc, long long stride_c,
+                             int batch_count, cublasComputeType_t compute_type) {
+    if (a_type != b_type || a_type != c_type || compute_type != CUBLAS_COMPUTE_32F) {
+        return CUBLAS_STATUS_NOT_SUPPORTED;
+    }
+    float alpha_value = *static_cast<const float *>(alpha);
+    float beta_value = *static_cast<const float *>(beta);
+    if (a_type == CUDA_R_32F) {
+        return Gemm(handle, transa, transb, m, n, k, alpha_value, static_cast<const float *>(a), lda, stride_a,
+                    static_cast<const float *>(b), ldb, stride_b, beta_value, static_cast<float *>(c), ldc, stride_c,
+                    batch_count);
+    } else if (a_type == CUDA_R_16F) {
+        return Gemm(handle, transa, transb, m, n, k, alpha_value, static_cast<const __half *>(a), lda, stride_a,
+                    static_cast<const __half *>(b), ldb, stride_b, beta_value, static_cast<__half *>(c), ldc, stride_c,
+                    batch_count);
+    }
+    return CUBLAS_STATUS_NOT_SUPPORTED;
+}
+
+} // namespace cuda_emu
+
+inline cublasStatus_t cublasCreate(cublasHandle_t *handle) {
+    *handle = new cublasContext();
+    return CUBLAS_STATUS_SUCCESS;
+}
+
+inline cublasStatus_t cublasDestroy(cublasHandle_t handle) {
+    if (handle == nullptr) {
+        return CUBLAS_STATUS_NOT_INITIALIZED;
+    }
+    delete handle;
+    return CUBLAS_STATUS_SUCCESS;
+}
+
+inline cublasStatus_t cublasSetStream(cublasHandle_t handle, cudaStream_t stream) {
+    handle->stream = stream;
+    return CUBLAS_STATUS_SUCCESS;
+}
+
+inline cublasStatus_t cublasGetStream(cublasHandle_t handle, cudaStream_t *stream) {
+    *stream = handle->stream;
+    return CUBLAS_STATUS_SUCCESS;
+}
+
+inline cublasStatus_t cublasSgemm(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m,
+                                  int n, int k, const float *alpha, const float *a, int lda, const float *b, int ldb,
+                                  const float *beta, float *c, int ldc) {
+    return cuda_emu::Gemm(handle, transa, transb, m, n, k, *alpha, a, lda, 0, b, ldb, 0, *beta, c, ldc, 0, 1);
+}
+
+inline cublasStatus_t cublasCgemm(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m,
+                                  int n, int k, const cuComplex *alpha, const cuComplex *a, int lda, const cuComplex *b,
+                                  int ldb, const cuComplex *beta, cuComplex *c, int ldc) {
+    return cuda_emu::Gemm(handle, transa, transb, m, n, k, cuda_emu::ToCompute(*alpha), a, lda, 0, b, ldb, 0,
+                          cuda_emu::ToCompute(*beta), c, ldc, 0, 1);
+}
+
+inline cublasStatus_t cublasSgemmStridedBatched(cublasHandle_t handle, cublasOperation_t transa,
+                                                cublasOperation_t transb, int m, int n, int k, const float *alpha,
+                                                const float *a, int lda, long long stride_a, const float *b, int ldb,
+                                                long long stride_b, const float *beta, float *c, int ldc,
+                                                long long stride_c, int batch_count) {
+    return cuda_emu::Gemm(handle, transa, transb, m, n, k, *alpha, a, lda, stride_a, b, ldb, stride_b, *beta, c, ldc,
+                          stride_c, batch_count);
+}
+
+inline cublasStatus_t cublasCgemm3mStridedBatched(cublasHandle_t handle, cublasOperation_t transa,
+                                                  cublasOperation_t transb, int m, int n, int k, const cuComplex *alpha,
+                                                  const cuComplex *a, int lda, long long stride_a, const cuComplex *b,
+                                                  int ldb, long long stride_b, const cuComplex *beta, cuComplex *c,
+                                                  int ldc, long long stride_c, int batch_count) {
+    return cuda_emu::Gemm(handle, transa, transb, m, n, k, cuda_emu::ToCompute(*alpha), a, lda, stride_a, b, ldb,
+                          stride_b, cuda_emu::ToCompute(*beta), c, ldc, stride_c, batch_count);
+}
+
+inline cublasStatus_t cublasGemmEx(cublasHandle_t handle, cublasOperation_t transa, cublasOperation_t transb, int m,
+                                   int n, int k, const void *alpha, const void *a, cudaDataType_t a_type, int lda,
+                                   const void *b, cudaDataType_t b_type, int ldb, const void *beta, void *c,
+                                   cudaDataType_t c_type, int ldc, cublasComputeType_t compute_type, cublasGemmAlgo_t) {
+    return cuda_emu::GemmEx(handle, transa, transb, m, n, k, alpha, a, a_type, lda, 0, b, b_type, ldb, 0, beta, c,
+                            c_type, ldc, 0, 1, compute_type);
+}
+
+inline cublasStatus_t cublasGemmStridedBatchedEx(cublasHandle_t handle, cublasOperation_t transa,
+                                                 cublasOperation_t transb, int m, int n, int k, const void *alpha,
+                                                 const void *a, cudaDataType_t a_type, int lda, long long stride_a,
+                                                 const void *b, cudaDataType_t b_type, int ldb, long long stride_b,
+                                                 const void *beta, void *c, cudaDataType_t c_type, int ldc,
+                                                 long long stride_c, int batch_count, cublasComputeType_t compute_type,
+                                                 cublasGemmAlgo_t) {
+    return cuda_emu::GemmEx(handle, transa, transb, m, n, k, alpha, a, a_type, lda, stride_a, b, b_type, ldb, stride_b,
+                            beta, c, c_type, ldc, stride_c, batch_count, compute_type);
+}
@@ -0,0 +1,10 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the CUDA driver header, only its version, see cuda_runtime.h.
+
+#pragma once
+
+#define CUDA_VERSION 12000
+
+#include "cuda_runtime.h"
@@ -0,0 +1,50 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+# Build of the GPU micro-benchmarks against the CPU emulation of the CUDA runtime in this directory, to run and profile
+# their host orchestration without GPU, see cuda_runtime.h.
+# The .cu sources are converted to C++ by rewriting the kernel launches kernel<<<config>>>(args) to
+# cuda_emu::Launch(kernel, cuda_emu::LaunchConfig(config))(args), the kernel being named by an identifier.
+
+if(CMAKE_SCRIPT_MODE_FILE)
+    # Conversion of INPUT to OUTPUT, run by the build
+    file(READ ${INPUT} content)
+    string(REGEX REPLACE "([A-Za-z_][A-Za-z0-9_]*)[ \t\r\n]*<<<" "cuda_emu::Launch(\\1, cuda_emu::LaunchConfig("
+           content "${content}")
+    string(REGEX REPLACE ">>>([ \t\r\n]*)\\(" "))\\1(" content "${content}")
+    file(WRITE ${OUTPUT} "#line 1 \"${INPUT}\"\n${content}")
+    return()
+endif()
+
+set(CUDA_EMULATION_DIR ${CMAKE_CURRENT_LIST_DIR})
+find_package(Threads REQUIRED)
+
+# Get the sources to compile, the .cu ones being converted to C++ in the binary directory.
+function(cuda_emulation_sources out_var)
+    set(sources "")
+    foreach(src ${ARGN})
+        if(src MATCHES "\\.cu$")
+            get_filename_component(name ${src} NAME_WE)
+            set(converted ${CMAKE_CURRENT_BINARY_DIR}/${name}.emu.cpp)
+            add_custom_command(
+                OUTPUT ${converted}
+                COMMAND ${CMAKE_COMMAND} -DINPUT=${CMAKE_CURRENT_SOURCE_DIR}/${src} -DOUTPUT=${converted}
+                        -P ${CUDA_EMULATION_DIR}/cuda_emulation.cmake
+                DEPENDS ${src} ${CUDA_EMULATION_DIR}/cuda_emulation.cmake)
+            list(APPEND sources ${converted})
+        else()
+            list(APPEND sources ${src})
+        endif()
+    endforeach()
+    set(${out_var} ${sources} PARENT_SCOPE)
+endfunction()
+
+# Compile a target against the emulated CUDA headers.
+function(cuda_emulation_target target)
+    target_include_directories(${target} BEFORE PRIVATE ${CUDA_EMULATION_DIR} ${CMAKE_CURRENT_SOURCE_DIR})
+    target_compile_definitions(${target} PRIVATE CUDA_EMULATION)
+    target_compile_features(${target} PRIVATE cxx_std_17)
+    # The unroll pragmas of the kernels are for nvcc
+    target_compile_options(${target} PRIVATE -Wno-unknown-pragmas)
+    target_link_libraries(${target} Threads::Threads)
+endfunction()
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the half precision type of CUDA, stored as IEEE binary16 and computed in float.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+struct __half {
+    __half() = default;
+
+    // Round to the nearest binary16, ties to even.
+    __half(float f) {
+        uint32_t x = 0;
+        memcpy(&x, &f, sizeof(x));
+        uint32_t sign = (x >> 16) & 0x8000;
+        uint32_t mantissa = x & 0x7fffff;
+        int exponent = static_cast<int>((x >> 23) & 0xff) - 127 + 15;
+        if (((x >> 23) & 0xff) == 0xff) {
+            // Infinity or NaN
+            __x = sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+            return;
+        }
+        if (exponent >= 31) {
+            __x = sign | 0x7c00;
+            return;
+        }
+        uint32_t bits = 0;
+        int shift = 13;
+        if (exponent <= 0) {
+            // Subnormal, with the implicit bit
+            if (exponent < -10) {
+                __x = sign;
+                return;
+            }
+            mantissa |= 0x800000;
+            shift = 14 - exponent;
+        } else {
+            bits = static_cast<uint32_t>(exponent) << 10;
+        }
+        bits |= mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        // A carry into the exponent rounds up to the next binade or to infinity
+        if (rest > halfway || (rest == halfway && (bits & 1) != 0)) {
+            bits++;
+        }
+        __x = static_cast<uint16_t>(sign | bits);
+    }
+
+    operator float() const {
+        int exponent = (__x >> 10) & 0x1f;
+        int mantissa = __x & 0x3ff;
+        float value = 0;
+        if (exponent == 0x1f) {
+            value = mantissa != 0 ? NAN : INFINITY;
+        } else if (exponent == 0) {
+            value = std::ldexp(static_cast<float>(mantissa), -24);
+        } else {
+            value = std::ldexp(static_cast<float>(mantissa + 0x400), exponent - 25);
+        }
+        return (__x & 0x8000) != 0 ? -value : value;
+    }
+
+    uint16_t __x;
+};
+typedef __half half;
+
+inline __half __float2half(float f) { return __half(f); }
+inline float __half2float(__half h) { return static_cast<float>(h); }
@@ -0,0 +1,717 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the subset of the CUDA runtime used by the GPU micro-benchmarks.
+// It lets the host orchestration of the benchmarks (argument composition, buffer and stream setup, launches and
+// event timing) run and be profiled on machines without GPU, the timings of the device work being meaningless.
+// Device memory is host memory, a stream is a host worker thread running its work in order, an event carries the host
+// time at which its stream reaches it, and a kernel runs every thread of every block in turn on the worker of its
+// stream. The null stream of a device does not synchronize with the other streams. The number of devices is read
+// from CUDA_EMULATION_DEVICES, 2 by default.
+// Built with -DCUDA_EMULATION=ON, see cuda_emulation.cmake, which rewrites the kernel launches of the .cu sources to
+// cuda_emu::Launch calls.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#define CUDART_VERSION 12000
+
+// Function qualifiers of the device code, plain host functions here.
+#define __global__
+#define __device__
+#define __host__
+#define __forceinline__ inline __attribute__((always_inline))
+#define __launch_bounds__(...)
+
+// Vector types.
+struct uint3 {
+    unsigned int x, y, z;
+};
+
+struct dim3 {
+    unsigned int x, y, z;
+    dim3(unsigned int vx = 1, unsigned int vy = 1, unsigned int vz = 1) : x(vx), y(vy), z(vz) {}
+};
+
+struct alignas(8) float2 {
+    float x, y;
+};
+
+struct alignas(16) ulong2 {
+    unsigned long x, y;
+};
+
+inline float2 make_float2(float x, float y) { return {x, y}; }
+inline ulong2 make_ulong2(unsigned long x, unsigned long y) { return {x, y}; }
+
+// Indices of the running thread, set by the emulated launches.
+inline thread_local uint3 threadIdx;
+inline thread_local uint3 blockIdx;
+inline thread_local dim3 blockDim;
+inline thread_local dim3 gridDim;
+
+enum cudaError {
+    cudaSuccess = 0,
+    cudaErrorInvalidValue = 1,
+    cudaErrorMemoryAllocation = 2,
+    cudaErrorInvalidConfiguration = 9,
+    cudaErrorInvalidDevice = 101,
+    cudaErrorInvalidResourceHandle = 400,
+    cudaErrorNotReady = 600,
+    cudaErrorPeerAccessAlreadyEnabled = 704,
+    cudaErrorPeerAccessNotEnabled = 705
+};
+typedef enum cudaError cudaError_t;
+
+enum cudaMemcpyKind {
+    cudaMemcpyHostToHost = 0,
+    cudaMemcpyHostToDevice = 1,
+    cudaMemcpyDeviceToHost = 2,
+    cudaMemcpyDeviceToDevice = 3,
+    cudaMemcpyDefault = 4
+};
+
+enum cudaDeviceAttr {
+    cudaDevAttrMaxThreadsPerBlock = 1,
+    cudaDevAttrWarpSize = 10,
+    cudaDevAttrMultiProcessorCount = 16,
+    cudaDevAttrMemoryClockRate = 36,
+    cudaDevAttrGlobalMemoryBusWidth = 37
+};
+
+enum cudaDataType_t { CUDA_R_32F = 0, CUDA_R_64F = 1, CUDA_R_16F = 2, CUDA_C_32F = 4 };
+typedef enum cudaDataType_t cudaDataType;
+
+#define cudaStreamDefault 0x00
+#define cudaStreamNonBlocking 0x01
+#define cudaEventDefault 0x00
+#define cudaEventBlockingSync 0x01
+#define cudaEventDisableTiming 0x02
+#define cudaHostRegisterDefault 0x00
+#define cudaHostRegisterPortable 0x01
+#define cudaHostRegisterMapped 0x02
+#define cudaHostAllocDefault 0x00
+
+struct cudaDeviceProp {
+    char name[256];
+    size_t totalGlobalMem;
+    int warpSize;
+    int maxThreadsPerBlock;
+    int multiProcessorCount;
+    int major;
+    int minor;
+    int memoryClockRate;
+    int memoryBusWidth;
+    int ECCEnabled;
+    int pciBusID;
+    int pciDeviceID;
+    int pciDomainID;
+};
+
+namespace cuda_emu {
+
+using Clock = std::chrono::steady_clock;
+
+// Memory clock in kHz and bus width in bits reported for the devices, those of a DDR5-4800 channel.
+constexpr int kMemoryClockKhz = 2400000;
+constexpr int kMemoryBusWidth = 64;
+
+// Alignment of the device allocations.
+constexpr size_t kAllocAlignment = 256;
+
+// Most threads of a block.
+constexpr unsigned int kMaxThreadsPerBlock = 1024;
+
+// In-order queue of device work run by a host worker thread.
+class Stream {
+  public:
+    explicit Stream(int device) : device_(device), worker_([this] { Work(); }) {}
+
+    // The work enqueued so far is completed before the worker stops.
+    ~Stream() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        worker_.join();
+    }
+
+    int Device() const { return device_; }
+
+    void Enqueue(std::function<void()> work) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(work));
+            submitted_++;
+        }
+        cv_.notify_all();
+    }
+
+    /**
+     * @brief Wait for the work enqueued so far.
+     */
+    void Synchronize() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        uint64_t target = submitted_;
+        done_cv_.wait(lock, [&] { return completed_ >= target; });
+    }
+
+    bool Idle() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return completed_ == submitted_;
+    }
+
+  private:
+    void Work() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [&] { return stop_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            std::function<void()> work = std::move(queue_.front());
+            queue_.pop_front();
+            lock.unlock();
+            work();
+            lock.lock();
+            completed_++;
+            done_cv_.notify_all();
+        }
+    }
+
+    int device_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::deque<std::function<void()>> queue_;
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    bool stop_ = false;
+
+    // Started last, once the members it uses are initialized.
+    std::thread worker_;
+};
+
+// State of an event, shared with the work recording it so that it may be destroyed before being reached.
+struct EventState {
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Number of records issued and reached by their streams.
+    uint64_t recorded = 0;
+    uint64_t reached = 0;
+
+    // Host time at which the last record was reached.
+    Clock::time_point time;
+
+    // Whether the event is timed.
+    bool timing = true;
+};
+
+} // namespace cuda_emu
+
+struct CUstream_st : public cuda_emu::Stream {
+    using cuda_emu::Stream::Stream;
+};
+typedef struct CUstream_st *cudaStream_t;
+
+struct CUevent_st {
+    std::shared_ptr<cuda_emu::EventState> state = std::make_shared<cuda_emu::EventState>();
+};
+typedef struct CUevent_st *cudaEvent_t;
+
+namespace cuda_emu {
+
+// Emulated devices and the state of the runtime.
+class Runtime {
+  public:
+    static Runtime &Get() {
+        static Runtime runtime;
+        return runtime;
+    }
+
+    int DeviceCount() const { return device_count_; }
+
+    bool ValidDevice(int device) const { return device >= 0 && device < device_count_; }
+
+    int &CurrentDevice() {
+        static thread_local int device = 0;
+        return device;
+    }
+
+    cudaError_t &LastError() {
+        static thread_local cudaError_t error = cudaSuccess;
+        return error;
+    }
+
+    /**
+     * @brief Get the stream to run work on, the null stream of the current device for nullptr.
+     */
+    cuda_emu::Stream *Resolve(cudaStream_t stream) {
+        if (stream != nullptr) {
+            return stream;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto &null_stream = null_streams_[CurrentDevice()];
+        if (!null_stream) {
+            null_stream = std::make_unique<CUstream_st>(CurrentDevice());
+        }
+        return null_stream.get();
+    }
+
+    cudaStream_t CreateStream() {
+        auto stream = new CUstream_st(CurrentDevice());
+        std::lock_guard<std::mutex> lock(mutex_);
+        streams_.insert(stream);
+        return stream;
+    }
+
+    void DestroyStream(cudaStream_t stream) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            streams_.erase(stream);
+        }
+        delete stream;
+    }
+
+    /**
+     * @brief Wait for the work of every stream of a device.
+     */
+    void SynchronizeDevice(int device) {
+        std::vector<cuda_emu::Stream *> streams;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto stream : streams_) {
+                if (stream->Device() == device) {
+                    streams.push_back(stream);
+                }
+            }
+            if (null_streams_[device]) {
+                streams.push_back(null_streams_[device].get());
+            }
+        }
+        for (auto stream : streams) {
+            stream->Synchronize();
+        }
+    }
+
+    /**
+     * @brief Enable the access of the current device to a peer.
+     *
+     * @return false if already enabled.
+     */
+    bool EnablePeer(int peer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peers_.insert({CurrentDevice(), peer}).second;
+    }
+
+    bool DisablePeer(int peer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peers_.erase({CurrentDevice(), peer}) > 0;
+    }
+
+    void ResetDevice(int device) {
+        SynchronizeDevice(device);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = peers_.begin(); it != peers_.end();) {
+            it = it->first == device ? peers_.erase(it) : std::next(it);
+        }
+    }
+
+  private:
+    Runtime() {
+        const char *devices = getenv("CUDA_EMULATION_DEVICES");
+        if (devices != nullptr && (1 != sscanf(devices, "%d", &device_count_) || device_count_ < 1)) {
+            fprintf(stderr, "Invalid CUDA_EMULATION_DEVICES: %s\n", devices);
+            exit(1);
+        }
+        null_streams_.resize(device_count_);
+    }
+
+    int device_count_ = 2;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<CUstream_st>> null_streams_;
+    std::set<cudaStream_t> streams_;
+    std::set<std::pair<int, int>> peers_;
+};
+
+/**
+ * @brief Record an error of the calling thread for cudaGetLastError and return it.
+ */
+inline cudaError_t SetError(cudaError_t error) {
+    if (error != cudaSuccess) {
+        Runtime::Get().LastError() = error;
+    }
+    return error;
+}
+
+// Launch configuration of a kernel.
+struct LaunchConfig {
+    LaunchConfig(dim3 grid_dim, dim3 block_dim, size_t shared_mem_bytes = 0, cudaStream_t launch_stream = nullptr)
+        : grid(grid_dim), block(block_dim), shared_mem(shared_mem_bytes), stream(launch_stream) {}
+
+    dim3 grid;
+    dim3 block;
+    size_t shared_mem;
+    cudaStream_t stream;
+};
+
+// Launch of a kernel, called with the kernel arguments.
+template <typename... P> class Launcher {
+  public:
+    Launcher(void (*kernel)(P...), const LaunchConfig &config) : kernel_(kernel), config_(config) {}
+
+    template <typename... A> void operator()(A &&...args) const {
+        static_assert(sizeof...(A) == sizeof...(P), "The kernel is launched with a wrong number of arguments.");
+        const dim3 &grid = config_.grid;
+        const dim3 &block = config_.block;
+        if (grid.x * grid.y * grid.z == 0 || block.x * block.y * block.z == 0 ||
+            block.x * block.y * block.z > kMaxThreadsPerBlock) {
+            SetError(cudaErrorInvalidConfiguration);
+            return;
+        }
+        // The arguments are converted to the parameter types and copied at launch as by the driver
+        std::tuple<std::decay_t<P>...> params(std::forward<A>(args)...);
+        Runtime::Get().Resolve(config_.stream)->Enqueue([kernel = kernel_, grid, block, params] {
+            gridDim = grid;
+            blockDim = block;
+            for (blockIdx.z = 0; blockIdx.z < grid.z; blockIdx.z++) {
+                for (blockIdx.y = 0; blockIdx.y < grid.y; blockIdx.y++) {
+                    for (blockIdx.x = 0; blockIdx.x < grid.x; blockIdx.x++) {
+                        for (threadIdx.z = 0; threadIdx.z < block.z; threadIdx.z++) {
+                            for (threadIdx.y = 0; threadIdx.y < block.y; threadIdx.y++) {
+                                for (threadIdx.x = 0; threadIdx.x < block.x; threadIdx.x++) {
+                                    std::apply(kernel, params);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    }
+
+  private:
+    void (*kernel_)(P...);
+    LaunchConfig config_;
+};
+
+/**
+ * @brief Launch a kernel, kernel<<<config>>>(args) being rewritten to Launch(kernel, LaunchConfig(config))(args).
+ */
+template <typename... P> Launcher<P...> Launch(void (*kernel)(P...), const LaunchConfig &config) {
+    return Launcher<P...>(kernel, config);
+}
+
+} // namespace cuda_emu
+
+inline const char *cudaGetErrorString(cudaError_t error) {
+    switch (error) {
+    case cudaSuccess:
+        return "no error";
+    case cudaErrorInvalidValue:
+        return "invalid argument";
+    case cudaErrorMemoryAllocation:
+        return "out of memory";
+    case cudaErrorInvalidConfiguration:
+        return "invalid configuration argument";
+    case cudaErrorInvalidDevice:
+        return "invalid device ordinal";
+    case cudaErrorInvalidResourceHandle:
+        return "invalid resource handle";
+    case cudaErrorNotReady:
+        return "device not ready";
+    case cudaErrorPeerAccessAlreadyEnabled:
+        return "peer access is already enabled";
+    case cudaErrorPeerAccessNotEnabled:
+        return "peer access has not been enabled";
+    }
+    return "unrecognized error code";
+}
+
+inline cudaError_t cudaGetLastError() {
+    cudaError_t error = cuda_emu::Runtime::Get().LastError();
+    cuda_emu::Runtime::Get().LastError() = cudaSuccess;
+    return error;
+}
+
+inline cudaError_t cudaPeekAtLastError() { return cuda_emu::Runtime::Get().LastError(); }
+
+// Devices.
+
+inline cudaError_t cudaGetDeviceCount(int *count) {
+    *count = cuda_emu::Runtime::Get().DeviceCount();
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaSetDevice(int device) {
+    if (!cuda_emu::Runtime::Get().ValidDevice(device)) {
+        return cuda_emu::SetError(cudaErrorInvalidDevice);
+    }
+    cuda_emu::Runtime::Get().CurrentDevice() = device;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaGetDevice(int *device) {
+    *device = cuda_emu::Runtime::Get().CurrentDevice();
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceSynchronize() {
+    cuda_emu::Runtime::Get().SynchronizeDevice(cuda_emu::Runtime::Get().CurrentDevice());
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceReset() {
+    cuda_emu::Runtime::Get().ResetDevice(cuda_emu::Runtime::Get().CurrentDevice());
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaGetDeviceProperties(cudaDeviceProp *prop, int device) {
+    if (!cuda_emu::Runtime::Get().ValidDevice(device)) {
+        return cuda_emu::SetError(cudaErrorInvalidDevice);
+    }
+    memset(prop, 0, sizeof(*prop));
+    snprintf(prop->name, sizeof(prop->name), "CPU emulated device %d", device);
+    prop->totalGlobalMem = static_cast<size_t>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+    prop->warpSize = 32;
+    prop->maxThreadsPerBlock = cuda_emu::kMaxThreadsPerBlock;
+    prop->multiProcessorCount = 1;
+    prop->memoryClockRate = cuda_emu::kMemoryClockKhz;
+    prop->memoryBusWidth = cuda_emu::kMemoryBusWidth;
+    prop->pciBusID = device;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceGetAttribute(int *value, cudaDeviceAttr attr, int device) {
+    cudaDeviceProp prop;
+    if (cudaGetDeviceProperties(&prop, device) != cudaSuccess) {
+        return cudaErrorInvalidDevice;
+    }
+    switch (attr) {
+    case cudaDevAttrMaxThreadsPerBlock:
+        *value = prop.maxThreadsPerBlock;
+        return cudaSuccess;
+    case cudaDevAttrWarpSize:
+        *value = prop.warpSize;
+        return cudaSuccess;
+    case cudaDevAttrMultiProcessorCount:
+        *value = prop.multiProcessorCount;
+        return cudaSuccess;
+    case cudaDevAttrMemoryClockRate:
+        *value = prop.memoryClockRate;
+        return cudaSuccess;
+    case cudaDevAttrGlobalMemoryBusWidth:
+        *value = prop.memoryBusWidth;
+        return cudaSuccess;
+    }
+    return cuda_emu::SetError(cudaErrorInvalidValue);
+}
+
+inline cudaError_t cudaDeviceCanAccessPeer(int *can_access, int device, int peer) {
+    if (!cuda_emu::Runtime::Get().ValidDevice(device) || !cuda_emu::Runtime::Get().ValidDevice(peer)) {
+        return cuda_emu::SetError(cudaErrorInvalidDevice);
+    }
+    *can_access = device != peer;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaDeviceEnablePeerAccess(int peer, unsigned int) {
+    if (!cuda_emu::Runtime::Get().ValidDevice(peer) || peer == cuda_emu::Runtime::Get().CurrentDevice()) {
+        return cuda_emu::SetError(cudaErrorInvalidDevice);
+    }
+    return cuda_emu::Runtime::Get().EnablePeer(peer) ? cudaSuccess
+                                                     : cuda_emu::SetError(cudaErrorPeerAccessAlreadyEnabled);
+}
+
+inline cudaError_t cudaDeviceDisablePeerAccess(int peer) {
+    return cuda_emu::Runtime::Get().DisablePeer(peer) ? cudaSuccess
+                                                      : cuda_emu::SetError(cudaErrorPeerAccessNotEnabled);
+}
+
+// Memory, all of it host memory.
+
+inline cudaError_t cudaMalloc(void **ptr, size_t size) {
+    size_t aligned = (size + cuda_emu::kAllocAlignment - 1) / cuda_emu::kAllocAlignment * cuda_emu::kAllocAlignment;
+    *ptr = size == 0 ? nullptr : aligned_alloc(cuda_emu::kAllocAlignment, aligned);
+    return size != 0 && *ptr == nullptr ? cuda_emu::SetError(cudaErrorMemoryAllocation) : cudaSuccess;
+}
+
+template <typename T> cudaError_t cudaMalloc(T **ptr, size_t size) {
+    return cudaMalloc(reinterpret_cast<void **>(ptr), size);
+}
+
+inline cudaError_t cudaMallocHost(void **ptr, size_t size) { return cudaMalloc(ptr, size); }
+
+inline cudaError_t cudaHostAlloc(void **ptr, size_t size, unsigned int) { return cudaMalloc(ptr, size); }
+
+// The device work still using the memory is completed first, as cudaFree does.
+inline cudaError_t cudaFree(void *ptr) {
+    cudaDeviceSynchronize();
+    free(ptr);
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaFreeHost(void *ptr) { return cudaFree(ptr); }
+
+inline cudaError_t cudaHostRegister(void *, size_t, unsigned int) { return cudaSuccess; }
+
+inline cudaError_t cudaHostUnregister(void *) { return cudaSuccess; }
+
+inline cudaError_t cudaHostGetDevicePointer(void **device_ptr, void *host_ptr, unsigned int) {
+    *device_ptr = host_ptr;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaMemcpyAsync(void *dst, const void *src, size_t count, cudaMemcpyKind,
+                                   cudaStream_t stream = nullptr) {
+    cuda_emu::Runtime::Get().Resolve(stream)->Enqueue([=] { memcpy(dst, src, count); });
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaMemcpy(void *dst, const void *src, size_t count, cudaMemcpyKind kind) {
+    cuda_emu::Stream *stream = cuda_emu::Runtime::Get().Resolve(nullptr);
+    cudaMemcpyAsync(dst, src, count, kind, nullptr);
+    stream->Synchronize();
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaMemsetAsync(void *ptr, int value, size_t count, cudaStream_t stream = nullptr) {
+    cuda_emu::Runtime::Get().Resolve(stream)->Enqueue([=] { memset(ptr, value, count); });
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaMemset(void *ptr, int value, size_t count) {
+    cuda_emu::Stream *stream = cuda_emu::Runtime::Get().Resolve(nullptr);
+    cudaMemsetAsync(ptr, value, count, nullptr);
+    stream->Synchronize();
+    return cudaSuccess;
+}
+
+// Streams.
+
+inline cudaError_t cudaStreamCreate(cudaStream_t *stream) {
+    *stream = cuda_emu::Runtime::Get().CreateStream();
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaStreamCreateWithFlags(cudaStream_t *stream, unsigned int) { return cudaStreamCreate(stream); }
+
+inline cudaError_t cudaStreamDestroy(cudaStream_t stream) {
+    if (stream == nullptr) {
+        return cuda_emu::SetError(cudaErrorInvalidResourceHandle);
+    }
+    cuda_emu::Runtime::Get().DestroyStream(stream);
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaStreamSynchronize(cudaStream_t stream) {
+    cuda_emu::Runtime::Get().Resolve(stream)->Synchronize();
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaStreamQuery(cudaStream_t stream) {
+    return cuda_emu::Runtime::Get().Resolve(stream)->Idle() ? cudaSuccess : cudaErrorNotReady;
+}
+
+// Events.
+
+inline cudaError_t cudaEventCreateWithFlags(cudaEvent_t *event, unsigned int flags) {
+    *event = new CUevent_st();
+    (*event)->state->timing = (flags & cudaEventDisableTiming) == 0;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaEventCreate(cudaEvent_t *event) { return cudaEventCreateWithFlags(event, cudaEventDefault); }
+
+inline cudaError_t cudaEventDestroy(cudaEvent_t event) {
+    if (event == nullptr) {
+        return cuda_emu::SetError(cudaErrorInvalidResourceHandle);
+    }
+    delete event;
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaEventRecord(cudaEvent_t event, cudaStream_t stream = nullptr) {
+    if (event == nullptr) {
+        return cuda_emu::SetError(cudaErrorInvalidResourceHandle);
+    }
+    std::shared_ptr<cuda_emu::EventState> state = event->state;
+    uint64_t record = 0;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        record = ++state->recorded;
+    }
+    cuda_emu::Runtime::Get().Resolve(stream)->Enqueue([state, record] {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->time = cuda_emu::Clock::now();
+            state->reached = record;
+        }
+        state->cv.notify_all();
+    });
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaEventQuery(cudaEvent_t event) {
+    std::lock_guard<std::mutex> lock(event->state->mutex);
+    return event->state->reached == event->state->recorded ? cudaSuccess : cudaErrorNotReady;
+}
+
+inline cudaError_t cudaEventSynchronize(cudaEvent_t event) {
+    cuda_emu::EventState &state = *event->state;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    uint64_t record = state.recorded;
+    state.cv.wait(lock, [&] { return state.reached >= record; });
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaStreamWaitEvent(cudaStream_t stream, cudaEvent_t event, unsigned int = 0) {
+    std::shared_ptr<cuda_emu::EventState> state = event->state;
+    uint64_t record = 0;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        record = state->recorded;
+    }
+    cuda_emu::Runtime::Get().Resolve(stream)->Enqueue([state, record] {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->cv.wait(lock, [&] { return state->reached >= record; });
+    });
+    return cudaSuccess;
+}
+
+inline cudaError_t cudaEventElapsedTime(float *ms, cudaEvent_t start, cudaEvent_t end) {
+    cuda_emu::Clock::time_point times[2];
+    cudaEvent_t events[2] = {start, end};
+    for (int i = 0; i < 2; i++) {
+        std::lock_guard<std::mutex> lock(events[i]->state->mutex);
+        if (!events[i]->state->timing || events[i]->state->recorded == 0) {
+            return cuda_emu::SetError(cudaErrorInvalidResourceHandle);
+        }
+        if (events[i]->state->reached != events[i]->state->recorded) {
+            return cuda_emu::SetError(cudaErrorNotReady);
+        }
+        times[i] = events[i]->state->time;
+    }
+    *ms = std::chrono::duration<float, std::milli>(times[1] - times[0]).count();
+    return cudaSuccess;
+}
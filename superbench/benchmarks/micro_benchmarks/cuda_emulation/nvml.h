@@ -0,0 +1,75 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU emulation of the subset of NVML used by the GPU micro-benchmarks, for the devices of cuda_runtime.h.
+
+#pragma once
+
+#include <vector>
+
+#include "cuda_runtime.h"
+
+typedef enum nvmlReturn_enum {
+    NVML_SUCCESS = 0,
+    NVML_ERROR_UNINITIALIZED = 1,
+    NVML_ERROR_INVALID_ARGUMENT = 2,
+    NVML_ERROR_NOT_SUPPORTED = 3
+} nvmlReturn_t;
+
+typedef enum nvmlClockType_enum {
+    NVML_CLOCK_GRAPHICS = 0,
+    NVML_CLOCK_SM = 1,
+    NVML_CLOCK_MEM = 2,
+    NVML_CLOCK_VIDEO = 3
+} nvmlClockType_t;
+
+struct nvmlDevice_st {
+    unsigned int index;
+};
+typedef struct nvmlDevice_st *nvmlDevice_t;
+
+inline nvmlReturn_t nvmlInit() { return NVML_SUCCESS; }
+inline nvmlReturn_t nvmlInit_v2() { return NVML_SUCCESS; }
+inline nvmlReturn_t nvmlShutdown() { return NVML_SUCCESS; }
+
+inline nvmlReturn_t nvmlDeviceGetCount(unsigned int *count) {
+    *count = cuda_emu::Runtime::Get().DeviceCount();
+    return NVML_SUCCESS;
+}
+
+inline nvmlReturn_t nvmlDeviceGetHandleByIndex(unsigned int index, nvmlDevice_t *device) {
+    static std::vector<nvmlDevice_st> devices = [] {
+        std::vector<nvmlDevice_st> all(cuda_emu::Runtime::Get().DeviceCount());
+        for (size_t i = 0; i < all.size(); i++) {
+            all[i].index = i;
+        }
+        return all;
+    }();
+    if (index >= devices.size()) {
+        return NVML_ERROR_INVALID_ARGUMENT;
+    }
+    *device = &devices[index];
+    return NVML_SUCCESS;
+}
+
+inline nvmlReturn_t nvmlDeviceGetClockInfo(nvmlDevice_t, nvmlClockType_t type, unsigned int *clock_mhz) {
+    if (type != NVML_CLOCK_MEM) {
+        return NVML_ERROR_NOT_SUPPORTED;
+    }
+    *clock_mhz = cuda_emu::kMemoryClockKhz / 1000;
+    return NVML_SUCCESS;
+}
+
+inline const char *nvmlErrorString(nvmlReturn_t result) {
+    switch (result) {
+    case NVML_SUCCESS:
+        return "Success";
+    case NVML_ERROR_UNINITIALIZED:
+        return "Uninitialized";
+    case NVML_ERROR_INVALID_ARGUMENT:
+        return "Invalid Argument";
+    case NVML_ERROR_NOT_SUPPORTED:
+        return "Not Supported";
+    }
+    return "Unknown Error";
+}
@@ -0,0 +1,139 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the data-loader read benchmark."""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class DataLoaderReadBenchmark(MicroBenchmarkWithInvoke):
+    """The data-loader read benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'dataloader_read'
+        self._methods = ['sync', 'fadvise', 'io_uring']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--methods',
+            type=str,
+            nargs='+',
+            default=self._methods,
+            help='Read methods to test. E.g. {}.'.format(' '.join(self._methods)),
+        )
+        self._parser.add_argument(
+            '--dir',
+            type=str,
+            default='.',
+            required=False,
+            help='Directory to generate the synthetic dataset in.',
+        )
+        self._parser.add_argument(
+            '--num_files',
+            type=int,
+            default=4096,
+            required=False,
+            help='Number of samples in the dataset, each stored in its own file.',
+        )
+        self._parser.add_argument(
+            '--files_per_dir',
+            type=int,
+            default=1000,
+            required=False,
+            help='Number of files per sub-directory of the dataset.',
+        )
+        self._parser.add_argument(
+            '--min_size',
+            type=str,
+            default='100K',
+            required=False,
+            help='Smallest sample size, e.g. 100K.',
+        )
+        self._parser.add_argument(
+            '--max_size',
+            type=str,
+            default='1M',
+            required=False,
+            help='Largest sample size, e.g. 1M.',
+        )
+        self._parser.add_argument(
+            '--threads',
+            type=int,
+            default=8,
+            required=False,
+            help='Number of reader threads.',
+        )
+        self._parser.add_argument(
+            '--batch',
+            type=int,
+            default=16,
+            required=False,
+            help='Samples in flight per thread with io_uring, and prefetch distance per thread with fadvise.',
+        )
+        self._parser.add_argument(
+            '--keep_dataset',
+            action='store_true',
+            help='Keep the dataset after the test, so that later runs reuse it.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for method in self._args.methods:
+            if method not in self._methods:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid method - benchmark: {}, method: {}.'.format(self._name, method))
+                return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ' '.join('--%s' % method for method in self._args.methods)
+        args += ' --dir %s --num_files %d --files_per_dir %d --min_size %s --max_size %s --threads %d --batch %d' % (
+            self._args.dir, self._args.num_files, self._args.files_per_dir, self._args.min_size,
+            self._args.max_size, self._args.threads, self._args.batch
+        )
+        if self._args.keep_dataset:
+            args += ' --keep_dataset'
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('dataloader-read', DataLoaderReadBenchmark)
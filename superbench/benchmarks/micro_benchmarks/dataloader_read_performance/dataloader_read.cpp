@@ -0,0 +1,543 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Training data-loader read benchmark.
+// A synthetic dataset of many small files (100KB to 1MB by default) is generated in a directory tree and read in a
+// shuffled order, as a data loader does in every epoch. Synchronous reads from a thread pool, the same pool with a
+// prefetcher issuing posix_fadvise(WILLNEED) ahead of the readers, and io_uring openat+read+close chains on direct
+// descriptors are compared, each with a cold and then a warm page cache.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../host_utils/io_uring_utils.h"
+#include "../host_utils/io_utils.h"
+#include "../host_utils/result_emitter.h"
+#include "../host_utils/stats_utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Ways to read the samples.
+enum class Method { kSync, kFadvise, kIoUring };
+
+// Options accepted by this program.
+struct Opts {
+    // Read methods to test.
+    std::vector<Method> methods;
+
+    // Directory of the dataset.
+    std::string dir = ".";
+
+    // Number of samples, each stored in its own file.
+    int num_files = 4096;
+
+    // Number of files per sub-directory.
+    int files_per_dir = 1000;
+
+    // Smallest sample size in bytes.
+    uint64_t min_size = 100 * 1024;
+
+    // Largest sample size in bytes.
+    uint64_t max_size = 1024 * 1024;
+
+    // Number of reader threads.
+    int threads = 8;
+
+    // Number of samples in flight per thread with io_uring, and the prefetch distance per thread with fadvise.
+    int batch = 16;
+
+    // Seed of the sample sizes and the shuffled order.
+    int seed = 0;
+
+    // Whether to keep the dataset after the test.
+    bool keep_dataset = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// The dataset, one file per sample.
+struct Dataset {
+    std::vector<std::string> paths;
+    std::vector<uint64_t> sizes;
+    uint64_t max_size = 0;
+};
+
+// Result of one epoch.
+struct EpochResult {
+    double seconds = 0;
+    uint64_t bytes = 0;
+    host_utils::LatencyHistogram lat_ns;
+    int error = 0;
+};
+
+/**
+ * @brief Get the name of a read method used in metric names.
+ *
+ * @param method The read method.
+ * @return The name of the method.
+ */
+const char *MethodName(Method method) {
+    switch (method) {
+    case Method::kSync:
+        return "sync";
+    case Method::kFadvise:
+        return "fadvise";
+    case Method::kIoUring:
+        return "io_uring";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: dataloader_read "
+              << "[--sync] [--fadvise] [--io_uring] "
+              << "[--dir <path>] "
+              << "[--num_files <num>] "
+              << "[--files_per_dir <num>] "
+              << "[--min_size <bytes>] "
+              << "[--max_size <bytes>] "
+              << "[--threads <num>] "
+              << "[--batch <num>] "
+              << "[--seed <num>] "
+              << "[--keep_dataset] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the data-loader read benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kSync,
+        kFadvise,
+        kIoUring,
+        kDir,
+        kNumFiles,
+        kFilesPerDir,
+        kMinSize,
+        kMaxSize,
+        kThreads,
+        kBatch,
+        kSeed,
+        kKeepDataset
+    };
+    const struct option options[] = {
+        {"sync", no_argument, nullptr, static_cast<int>(OptIdx::kSync)},
+        {"fadvise", no_argument, nullptr, static_cast<int>(OptIdx::kFadvise)},
+        {"io_uring", no_argument, nullptr, static_cast<int>(OptIdx::kIoUring)},
+        {"dir", required_argument, nullptr, static_cast<int>(OptIdx::kDir)},
+        {"num_files", required_argument, nullptr, static_cast<int>(OptIdx::kNumFiles)},
+        {"files_per_dir", required_argument, nullptr, static_cast<int>(OptIdx::kFilesPerDir)},
+        {"min_size", required_argument, nullptr, static_cast<int>(OptIdx::kMinSize)},
+        {"max_size", required_argument, nullptr, static_cast<int>(OptIdx::kMaxSize)},
+        {"threads", required_argument, nullptr, static_cast<int>(OptIdx::kThreads)},
+        {"batch", required_argument, nullptr, static_cast<int>(OptIdx::kBatch)},
+        {"seed", required_argument, nullptr, static_cast<int>(OptIdx::kSeed)},
+        {"keep_dataset", no_argument, nullptr, static_cast<int>(OptIdx::kKeepDataset)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kNumFiles), {&opts->num_files, 1}},
+        {static_cast<int>(OptIdx::kFilesPerDir), {&opts->files_per_dir, 1}},
+        {static_cast<int>(OptIdx::kThreads), {&opts->threads, 1}},
+        {static_cast<int>(OptIdx::kBatch), {&opts->batch, 1}},
+        {static_cast<int>(OptIdx::kSeed), {&opts->seed, 0}}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt_idx == static_cast<int>(OptIdx::kSync)) {
+            opts->methods.push_back(Method::kSync);
+        } else if (opt_idx == static_cast<int>(OptIdx::kFadvise)) {
+            opts->methods.push_back(Method::kFadvise);
+        } else if (opt_idx == static_cast<int>(OptIdx::kIoUring)) {
+            opts->methods.push_back(Method::kIoUring);
+        } else if (opt_idx == static_cast<int>(OptIdx::kDir)) {
+            opts->dir = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kMinSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->min_size) || opts->min_size == 0;
+        } else if (opt_idx == static_cast<int>(OptIdx::kMaxSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->max_size) || opts->max_size == 0;
+        } else if (opt_idx == static_cast<int>(OptIdx::kKeepDataset)) {
+            opts->keep_dataset = true;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (!parse_err && opts->min_size > opts->max_size) {
+        std::cerr << "The min_size must not be larger than the max_size." << std::endl;
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    if (opts->methods.empty()) {
+        opts->methods = {Method::kSync, Method::kFadvise, Method::kIoUring};
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Generate the dataset, reusing files of the expected size left by an earlier run with --keep_dataset.
+ *
+ * @param opts The benchmark options.
+ * @param dataset The generated dataset.
+ * @return true on success.
+ */
+bool GenerateDataset(const Opts &opts, Dataset *dataset) {
+    std::mt19937_64 rng(opts.seed);
+    std::uniform_int_distribution<uint64_t> size_dist(opts.min_size, opts.max_size);
+    std::vector<char> content(opts.max_size);
+    std::generate(content.begin(), content.end(), [&rng]() { return static_cast<char>(rng()); });
+    std::string root = opts.dir + "/sb_dataset";
+    mkdir(root.c_str(), 0755);
+
+    char name[64];
+    for (int i = 0; i < opts.num_files; i++) {
+        snprintf(name, sizeof(name), "/d%05d", i / opts.files_per_dir);
+        std::string subdir = root + name;
+        if (i % opts.files_per_dir == 0) {
+            mkdir(subdir.c_str(), 0755);
+        }
+        snprintf(name, sizeof(name), "/f%08d.bin", i);
+        dataset->paths.push_back(subdir + name);
+        dataset->sizes.push_back(size_dist(rng));
+        dataset->max_size = std::max(dataset->max_size, dataset->sizes.back());
+
+        struct stat st;
+        const std::string &path = dataset->paths.back();
+        if (stat(path.c_str(), &st) == 0 && static_cast<uint64_t>(st.st_size) == dataset->sizes.back()) {
+            continue;
+        }
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        // Shift the content per file, so that files do not share identical data
+        size_t shift = i % (content.size() - dataset->sizes.back() + 1);
+        if (fd < 0 || write(fd, content.data() + shift, dataset->sizes.back()) !=
+                          static_cast<ssize_t>(dataset->sizes.back())) {
+            std::cerr << "Failed to write " << path << ". ERROR: " << strerror(errno) << std::endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return false;
+        }
+        close(fd);
+    }
+    sync();
+    return true;
+}
+
+/**
+ * @brief Remove the dataset directory tree.
+ *
+ * @param opts The benchmark options.
+ * @param dataset The dataset.
+ */
+void RemoveDataset(const Opts &opts, const Dataset &dataset) {
+    for (const auto &path : dataset.paths) {
+        unlink(path.c_str());
+    }
+    std::string root = opts.dir + "/sb_dataset";
+    char name[64];
+    for (int i = 0; i < opts.num_files; i += opts.files_per_dir) {
+        snprintf(name, sizeof(name), "/d%05d", i / opts.files_per_dir);
+        rmdir((root + name).c_str());
+    }
+    rmdir(root.c_str());
+}
+
+/**
+ * @brief Reader body of the thread pool, reads samples in the shuffled order with blocking calls.
+ *
+ * @param dataset The dataset.
+ * @param order The shuffled order of the samples.
+ * @param next The index in the order of the next sample to read, shared by all readers.
+ * @param result The result of this reader.
+ */
+void SyncReader(const Dataset &dataset, const std::vector<int> &order, std::atomic<size_t> *next,
+                EpochResult *result) {
+    std::vector<char> buffer(dataset.max_size);
+    for (size_t i = (*next)++; i < order.size() && result->error == 0; i = (*next)++) {
+        int sample = order[i];
+        auto start = Clock::now();
+        int fd = open(dataset.paths[sample].c_str(), O_RDONLY);
+        ssize_t len = fd < 0 ? -1 : read(fd, buffer.data(), dataset.sizes[sample]);
+        if (len != static_cast<ssize_t>(dataset.sizes[sample])) {
+            result->error = len < 0 ? errno : EIO;
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        result->lat_ns.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        result->bytes += dataset.sizes[sample];
+    }
+}
+
+/**
+ * @brief Prefetcher body, hints the kernel to read ahead the samples the readers will need next.
+ *
+ * @param dataset The dataset.
+ * @param order The shuffled order of the samples.
+ * @param next The index in the order of the next sample to read by the readers.
+ * @param distance The number of samples to stay ahead of the readers.
+ */
+void Prefetcher(const Dataset &dataset, const std::vector<int> &order, const std::atomic<size_t> *next,
+                size_t distance) {
+    for (size_t i = 0; i < order.size(); i++) {
+        while (i >= next->load() + distance) {
+            std::this_thread::yield();
+        }
+        int fd = open(dataset.paths[order[i]].c_str(), O_RDONLY);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+}
+
+/**
+ * @brief Reader body with io_uring, keeps batch openat+read+close chains in flight on direct descriptors.
+ *
+ * The openat installs the file in a slot of the registered file table, and the linked read and close use the
+ * slot, so a whole sample is read without a round trip to user space.
+ *
+ * @param opts The benchmark options.
+ * @param dataset The dataset.
+ * @param order The shuffled order of the samples.
+ * @param next The index in the order of the next sample to read, shared by all readers.
+ * @param result The result of this reader.
+ */
+void IoUringReader(const Opts &opts, const Dataset &dataset, const std::vector<int> &order,
+                   std::atomic<size_t> *next, EpochResult *result) {
+    host_utils::IoUring ring;
+    int ret = ring.Init(opts.batch * 3);
+    std::vector<int> slots(opts.batch, -1);
+    if (ret == 0) {
+        ret = ring.RegisterFiles(slots.data(), opts.batch);
+    }
+    if (ret != 0) {
+        result->error = -ret;
+        std::cerr << "Failed to set up io_uring. ERROR: " << strerror(result->error) << std::endl;
+        return;
+    }
+    std::vector<char> buffers(opts.batch * dataset.max_size);
+    std::vector<int> sample_of_slot(opts.batch, -1);
+    std::vector<Clock::time_point> start_of_slot(opts.batch);
+    std::vector<int> free_slots;
+    for (int slot = opts.batch - 1; slot >= 0; slot--) {
+        free_slots.push_back(slot);
+    }
+    int inflight = 0;
+    bool done = false;
+
+    // Every chain completes three entries, user data holds the slot and the step
+    auto tag = [](int slot, int step) { return static_cast<uint64_t>(slot) * 3 + step; };
+    while (result->error == 0) {
+        while (!done && !free_slots.empty()) {
+            size_t i = (*next)++;
+            if (i >= order.size()) {
+                done = true;
+                break;
+            }
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            int sample = order[i];
+            sample_of_slot[slot] = sample;
+            start_of_slot[slot] = Clock::now();
+
+            io_uring_sqe *sqe = ring.GetSqe();
+            host_utils::PrepOpenatDirect(sqe, dataset.paths[sample].c_str(), O_RDONLY, slot, tag(slot, 0));
+            sqe->flags = IOSQE_IO_LINK;
+            sqe = ring.GetSqe();
+            host_utils::PrepRw(sqe, IORING_OP_READ, slot, buffers.data() + slot * dataset.max_size,
+                               dataset.sizes[sample], 0, tag(slot, 1));
+            sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+            host_utils::PrepCloseDirect(ring.GetSqe(), slot, tag(slot, 2));
+            inflight++;
+        }
+        if (inflight == 0) {
+            break;
+        }
+        ret = ring.Submit(1);
+        io_uring_cqe *cqe = nullptr;
+        if ((ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) || (ret = ring.WaitCqe(&cqe)) != 0) {
+            result->error = -ret;
+            break;
+        }
+        for (; cqe != nullptr; cqe = ring.PeekCqe()) {
+            int slot = static_cast<int>(cqe->user_data / 3);
+            int step = static_cast<int>(cqe->user_data % 3);
+            int sample = sample_of_slot[slot];
+            bool failed = step == 1 ? cqe->res != static_cast<int>(dataset.sizes[sample]) : cqe->res < 0;
+            if (failed && result->error == 0) {
+                result->error = cqe->res < 0 ? -cqe->res : EIO;
+            }
+            ring.SeenCqe();
+            if (step == 2) {
+                result->lat_ns.Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_of_slot[slot]).count());
+                result->bytes += dataset.sizes[sample];
+                free_slots.push_back(slot);
+                inflight--;
+            }
+        }
+    }
+    if (result->error != 0) {
+        std::cerr << "Failed to read samples with io_uring. ERROR: " << strerror(result->error) << std::endl;
+    }
+}
+
+/**
+ * @brief Read every sample once in a shuffled order.
+ *
+ * @param opts The benchmark options.
+ * @param method The read method.
+ * @param dataset The dataset.
+ * @param epoch The index of the epoch, used to shuffle.
+ * @param result The result of the epoch.
+ */
+void RunEpoch(const Opts &opts, Method method, const Dataset &dataset, int epoch, EpochResult *result) {
+    std::vector<int> order(dataset.paths.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = static_cast<int>(i);
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937_64(opts.seed + epoch));
+
+    std::atomic<size_t> next(0);
+    std::vector<EpochResult> results(opts.threads);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int i = 0; i < opts.threads; i++) {
+        if (method == Method::kIoUring) {
+            threads.emplace_back(IoUringReader, std::cref(opts), std::cref(dataset), std::cref(order), &next,
+                                 &results[i]);
+        } else {
+            threads.emplace_back(SyncReader, std::cref(dataset), std::cref(order), &next, &results[i]);
+        }
+    }
+    if (method == Method::kFadvise) {
+        Prefetcher(dataset, order, &next, static_cast<size_t>(opts.batch) * opts.threads);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    result->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (const auto &reader : results) {
+        result->bytes += reader.bytes;
+        result->lat_ns.Merge(reader.lat_ns);
+        result->error = result->error != 0 ? result->error : reader.error;
+    }
+}
+
+/**
+ * @brief Emit the metrics of one epoch.
+ *
+ * @param emitter The result emitter.
+ * @param method The read method.
+ * @param cache The page cache state, cold or warm.
+ * @param result The result of the epoch.
+ */
+void EmitResult(host_utils::ResultEmitter *emitter, Method method, const std::string &cache,
+                const EpochResult &result) {
+    std::string tag = std::string(MethodName(method)) + "_" + cache;
+    host_utils::ResultTags tags = {{"method", MethodName(method)}, {"cache", cache}};
+    emitter->Metric(tag + "_samples_per_sec", result.lat_ns.Count() / result.seconds, "samples/s", tags);
+    emitter->Metric(tag + "_bw", result.bytes / result.seconds / 1e9, "GB/s", tags);
+    emitter->Metric(tag + "_lat_us_avg", result.lat_ns.Mean() / 1e3, "us", tags);
+    for (double percentile : host_utils::kLatencyPercentiles) {
+        emitter->Metric(tag + "_lat_us_" + host_utils::PercentileName(percentile),
+                        result.lat_ns.Percentile(percentile) / 1e3, "us", tags);
+    }
+    emitter->Metric(tag + "_lat_us_max", result.lat_ns.Max() / 1e3, "us", tags);
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    Dataset dataset;
+    if (!GenerateDataset(opts, &dataset)) {
+        return 1;
+    }
+
+    host_utils::ResultEmitter emitter(opts.result);
+    int epoch = 0;
+    for (Method method : opts.methods) {
+        // The cold epoch starts with every sample evicted from the page cache, the warm one right after it
+        for (const auto &path : dataset.paths) {
+            host_utils::DropFileCache(path.c_str());
+        }
+        for (const char *cache : {"cold", "warm"}) {
+            EpochResult result;
+            RunEpoch(opts, method, dataset, epoch++, &result);
+            if (result.error != 0) {
+                std::cerr << "Epoch failed - method: " << MethodName(method) << ", cache: " << cache << std::endl;
+                ret = 1;
+                break;
+            }
+            EmitResult(&emitter, method, cache, result);
+            if (emitter.Stopped()) {
+                ret = 1;
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    if (!opts.keep_dataset) {
+        RemoveDataset(opts, dataset);
+    }
+    return ret;
+}
@@ -24,6 +24,8 @@ def __init__(self, name, parameters=''):
         super().__init__(name, parameters)
 
         self._bin_name = 'fio'
+        # Binary of each engine, io_uring is a native implementation accepting the same options as fio
+        self.__engine_bin_names = {'fio': 'fio', 'io_uring': 'io_uring_disk'}
 
         self.__io_patterns = ['seq', 'rand']
         self.__io_types = ['read', 'write', 'readwrite']
@@ -76,6 +78,33 @@ def add_parser_arguments(self):
             required=False,
             help='Disk block device(s) to be tested.',
         )
+        self._parser.add_argument(
+            '--files',
+            type=str,
+            nargs='*',
+            default=[],
+            required=False,
+            help='Regular file(s) on local filesystems to be tested, created with file_size if needed.',
+        )
+        self._parser.add_argument(
+            '--file_size',
+            type=str,
+            default='16G',
+            required=False,
+            help='Size of the regular file(s) to be tested, e.g. 16G.',
+        )
+        self._parser.add_argument(
+            '--engine',
+            type=str,
+            default='fio',
+            required=False,
+            help='Engine to run the tests. Possible values are {}.'.format(' '.join(self.__engine_bin_names)),
+        )
+        self._parser.add_argument(
+            '--io_uring_sqpoll',
+            action='store_true',
+            help='Use a kernel thread to poll the submission queue, only for io_uring engine.',
+        )
 
         # Disable precondition by default
         self._parser.add_argument(
@@ -146,7 +175,10 @@ def _get_arguments_from_env(self):
         try:
             if os.getenv('PROC_RANK'):
                 rank = int(os.getenv('PROC_RANK'))
-                self._args.block_devices = [self._args.block_devices[rank]]
+                if self._args.block_devices or not self._args.files:
+                    self._args.block_devices = [self._args.block_devices[rank]]
+                else:
+                    self._args.files = [self._args.files[rank]]
                 if os.getenv('NUMA_NODES'):
                     self._args.numa = int(os.getenv('NUMA_NODES').split(',')[rank])
             return True
@@ -157,6 +189,19 @@ def _get_arguments_from_env(self):
             )
             return False
 
+    def _set_binary_path(self):
+        """Set the binary of the selected engine before searching it.
+
+        Return:
+            True if the binary exists.
+        """
+        if self._args.engine not in self.__engine_bin_names:
+            self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+            logger.error('Invalid engine - benchmark: {}, engine: {}.'.format(self._name, self._args.engine))
+            return False
+        self._bin_name = self.__engine_bin_names[self._args.engine]
+        return super()._set_binary_path()
+
     def _preprocess(self):    # noqa: C901
         """Preprocess/preparation operations before the benchmarking.
 
@@ -170,23 +215,34 @@ def _preprocess(self):    # noqa: C901
         if self._args.numa is not None:
             fio_basic_command = f'numactl -N {self._args.numa} {fio_basic_command}'
         if self._args.verify is not None:
+            if self._args.engine != 'fio':
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Verify is only supported by fio engine - benchmark: {}.'.format(self._name))
+                return False
             fio_basic_command = f'{fio_basic_command} --verify={self._args.verify}'
+        if self._args.engine == 'io_uring':
+            fio_basic_command += ' --fixedbufs=1 --registerfiles=1'
+            if self._args.io_uring_sqpoll:
+                fio_basic_command += ' --sqthread_poll=1'
 
         for block_device in self._args.block_devices:
             if not Path(block_device).is_block_device():
                 self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
                 logger.error('Invalid block device: {}.'.format(block_device))
                 return False
+        targets = ['--filename=%s' % block_device for block_device in self._args.block_devices]
+        targets += ['--filename=%s --size=%s' % (file, self._args.file_size) for file in self._args.files]
 
+        for target in targets:
             if self._args.enable_seq_precond:
                 command = fio_basic_command +\
-                    ' --filename=%s' % block_device +\
+                    ' %s' % target +\
                     self.__fio_args['seq_precond']
                 self._commands.append(command)
 
             if self._args.rand_precond_time > 0:
                 command = fio_basic_command +\
-                    ' --filename=%s' % block_device +\
+                    ' %s' % target +\
                     ' --runtime=%ds' % self._args.rand_precond_time +\
                     self.__fio_args['rand_precond']
                 self._commands.append(command)
@@ -197,7 +253,7 @@ def _preprocess(self):    # noqa: C901
                     runtime = getattr(self._args, '%s_runtime' % io_str)
                     if runtime > 0:
                         command = fio_basic_command +\
-                            ' --filename=%s' % block_device +\
+                            ' %s' % target +\
                             ' --ramp_time=%ds' % getattr(self._args, '%s_ramp_time' % io_str) +\
                             ' --runtime=%ds' % runtime +\
                             ' --iodepth=%d' % getattr(self._args, '%s_iodepth' % io_str) +\
@@ -0,0 +1,108 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the filesystem metadata benchmark."""
+
+import os
+
+from superbench.benchmarks import BenchmarkRegistry
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class FsMetadataBenchmark(MicroBenchmarkWithInvoke):
+    """The filesystem metadata benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'fs_metadata'
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--dir',
+            type=str,
+            default='.',
+            required=False,
+            help='Directory to run the test in, e.g. a mount point of the filesystem to test.',
+        )
+        self._parser.add_argument(
+            '--threads',
+            type=int,
+            default=4,
+            required=False,
+            help='Number of threads.',
+        )
+        self._parser.add_argument(
+            '--files',
+            type=int,
+            default=1000,
+            required=False,
+            help='Number of files per thread.',
+        )
+        self._parser.add_argument(
+            '--shared_dir',
+            action='store_true',
+            help='Let all threads work in one shared directory instead of a private directory each.',
+        )
+        self._parser.add_argument(
+            '--io_uring',
+            action='store_true',
+            help='Issue create, stat and open-close with io_uring openat/statx.',
+        )
+        self._parser.add_argument(
+            '--iodepth',
+            type=int,
+            default=16,
+            required=False,
+            help='Number of operations in flight per thread with io_uring.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = '--dir %s --threads %d --files %d --iodepth %d' % (
+            self._args.dir, self._args.threads, self._args.files, self._args.iodepth
+        )
+        if self._args.shared_dir:
+            args += ' --shared_dir'
+        if self._args.io_uring:
+            args += ' --io_uring'
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('fs-metadata', FsMetadataBenchmark)
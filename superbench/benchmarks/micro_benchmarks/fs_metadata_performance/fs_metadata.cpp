@@ -0,0 +1,453 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Filesystem metadata operation rate benchmark in the style of mdtest.
+// Every thread creates, stats, opens and closes, renames and unlinks its own set of empty files, either in a private
+// directory per thread or all in one shared directory, and lists the directory. Each phase starts on all threads at
+// once and reports the aggregate operation rate and the per-operation latency. Create, stat and open-close can be
+// issued with io_uring openat/statx instead of the blocking calls.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../host_utils/io_uring_utils.h"
+#include "../host_utils/result_emitter.h"
+#include "../host_utils/stats_utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Metadata operations, run as phases in this order.
+enum class Phase { kCreate, kStat, kOpenClose, kReaddir, kRename, kUnlink };
+
+// Options accepted by this program.
+struct Opts {
+    // Directory to run the test in.
+    std::string dir = ".";
+
+    // Number of threads.
+    int threads = 4;
+
+    // Number of files per thread.
+    int files = 1000;
+
+    // Whether all threads work in one shared directory instead of a private directory each.
+    bool shared_dir = false;
+
+    // Whether to issue create, stat and open-close with io_uring.
+    bool io_uring = false;
+
+    // Number of operations in flight per thread with io_uring.
+    int iodepth = 16;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Files and result of one thread.
+struct Worker {
+    // Directory the files of this thread live in.
+    std::string dir;
+
+    // Paths of the files, and their names after the rename phase.
+    std::vector<std::string> paths;
+    std::vector<std::string> renamed_paths;
+
+    // Latency of the operations in the current phase.
+    host_utils::LatencyHistogram lat_ns;
+
+    // Number of operations in the current phase.
+    uint64_t ops = 0;
+
+    // Error number of the first failed operation, 0 if none.
+    int error = 0;
+};
+
+/**
+ * @brief Get the name of a phase used in metric names.
+ *
+ * @param phase The phase.
+ * @return The name of the phase.
+ */
+const char *PhaseName(Phase phase) {
+    switch (phase) {
+    case Phase::kCreate:
+        return "create";
+    case Phase::kStat:
+        return "stat";
+    case Phase::kOpenClose:
+        return "open_close";
+    case Phase::kReaddir:
+        return "readdir";
+    case Phase::kRename:
+        return "rename";
+    case Phase::kUnlink:
+        return "unlink";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: fs_metadata "
+              << "[--dir <path>] "
+              << "[--threads <num>] "
+              << "[--files <num>] "
+              << "[--shared_dir] "
+              << "[--io_uring] "
+              << "[--iodepth <num>] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the filesystem metadata benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx { kDir, kThreads, kFiles, kSharedDir, kIoUring, kIodepth };
+    const struct option options[] = {{"dir", required_argument, nullptr, static_cast<int>(OptIdx::kDir)},
+                                     {"threads", required_argument, nullptr, static_cast<int>(OptIdx::kThreads)},
+                                     {"files", required_argument, nullptr, static_cast<int>(OptIdx::kFiles)},
+                                     {"shared_dir", no_argument, nullptr, static_cast<int>(OptIdx::kSharedDir)},
+                                     {"io_uring", no_argument, nullptr, static_cast<int>(OptIdx::kIoUring)},
+                                     {"iodepth", required_argument, nullptr, static_cast<int>(OptIdx::kIodepth)},
+                                     RESULT_LONG_OPTIONS,
+                                     {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {{static_cast<int>(OptIdx::kThreads), {&opts->threads, 1}},
+                                                     {static_cast<int>(OptIdx::kFiles), {&opts->files, 1}},
+                                                     {static_cast<int>(OptIdx::kIodepth), {&opts->iodepth, 1}}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt_idx == static_cast<int>(OptIdx::kDir)) {
+            opts->dir = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kSharedDir)) {
+            opts->shared_dir = true;
+        } else if (opt_idx == static_cast<int>(OptIdx::kIoUring)) {
+            opts->io_uring = true;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Run operations with io_uring, keeping iodepth of them in flight.
+ *
+ * Every operation is a chain of entries linked together, e.g. an openat on a direct descriptor followed by its close,
+ * and its latency lasts from the submission until the last entry of the chain completes.
+ *
+ * @param opts The benchmark options.
+ * @param chain_len The number of entries of each operation.
+ * @param prep Fills the entries of operation i using the slot as its registered file and buffer index.
+ * @param worker The worker to record the latency and errors to.
+ */
+void RunIoUringOps(const Opts &opts, int chain_len,
+                   const std::function<void(host_utils::IoUring *, size_t i, int slot, uint64_t user_data)> &prep,
+                   Worker *worker) {
+    host_utils::IoUring ring;
+    int ret = ring.Init(opts.iodepth * chain_len);
+    std::vector<int> slots(opts.iodepth, -1);
+    if (ret == 0) {
+        ret = ring.RegisterFiles(slots.data(), opts.iodepth);
+    }
+    if (ret != 0) {
+        worker->error = -ret;
+        return;
+    }
+    std::vector<Clock::time_point> start_of_slot(opts.iodepth);
+    std::vector<int> pending_of_slot(opts.iodepth, 0);
+    std::vector<int> free_slots;
+    for (int slot = opts.iodepth - 1; slot >= 0; slot--) {
+        free_slots.push_back(slot);
+    }
+    size_t next = 0;
+    int inflight = 0;
+
+    while (worker->error == 0) {
+        for (; next < worker->paths.size() && !free_slots.empty(); next++) {
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            start_of_slot[slot] = Clock::now();
+            pending_of_slot[slot] = chain_len;
+            prep(&ring, next, slot, slot);
+            inflight++;
+        }
+        if (inflight == 0) {
+            break;
+        }
+        ret = ring.Submit(1);
+        io_uring_cqe *cqe = nullptr;
+        if ((ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) || (ret = ring.WaitCqe(&cqe)) != 0) {
+            worker->error = -ret;
+            break;
+        }
+        for (; cqe != nullptr; cqe = ring.PeekCqe()) {
+            int slot = static_cast<int>(cqe->user_data);
+            if (cqe->res < 0 && worker->error == 0) {
+                worker->error = -cqe->res;
+            }
+            ring.SeenCqe();
+            if (--pending_of_slot[slot] == 0) {
+                worker->lat_ns.Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_of_slot[slot]).count());
+                worker->ops++;
+                free_slots.push_back(slot);
+                inflight--;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Run one phase with io_uring on the files of a worker.
+ *
+ * @param opts The benchmark options.
+ * @param phase The phase, one of create, stat and open-close.
+ * @param worker The worker.
+ */
+void RunIoUringPhase(const Opts &opts, Phase phase, Worker *worker) {
+    if (phase == Phase::kStat) {
+        std::vector<struct statx> bufs(opts.iodepth);
+        RunIoUringOps(
+            opts, 1,
+            [&](host_utils::IoUring *ring, size_t i, int slot, uint64_t user_data) {
+                host_utils::PrepStatx(ring->GetSqe(), worker->paths[i].c_str(), STATX_BASIC_STATS, &bufs[slot],
+                                      user_data);
+            },
+            worker);
+        return;
+    }
+    int flags = phase == Phase::kCreate ? O_WRONLY | O_CREAT | O_EXCL : O_RDONLY;
+    RunIoUringOps(
+        opts, 2,
+        [&](host_utils::IoUring *ring, size_t i, int slot, uint64_t user_data) {
+            io_uring_sqe *sqe = ring->GetSqe();
+            host_utils::PrepOpenatDirect(sqe, worker->paths[i].c_str(), flags, slot, user_data, 0644);
+            sqe->flags = IOSQE_IO_LINK;
+            host_utils::PrepCloseDirect(ring->GetSqe(), slot, user_data);
+        },
+        worker);
+}
+
+/**
+ * @brief Run one operation of a phase with the blocking calls.
+ *
+ * @param phase The phase.
+ * @param worker The worker.
+ * @param i The index of the file.
+ * @return The number of operations done, -1 on failure.
+ */
+int64_t RunSyncOp(Phase phase, Worker *worker, size_t i) {
+    const char *path = worker->paths[i].c_str();
+    int fd = -1;
+    struct stat st;
+    switch (phase) {
+    case Phase::kCreate:
+    case Phase::kOpenClose:
+        fd = phase == Phase::kCreate ? open(path, O_WRONLY | O_CREAT | O_EXCL, 0644) : open(path, O_RDONLY);
+        return fd < 0 || close(fd) != 0 ? -1 : 1;
+    case Phase::kStat:
+        return stat(path, &st) != 0 ? -1 : 1;
+    case Phase::kRename:
+        return rename(path, worker->renamed_paths[i].c_str()) != 0 ? -1 : 1;
+    case Phase::kUnlink:
+        return unlink(worker->renamed_paths[i].c_str()) != 0 ? -1 : 1;
+    case Phase::kReaddir:
+        break;
+    }
+    DIR *dir = opendir(worker->dir.c_str());
+    if (dir == nullptr) {
+        return -1;
+    }
+    int64_t entries = 0;
+    while (readdir(dir) != nullptr) {
+        entries++;
+    }
+    closedir(dir);
+    return entries;
+}
+
+/**
+ * @brief Run one phase on the files of a worker.
+ *
+ * A readdir phase lists the directory of the worker once, counting every entry as an operation, and records the
+ * latency of the whole listing.
+ *
+ * @param opts The benchmark options.
+ * @param phase The phase.
+ * @param worker The worker.
+ */
+void RunPhase(const Opts &opts, Phase phase, Worker *worker) {
+    worker->ops = 0;
+    worker->lat_ns = host_utils::LatencyHistogram();
+    if (opts.io_uring && (phase == Phase::kCreate || phase == Phase::kStat || phase == Phase::kOpenClose)) {
+        RunIoUringPhase(opts, phase, worker);
+        return;
+    }
+    size_t count = phase == Phase::kReaddir ? 1 : worker->paths.size();
+    for (size_t i = 0; i < count; i++) {
+        auto start = Clock::now();
+        int64_t ops = RunSyncOp(phase, worker, i);
+        if (ops < 0) {
+            worker->error = errno;
+            return;
+        }
+        worker->lat_ns.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        worker->ops += ops;
+    }
+}
+
+/**
+ * @brief Run one phase on all workers starting at the same time, and emit its metrics.
+ *
+ * @param emitter The result emitter.
+ * @param opts The benchmark options.
+ * @param phase The phase.
+ * @param workers The workers.
+ * @return 0 on success, the error number of the first failed operation on failure.
+ */
+int RunAndEmitPhase(host_utils::ResultEmitter *emitter, const Opts &opts, Phase phase, std::vector<Worker> *workers) {
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (auto &worker : *workers) {
+        threads.emplace_back([&opts, phase, &worker, &ready, &go]() {
+            ready++;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            RunPhase(opts, phase, &worker);
+        });
+    }
+    while (ready.load() < opts.threads) {
+        std::this_thread::yield();
+    }
+    auto start = Clock::now();
+    go = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    uint64_t ops = 0;
+    host_utils::LatencyHistogram lat_ns;
+    for (const auto &worker : *workers) {
+        if (worker.error != 0) {
+            std::cerr << "Failed to run phase " << PhaseName(phase) << ". ERROR: " << strerror(worker.error)
+                      << std::endl;
+            return worker.error;
+        }
+        ops += worker.ops;
+        lat_ns.Merge(worker.lat_ns);
+    }
+
+    std::string tag = PhaseName(phase);
+    host_utils::ResultTags tags = {{"phase", tag}};
+    emitter->Metric(tag + "_ops_per_sec", ops / seconds, "ops/s", tags);
+    emitter->Metric(tag + "_lat_us_avg", lat_ns.Mean() / 1e3, "us", tags);
+    for (double percentile : host_utils::kLatencyPercentiles) {
+        emitter->Metric(tag + "_lat_us_" + host_utils::PercentileName(percentile), lat_ns.Percentile(percentile) / 1e3,
+                        "us", tags);
+    }
+    emitter->Metric(tag + "_lat_us_max", lat_ns.Max() / 1e3, "us", tags);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    std::string root = opts.dir + "/sb_mdtest";
+    if (mkdir(root.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Failed to create " << root << ". ERROR: " << strerror(errno) << std::endl;
+        return 1;
+    }
+    std::vector<Worker> workers(opts.threads);
+    char name[64];
+    for (int t = 0; t < opts.threads; t++) {
+        Worker &worker = workers[t];
+        snprintf(name, sizeof(name), "/t%d", t);
+        worker.dir = root + (opts.shared_dir ? std::string("/shared") : std::string(name));
+        if (mkdir(worker.dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Failed to create " << worker.dir << ". ERROR: " << strerror(errno) << std::endl;
+            return 1;
+        }
+        for (int i = 0; i < opts.files; i++) {
+            snprintf(name, sizeof(name), "/f%d.%d", t, i);
+            worker.paths.push_back(worker.dir + name);
+            worker.renamed_paths.push_back(worker.paths.back() + ".r");
+        }
+    }
+
+    host_utils::ResultEmitter emitter(opts.result);
+    for (Phase phase :
+         {Phase::kCreate, Phase::kStat, Phase::kOpenClose, Phase::kReaddir, Phase::kRename, Phase::kUnlink}) {
+        ret = RunAndEmitPhase(&emitter, opts, phase, &workers);
+        if (ret == 0 && emitter.Stopped()) {
+            ret = 1;
+        }
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    for (const auto &worker : workers) {
+        // Remove whatever is left if a phase failed
+        for (size_t i = 0; ret != 0 && i < worker.paths.size(); i++) {
+            unlink(worker.paths[i].c_str());
+            unlink(worker.renamed_paths[i].c_str());
+        }
+        rmdir(worker.dir.c_str());
+    }
+    rmdir(root.c_str());
+    return ret == 0 ? 0 : 1;
+}
@@ -6,6 +6,7 @@
 #include <cerrno> // errno
 #include <cstdio>
 #include <cstring>
+#include <string>
 #include <vector>
 
 #include <getopt.h>
@@ -14,6 +15,8 @@
 #include <cuda.h>
 #include <cuda_runtime.h>
 
+#include "../host_utils/result_emitter.h"
+
 // Arguments for each sub benchmark run.
 struct SubBenchArgs {
     // Whether source device is GPU.
@@ -136,6 +139,9 @@ struct Opts {
 
     // Whether check data after copy.
     bool check_data = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
 };
 
 // Print usage of this program.
@@ -155,7 +161,8 @@ void PrintUsage() {
            "[--all_to_one] "
            "[--all_to_all] "
            "[--bidirectional] "
-           "[--check_data]\n");
+           "[--check_data] %s\n",
+           host_utils::kResultOptsUsage);
 }
 
 // Parse options of this program.
@@ -194,7 +201,9 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
         {"all_to_one", no_argument, nullptr, static_cast<int>(OptIdx::kEnableAllToOne)},
         {"all_to_all", no_argument, nullptr, static_cast<int>(OptIdx::kEnableAllToAll)},
         {"bidirectional", no_argument, nullptr, static_cast<int>(OptIdx::kEnableBidirectional)},
-        {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)}};
+        {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
     int getopt_ret = 0;
     int opt_idx = 0;
     bool size_specified = false;
@@ -211,6 +220,13 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
         } else if (getopt_ret == '?') {
             parse_err = true;
             break;
+        } else if (host_utils::IsResultOpt(getopt_ret)) {
+            if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                fprintf(stderr, "Invalid %s: %s\n", options[opt_idx].name, optarg);
+                parse_err = true;
+                break;
+            }
+            continue;
         }
         switch (opt_idx) {
         case static_cast<int>(OptIdx::kSize):
@@ -598,7 +614,7 @@ int DestroyEvent(BenchArgs *args) {
 // 2) RCCL:
 // https://github.com/ROCmSoftwarePlatform/rccl/blob/5c8380ff5b5925cae4bce00b1879a5f930226e8d/src/collectives/device/common_kernel.h#L268
 inline __device__ void FetchULong2(ulong2 &v, const ulong2 *p) {
-#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__)
+#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__) || defined(CUDA_EMULATION)
     v.x = p->x;
     v.y = p->y;
 #else
@@ -613,7 +629,7 @@ inline __device__ void FetchULong2(ulong2 &v, const ulong2 *p) {
 // 2) RCCL:
 // https://github.com/ROCmSoftwarePlatform/rccl/blob/5c8380ff5b5925cae4bce00b1879a5f930226e8d/src/collectives/device/common_kernel.h#L276
 inline __device__ void StoreULong2(ulong2 *p, ulong2 &v) {
-#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__)
+#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__) || defined(CUDA_EMULATION)
     p->x = v.x;
     p->y = v.y;
 #else
@@ -634,35 +650,30 @@ __global__ void SMCopyKernel(ulong2 *tgt, const ulong2 *src) {
         StoreULong2(tgt + index + i * blockDim.x, val[i]);
 }
 
-// Print result tag as <src_dev>_to_<dst_dev>_by_<worker_dev>_using_<sm|dma>_under_<numa_node>.
-void PrintResultTag(const BenchArgs &args) {
-    if (args.subs[0].is_src_dev_gpu) {
-        printf("gpu%d", args.subs[0].src_gpu_id);
-    } else {
-        printf("cpu");
-    }
-    printf("%s", args.num_subs == 1 ? "_to_" : "_and_");
-    if (args.subs[0].is_dst_dev_gpu) {
-        printf("gpu%d", args.subs[0].dst_gpu_id);
-    } else {
-        printf("cpu");
-    }
+// Get result tag as <src_dev>_to_<dst_dev>_by_<worker_dev>_using_<sm|dma>_under_<numa_node>, with the devices, copy
+// type and NUMA node as the tags of the records.
+std::string GetResultTag(const BenchArgs &args, host_utils::ResultTags *tags) {
+    std::string src = args.subs[0].is_src_dev_gpu ? "gpu" + std::to_string(args.subs[0].src_gpu_id) : "cpu";
+    std::string dst = args.subs[0].is_dst_dev_gpu ? "gpu" + std::to_string(args.subs[0].dst_gpu_id) : "cpu";
+    std::string tag = src + (args.num_subs == 1 ? "_to_" : "_and_") + dst;
+    *tags = {{"src", src}, {"dst", dst}};
     if (args.subs[0].is_src_dev_gpu && args.subs[0].is_dst_dev_gpu &&
         args.subs[0].src_gpu_id != args.subs[0].dst_gpu_id) {
-        if (args.subs[0].src_gpu_id == args.subs[0].worker_gpu_id) {
-            printf("_write");
-        } else {
-            printf("_read");
-        }
+        std::string access = args.subs[0].src_gpu_id == args.subs[0].worker_gpu_id ? "write" : "read";
+        tag += "_" + access;
+        tags->push_back({"access", access});
     }
-    printf("_by_%s", args.is_sm_copy ? "sm" : "dma");
+    tag += std::string("_by_") + (args.is_sm_copy ? "sm" : "dma");
+    tags->push_back({"copy", args.is_sm_copy ? "sm" : "dma"});
     if (!args.subs[0].is_src_dev_gpu || !args.subs[0].is_dst_dev_gpu) {
-        printf("_under_numa%lu", args.numa_id);
+        tag += "_under_numa" + std::to_string(args.numa_id);
+        tags->push_back({"numa", std::to_string(args.numa_id)});
     }
+    return tag;
 }
 
 // Run copy benchmark.
-int RunCopy(BenchArgs *args) {
+int RunCopy(BenchArgs *args, host_utils::ResultEmitter *emitter) {
     cudaError_t cuda_err = cudaSuccess;
     uint64_t num_thread_blocks;
 
@@ -734,13 +745,17 @@ int RunCopy(BenchArgs *args) {
         max_time_in_ms = time_in_ms > max_time_in_ms ? time_in_ms : max_time_in_ms;
     }
 
-    PrintResultTag(*args);
+    host_utils::ResultTags tags;
+    std::string tag = GetResultTag(*args, &tags);
     double bw = args->size * args->num_loops * args->num_subs / max_time_in_ms / 1e6;
     if (args->subs[0].is_src_dev_gpu && args->subs[0].is_dst_dev_gpu &&
         args->subs[0].src_gpu_id == args->subs[0].dst_gpu_id) {
         bw *= 2.0;
     }
-    printf(" %g\n", bw);
+    // The text output keeps its "<tag> <bw>" lines
+    char text[256];
+    snprintf(text, sizeof(text), "%s %g", tag.c_str(), bw);
+    emitter->Metric(tag + "_bw", bw, "GB/s", tags, text);
 
     return 0;
 }
@@ -770,7 +785,7 @@ int EnablePeerAccess(int src_gpu_id, int dst_gpu_id, int *can_access) {
     return 0;
 }
 
-int RunBench(BenchArgs *args) {
+int RunBench(BenchArgs *args, host_utils::ResultEmitter *emitter) {
     int ret = 0;
     int destroy_ret = 0;
     ret = PrepareBufAndStream(args);
@@ -781,7 +796,7 @@ int RunBench(BenchArgs *args) {
     if (ret != 0) {
         goto destroy_event;
     }
-    ret = RunCopy(args);
+    ret = RunCopy(args, emitter);
     if (ret == 0 && args->check_data) {
         ret = CheckBuf(args);
     }
@@ -876,7 +891,8 @@ __global__ void SMOneToAllCopyKernel(ulong2 **dst_buffers, ulong2 *src_buffer, u
 }
 
 // src_rank/dst_rank: < 0 for all ranks, else for specified rank
-int RunAllToAllBench(const Opts &opts, int gpu_count, int src_rank, int dst_rank) {
+int RunAllToAllBench(const Opts &opts, int gpu_count, int src_rank, int dst_rank,
+                     host_utils::ResultEmitter *emitter) {
     int ret = 0;
     cudaError_t cuda_err = cudaSuccess;
     int can_access = 0;
@@ -1056,13 +1072,13 @@ int RunAllToAllBench(const Opts &opts, int gpu_count, int src_rank, int dst_rank
             min_bw = std::min(min_bw, bw);
         }
     }
-    if (src_rank < 0 && dst_rank < 0) {
-        printf("gpu_all_to_gpu_all_write_by_sm %g\n", min_bw);
-    } else if (src_rank < 0) {
-        printf("gpu_all_to_gpu%d_write_by_sm %g\n", dst_rank, min_bw);
-    } else {
-        printf("gpu%d_to_gpu_all_write_by_sm %g\n", src_rank, min_bw);
-    }
+    std::string src = src_rank < 0 ? "gpu_all" : "gpu" + std::to_string(src_rank);
+    std::string dst = dst_rank < 0 ? "gpu_all" : "gpu" + std::to_string(dst_rank);
+    std::string tag = src + "_to_" + dst + "_write_by_sm";
+    char text[256];
+    snprintf(text, sizeof(text), "%s %g", tag.c_str(), min_bw);
+    emitter->Metric(tag + "_bw", min_bw, "GB/s", {{"src", src}, {"dst", dst}, {"access", "write"}, {"copy", "sm"}},
+                    text);
 
     // Check data
     if (opts.check_data) {
@@ -1132,6 +1148,7 @@ int main(int argc, char **argv) {
     if (ret != 0) {
         return ret;
     }
+    host_utils::ResultEmitter emitter(opts.result);
     args.num_warm_up = opts.num_warm_up;
     args.num_loops = opts.num_loops;
     args.size = opts.size;
@@ -1246,32 +1263,42 @@ int main(int argc, char **argv) {
             fprintf(stderr, "main::numa_run_on_node error: %d\n", errno);
             return -1;
         }
-        ret = RunBench(&curr_args);
+        ret = RunBench(&curr_args, &emitter);
         if (ret != 0) {
             return -1;
         }
+        // Stop at the first copy failing the baseline with --fail_fast
+        if (emitter.Stopped()) {
+            return 1;
+        }
     }
 
     if (opts.one_to_all_enabled) {
         for (int i = 0; i < gpu_count; i++) {
-            ret = RunAllToAllBench(opts, gpu_count, i, -1);
+            ret = RunAllToAllBench(opts, gpu_count, i, -1, &emitter);
             if (ret != 0) {
                 return -1;
             }
+            if (emitter.Stopped()) {
+                return 1;
+            }
         }
     }
 
     if (opts.all_to_one_enabled) {
         for (int i = 0; i < gpu_count; i++) {
-            ret = RunAllToAllBench(opts, gpu_count, -1, i);
+            ret = RunAllToAllBench(opts, gpu_count, -1, i, &emitter);
             if (ret != 0) {
                 return -1;
             }
+            if (emitter.Stopped()) {
+                return 1;
+            }
         }
     }
 
     if (opts.all_to_all_enabled) {
-        ret = RunAllToAllBench(opts, gpu_count, -1, -1);
+        ret = RunAllToAllBench(opts, gpu_count, -1, -1, &emitter);
         if (ret != 0) {
             return -1;
         }
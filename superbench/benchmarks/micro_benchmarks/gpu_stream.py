@@ -5,8 +5,7 @@
 
 import os
 
-from superbench.common.utils import logger
-from superbench.benchmarks import BenchmarkRegistry, Platform, ReturnCode
+from superbench.benchmarks import BenchmarkRegistry, Platform
 from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
 
 
@@ -57,6 +56,8 @@ def add_parser_arguments(self):
             help='Enable data checking',
         )
 
+        self._add_result_record_arguments()
+
     def _preprocess(self):
         """Preprocess/preparation operations before the benchmarking.
 
@@ -75,6 +76,8 @@ def _preprocess(self):
         if self._args.check_data:
             args += ' --check_data'
 
+        args += self._result_record_args()
+
         self._commands = ['%s %s' % (self.__bin_path, args)]
 
         return True
@@ -91,29 +94,7 @@ def _process_raw_result(self, cmd_idx, raw_output):
         Return:
             True if the raw output string is valid and result can be extracted.
         """
-        self._result.add_raw_data('raw_output_' + str(cmd_idx), raw_output, self._args.log_raw_data)
-
-        try:
-            output_lines = [x.strip() for x in raw_output.strip().splitlines()]
-            count = 0
-            for output_line in output_lines:
-                if output_line.startswith('STREAM_'):
-                    count += 1
-                    tag, bw_str, ratio = output_line.split()
-                    self._result.add_result(tag + '_bw', float(bw_str))
-                    self._result.add_result(tag + '_ratio', float(ratio))
-            if count == 0:
-                raise BaseException('No valid results found.')
-        except BaseException as e:
-            self._result.set_return_code(ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
-            logger.error(
-                'The result format is invalid - round: {}, benchmark: {}, raw output: {}, message: {}.'.format(
-                    self._curr_run_index, self._name, raw_output, str(e)
-                )
-            )
-            return False
-
-        return True
+        return self._process_result_records(cmd_idx, raw_output)
 
 
 BenchmarkRegistry.register_benchmark('gpu-stream', GpuStreamBenchmark, platform=Platform.CUDA)
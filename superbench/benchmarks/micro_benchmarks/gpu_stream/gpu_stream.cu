@@ -8,7 +8,9 @@
 
 #include "gpu_stream.hpp"
 #include <cassert>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <nvml.h>
 
 /**
@@ -551,11 +553,13 @@ float GpuStream::GetActualMemoryClockRate(int gpu_id) {
  *
  * @param[in,out] args A unique pointer to a BenchArgs structure containing the necessary arguments for the
  benchmark.
+ * @param[in] emitter The emitter of the results.
  *
  * @return int The status code indicating success or failure of the benchmark execution.
  * */
 template <typename T>
-int GpuStream::RunStream(std::unique_ptr<BenchArgs<T>> &args, const std::string &data_type, float peak_bw) {
+int GpuStream::RunStream(std::unique_ptr<BenchArgs<T>> &args, const std::string &data_type, float peak_bw,
+                         host_utils::ResultEmitter *emitter) {
     int ret = 0;
     ret = PrepareBufAndStream<T>(args);
 
@@ -581,22 +585,31 @@ int GpuStream::RunStream(std::unique_ptr<BenchArgs<T>> &args, const std::string
         }
     }
 
-    // output formatted results to stdout
-    // Tags are of format:
-    // STREAM_<Kernelname>_datatype_gpu_<gpu_id>_buffer_<buffer_size>_block_<block_size>
+    // emit the bandwidth and its ratio to the peak of every kernel and block size
+    // Metrics are named:
+    // STREAM_<Kernelname>_datatype_gpu_<gpu_id>_buffer_<buffer_size>_block_<block_size>_(bw|ratio)
     for (int i = 0; i < args->sub.times_in_ms.size(); i++) {
         std::string tag = "STREAM_" + KernelToString(i) + "_" + data_type + "_gpu_" + std::to_string(args->gpu_id) +
                           "_buffer_" + std::to_string(args->size);
         for (int j = 0; j < args->sub.times_in_ms[i].size(); j++) {
-            // Calculate and display bandwidth
+            // Calculate and emit bandwidth
             double bw = args->size * args->num_loops / args->sub.times_in_ms[i][j] / 1e6;
-            std::cout << tag << "_block_" << kThreadsPerBlock[j] << "\t" << bw << "\t";
-
-            if (peak_bw < 0) { // cannot get peak_bw -> prints -1 for efficiency
-                std::cout << "-1" << std::endl;
+            std::string name = tag + "_block_" + std::to_string(kThreadsPerBlock[j]);
+            host_utils::ResultTags tags = {{"kernel", KernelToString(i)},
+                                           {"data_type", data_type},
+                                           {"gpu", std::to_string(args->gpu_id)},
+                                           {"buffer", std::to_string(args->size)},
+                                           {"block", std::to_string(kThreadsPerBlock[j])}};
+            // The text output keeps its "<name>\t<bw>\t<ratio>" lines
+            std::ostringstream line;
+            line << name << "\t" << bw << "\t";
+            if (peak_bw < 0) { // cannot get peak_bw -> -1 for efficiency
+                line << "-1";
             } else {
-                std::cout << std::fixed << std::setprecision(2) << bw / peak_bw * 100 << std::endl;
+                line << std::fixed << std::setprecision(2) << bw / peak_bw * 100;
             }
+            emitter->Metric(name + "_bw", bw, "GB/s", tags, line.str());
+            emitter->Metric(name + "_ratio", peak_bw < 0 ? -1 : bw / peak_bw * 100, "%", tags, "");
         }
     }
     // cleanup buffer and streams for the curr arg
@@ -650,7 +663,8 @@ int GpuStream::Run() {
     }
 
     bool has_error = false;
-    // Run the benchmark for all the configured data
+    host_utils::ResultEmitter emitter(opts_.result);
+    // Run the benchmark for all the configured data, stopping at the first GPU failing the baseline with --fail_fast
     for (auto &variant_args : bench_args_) {
         std::visit(
             [&](auto &curr_args) {
@@ -678,9 +692,9 @@ int GpuStream::Run() {
 
                 // Run the stream benchmark for the configured data, passing the peak bandwidth
                 if constexpr (std::is_same_v<std::decay_t<decltype(*curr_args)>, BenchArgs<float>>) {
-                    ret = RunStream<float>(curr_args, "float", peak_bw);
+                    ret = RunStream<float>(curr_args, "float", peak_bw, &emitter);
                 } else if constexpr (std::is_same_v<std::decay_t<decltype(*curr_args)>, BenchArgs<double>>) {
-                    ret = RunStream<double>(curr_args, "double", peak_bw);
+                    ret = RunStream<double>(curr_args, "double", peak_bw, &emitter);
                 } else {
                     std::cerr << "Run::Unknown type error" << std::endl;
                     has_error = true;
@@ -693,6 +707,9 @@ int GpuStream::Run() {
                 }
             },
             variant_args);
+        if (emitter.Stopped()) {
+            return 1;
+        }
     }
     if (has_error) {
         return -1;
@@ -53,7 +53,9 @@ class GpuStream {
     // Benchmark functions
     template <typename T> int RunStreamKernel(std::unique_ptr<BenchArgs<T>> &, Kernel, int);
     float GetActualMemoryClockRate(int gpu_id);
-    template <typename T> int RunStream(std::unique_ptr<BenchArgs<T>> &, const std::string &data_type, float peak_bw);
+    template <typename T>
+    int RunStream(std::unique_ptr<BenchArgs<T>> &, const std::string &data_type, float peak_bw,
+                  host_utils::ResultEmitter *emitter);
 
     // Helper functions
     int GetGpuCount(int *);
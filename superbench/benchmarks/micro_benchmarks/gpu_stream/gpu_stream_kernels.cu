@@ -18,7 +18,7 @@
  * @param[in] p The source memory location to fetch the value from.
  */
 template <typename T> inline __device__ void Fetch(T &v, const T *p) {
-#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__)
+#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__) || defined(CUDA_EMULATION)
     v = *p;
 #else
     if constexpr (std::is_same<T, float>::value) {
@@ -44,7 +44,7 @@ template <typename T> inline __device__ void Fetch(T &v, const T *p) {
  * @param[in] v The register containing the value to be stored.
  */
 template <typename T> inline __device__ void Store(T *p, const T &v) {
-#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__)
+#if defined(__HIP_PLATFORM_HCC__) || defined(__HCC__) || defined(__HIPCC__) || defined(CUDA_EMULATION)
     *p = v;
 #else
     if constexpr (std::is_same<T, float>::value) {
@@ -43,7 +43,7 @@ void PrintUsage() {
               << "--size <size in bytes> "
               << "--num_warm_up <num_warm_up> "
               << "--num_loops <num_loops> "
-              << "[--check_data]" << std::endl;
+              << "[--check_data] " << host_utils::kResultOptsUsage << std::endl;
 }
 
 /**
@@ -79,7 +79,9 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
     const struct option options[] = {{"size", required_argument, nullptr, static_cast<int>(OptIdx::kSize)},
                                      {"num_warm_up", required_argument, nullptr, static_cast<int>(OptIdx::kNumWarmUp)},
                                      {"num_loops", required_argument, nullptr, static_cast<int>(OptIdx::kNumLoops)},
-                                     {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)}};
+                                     {"check_data", no_argument, nullptr, static_cast<int>(OptIdx::kEnableCheckData)},
+                                     RESULT_LONG_OPTIONS,
+                                     {nullptr, 0, nullptr, 0}};
     int getopt_ret = 0;
     int opt_idx = 0;
     bool size_specified = true;
@@ -97,6 +99,13 @@ int ParseOpts(int argc, char **argv, Opts *opts) {
         } else if (getopt_ret == '?') {
             parse_err = true;
             break;
+        } else if (host_utils::IsResultOpt(getopt_ret)) {
+            if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+                break;
+            }
+            continue;
         }
         switch (opt_idx) {
         case static_cast<int>(OptIdx::kSize):
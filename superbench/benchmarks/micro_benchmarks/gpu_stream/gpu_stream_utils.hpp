@@ -17,6 +17,8 @@
 #include <numa.h>
 #include <nvml.h>
 
+#include "../host_utils/result_emitter.h"
+
 // Custom deleter for GPU buffers
 struct GpuBufferDeleter {
     template <typename T> void operator()(T *ptr) const {
@@ -121,6 +123,9 @@ struct Opts {
 
     // Whether check data after copy.
     bool check_data = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
 };
 
 std::string KernelToString(int); // Function to convert enum to string
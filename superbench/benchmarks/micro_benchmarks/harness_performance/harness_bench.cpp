@@ -0,0 +1,269 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Micro-benchmarks of the host-side internals of the benchmark binaries, so that a regression of their overhead is
+// caught before it skews the device measurements: the thread pool of cuda_decode_performance, the config and output
+// parsing of ib_validation_performance, the metric calculation of cuda_decode_performance, the option parsing, data
+// filling and transposing of cublas_function, and the buffer arena of host_utils. They are built against the CPU
+// emulation of the CUDA runtime, see cuda_emulation, and sized as in real runs, e.g. 100k-line configs, 10M samples and
+// 16k x 16k matrices.
+// Run a subset with e.g. harness_bench --benchmark_filter=CalMetrics.
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include "../cublas_function/cublas_function_helper.h"
+#include "../cuda_decode_performance/MetricsUtils.h"
+#include "../cuda_decode_performance/ThreadPoolUtils.h"
+#include "../host_utils/buffer_arena.h"
+#include "../ib_validation_performance/ib_validation_utils.h"
+
+namespace {
+
+// Number of tasks enqueued per iteration of the thread pool benchmark.
+constexpr size_t kThreadPoolTasks = 1024;
+
+// Number of nodes and ranks per node of the generated IB validation configs.
+constexpr int kConfigNodes = 128;
+constexpr int kConfigLocalSize = 8;
+
+// Number of pairs per line of the generated IB validation configs.
+constexpr int kConfigPairsPerLine = 8;
+
+// Raw output of ib_write_bw and ib_write_lat as parsed by the IB validation tool.
+const char *kIbBwOutput = "---------------------------------------------------------------------------------------\n"
+                          "                    RDMA_Write BW Test\n"
+                          " Dual-port       : OFF          Device         : mlx5_0\n"
+                          " Number of qps   : 1            Transport type : IB\n"
+                          " Connection type : RC           Using SRQ      : OFF\n"
+                          " TX depth        : 128\n"
+                          " CQ Moderation   : 100\n"
+                          " Mtu             : 4096[B]\n"
+                          " Link type       : IB\n"
+                          " Max inline data : 0[B]\n"
+                          " rdma_cm QPs     : OFF\n"
+                          " Data ex. method : Ethernet\n"
+                          "---------------------------------------------------------------------------------------\n"
+                          " local address: LID 0x1c QPN 0x0167 PSN 0xc1d4e6 RKey 0x1fff00 VAddr 0x007f3a6b200000\n"
+                          " remote address: LID 0x1d QPN 0x0167 PSN 0x4c3e8a RKey 0x1fff00 VAddr 0x007f8a2e200000\n"
+                          "---------------------------------------------------------------------------------------\n"
+                          " #bytes     #iterations    BW peak[Gb/sec]    BW average[Gb/sec]   MsgRate[Mpps]\n"
+                          " 8388608    5000             196.08             195.76              0.002917\n"
+                          "---------------------------------------------------------------------------------------\n";
+const char *kIbLatOutput = "---------------------------------------------------------------------------------------\n"
+                           "                    RDMA_Write Latency Test\n"
+                           " Dual-port       : OFF          Device         : mlx5_0\n"
+                           " Number of qps   : 1            Transport type : IB\n"
+                           " Connection type : RC           Using SRQ      : OFF\n"
+                           " TX depth        : 1\n"
+                           " Mtu             : 4096[B]\n"
+                           " Link type       : IB\n"
+                           " Max inline data : 220[B]\n"
+                           " rdma_cm QPs     : OFF\n"
+                           " Data ex. method : Ethernet\n"
+                           "---------------------------------------------------------------------------------------\n"
+                           " local address: LID 0x1c QPN 0x0168 PSN 0x5a3e1b RKey 0x1fff00 VAddr 0x007f3a6b200000\n"
+                           " remote address: LID 0x1d QPN 0x0168 PSN 0x9d2c7f RKey 0x1fff00 VAddr 0x007f8a2e200000\n"
+                           "---------------------------------------------------------------------------------------\n"
+                           " #bytes #iterations    t_min[usec]    t_max[usec]  t_typical[usec]    t_avg[usec]    "
+                           "t_stdev[usec]   99% percentile[usec]   99.9% percentile[usec]\n"
+                           " 8388608    5000        581.27   876.26   594.87    595.50     3.33       601.65          "
+                           "621.14\n"
+                           "---------------------------------------------------------------------------------------\n";
+
+// Command line of cublas_function as generated by the cublas-function benchmark.
+const std::vector<std::string> kCublasArgs = {
+    "cublas_benchmark", "--num_test",    "20",    "--warm_up",     "5",     "--num_in_step", "100",
+    "--random_seed",    "33931",         "--eps", "0.001",         "--correctness",          "--random_data",
+    "--config_json",
+    R"({"name":"cublasGemmStridedBatchedEx","m":224,"n":224,"k":64,"transa":0,"transb":0,)"
+    R"("datatype":"half","use_tensor_core":true,"batchCount":160})"};
+
+/**
+ * @brief Expose the host routines of CublasFunction for a float matrix product of the given sizes.
+ */
+class CublasHostRoutines : public CublasFunction {
+  public:
+    CublasHostRoutines(int m, int n, int k) {
+        m_ = m;
+        n_ = n;
+        k_ = k;
+        batch_count_ = 1;
+        random_seed = 33931;
+    }
+    using CublasFunction::fill_data;
+    using CublasFunction::transpose;
+};
+
+/**
+ * @brief Write an IB validation config of all-to-all pairs among the nodes.
+ *
+ * @param lines The number of lines.
+ * @return The path of the config, to be removed by the caller.
+ */
+std::string WriteIbConfig(int lines) {
+    char path[] = "/tmp/harness_bench_config_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        return "";
+    }
+    close(fd);
+    std::ofstream out(path);
+    for (int line = 0; line < lines; line++) {
+        for (int pair = 0; pair < kConfigPairsPerLine; pair++) {
+            int server = (line + pair * (kConfigNodes / kConfigPairsPerLine)) % kConfigNodes;
+            int client = (server + 1 + line / kConfigNodes) % kConfigNodes;
+            out << (pair == 0 ? "" : ";") << server << "," << (client == server ? (client + 1) % kConfigNodes : client);
+        }
+        out << "\n";
+    }
+    return path;
+}
+
+} // namespace
+
+/**
+ * @brief Enqueue tasks into the ThreadPool of cuda_decode_performance and wait for their results.
+ */
+void BM_ThreadPoolEnqueue(benchmark::State &state) {
+    ThreadPool pool(state.range(0));
+    std::vector<std::future<size_t>> results(kThreadPoolTasks);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kThreadPoolTasks; i++) {
+            results[i] = pool.enqueue([](size_t thread_idx, size_t task) { return thread_idx + task; }, i);
+        }
+        for (auto &result : results) {
+            benchmark::DoNotOptimize(result.get());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kThreadPoolTasks);
+}
+BENCHMARK(BM_ThreadPoolEnqueue)->Arg(1)->Arg(4)->Arg(16)->UseRealTime();
+
+/**
+ * @brief Parse the raw output of an ib command, bandwidth for argument 0 and latency for argument 1.
+ */
+void BM_IbProcessRawOutput(benchmark::State &state) {
+    std::string output = state.range(0) == 0 ? kIbBwOutput : kIbLatOutput;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(process_raw_output(output));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IbProcessRawOutput)->Arg(0)->Arg(1);
+
+/**
+ * @brief Load an IB validation config of the given number of lines.
+ */
+void BM_IbLoadConfig(benchmark::State &state) {
+    std::string path = WriteIbConfig(state.range(0));
+    if (path.empty()) {
+        state.SkipWithError("Failed to write the config.");
+        return;
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(load_config(path, kConfigNodes * kConfigLocalSize, kConfigLocalSize, false));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    remove(path.c_str());
+}
+BENCHMARK(BM_IbLoadConfig)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Calculate the metrics of cuda_decode_performance over the given number of samples.
+ */
+void BM_CalMetrics(benchmark::State &state) {
+    std::mt19937_64 gen(33931);
+    std::lognormal_distribution<double> latency(1.0, 0.5);
+    std::vector<double> samples(state.range(0));
+    for (auto &sample : samples) {
+        sample = latency(gen);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(CalMetrics(samples));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CalMetrics)->Arg(100000)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Parse the command line of cublas_function and its function config.
+ */
+void BM_CublasOptions(benchmark::State &state) {
+    std::vector<std::string> args = kCublasArgs;
+    std::vector<char *> argv;
+    for (auto &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    for (auto _ : state) {
+        Options options(static_cast<int>(argv.size()), argv.data());
+        CublasFunction function = json::parse(options.para_info_json).get<CublasFunction>();
+        benchmark::DoNotOptimize(function);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CublasOptions);
+
+/**
+ * @brief Fill the float inputs of cublas_function for square matrices, random data for argument 1.
+ */
+void BM_CublasFillData(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0));
+    CublasHostRoutines routines(n, n, n);
+    std::vector<float> a(static_cast<size_t>(n) * n), b(static_cast<size_t>(n) * n);
+    for (auto _ : state) {
+        routines.fill_data(a.data(), b.data(), state.range(1) != 0);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * (a.size() + b.size()) * sizeof(float));
+}
+BENCHMARK(BM_CublasFillData)
+    ->Args({4096, 0})
+    ->Args({4096, 1})
+    ->Args({16384, 0})
+    ->Args({16384, 1})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Transpose a float square matrix with the CPU reference routine of cublas_function.
+ */
+void BM_CublasTranspose(benchmark::State &state) {
+    int n = static_cast<int>(state.range(0));
+    CublasHostRoutines routines(n, n, n);
+    std::vector<float> matrix(static_cast<size_t>(n) * n, 1.0f);
+    for (auto _ : state) {
+        float *transposed = routines.transpose(matrix.data(), n, n, 1);
+        benchmark::DoNotOptimize(transposed);
+        free(transposed);
+    }
+    state.SetBytesProcessed(state.iterations() * matrix.size() * sizeof(float) * 2);
+}
+BENCHMARK(BM_CublasTranspose)->Arg(4096)->Arg(16384)->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Get a buffer of the given MiB from the arena, mapped and pre-faulted anew for argument 0 and reused for 1.
+ */
+void BM_ArenaAcquire(benchmark::State &state) {
+    size_t size = static_cast<size_t>(state.range(0)) << 20;
+    bool reuse = state.range(1) != 0;
+    host_utils::BufferArena arena;
+    for (auto _ : state) {
+        host_utils::ArenaBuffer buffer = arena.Acquire(0, size);
+        benchmark::DoNotOptimize(buffer.Data());
+        buffer.Release();
+        if (!reuse) {
+            arena.Trim();
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_ArenaAcquire)->Args({64, 0})->Args({64, 1})->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,118 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the single-process host benchmark runner."""
+
+import os
+import shlex
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class HostRunnerBenchmark(MicroBenchmarkWithInvoke):
+    """The single-process host benchmark runner class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'host_runner'
+        self._plugins = ['numa_copy', 'stream', 'gemm', 'dispatch', 'all_to_all', 'mem_lock', 'mem_test', 'sync']
+        # mem_lock needs a locked memory limit above the buffer size and mem_test takes most of the free memory for a
+        # minute, so they only run when given
+        self._default_plugins = ['numa_copy', 'stream', 'gemm', 'dispatch', 'all_to_all', 'sync']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--benchmarks',
+            type=str,
+            nargs='+',
+            default=None,
+            help='Plan lines to run in one process, each "<plugin> [key=value ...]" with plugins {}. '
+            'All but mem_lock and mem_test with their defaults if neither --benchmarks nor --plan is specified.'.format(
+                ' '.join(self._plugins)
+            ),
+        )
+        self._parser.add_argument(
+            '--plan',
+            type=str,
+            default=None,
+            required=False,
+            help='Plan file with one plan line per benchmark, run before --benchmarks.',
+        )
+        self._parser.add_argument(
+            '--cpus',
+            type=str,
+            default=None,
+            required=False,
+            help='Cpus of the shared thread team, e.g. 0-31. All the cpus of the affinity if not specified.',
+        )
+        self._parser.add_argument(
+            '--pages',
+            type=str,
+            default='default',
+            choices=['default', 'small', 'thp', 'hugetlb'],
+            required=False,
+            help='Pages backing the shared buffers, hugetlb falling back to transparent huge pages if none is left.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        if self._args.benchmarks is None:
+            self._args.benchmarks = [] if self._args.plan else list(self._default_plugins)
+        for line in self._args.benchmarks:
+            plugin = line.split()[0] if line.split() else ''
+            if plugin not in self._plugins:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid plugin - benchmark: {}, plan line: {}.'.format(self._name, line))
+                return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ''
+        if self._args.plan:
+            args += ' --plan %s' % self._args.plan
+        args += ''.join(' --run %s' % shlex.quote(line) for line in self._args.benchmarks)
+        if self._args.cpus:
+            args += ' --cpus %s' % self._args.cpus
+        if self._args.pages != 'default':
+            args += ' --pages %s' % self._args.pages
+        args += self._result_record_args()
+
+        self._commands = ['%s%s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('host-runner', HostRunnerBenchmark)
@@ -0,0 +1,272 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// All-to-all copy plugin of the host runner, the CPU counterpart of RunAllToAllBench in gpu_copy.
+// Workers are team members taken in turn from every NUMA node, each owning a source and a destination buffer of one
+// slice per worker on its own node. Like SMOneToAllCopyKernel, a worker writes slice d of its source buffer into slice
+// s of the destination buffer of worker d, s being itself, with all the writers copying concurrently: one worker to
+// all the others, all the others to one worker, and every worker to every other. The bandwidth of every writer and of
+// the whole collective is reported with the tags of gpu_copy, worker ranks taking the place of GPUs.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Collectives, in the order of the gpu_copy options.
+const char *const kModes[] = {"one_to_all", "all_to_one", "all_to_all"};
+
+class AllToAll : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        std::string modes;
+        bool ok = params->Int("workers", &workers_, 0) && params->Size("slice", &slice_) &&
+                  params->Int("warmup", &warmup_, 0) && params->Int("iters", &iters_, 1) &&
+                  params->String("modes", &modes) && params->Int("check_data", &check_data_, 0);
+        if (!ok) {
+            return false;
+        }
+        if (!modes.empty()) {
+            modes_.clear();
+            std::stringstream ss(modes);
+            for (std::string mode; std::getline(ss, mode, ',');) {
+                if (std::find_if(std::begin(kModes), std::end(kModes),
+                                 [&](const char *name) { return mode == name; }) == std::end(kModes)) {
+                    std::cerr << "Invalid modes: " << mode << ", use one_to_all, all_to_one or all_to_all."
+                              << std::endl;
+                    return false;
+                }
+                modes_.push_back(mode);
+            }
+        }
+        return !modes_.empty();
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        int count = workers_ == 0 ? ctx->team->Size() : std::min(workers_, ctx->team->Size());
+        if (count < 2) {
+            // Nothing to exchange with a single worker, as on a single-cpu host, which is not a failure of the plan
+            std::cerr << "All-to-all copies need at least 2 workers, the team has " << ctx->team->Size()
+                      << ", skipped." << std::endl;
+            return true;
+        }
+        if (!Place(ctx, count)) {
+            return false;
+        }
+        for (const auto &mode : modes_) {
+            // Source and destination ranks of the collective, all ranks if negative
+            if (mode == "all_to_all") {
+                if (!Measure(ctx, emitter, -1, -1)) {
+                    return false;
+                }
+                continue;
+            }
+            for (int rank = 0; rank < count && !emitter->Stopped(); rank++) {
+                bool ok = mode == "one_to_all" ? Measure(ctx, emitter, rank, -1) : Measure(ctx, emitter, -1, rank);
+                if (!ok) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+  private:
+    /**
+     * @brief Pick the workers in turn from the nodes with cpus and lay out their buffers on their nodes.
+     *
+     * @param count The number of workers.
+     */
+    bool Place(host_runner::HostContext *ctx, int count) {
+        std::set<int> nodes;
+        for (int cpu : ctx->topology.cpus) {
+            nodes.insert(ctx->topology.cpu_node.at(cpu));
+        }
+        std::vector<std::vector<int>> on_node;
+        for (int node : nodes) {
+            on_node.push_back(ctx->topology.MembersOnNode(node));
+        }
+        members_.clear();
+        for (size_t i = 0; static_cast<int>(members_.size()) < count; i++) {
+            for (const auto &members : on_node) {
+                if (i < members.size() && static_cast<int>(members_.size()) < count) {
+                    members_.push_back(members[i]);
+                }
+            }
+        }
+
+        // Every node holds the buffers of its workers, one slice per worker each
+        uint64_t buffer_size = slice_ * members_.size();
+        std::map<int, std::vector<int>> node_ranks;
+        for (size_t rank = 0; rank < members_.size(); rank++) {
+            node_ranks[Node(ctx, static_cast<int>(rank))].push_back(static_cast<int>(rank));
+        }
+        src_.assign(members_.size(), nullptr);
+        dst_.assign(members_.size(), nullptr);
+        for (const auto &node : node_ranks) {
+            char *src = ctx->arena->Get(node.first, 0, node.second.size() * buffer_size);
+            char *dst = ctx->arena->Get(node.first, 1, node.second.size() * buffer_size);
+            if (src == nullptr || dst == nullptr) {
+                return false;
+            }
+            for (size_t i = 0; i < node.second.size(); i++) {
+                src_[node.second[i]] = src + i * buffer_size;
+                dst_[node.second[i]] = dst + i * buffer_size;
+            }
+        }
+        // Every slice of a source buffer holds its own byte, so that a misplaced copy is detected
+        ctx->team->Run(members_, [&](int rank, int ranks) {
+            for (int slice = 0; slice < ranks; slice++) {
+                memset(src_[rank] + slice * slice_, (rank * ranks + slice) % 251 + 1, slice_);
+            }
+            memset(dst_[rank], 0, buffer_size);
+        });
+        return true;
+    }
+
+    /**
+     * @brief Run a collective and emit the bandwidth of its writers and of the whole.
+     *
+     * @param src_rank The only writer, all the ranks if negative.
+     * @param dst_rank The only rank written to, all the ranks if negative.
+     */
+    bool Measure(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter, int src_rank, int dst_rank) {
+        int count = static_cast<int>(members_.size());
+        std::vector<int> writers;
+        for (int rank = 0; rank < count; rank++) {
+            if ((src_rank < 0 || rank == src_rank) && rank != dst_rank) {
+                writers.push_back(rank);
+            }
+        }
+        std::vector<int> members;
+        for (int rank : writers) {
+            members.push_back(members_[rank]);
+        }
+
+        std::vector<double> seconds(writers.size(), 0);
+        std::vector<Clock::time_point> starts(writers.size()), ends(writers.size());
+        double total_seconds = 0;
+        for (int i = 0; i < warmup_ + iters_; i++) {
+            std::atomic<int> arrived{0};
+            ctx->team->Run(members, [&](int index, int num_writers) {
+                // Start together, so that the copies contend as in the collective
+                arrived.fetch_add(1);
+                while (arrived.load() < num_writers) {
+                    std::this_thread::yield();
+                }
+                int rank = writers[index];
+                starts[index] = Clock::now();
+                // Staggered targets, so that the writers do not all start on the same buffer
+                for (int step = 1; step < count; step++) {
+                    int target = (rank + step) % count;
+                    if (dst_rank < 0 || target == dst_rank) {
+                        memcpy(dst_[target] + rank * slice_, src_[rank] + target * slice_, slice_);
+                    }
+                }
+                ends[index] = Clock::now();
+            });
+            if (i >= warmup_) {
+                for (size_t w = 0; w < writers.size(); w++) {
+                    seconds[w] += std::chrono::duration<double>(ends[w] - starts[w]).count();
+                }
+                total_seconds += std::chrono::duration<double>(*std::max_element(ends.begin(), ends.end()) -
+                                                               *std::min_element(starts.begin(), starts.end()))
+                                     .count();
+            }
+        }
+        if (check_data_ != 0 && !Check(src_rank, dst_rank)) {
+            return false;
+        }
+
+        std::string src_name = src_rank < 0 ? "worker_all" : "worker" + std::to_string(src_rank);
+        std::string dst_name = dst_rank < 0 ? "worker_all" : "worker" + std::to_string(dst_rank);
+        std::string name = src_name + "_to_" + dst_name + "_write";
+        host_utils::ResultTags tags = {{"src", src_rank < 0 ? "all" : std::to_string(src_rank)},
+                                       {"dst", dst_rank < 0 ? "all" : std::to_string(dst_rank)},
+                                       {"workers", std::to_string(count)},
+                                       {"slice", std::to_string(slice_)}};
+        // Bytes written by every writer per iteration
+        double bytes = static_cast<double>(slice_) * (dst_rank < 0 ? count - 1 : 1);
+        if (writers.size() > 1) {
+            for (size_t w = 0; w < writers.size(); w++) {
+                host_utils::ResultTags worker_tags = tags;
+                worker_tags.push_back({"worker", std::to_string(writers[w])});
+                worker_tags.push_back({"cpu", std::to_string(ctx->topology.cpus[members_[writers[w]]])});
+                worker_tags.push_back({"numa", std::to_string(Node(ctx, writers[w]))});
+                emitter->Metric(name + "_by_worker" + std::to_string(writers[w]) + "_bw",
+                                bytes * iters_ / seconds[w] / 1e9, "GB/s", worker_tags);
+            }
+        }
+        emitter->Metric(name + "_bw", bytes * writers.size() * iters_ / total_seconds / 1e9, "GB/s", tags);
+        return true;
+    }
+
+    /**
+     * @brief Compare the slices written by a collective with their sources.
+     */
+    bool Check(int src_rank, int dst_rank) const {
+        int count = static_cast<int>(members_.size());
+        for (int src = 0; src < count; src++) {
+            for (int dst = 0; dst < count; dst++) {
+                if (src == dst || (src_rank >= 0 && src != src_rank) || (dst_rank >= 0 && dst != dst_rank)) {
+                    continue;
+                }
+                if (memcmp(dst_[dst] + src * slice_, src_[src] + dst * slice_, slice_) != 0) {
+                    std::cerr << "Data integrity check failed from worker " << src << " to worker " << dst << "."
+                              << std::endl;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Get the NUMA node of a worker.
+     */
+    int Node(host_runner::HostContext *ctx, int rank) const {
+        return ctx->topology.cpu_node.at(ctx->topology.cpus[members_[rank]]);
+    }
+
+    // Number of workers, all the team if 0.
+    int workers_ = 8;
+
+    // Size in bytes of the slice copied from every worker to every other.
+    uint64_t slice_ = 4ULL << 20;
+
+    // Number of warmup collectives.
+    int warmup_ = 1;
+
+    // Number of timed collectives.
+    int iters_ = 10;
+
+    // Collectives to run.
+    std::vector<std::string> modes_ = {"one_to_all", "all_to_one", "all_to_all"};
+
+    // Whether to compare the written slices with their sources.
+    int check_data_ = 0;
+
+    // Team member of every worker rank.
+    std::vector<int> members_;
+
+    // Source and destination buffers of every worker rank.
+    std::vector<char *> src_;
+    std::vector<char *> dst_;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("all_to_all", AllToAll);
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// CPU GEMM plugin of the host runner.
+// A single precision c = a * b of row-major matrices is computed in cache blocks, the rows of c being shared by the
+// team members, with the matrices in the arena of the NUMA node of the first member.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Kernels compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+// Rows and depth of the cache blocks.
+constexpr size_t kBlockRows = 64;
+constexpr size_t kBlockDepth = 256;
+
+/**
+ * @brief Compute rows [row_begin, row_end) of c = a * b of row-major matrices.
+ */
+SIMD_CLONES void Gemm(const float *a, const float *b, float *c, size_t row_begin, size_t row_end, size_t n, size_t k) {
+    for (size_t i = row_begin; i < row_end; i++) {
+        std::fill(c + i * n, c + (i + 1) * n, 0.0f);
+    }
+    for (size_t ib = row_begin; ib < row_end; ib += kBlockRows) {
+        for (size_t pb = 0; pb < k; pb += kBlockDepth) {
+            for (size_t i = ib; i < std::min(ib + kBlockRows, row_end); i++) {
+                float *row = c + i * n;
+                for (size_t p = pb; p < std::min(pb + kBlockDepth, k); p++) {
+                    float aip = a[i * k + p];
+                    const float *brow = b + p * n;
+                    for (size_t j = 0; j < n; j++) {
+                        row[j] += aip * brow[j];
+                    }
+                }
+            }
+        }
+    }
+}
+
+class CpuGemm : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        return params->Int("m", &m_, 1) && params->Int("n", &n_, 1) && params->Int("k", &k_, 1) &&
+               params->Int("warmup", &warmup_, 0) && params->Int("iters", &iters_, 1) &&
+               params->Int("threads", &threads_, 0);
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        int num_threads = threads_ == 0 ? ctx->team->Size() : std::min(threads_, ctx->team->Size());
+        std::vector<int> members(num_threads);
+        for (int m = 0; m < num_threads; m++) {
+            members[m] = m;
+        }
+        int node = ctx->topology.cpu_node.at(ctx->topology.cpus[0]);
+        float *a = reinterpret_cast<float *>(ctx->arena->Get(node, 0, sizeof(float) * m_ * k_));
+        float *b = reinterpret_cast<float *>(ctx->arena->Get(node, 1, sizeof(float) * k_ * n_));
+        float *c = reinterpret_cast<float *>(ctx->arena->Get(node, 2, sizeof(float) * m_ * n_));
+        if (a == nullptr || b == nullptr || c == nullptr) {
+            return false;
+        }
+        std::fill(a, a + static_cast<size_t>(m_) * k_, 1.0f);
+        std::fill(b, b + static_cast<size_t>(k_) * n_, 0.5f);
+
+        double seconds = 0;
+        int iters = 0;
+        for (int i = 0; i < warmup_ + iters_; i++) {
+            auto start = Clock::now();
+            ctx->team->Run(members, [&](int index, int count) {
+                Gemm(a, b, c, static_cast<size_t>(m_) * index / count, static_cast<size_t>(m_) * (index + 1) / count,
+                     n_, k_);
+            });
+            if (i >= warmup_) {
+                double gemm_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                seconds += gemm_seconds;
+                iters++;
+                // The remaining iterations are skipped once the throughput is confirmed below the baseline
+                if (emitter->Observe("gflops", 2.0 * m_ * n_ * k_ / gemm_seconds / 1e9)) {
+                    break;
+                }
+            }
+        }
+
+        host_utils::ResultTags tags = {{"m", std::to_string(m_)},
+                                       {"n", std::to_string(n_)},
+                                       {"k", std::to_string(k_)},
+                                       {"threads", std::to_string(num_threads)}};
+        emitter->Metric("time", seconds / iters * 1e3, "ms", tags);
+        emitter->Metric("gflops", 2.0 * m_ * n_ * k_ * iters / seconds / 1e9, "GFLOPS", tags);
+        return true;
+    }
+
+  private:
+    // Shape of the GEMM.
+    int m_ = 1024;
+    int n_ = 1024;
+    int k_ = 1024;
+
+    // Number of warmup iterations.
+    int warmup_ = 1;
+
+    // Number of timed iterations.
+    int iters_ = 5;
+
+    // Number of team members to run on, all if 0.
+    int threads_ = 0;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("gemm", CpuGemm);
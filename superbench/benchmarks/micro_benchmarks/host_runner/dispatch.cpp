@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Dispatch overhead plugin of the host runner.
+// An empty job is run on the first members of the team, back to back and with a pause that lets the members park, and
+// the round trip of every dispatch is the overhead a benchmark pays to fork and join its threads.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../host_utils/stats_utils.h"
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class Dispatch : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        return params->IntList("threads", &threads_, 1) && params->Int("iters", &iters_, 1) &&
+               params->Int("parked_iters", &parked_iters_, 0);
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        for (int num_threads : threads_) {
+            if (num_threads > ctx->team->Size()) {
+                continue;
+            }
+            std::vector<int> members(num_threads);
+            for (int m = 0; m < num_threads; m++) {
+                members[m] = m;
+            }
+            host_utils::ResultTags tags = {{"threads", std::to_string(num_threads)}};
+            std::string prefix = "t" + std::to_string(num_threads) + "_";
+            // Hot members are still spinning from the previous dispatch, parked ones sleep on the team
+            Measure(ctx, emitter, members, iters_, false, prefix + "hot_", tags);
+            Measure(ctx, emitter, members, parked_iters_, true, prefix + "parked_", tags);
+        }
+        return true;
+    }
+
+  private:
+    void Measure(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter, const std::vector<int> &members,
+                 int iters, bool parked, const std::string &prefix, const host_utils::ResultTags &tags) {
+        if (iters == 0) {
+            return;
+        }
+        std::vector<double> samples(iters);
+        auto noop = [](int, int) {};
+        for (int i = 0; i < iters; i++) {
+            if (parked) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            }
+            auto start = Clock::now();
+            ctx->team->Run(members, noop);
+            samples[i] = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        }
+        emitter->Samples(prefix + "latency", samples, "us", tags);
+        emitter->Metric(prefix + "latency_avg", host_utils::Mean(samples), "us", tags);
+        std::sort(samples.begin(), samples.end());
+        for (double percentile : {50.0, 99.0}) {
+            emitter->Metric(prefix + "latency_p" + host_utils::PercentileName(percentile),
+                            host_utils::Percentile(samples, percentile), "us", tags);
+        }
+    }
+
+    // Numbers of members to dispatch to.
+    std::vector<int> threads_ = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+
+    // Number of back to back dispatches.
+    int iters_ = 10000;
+
+    // Number of dispatches to parked members.
+    int parked_iters_ = 200;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("dispatch", Dispatch);
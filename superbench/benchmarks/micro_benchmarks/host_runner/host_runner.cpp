@@ -0,0 +1,511 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Single-process host benchmark runner.
+// The runner reads a plan, one benchmark per line as "<plugin> [key=value ...]", from --plan files and --run options,
+// configures every entry before running any, and then runs them in order in this process. The topology, the thread
+// team and the NUMA arena are set up once and shared, so that the entries do not pay for thread creation and page
+// faults again, and the results of every entry are emitted with its label as prefix.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <numa.h>
+#include <sched.h>
+
+#include "../host_utils/cpu_utils.h"
+#include "../host_utils/io_utils.h"
+#include "host_runner.h"
+
+using Clock = std::chrono::steady_clock;
+
+namespace host_runner {
+
+bool Params::Add(const std::string &token) {
+    size_t eq = token.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return false;
+    }
+    return values_.emplace(token.substr(0, eq), std::make_pair(token.substr(eq + 1), false)).second;
+}
+
+bool Params::Int(const std::string &key, int *value, int min) {
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+        return true;
+    }
+    it->second.second = true;
+    char extra = 0;
+    bool ok = 1 == sscanf(it->second.first.c_str(), "%d%c", value, &extra) && *value >= min;
+    if (!ok) {
+        std::cerr << "Invalid " << key << ": " << it->second.first << std::endl;
+    }
+    return ok;
+}
+
+bool Params::Size(const std::string &key, uint64_t *value) {
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+        return true;
+    }
+    it->second.second = true;
+    bool ok = host_utils::ParseSize(it->second.first.c_str(), value) && *value > 0;
+    if (!ok) {
+        std::cerr << "Invalid " << key << ": " << it->second.first << std::endl;
+    }
+    return ok;
+}
+
+bool Params::IntList(const std::string &key, std::vector<int> *values, int min) {
+    auto it = values_.find(key);
+    if (it == values_.end()) {
+        return true;
+    }
+    it->second.second = true;
+    bool ok = host_utils::ParseIntList(it->second.first.c_str(), values) &&
+              *std::min_element(values->begin(), values->end()) >= min;
+    if (!ok) {
+        std::cerr << "Invalid " << key << ": " << it->second.first << std::endl;
+    }
+    return ok;
+}
+
+bool Params::String(const std::string &key, std::string *value) {
+    auto it = values_.find(key);
+    if (it != values_.end()) {
+        it->second.second = true;
+        *value = it->second.first;
+    }
+    return true;
+}
+
+std::vector<std::string> Params::Unused() const {
+    std::vector<std::string> keys;
+    for (const auto &value : values_) {
+        if (!value.second.second) {
+            keys.push_back(value.first);
+        }
+    }
+    return keys;
+}
+
+bool Topology::Discover(const std::vector<int> &requested) {
+    cpus = requested;
+    if (cpus.empty()) {
+        cpu_set_t affinity;
+        CPU_ZERO(&affinity);
+        if (sched_getaffinity(0, sizeof(affinity), &affinity) != 0) {
+            std::cerr << "Failed to get the cpu affinity. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &affinity)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    if (cpus.empty()) {
+        std::cerr << "No cpu to run on." << std::endl;
+        return false;
+    }
+
+    bool numa = numa_available() >= 0;
+    for (int cpu : cpus) {
+        cpu_node[cpu] = numa ? std::max(numa_node_of_cpu(cpu), 0) : 0;
+    }
+    if (!numa) {
+        mem_nodes = {0};
+        return true;
+    }
+    // Nodes without memory, e.g. those reserved for GPUs, cannot hold buffers
+    for (int node = 0; node <= numa_max_node(); node++) {
+        if (numa_bitmask_isbitset(numa_all_nodes_ptr, node) && numa_node_size64(node, nullptr) > 0) {
+            mem_nodes.push_back(node);
+        }
+    }
+    return !mem_nodes.empty();
+}
+
+// Number of polls of a parked member before it sleeps.
+constexpr int kTeamSpins = 20000;
+
+ThreadTeam::ThreadTeam(const std::vector<int> &cpus)
+    : cpus_(cpus), member_generation_(new std::atomic<uint64_t>[cpus.size()]), member_index_(cpus.size(), -1) {
+    for (size_t m = 0; m < cpus_.size(); m++) {
+        member_generation_[m].store(0);
+    }
+    for (int m = 0; m < Size(); m++) {
+        threads_.emplace_back([this, m]() { Worker(m); });
+    }
+}
+
+ThreadTeam::~ThreadTeam() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_.fetch_add(1);
+    }
+    cv_.notify_all();
+    for (auto &thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadTeam::Run(const std::vector<int> &members, const std::function<void(int, int)> &job) {
+    if (members.empty()) {
+        return;
+    }
+    uint64_t generation = generation_.load() + 1;
+    job_ = &job;
+    job_size_ = static_cast<int>(members.size());
+    done_.store(0);
+    for (size_t i = 0; i < members.size(); i++) {
+        member_index_[members[i]] = static_cast<int>(i);
+        member_generation_[members[i]].store(generation);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_.store(generation);
+    }
+    cv_.notify_all();
+    for (int spin = 0; done_.load() != job_size_; spin = std::min(spin + 1, 1000)) {
+        if (spin == 1000) {
+            sched_yield();
+        }
+    }
+}
+
+void ThreadTeam::RunAll(const std::function<void(int, int)> &job) {
+    std::vector<int> members(Size());
+    for (int m = 0; m < Size(); m++) {
+        members[m] = m;
+    }
+    Run(members, job);
+}
+
+void ThreadTeam::Worker(int member) {
+    host_utils::PinThreadToCpu(cpus_[member]);
+    for (uint64_t seen = 0;;) {
+        for (int spin = 0; generation_.load() == seen && spin < kTeamSpins; spin++) {
+        }
+        if (generation_.load() == seen) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]() { return generation_.load() != seen; });
+        }
+        seen = generation_.load();
+        if (stop_.load()) {
+            return;
+        }
+        // A member skipped by a job may only see the generation of a later one
+        if (member_generation_[member].load() == seen) {
+            (*job_)(member_index_[member], job_size_);
+            done_.fetch_add(1);
+        }
+    }
+}
+
+NumaArena::NumaArena(const Topology *topology, ThreadTeam *team, host_utils::PageBacking backing)
+    : topology_(topology), team_(team), arena_([this, backing]() {
+          host_utils::ArenaOpts opts;
+          opts.backing = backing;
+          opts.prefault = [this](int node, char *buf, size_t size, size_t page) { Prefault(node, buf, size, page); };
+          return opts;
+      }()) {}
+
+char *NumaArena::Get(int node, int slot, uint64_t size) {
+    auto &buffer = buffers_[{node, slot}];
+    if (buffer.Size() >= size) {
+        return buffer.Data();
+    }
+    // Unmap the smaller buffer before mapping the larger one, no other slot could reuse it
+    buffer.Release();
+    arena_.Trim();
+    buffer = arena_.Acquire(numa_available() >= 0 ? node : -1, size);
+    if (!buffer) {
+        std::cerr << "Failed to allocate " << size << " bytes on NUMA node " << node << "." << std::endl;
+        return nullptr;
+    }
+    return buffer.Data();
+}
+
+void NumaArena::Prefault(int node, char *buf, size_t size, size_t page) {
+    // Fault the pages in with the members on the node, or with all members for a node without cpus
+    std::vector<int> members = topology_->MembersOnNode(node);
+    if (members.empty()) {
+        for (int m = 0; m < team_->Size(); m++) {
+            members.push_back(m);
+        }
+    }
+    uint64_t pages = size / page;
+    team_->Run(members, [&](int index, int count) {
+        for (uint64_t p = pages * index / count; p < pages * (index + 1) / count; p++) {
+            *static_cast<volatile char *>(buf + p * page) = 0;
+        }
+    });
+}
+
+std::vector<int> Topology::MembersOnNode(int node) const {
+    std::vector<int> members;
+    for (size_t m = 0; m < cpus.size(); m++) {
+        if (cpu_node.at(cpus[m]) == node) {
+            members.push_back(static_cast<int>(m));
+        }
+    }
+    return members;
+}
+
+} // namespace host_runner
+
+// One benchmark of the plan.
+struct PlanEntry {
+    // Name of the plugin.
+    std::string plugin;
+
+    // Label prefixing the metrics, the plugin name unless given with label=.
+    std::string label;
+
+    // The configured benchmark.
+    std::unique_ptr<host_runner::HostBenchmark> benchmark;
+};
+
+// Options accepted by this program.
+struct Opts {
+    // Plan files.
+    std::vector<std::string> plans;
+
+    // Plan lines given on the command line, run after those of the files.
+    std::vector<std::string> runs;
+
+    // Cpus of the thread team, all the cpus of the affinity if empty.
+    std::vector<int> cpus;
+
+    // Pages backing the shared buffers.
+    host_utils::PageBacking pages = host_utils::PageBacking::kDefault;
+
+    // Whether to list the plugins and exit.
+    bool list = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: host_runner "
+              << "[--plan <file>] "
+              << "[--run \"<plugin> [key=value ...]\"] "
+              << "[--cpus <list>] "
+              << "[--pages default|small|thp|hugetlb] "
+              << "[--list] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the host runner.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx { kPlan, kRun, kCpus, kPages, kList };
+    const struct option options[] = {
+        {"plan", required_argument, nullptr, static_cast<int>(OptIdx::kPlan)},
+        {"run", required_argument, nullptr, static_cast<int>(OptIdx::kRun)},
+        {"cpus", required_argument, nullptr, static_cast<int>(OptIdx::kCpus)},
+        {"pages", required_argument, nullptr, static_cast<int>(OptIdx::kPages)},
+        {"list", no_argument, nullptr, static_cast<int>(OptIdx::kList)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kPlan)) {
+            opts->plans.push_back(optarg);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kRun)) {
+            opts->runs.push_back(optarg);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kCpus)) {
+            try {
+                opts->cpus = host_utils::ParseCpuList(optarg);
+            } catch (const std::exception &e) {
+                parse_err = true;
+            }
+            parse_err = parse_err || opts->cpus.empty();
+        } else if (getopt_ret == static_cast<int>(OptIdx::kPages)) {
+            parse_err = !host_utils::ParsePageBacking(optarg, &opts->pages);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kList)) {
+            opts->list = true;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (!parse_err && !opts->list && opts->plans.empty() && opts->runs.empty()) {
+        std::cerr << "No plan given." << std::endl;
+        parse_err = true;
+    }
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse and configure a plan line, skipping blank lines and comments.
+ *
+ * @param line The line.
+ * @param where The location of the line for error messages.
+ * @param entries The entries to append to.
+ * @return true on success.
+ */
+bool AddPlanLine(const std::string &line, const std::string &where, std::vector<PlanEntry> *entries) {
+    std::istringstream tokens(line.substr(0, line.find('#')));
+    PlanEntry entry;
+    if (!(tokens >> entry.plugin)) {
+        return true;
+    }
+    auto factory = host_runner::Registry().find(entry.plugin);
+    if (factory == host_runner::Registry().end()) {
+        std::cerr << where << ": unknown plugin " << entry.plugin << "." << std::endl;
+        return false;
+    }
+    host_runner::Params params;
+    for (std::string token; tokens >> token;) {
+        if (!params.Add(token)) {
+            std::cerr << where << ": invalid or repeated option " << token << "." << std::endl;
+            return false;
+        }
+    }
+    entry.label = entry.plugin;
+    params.String("label", &entry.label);
+    for (const auto &other : *entries) {
+        if (other.label == entry.label) {
+            std::cerr << where << ": label " << entry.label << " is already used, set another with label=."
+                      << std::endl;
+            return false;
+        }
+    }
+    entry.benchmark = factory->second();
+    if (!entry.benchmark->Configure(&params)) {
+        std::cerr << where << ": invalid options of " << entry.plugin << "." << std::endl;
+        return false;
+    }
+    for (const auto &key : params.Unused()) {
+        std::cerr << where << ": unknown option " << key << " of " << entry.plugin << "." << std::endl;
+        return false;
+    }
+    entries->push_back(std::move(entry));
+    return true;
+}
+
+/**
+ * @brief Read the plan from the files and the command line.
+ *
+ * @param opts The runner options.
+ * @param entries The configured entries.
+ * @return true on success.
+ */
+bool ReadPlan(const Opts &opts, std::vector<PlanEntry> *entries) {
+    for (const auto &plan : opts.plans) {
+        std::ifstream in(plan);
+        if (!in) {
+            std::cerr << "Failed to open plan " << plan << "." << std::endl;
+            return false;
+        }
+        int line_no = 0;
+        for (std::string line; std::getline(in, line);) {
+            if (!AddPlanLine(line, plan + ":" + std::to_string(++line_no), entries)) {
+                return false;
+            }
+        }
+    }
+    for (const auto &run : opts.runs) {
+        if (!AddPlanLine(run, "--run", entries)) {
+            return false;
+        }
+    }
+    if (entries->empty()) {
+        std::cerr << "The plan is empty." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+    if (opts.list) {
+        for (const auto &plugin : host_runner::Registry()) {
+            std::cout << plugin.first << std::endl;
+        }
+        return 0;
+    }
+
+    std::vector<PlanEntry> entries;
+    if (!ReadPlan(opts, &entries)) {
+        return 1;
+    }
+
+    auto start = Clock::now();
+    host_runner::HostContext ctx;
+    if (!ctx.topology.Discover(opts.cpus)) {
+        return 1;
+    }
+    host_runner::ThreadTeam team(ctx.topology.cpus);
+    host_runner::NumaArena arena(&ctx.topology, &team, opts.pages);
+    ctx.team = &team;
+    ctx.arena = &arena;
+    // An empty job on every member so that all of them are up and pinned
+    team.RunAll([](int, int) {});
+
+    host_utils::ResultEmitter emitter(opts.result);
+    emitter.Metric("runner_setup_time", std::chrono::duration<double>(Clock::now() - start).count(), "s");
+    int failures = 0;
+    for (auto &entry : entries) {
+        host_runner::PluginEmitter plugin_emitter(&emitter, entry.label);
+        start = Clock::now();
+        bool ok = entry.benchmark->Run(&ctx, &plugin_emitter);
+        plugin_emitter.Metric("wall_time", std::chrono::duration<double>(Clock::now() - start).count(), "s");
+        plugin_emitter.Metric("return_code", ok ? 0 : 1);
+        if (!ok) {
+            std::cerr << "Benchmark " << entry.label << " failed." << std::endl;
+            failures++;
+        }
+        if (emitter.Stopped()) {
+            failures++;
+            break;
+        }
+    }
+    emitter.Metric("runner_arena_size", arena.Capacity() / 1e9, "GB");
+    return failures == 0 ? 0 : 1;
+}
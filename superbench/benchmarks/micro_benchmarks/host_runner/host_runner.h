@@ -0,0 +1,302 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Interfaces of the single-process host benchmark runner.
+// CPU benchmarks are plugins registered by name with REGISTER_HOST_BENCHMARK. The runner executes a plan of plugin
+// invocations in one process, sharing between them the topology discovered once, a team of pinned threads started
+// once, and NUMA-placed buffers that are pre-faulted once and only grow.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../host_utils/buffer_arena.h"
+#include "../host_utils/result_emitter.h"
+
+namespace host_runner {
+
+// Options of one plan entry, "key=value" tokens of its line.
+class Params {
+  public:
+    /**
+     * @brief Add a "key=value" token.
+     *
+     * @param token The token.
+     * @return true if the token is well-formed and the key is new.
+     */
+    bool Add(const std::string &token);
+
+    /**
+     * @brief Read an integer option, left unchanged if absent.
+     *
+     * @param key The key.
+     * @param value The value.
+     * @param min The lower bound.
+     * @return true if absent or valid.
+     */
+    bool Int(const std::string &key, int *value, int min);
+
+    /**
+     * @brief Read a size option such as "64M", left unchanged if absent.
+     *
+     * @param key The key.
+     * @param value The value in bytes.
+     * @return true if absent or a valid non-zero size.
+     */
+    bool Size(const std::string &key, uint64_t *value);
+
+    /**
+     * @brief Read a comma separated integer list option, left unchanged if absent.
+     *
+     * @param key The key.
+     * @param values The values.
+     * @param min The lower bound of every value.
+     * @return true if absent or valid.
+     */
+    bool IntList(const std::string &key, std::vector<int> *values, int min);
+
+    /**
+     * @brief Read a string option, left unchanged if absent.
+     *
+     * @param key The key.
+     * @param value The value.
+     * @return true.
+     */
+    bool String(const std::string &key, std::string *value);
+
+    /**
+     * @brief Get the keys that were given but never read.
+     *
+     * @return The unknown keys.
+     */
+    std::vector<std::string> Unused() const;
+
+  private:
+    // Values and whether they were read, by key.
+    std::map<std::string, std::pair<std::string, bool>> values_;
+};
+
+// Topology of the host, discovered once.
+struct Topology {
+    // Cpus the runner may use, from its affinity or --cpus.
+    std::vector<int> cpus;
+
+    // NUMA node of every usable cpu, by cpu.
+    std::map<int, int> cpu_node;
+
+    // NUMA nodes with memory.
+    std::vector<int> mem_nodes;
+
+    /**
+     * @brief Discover the topology with libnuma, as a single node 0 if NUMA is not available.
+     *
+     * @param cpus The cpus to use, all the cpus of the affinity if empty.
+     * @return true on success.
+     */
+    bool Discover(const std::vector<int> &cpus);
+
+    /**
+     * @brief Get the indices in cpus, which are also the thread team members, of the cpus on a NUMA node.
+     *
+     * @param node The node.
+     * @return The members, empty if the node has no usable cpu.
+     */
+    std::vector<int> MembersOnNode(int node) const;
+};
+
+// Team of threads pinned one per cpu, started once and parked between jobs.
+class ThreadTeam {
+  public:
+    /**
+     * @brief Start the threads.
+     *
+     * @param cpus The cpu of every member.
+     */
+    explicit ThreadTeam(const std::vector<int> &cpus);
+
+    ~ThreadTeam();
+
+    ThreadTeam(const ThreadTeam &) = delete;
+    ThreadTeam &operator=(const ThreadTeam &) = delete;
+
+    /**
+     * @brief Get the number of members.
+     */
+    int Size() const { return static_cast<int>(cpus_.size()); }
+
+    /**
+     * @brief Get the cpu of a member.
+     */
+    int Cpu(int member) const { return cpus_[member]; }
+
+    /**
+     * @brief Run a job on some members and wait for them.
+     *
+     * @param members The members, distinct.
+     * @param job The job, called with the index in members and the number of members.
+     */
+    void Run(const std::vector<int> &members, const std::function<void(int, int)> &job);
+
+    /**
+     * @brief Run a job on all members and wait for them.
+     *
+     * @param job The job, called with the member and the number of members.
+     */
+    void RunAll(const std::function<void(int, int)> &job);
+
+  private:
+    void Worker(int member);
+
+    std::vector<int> cpus_;
+    std::vector<std::thread> threads_;
+
+    // Generation of the last job of every member, and its index in the job.
+    std::unique_ptr<std::atomic<uint64_t>[]> member_generation_;
+    std::vector<int> member_index_;
+
+    const std::function<void(int, int)> *job_ = nullptr;
+    int job_size_ = 0;
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<int> done_{0};
+    std::atomic<bool> stop_{false};
+
+    // Parked members wait on the condition variable after a short spin.
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+// Buffers placed on NUMA nodes, pre-faulted by the team and reused across the plan, growing only.
+class NumaArena {
+  public:
+    /**
+     * @brief Create an empty arena.
+     *
+     * @param topology The topology.
+     * @param team The team to pre-fault with.
+     * @param backing The pages backing the buffers.
+     */
+    NumaArena(const Topology *topology, ThreadTeam *team,
+              host_utils::PageBacking backing = host_utils::PageBacking::kDefault);
+
+    NumaArena(const NumaArena &) = delete;
+    NumaArena &operator=(const NumaArena &) = delete;
+
+    /**
+     * @brief Get a pre-faulted buffer on a node, valid until the next call with the same node and slot.
+     *
+     * @param node The NUMA node.
+     * @param slot The slot on the node, so that a benchmark can hold several buffers on a node.
+     * @param size The size in bytes.
+     * @return The buffer, nullptr on failure.
+     */
+    char *Get(int node, int slot, uint64_t size);
+
+    /**
+     * @brief Get the total size of the buffers.
+     */
+    uint64_t Capacity() const { return arena_.Capacity(); }
+
+  private:
+    /**
+     * @brief Write every page of a new block once with the members on its node.
+     */
+    void Prefault(int node, char *buf, size_t size, size_t page);
+
+    const Topology *topology_;
+    ThreadTeam *team_;
+
+    // Declared first to outlive the buffers.
+    host_utils::BufferArena arena_;
+
+    // Buffers by node and slot.
+    std::map<std::pair<int, int>, host_utils::ArenaBuffer> buffers_;
+};
+
+// Resources shared by all the benchmarks of a plan.
+struct HostContext {
+    Topology topology;
+    ThreadTeam *team = nullptr;
+    NumaArena *arena = nullptr;
+};
+
+// Emitter of the results of one benchmark, prefixing the metric names with its label.
+class PluginEmitter {
+  public:
+    PluginEmitter(host_utils::ResultEmitter *emitter, const std::string &label) : emitter_(emitter), label_(label) {}
+
+    void Metric(const std::string &name, double value, const std::string &unit = "",
+                host_utils::ResultTags tags = {}) {
+        tags.insert(tags.begin(), {"benchmark", label_});
+        emitter_->Metric(label_ + "_" + name, value, unit, tags);
+    }
+
+    void Samples(const std::string &name, const std::vector<double> &samples, const std::string &unit = "",
+                 host_utils::ResultTags tags = {}) {
+        tags.insert(tags.begin(), {"benchmark", label_});
+        emitter_->Samples(label_ + "_" + name, samples, unit, tags);
+    }
+
+    bool Observe(const std::string &name, double value) { return emitter_->Observe(label_ + "_" + name, value); }
+
+    bool Stopped() const { return emitter_->Stopped(); }
+
+  private:
+    host_utils::ResultEmitter *emitter_;
+    std::string label_;
+};
+
+// A benchmark plugin.
+class HostBenchmark {
+  public:
+    virtual ~HostBenchmark() = default;
+
+    /**
+     * @brief Read the options of a plan entry, before any benchmark of the plan runs.
+     *
+     * @param params The options.
+     * @return true if they are valid.
+     */
+    virtual bool Configure(Params *params) = 0;
+
+    /**
+     * @brief Run the benchmark and emit its metrics.
+     *
+     * @param ctx The shared resources.
+     * @param emitter The emitter of the benchmark.
+     * @return true on success.
+     */
+    virtual bool Run(HostContext *ctx, PluginEmitter *emitter) = 0;
+};
+
+using HostBenchmarkFactory = std::function<std::unique_ptr<HostBenchmark>()>;
+
+/**
+ * @brief Get the registered plugins.
+ *
+ * @return The factories of the plugins, by name.
+ */
+inline std::map<std::string, HostBenchmarkFactory> &Registry() {
+    static std::map<std::string, HostBenchmarkFactory> registry;
+    return registry;
+}
+
+// Registration of a plugin by a static object.
+struct Registrar {
+    Registrar(const std::string &name, HostBenchmarkFactory factory) { Registry()[name] = std::move(factory); }
+};
+
+#define REGISTER_HOST_BENCHMARK(name, cls)                                                                            \
+    static host_runner::Registrar cls##_registrar(                                                                     \
+        name, []() { return std::unique_ptr<host_runner::HostBenchmark>(new cls()); })
+
+} // namespace host_runner
@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Host STREAM plugin of the host runner.
+// The copy, scale, add and triad kernels of STREAM run on the team members, every member working on a slice of
+// arrays placed on its own NUMA node, and the best bandwidth over the iterations is reported as STREAM does.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Kernels compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+SIMD_CLONES void Copy(double *c, const double *a, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        c[i] = a[i];
+    }
+}
+
+SIMD_CLONES void Scale(double *b, const double *c, double scalar, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        b[i] = scalar * c[i];
+    }
+}
+
+SIMD_CLONES void Add(double *c, const double *a, const double *b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        c[i] = a[i] + b[i];
+    }
+}
+
+SIMD_CLONES void Triad(double *a, const double *b, const double *c, double scalar, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        a[i] = b[i] + scalar * c[i];
+    }
+}
+
+class HostStream : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        return params->Size("size", &size_) && params->Int("iters", &iters_, 1) &&
+               params->Int("threads", &threads_, 0);
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        int num_threads = threads_ == 0 ? ctx->team->Size() : std::min(threads_, ctx->team->Size());
+        std::vector<int> members(num_threads);
+        for (int m = 0; m < num_threads; m++) {
+            members[m] = m;
+        }
+
+        // Every node holds the slices of its members, each array being size bytes in total
+        size_t elems = size_ / sizeof(double) / num_threads;
+        std::map<int, std::vector<int>> node_members;
+        for (int m : members) {
+            node_members[ctx->topology.cpu_node.at(ctx->topology.cpus[m])].push_back(m);
+        }
+        std::vector<double *> arrays[3];
+        for (auto &array : arrays) {
+            array.resize(num_threads);
+        }
+        for (const auto &node : node_members) {
+            for (int a = 0; a < 3; a++) {
+                char *buf = ctx->arena->Get(node.first, a, node.second.size() * elems * sizeof(double));
+                if (buf == nullptr) {
+                    return false;
+                }
+                for (size_t i = 0; i < node.second.size(); i++) {
+                    arrays[a][node.second[i]] = reinterpret_cast<double *>(buf) + i * elems;
+                }
+            }
+        }
+        ctx->team->Run(members, [&](int index, int) {
+            std::fill(arrays[0][index], arrays[0][index] + elems, 1.0);
+            std::fill(arrays[1][index], arrays[1][index] + elems, 2.0);
+            std::fill(arrays[2][index], arrays[2][index] + elems, 0.0);
+        });
+
+        const double scalar = 3.0;
+        const std::vector<std::pair<std::string, std::function<void(int)>>> kernels = {
+            {"copy", [&](int t) { Copy(arrays[2][t], arrays[0][t], elems); }},
+            {"scale", [&](int t) { Scale(arrays[1][t], arrays[2][t], scalar, elems); }},
+            {"add", [&](int t) { Add(arrays[2][t], arrays[0][t], arrays[1][t], elems); }},
+            {"triad", [&](int t) { Triad(arrays[0][t], arrays[1][t], arrays[2][t], scalar, elems); }}};
+        // Bytes moved per element, counted as STREAM does
+        const std::map<std::string, int> arrays_moved = {{"copy", 2}, {"scale", 2}, {"add", 3}, {"triad", 3}};
+        std::map<std::string, double> best;
+        for (int i = 0; i < iters_; i++) {
+            for (const auto &kernel : kernels) {
+                auto start = Clock::now();
+                ctx->team->Run(members, [&](int index, int) { kernel.second(index); });
+                double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                if (best.count(kernel.first) == 0 || seconds < best[kernel.first]) {
+                    best[kernel.first] = seconds;
+                }
+            }
+        }
+
+        host_utils::ResultTags tags = {{"threads", std::to_string(num_threads)}};
+        for (const auto &kernel : kernels) {
+            double bytes = static_cast<double>(arrays_moved.at(kernel.first)) * sizeof(double) * elems * num_threads;
+            emitter->Metric(kernel.first + "_bw", bytes / best[kernel.first] / 1e9, "GB/s", tags);
+        }
+        return true;
+    }
+
+  private:
+    // Size of each array in bytes.
+    uint64_t size_ = 256ULL << 20;
+
+    // Number of iterations, the best of which is reported.
+    int iters_ = 10;
+
+    // Number of team members to run on, all if 0.
+    int threads_ = 0;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("stream", HostStream);
@@ -0,0 +1,332 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Memory locking plugin of the host runner, the host side of pinning buffers for devices and RDMA.
+// cudaHostRegister, cudaMallocHost and ibv_reg_mr spend their time in the kernel faulting and pinning the pages, which
+// is measured here without a device: on every NUMA node with cpus and memory, a buffer bound to the node is locked by
+// the members on the node with mlock on fresh pages, mlock on pages faulted before, mlock2(MLOCK_ONFAULT) followed by
+// the first touch, and madvise(MADV_POPULATE_WRITE), with small, transparent huge or hugetlbfs pages and growing
+// thread counts. The cost of fork() with the buffer mapped, locked, and locked but excluded with MADV_DONTFORK as the
+// RDMA libraries do, is measured too.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <numa.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../host_utils/buffer_arena.h"
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Ways to make the pages of a buffer resident, and locked for all but madv_populate.
+const char *const kMethods[] = {"mlock", "mlock_populated", "mlock_onfault", "madv_populate"};
+
+class MemLock : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        std::string pages;
+        std::string methods;
+        bool ok = params->Size("size", &size_) && params->Int("iters", &iters_, 1) &&
+                  params->IntList("threads", &threads_, 1) && params->Int("forks", &forks_, 0) &&
+                  params->String("pages", &pages) && params->String("methods", &methods);
+        if (!ok) {
+            return false;
+        }
+        // Whole huge pages, so that every backing locks the same bytes
+        size_ = (size_ + host_utils::kHugePageSize - 1) / host_utils::kHugePageSize * host_utils::kHugePageSize;
+        if (!pages.empty()) {
+            pages_ = Split(pages);
+        }
+        if (!methods.empty()) {
+            methods_ = Split(methods);
+        }
+        for (const auto &name : pages_) {
+            host_utils::PageBacking backing;
+            if (!host_utils::ParsePageBacking(name, &backing) || backing == host_utils::PageBacking::kDefault) {
+                std::cerr << "Invalid pages: " << name << ", use small, thp or hugetlb." << std::endl;
+                return false;
+            }
+        }
+        for (const auto &name : methods_) {
+            if (std::find_if(std::begin(kMethods), std::end(kMethods),
+                             [&](const char *method) { return name == method; }) == std::end(kMethods)) {
+                std::cerr << "Invalid methods: " << name << "." << std::endl;
+                return false;
+            }
+        }
+        return !pages_.empty() && !methods_.empty();
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        for (const auto &pages : pages_) {
+            host_utils::PageBacking backing = host_utils::PageBacking::kSmall;
+            host_utils::ParsePageBacking(pages, &backing);
+            if (backing == host_utils::PageBacking::kHugetlbfs) {
+                // Skip hugetlbfs pages at once if too few are reserved
+                char *probe = Map(ctx->topology.mem_nodes.front(), backing);
+                if (probe == nullptr) {
+                    continue;
+                }
+                munmap(probe, size_);
+            }
+            for (int node : ctx->topology.mem_nodes) {
+                std::vector<int> on_node = ctx->topology.MembersOnNode(node);
+                if (on_node.empty()) {
+                    continue;
+                }
+                for (int num_threads : threads_) {
+                    if (num_threads > static_cast<int>(on_node.size())) {
+                        continue;
+                    }
+                    std::vector<int> members(on_node.begin(), on_node.begin() + num_threads);
+                    for (const auto &method : methods_) {
+                        if (!Measure(ctx, emitter, node, backing, pages, members, method)) {
+                            return false;
+                        }
+                        if (emitter->Stopped()) {
+                            return true;
+                        }
+                    }
+                }
+            }
+            if (forks_ > 0 && !MeasureFork(emitter, ctx->topology.mem_nodes.front(), backing, pages)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    /**
+     * @brief Split a comma separated list.
+     */
+    static std::vector<std::string> Split(const std::string &list) {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        for (std::string item; std::getline(ss, item, ',');) {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    /**
+     * @brief Get the page size of a backing.
+     */
+    static size_t PageSize(host_utils::PageBacking backing) {
+        return backing == host_utils::PageBacking::kSmall ? static_cast<size_t>(sysconf(_SC_PAGESIZE))
+                                                          : host_utils::kHugePageSize;
+    }
+
+    /**
+     * @brief Map a buffer of size_ bytes bound to a node, not faulted yet.
+     *
+     * @param node The NUMA node.
+     * @param backing The pages.
+     * @return The buffer, nullptr on failure, e.g. when hugetlbfs has too few pages, which is not an error.
+     */
+    char *Map(int node, host_utils::PageBacking backing) {
+        size_t page = PageSize(backing);
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | (backing == host_utils::PageBacking::kHugetlbfs ? MAP_HUGETLB : 0);
+        // Huge pages are only used by the kernel for aligned ranges, hugetlbfs mappings are aligned already
+        size_t length = size_ + (backing == host_utils::PageBacking::kTransparentHuge ? page : 0);
+        void *mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map " << size_ << " bytes. ERROR: " << strerror(errno)
+                      << (backing == host_utils::PageBacking::kHugetlbfs ? ", hugetlb skipped." : "") << std::endl;
+            return nullptr;
+        }
+        char *begin = static_cast<char *>(mapping);
+        char *data = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(begin) + page - 1) / page * page);
+        if (data > begin) {
+            munmap(begin, data - begin);
+        }
+        if (begin + length > data + size_) {
+            munmap(data + size_, begin + length - (data + size_));
+        }
+        madvise(data, size_, backing == host_utils::PageBacking::kSmall ? MADV_NOHUGEPAGE : MADV_HUGEPAGE);
+        if (numa_available() >= 0) {
+            numa_tonode_memory(data, size_, node);
+        }
+        return data;
+    }
+
+    /**
+     * @brief Measure one method on one node and thread count.
+     *
+     * @param ctx The shared resources.
+     * @param emitter The emitter.
+     * @param node The NUMA node of the buffer and the threads.
+     * @param backing The pages.
+     * @param pages The name of the pages.
+     * @param members The members locking the buffer, one slice each.
+     * @param method The method.
+     * @return true on success.
+     */
+    bool Measure(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter, int node,
+                 host_utils::PageBacking backing, const std::string &pages, const std::vector<int> &members,
+                 const std::string &method) {
+        size_t page = PageSize(backing);
+        size_t num_pages = size_ / page;
+        std::vector<int> errors(members.size(), 0);
+        double lock_seconds = 0, unlock_seconds = 0;
+        bool locked = method != "madv_populate";
+        for (int i = 0; i < iters_; i++) {
+            char *data = Map(node, backing);
+            if (data == nullptr) {
+                return backing == host_utils::PageBacking::kHugetlbfs;
+            }
+            auto slice = [&](int index, int count, size_t *length) {
+                size_t first = num_pages * index / count;
+                *length = (num_pages * (index + 1) / count - first) * page;
+                return data + first * page;
+            };
+            if (method == "mlock_populated") {
+                ctx->team->Run(members, [&](int index, int count) {
+                    size_t length = 0;
+                    char *begin = slice(index, count, &length);
+                    for (size_t offset = 0; offset < length; offset += page) {
+                        begin[offset] = 0;
+                    }
+                });
+            }
+
+            auto start = Clock::now();
+            ctx->team->Run(members, [&](int index, int count) {
+                size_t length = 0;
+                char *begin = slice(index, count, &length);
+                int ret = 0;
+                if (method == "mlock" || method == "mlock_populated") {
+                    ret = mlock(begin, length);
+                } else if (method == "mlock_onfault") {
+                    ret = mlock2(begin, length, MLOCK_ONFAULT);
+                    for (size_t offset = 0; ret == 0 && offset < length; offset += page) {
+                        begin[offset] = 0;
+                    }
+                } else {
+                    ret = madvise(begin, length, MADV_POPULATE_WRITE);
+                }
+                errors[index] = ret == 0 ? 0 : errno;
+            });
+            lock_seconds += std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (locked) {
+                start = Clock::now();
+                ctx->team->Run(members, [&](int index, int count) {
+                    size_t length = 0;
+                    char *begin = slice(index, count, &length);
+                    munlock(begin, length);
+                });
+                unlock_seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            }
+            munmap(data, size_);
+
+            int error = *std::max_element(errors.begin(), errors.end());
+            if (error == EINVAL && method == "madv_populate") {
+                std::cerr << "MADV_POPULATE_WRITE is not supported by the kernel, skipped." << std::endl;
+                return true;
+            }
+            if (error != 0) {
+                std::cerr << method << " of " << size_ << " bytes failed. ERROR: " << strerror(error)
+                          << (error == ENOMEM || error == EPERM ? ", raise the locked memory limit (ulimit -l)." : "")
+                          << std::endl;
+                return false;
+            }
+        }
+
+        std::string name = "numa_" + std::to_string(node) + "_" + pages + "_t" + std::to_string(members.size()) + "_";
+        host_utils::ResultTags tags = {{"node", std::to_string(node)},
+                                       {"pages", pages},
+                                       {"threads", std::to_string(members.size())},
+                                       {"method", method}};
+        emitter->Metric(name + method + "_bw", size_ * iters_ / lock_seconds / 1e9, "GB/s", tags);
+        if (locked) {
+            emitter->Metric(name + method + "_unlock_bw", size_ * iters_ / unlock_seconds / 1e9, "GB/s", tags);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Measure fork() with a faulted buffer mapped, locked, and locked with MADV_DONTFORK.
+     *
+     * @param emitter The emitter.
+     * @param node The NUMA node of the buffer.
+     * @param backing The pages.
+     * @param pages The name of the pages.
+     * @return true on success.
+     */
+    bool MeasureFork(host_runner::PluginEmitter *emitter, int node, host_utils::PageBacking backing,
+                     const std::string &pages) {
+        char *data = Map(node, backing);
+        if (data == nullptr) {
+            return backing == host_utils::PageBacking::kHugetlbfs;
+        }
+        size_t page = PageSize(backing);
+        for (size_t offset = 0; offset < size_; offset += page) {
+            data[offset] = 0;
+        }
+        for (const char *variant : {"mapped", "locked", "dontfork"}) {
+            if (strcmp(variant, "locked") == 0 && mlock(data, size_) != 0) {
+                std::cerr << "mlock of " << size_ << " bytes failed. ERROR: " << strerror(errno) << std::endl;
+                munmap(data, size_);
+                return false;
+            }
+            if (strcmp(variant, "dontfork") == 0) {
+                madvise(data, size_, MADV_DONTFORK);
+            }
+            double seconds = 0;
+            for (int i = 0; i < forks_; i++) {
+                // The time until fork() returns in the parent, spent copying the page tables of the parent
+                auto start = Clock::now();
+                pid_t pid = fork();
+                if (pid == 0) {
+                    _exit(0);
+                }
+                seconds += std::chrono::duration<double>(Clock::now() - start).count();
+                if (pid < 0) {
+                    std::cerr << "Failed to fork. ERROR: " << strerror(errno) << std::endl;
+                    munmap(data, size_);
+                    return false;
+                }
+                waitpid(pid, nullptr, 0);
+            }
+            host_utils::ResultTags tags = {{"pages", pages}, {"variant", variant}};
+            emitter->Metric(pages + "_fork_" + variant + "_time", seconds * 1e3 / forks_, "ms", tags);
+        }
+        munmap(data, size_);
+        return true;
+    }
+
+    // Size of the buffer in bytes.
+    uint64_t size_ = 1ULL << 30;
+
+    // Number of timed lockings per method.
+    int iters_ = 3;
+
+    // Numbers of threads locking slices of the buffer, all on its node.
+    std::vector<int> threads_ = {1, 4};
+
+    // Number of timed forks per variant, 0 to skip them.
+    int forks_ = 5;
+
+    // Pages backing the buffer.
+    std::vector<std::string> pages_ = {"small", "thp"};
+
+    // Methods to measure.
+    std::vector<std::string> methods_ = {std::begin(kMethods), std::end(kMethods)};
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("mem_lock", MemLock);
@@ -0,0 +1,575 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Memory integrity plugin of the host runner, a memtester-class stress of most of the free memory of every node.
+// Every NUMA node with memory gets a buffer bound to it of a share of its free memory, split between the members on
+// the node, or between all members for a node without cpus, so that all the nodes are written and read back at once at
+// full bandwidth. The patterns are walking ones and zeros, moving inversions, address in address and reproducible
+// random words, repeated in passes until the duration is over. Words are compared a block at a time with vectorized
+// kernels, and only a block that differs is scanned for the failing words, which are reported with the node their page
+// actually lives on and, when readable from /proc/self/pagemap, their physical address.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <numa.h>
+#include <numaif.h>
+#include <unistd.h>
+
+#include "../host_utils/buffer_arena.h"
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Kernels compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+// Patterns, in the order they run in a pass.
+const char *const kPatterns[] = {"walking_ones", "walking_zeros", "moving_inversions", "address", "random"};
+
+// Words per block, the unit of the compares and of the scans for failing words.
+constexpr size_t kBlockWords = 4096;
+
+// Failing words printed per run, the others are only counted.
+constexpr int kMaxReports = 32;
+
+// Values of the words of a sweep.
+enum class Kind { kWalk, kConst, kAddress, kRandom };
+
+// Operations of a sweep over the buffers.
+enum class Op { kFill, kCheck, kCheckInvert };
+
+// One sweep of a pattern over all the buffers.
+struct Sweep {
+    Op op;
+    Kind kind;
+
+    // Bit of the walk, constant or seed, by kind.
+    uint64_t param;
+
+    // Mask xor-ed into the values, all ones for the inverted sweeps.
+    uint64_t mask;
+
+    // Whether the blocks are visited from the last to the first.
+    bool descending;
+};
+
+inline uint64_t SplitMix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Get the value of a word.
+ *
+ * @param word The word, for the address pattern.
+ * @param index The index of the word in the buffer of its node, for the other patterns.
+ */
+template <Kind K> inline uint64_t Value(const uint64_t *word, uint64_t index, uint64_t param, uint64_t mask) {
+    switch (K) {
+    case Kind::kWalk:
+        return (1ULL << ((index + param) & 63)) ^ mask;
+    case Kind::kConst:
+        return param ^ mask;
+    case Kind::kAddress:
+        return reinterpret_cast<uintptr_t>(word) ^ mask;
+    default:
+        return SplitMix(param + index) ^ mask;
+    }
+}
+
+// The walks repeat every 64 words, which are looked up rather than shifted so that the loops vectorize.
+inline void WalkWords(uint64_t *walk, uint64_t index, uint64_t param, uint64_t mask) {
+    for (uint64_t k = 0; k < 64; k++) {
+        walk[k] = Value<Kind::kWalk>(nullptr, index + k, param, mask);
+    }
+}
+
+template <Kind K> inline void FillWords(uint64_t *words, size_t n, uint64_t index, uint64_t param, uint64_t mask) {
+    if constexpr (K == Kind::kWalk) {
+        uint64_t walk[64];
+        WalkWords(walk, index, param, mask);
+        for (size_t i = 0; i < n; i += 64) {
+            for (size_t k = 0; k < 64; k++) {
+                words[i + k] = walk[k];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            words[i] = Value<K>(words + i, index + i, param, mask);
+        }
+    }
+}
+
+template <Kind K>
+inline uint64_t DiffWords(const uint64_t *words, size_t n, uint64_t index, uint64_t param, uint64_t mask) {
+    uint64_t diff = 0;
+    if constexpr (K == Kind::kWalk) {
+        uint64_t walk[64];
+        WalkWords(walk, index, param, mask);
+        for (size_t i = 0; i < n; i += 64) {
+            for (size_t k = 0; k < 64; k++) {
+                diff |= words[i + k] ^ walk[k];
+            }
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            diff |= words[i] ^ Value<K>(words + i, index + i, param, mask);
+        }
+    }
+    return diff;
+}
+
+SIMD_CLONES void Fill(Kind kind, uint64_t *words, size_t n, uint64_t index, uint64_t param, uint64_t mask) {
+    switch (kind) {
+    case Kind::kWalk:
+        return FillWords<Kind::kWalk>(words, n, index, param, mask);
+    case Kind::kConst:
+        return FillWords<Kind::kConst>(words, n, index, param, mask);
+    case Kind::kAddress:
+        return FillWords<Kind::kAddress>(words, n, index, param, mask);
+    default:
+        return FillWords<Kind::kRandom>(words, n, index, param, mask);
+    }
+}
+
+/**
+ * @brief Compare words with their values.
+ *
+ * @return The bits that differ in any word, 0 if all words are intact.
+ */
+SIMD_CLONES uint64_t Diff(Kind kind, const uint64_t *words, size_t n, uint64_t index, uint64_t param, uint64_t mask) {
+    switch (kind) {
+    case Kind::kWalk:
+        return DiffWords<Kind::kWalk>(words, n, index, param, mask);
+    case Kind::kConst:
+        return DiffWords<Kind::kConst>(words, n, index, param, mask);
+    case Kind::kAddress:
+        return DiffWords<Kind::kAddress>(words, n, index, param, mask);
+    default:
+        return DiffWords<Kind::kRandom>(words, n, index, param, mask);
+    }
+}
+
+/**
+ * @brief Get the value of a word for the scans of the failing words.
+ */
+uint64_t Expected(Kind kind, const uint64_t *word, uint64_t index, uint64_t param, uint64_t mask) {
+    switch (kind) {
+    case Kind::kWalk:
+        return Value<Kind::kWalk>(word, index, param, mask);
+    case Kind::kConst:
+        return Value<Kind::kConst>(word, index, param, mask);
+    case Kind::kAddress:
+        return Value<Kind::kAddress>(word, index, param, mask);
+    default:
+        return Value<Kind::kRandom>(word, index, param, mask);
+    }
+}
+
+// A failing word.
+struct Failure {
+    const uint64_t *word;
+    uint64_t expected;
+    uint64_t actual;
+    int node;
+};
+
+// Words of a node buffer checked by one member.
+struct Task {
+    // Index of the node in the buffers.
+    size_t buffer;
+    uint64_t begin;
+    uint64_t end;
+};
+
+class MemTest : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        std::string patterns;
+        bool ok = params->Int("percent", &percent_, 1) && params->Size("size", &size_) &&
+                  params->Int("seconds", &seconds_, 0) && params->String("patterns", &patterns) &&
+                  params->Int("seed", &seed_, 0) && params->Int("inject", &inject_, 0);
+        if (!ok) {
+            return false;
+        }
+        if (percent_ > 95) {
+            std::cerr << "Invalid percent: " << percent_ << ", at most 95 percent of the free memory is tested."
+                      << std::endl;
+            return false;
+        }
+        if (!patterns.empty()) {
+            patterns_.clear();
+            std::stringstream ss(patterns);
+            for (std::string pattern; std::getline(ss, pattern, ',');) {
+                if (std::find_if(std::begin(kPatterns), std::end(kPatterns),
+                                 [&](const char *name) { return pattern == name; }) == std::end(kPatterns)) {
+                    std::cerr << "Invalid patterns: " << pattern << "." << std::endl;
+                    return false;
+                }
+                patterns_.push_back(pattern);
+            }
+        }
+        return !patterns_.empty();
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        // The buffers are not taken from the shared arena, which would keep most of the memory for the rest of the plan
+        host_utils::ArenaOpts opts;
+        opts.prefault = [ctx](int node, char *buf, size_t size, size_t page) { Prefault(ctx, node, buf, size, page); };
+        host_utils::BufferArena arena(opts);
+        bool ok = Allocate(ctx, &arena) && Test(ctx, emitter);
+        buffers_.clear();
+        return ok;
+    }
+
+  private:
+    /**
+     * @brief Run the passes over the buffers and emit the bandwidth and the failing words.
+     */
+    bool Test(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) {
+        Split(ctx);
+
+        // Bytes moved by every pattern over all nodes, and the time of its sweeps
+        std::map<std::string, double> pattern_bytes, pattern_seconds;
+        std::map<std::string, uint64_t> pattern_errors;
+        std::vector<uint64_t> node_errors(buffers_.size(), 0);
+        double total_seconds = 0;
+        int passes = 0;
+        auto deadline = Clock::now() + std::chrono::seconds(seconds_);
+        bool over = false;
+        while (!over && !emitter->Stopped()) {
+            for (const auto &pattern : patterns_) {
+                for (const auto &sweep : Sweeps(pattern, passes)) {
+                    auto start = Clock::now();
+                    std::vector<uint64_t> errors = RunSweep(ctx, sweep, pattern, passes);
+                    if (sweep.op == Op::kFill) {
+                        Inject();
+                    }
+                    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                    pattern_seconds[pattern] += seconds;
+                    total_seconds += seconds;
+                    for (size_t b = 0; b < buffers_.size(); b++) {
+                        double bytes = static_cast<double>(buffers_[b].Size()) * (sweep.op == Op::kCheckInvert ? 2 : 1);
+                        pattern_bytes[pattern] += bytes;
+                        node_bytes_[b] += bytes;
+                        pattern_errors[pattern] += errors[b];
+                        node_errors[b] += errors[b];
+                    }
+                }
+                // Patterns after the first pass are only started before the deadline
+                if (passes > 0 && Clock::now() >= deadline) {
+                    over = true;
+                    break;
+                }
+            }
+            passes++;
+            over = over || Clock::now() >= deadline;
+        }
+
+        uint64_t total_errors = 0;
+        for (size_t b = 0; b < buffers_.size(); b++) {
+            std::string name = "numa_" + std::to_string(nodes_[b]);
+            host_utils::ResultTags tags = {{"numa", std::to_string(nodes_[b])}};
+            emitter->Metric(name + "_size", buffers_[b].Size() / 1e9, "GB", tags);
+            emitter->Metric(name + "_bw", node_bytes_[b] / total_seconds / 1e9, "GB/s", tags);
+            emitter->Metric(name + "_errors", node_errors[b], "", tags);
+            total_errors += node_errors[b];
+        }
+        for (const auto &pattern : patterns_) {
+            if (pattern_seconds.count(pattern) == 0) {
+                continue;
+            }
+            host_utils::ResultTags tags = {{"pattern", pattern}};
+            if (pattern == "random") {
+                tags.push_back({"seed", std::to_string(seed_)});
+            }
+            emitter->Metric(pattern + "_bw", pattern_bytes[pattern] / pattern_seconds[pattern] / 1e9, "GB/s", tags);
+            emitter->Metric(pattern + "_errors", pattern_errors[pattern], "", tags);
+        }
+        emitter->Metric("passes", passes);
+        emitter->Metric("errors", total_errors);
+        if (total_errors > 0) {
+            std::cerr << "Memory test found " << total_errors << " failing words." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Flip a bit of the injected number of words spread over the first buffer, to test the detection.
+     */
+    void Inject() {
+        uint64_t *words = buffers_[0].As<uint64_t>();
+        uint64_t count = buffers_[0].Size() / sizeof(uint64_t);
+        for (int i = 0; i < inject_; i++) {
+            words[count * i / inject_] ^= 1ULL << (i % 64);
+        }
+    }
+
+    /**
+     * @brief Write every page of a new buffer once with the members on its node, or with all members.
+     */
+    static void Prefault(host_runner::HostContext *ctx, int node, char *buf, size_t size, size_t page) {
+        std::vector<int> members = Members(ctx, node);
+        uint64_t pages = size / page;
+        ctx->team->Run(members, [&](int index, int count) {
+            for (uint64_t p = pages * index / count; p < pages * (index + 1) / count; p++) {
+                *static_cast<volatile char *>(buf + p * page) = 0;
+            }
+        });
+    }
+
+    /**
+     * @brief Get the members working on a node, those on the node or all members for a node without cpus.
+     */
+    static std::vector<int> Members(host_runner::HostContext *ctx, int node) {
+        std::vector<int> members = ctx->topology.MembersOnNode(node);
+        if (members.empty()) {
+            for (int m = 0; m < ctx->team->Size(); m++) {
+                members.push_back(m);
+            }
+        }
+        return members;
+    }
+
+    /**
+     * @brief Get a buffer of the tested share of the free memory on every node.
+     */
+    bool Allocate(host_runner::HostContext *ctx, host_utils::BufferArena *arena) {
+        buffers_.clear();
+        nodes_.clear();
+        for (int node : ctx->topology.mem_nodes) {
+            uint64_t size = size_;
+            if (size == 0) {
+                long long free_bytes = 0;
+                if (numa_available() >= 0) {
+                    numa_node_size64(node, &free_bytes);
+                } else {
+                    free_bytes = static_cast<long long>(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+                }
+                size = static_cast<uint64_t>(free_bytes) / 100 * percent_;
+            }
+            // Whole blocks, so that the members split the buffer on block boundaries
+            size = size / (kBlockWords * sizeof(uint64_t)) * (kBlockWords * sizeof(uint64_t));
+            if (size == 0) {
+                continue;
+            }
+            host_utils::ArenaBuffer buffer = arena->Acquire(numa_available() >= 0 ? node : -1, size);
+            if (!buffer) {
+                std::cerr << "Failed to allocate " << size << " bytes on NUMA node " << node << "." << std::endl;
+                return false;
+            }
+            buffers_.push_back(std::move(buffer));
+            nodes_.push_back(node);
+        }
+        node_bytes_.assign(buffers_.size(), 0);
+        return !buffers_.empty();
+    }
+
+    /**
+     * @brief Split the blocks of every buffer between the members working on its node.
+     */
+    void Split(host_runner::HostContext *ctx) {
+        tasks_.assign(ctx->team->Size(), {});
+        for (size_t b = 0; b < buffers_.size(); b++) {
+            std::vector<int> members = Members(ctx, nodes_[b]);
+            uint64_t blocks = buffers_[b].Size() / sizeof(uint64_t) / kBlockWords;
+            for (size_t i = 0; i < members.size(); i++) {
+                uint64_t begin = blocks * i / members.size() * kBlockWords;
+                uint64_t end = blocks * (i + 1) / members.size() * kBlockWords;
+                if (end > begin) {
+                    tasks_[members[i]].push_back({b, begin, end});
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Get the sweeps of a pattern in a pass.
+     */
+    std::vector<Sweep> Sweeps(const std::string &pattern, int pass) const {
+        const uint64_t kOnes = ~0ULL;
+        if (pattern == "walking_ones" || pattern == "walking_zeros") {
+            // Every word holds a single set or cleared bit, which moves along the words and between the passes
+            uint64_t mask = pattern == "walking_ones" ? 0 : kOnes;
+            return {{Op::kFill, Kind::kWalk, static_cast<uint64_t>(pass), mask, false},
+                    {Op::kCheck, Kind::kWalk, static_cast<uint64_t>(pass), mask, false}};
+        }
+        if (pattern == "moving_inversions") {
+            // A byte pattern with a bit moving between the passes, inverted upwards and then back downwards
+            uint64_t value = 0x0101010101010101ULL << (pass % 8);
+            return {{Op::kFill, Kind::kConst, value, 0, false},
+                    {Op::kCheckInvert, Kind::kConst, value, 0, false},
+                    {Op::kCheckInvert, Kind::kConst, value, kOnes, true},
+                    {Op::kCheck, Kind::kConst, value, 0, false}};
+        }
+        if (pattern == "address") {
+            return {{Op::kFill, Kind::kAddress, 0, 0, false},
+                    {Op::kCheck, Kind::kAddress, 0, 0, false},
+                    {Op::kFill, Kind::kAddress, 0, kOnes, false},
+                    {Op::kCheck, Kind::kAddress, 0, kOnes, false}};
+        }
+        // Random words of a seed derived from the seed of the run, reproducible between runs
+        uint64_t seed = SplitMix(seed_ + pass);
+        return {{Op::kFill, Kind::kRandom, seed, 0, false}, {Op::kCheck, Kind::kRandom, seed, 0, false}};
+    }
+
+    /**
+     * @brief Run a sweep on all the buffers at once.
+     *
+     * @return The number of failing words of every buffer.
+     */
+    std::vector<uint64_t> RunSweep(host_runner::HostContext *ctx, const Sweep &sweep, const std::string &pattern,
+                                   int pass) {
+        std::vector<std::vector<uint64_t>> member_errors(tasks_.size(), std::vector<uint64_t>(buffers_.size(), 0));
+        std::vector<std::vector<Failure>> member_failures(tasks_.size());
+        ctx->team->RunAll([&](int member, int) {
+            for (const auto &task : tasks_[member]) {
+                uint64_t *words = buffers_[task.buffer].As<uint64_t>();
+                uint64_t blocks = (task.end - task.begin) / kBlockWords;
+                for (uint64_t i = 0; i < blocks; i++) {
+                    uint64_t index = task.begin + (sweep.descending ? blocks - 1 - i : i) * kBlockWords;
+                    uint64_t *block = words + index;
+                    if (sweep.op != Op::kFill &&
+                        Diff(sweep.kind, block, kBlockWords, index, sweep.param, sweep.mask) != 0) {
+                        member_errors[member][task.buffer] +=
+                            Scan(sweep, block, index, nodes_[task.buffer], &member_failures[member]);
+                    }
+                    if (sweep.op != Op::kCheck) {
+                        // The moving inversions write the inverse of what they checked, in the block still in cache
+                        uint64_t mask = sweep.op == Op::kFill ? sweep.mask : ~sweep.mask;
+                        Fill(sweep.kind, block, kBlockWords, index, sweep.param, mask);
+                    }
+                }
+            }
+        });
+
+        std::vector<uint64_t> errors(buffers_.size(), 0);
+        for (size_t m = 0; m < tasks_.size(); m++) {
+            for (size_t b = 0; b < buffers_.size(); b++) {
+                errors[b] += member_errors[m][b];
+            }
+            for (const auto &failure : member_failures[m]) {
+                Report(failure, pattern, pass);
+            }
+        }
+        return errors;
+    }
+
+    /**
+     * @brief Count the failing words of a block and keep the first ones for the report.
+     */
+    uint64_t Scan(const Sweep &sweep, const uint64_t *block, uint64_t index, int node, std::vector<Failure> *failures) {
+        uint64_t count = 0;
+        for (size_t i = 0; i < kBlockWords; i++) {
+            uint64_t expected = Expected(sweep.kind, block + i, index + i, sweep.param, sweep.mask);
+            if (block[i] != expected) {
+                count++;
+                if (failures->size() < kMaxReports) {
+                    failures->push_back({block + i, expected, block[i], node});
+                }
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Print a failing word with the node of its page and its physical address.
+     */
+    void Report(const Failure &failure, const std::string &pattern, int pass) {
+        if (reports_ >= kMaxReports) {
+            return;
+        }
+        reports_++;
+        int page_node = -1;
+        if (get_mempolicy(&page_node, nullptr, 0, const_cast<uint64_t *>(failure.word), MPOL_F_NODE | MPOL_F_ADDR) !=
+            0) {
+            page_node = -1;
+        }
+        char line[512];
+        snprintf(line, sizeof(line),
+                 "Memory error in %s pass %d on NUMA node %d (page on node %d) at %p, physical %s, expected 0x%016llx, "
+                 "actual 0x%016llx, bits 0x%016llx.",
+                 pattern.c_str(), pass, failure.node, page_node, static_cast<const void *>(failure.word),
+                 PhysicalAddress(failure.word).c_str(), static_cast<unsigned long long>(failure.expected),
+                 static_cast<unsigned long long>(failure.actual),
+                 static_cast<unsigned long long>(failure.expected ^ failure.actual));
+        std::cerr << line << std::endl;
+    }
+
+    /**
+     * @brief Get the physical address of a word from /proc/self/pagemap, which needs CAP_SYS_ADMIN.
+     *
+     * @return The address in hexadecimal, "unknown" if not readable.
+     */
+    static std::string PhysicalAddress(const void *word) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t address = reinterpret_cast<uintptr_t>(word);
+        std::ifstream pagemap("/proc/self/pagemap", std::ios::binary);
+        uint64_t entry = 0;
+        pagemap.seekg(address / page * sizeof(entry));
+        if (!pagemap.read(reinterpret_cast<char *>(&entry), sizeof(entry))) {
+            return "unknown";
+        }
+        // Bit 63 tells a present page, bits 0-54 its frame number, 0 without the capability
+        uint64_t frame = entry & ((1ULL << 55) - 1);
+        if ((entry >> 63) == 0 || frame == 0) {
+            return "unknown";
+        }
+        char text[32];
+        snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(frame * page + address % page));
+        return text;
+    }
+
+    // Percentage of the free memory of every node to test.
+    int percent_ = 70;
+
+    // Size in bytes to test on every node instead of a percentage, 0 for the percentage.
+    uint64_t size_ = 0;
+
+    // Duration in seconds, passes over the patterns being repeated until it is over, 0 for a single pass.
+    int seconds_ = 60;
+
+    // Patterns to run in every pass.
+    std::vector<std::string> patterns_ = {std::begin(kPatterns), std::end(kPatterns)};
+
+    // Seed of the random words.
+    int seed_ = 33931;
+
+    // Words flipped after every fill, so that the tests can check that the failing words are found.
+    int inject_ = 0;
+
+    // Buffer of every tested node, and the node.
+    std::vector<host_utils::ArenaBuffer> buffers_;
+    std::vector<int> nodes_;
+
+    // Bytes moved on every tested node.
+    std::vector<double> node_bytes_;
+
+    // Blocks of every member.
+    std::vector<std::vector<Task>> tasks_;
+
+    // Failing words printed so far.
+    int reports_ = 0;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("mem_test", MemTest);
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// NUMA copy plugin of the host runner, the copy matrix of cpu_copy in host_utils/numa_copy_utils.h on the shared team
+// and arena, every copy being shared by up to threads members on the executing node. With sweep_exec, as cpu_copy
+// --sweep_exec_node, every pair is copied by the members of every node of the team instead. On a host with a single
+// NUMA node with memory, the copy within the node is measured, as there is no pair of nodes.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../host_utils/numa_copy_utils.h"
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class NumaCopy : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        return params->Size("size", &size_) && params->Int("warmup", &warmup_, 0) && params->Int("iters", &iters_, 1) &&
+               params->Int("threads", &threads_, 1) && params->Int("local", &local_, 0) &&
+               params->Int("check_data", &check_data_, 0) && params->Int("sweep_exec", &sweep_exec_, 0);
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        std::set<int> exec_nodes;
+        for (int cpu : ctx->topology.cpus) {
+            exec_nodes.insert(ctx->topology.cpu_node.at(cpu));
+        }
+        bool local = local_ != 0 || ctx->topology.mem_nodes.size() == 1;
+        auto copies = host_utils::NumaCopyMatrix(ctx->topology.mem_nodes, {exec_nodes.begin(), exec_nodes.end()},
+                                                 local, sweep_exec_ != 0);
+        if (copies.empty()) {
+            std::cerr << "No NUMA node with memory to copy between with the cpus of the team." << std::endl;
+            return false;
+        }
+        for (const auto &copy : copies) {
+            if (!Copy(ctx, emitter, copy)) {
+                return false;
+            }
+            if (emitter->Stopped()) {
+                return true;
+            }
+        }
+        return true;
+    }
+
+  private:
+    /**
+     * @brief Run a copy of the matrix with the members on its executing node and emit the bandwidth and latency.
+     */
+    bool Copy(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter, const host_utils::NumaCopy &copy) {
+        std::vector<int> members = ctx->topology.MembersOnNode(copy.exec_node);
+        members.resize(std::min<size_t>(members.size(), threads_));
+        char *src = ctx->arena->Get(copy.src_node, 0, size_);
+        char *dst = ctx->arena->Get(copy.dst_node, 1, size_);
+        if (src == nullptr || dst == nullptr) {
+            return false;
+        }
+        memset(src, 1, size_);
+
+        std::string name = copy.Name();
+        double seconds = 0;
+        int iters = 0;
+        for (int i = 0; i < warmup_ + iters_; i++) {
+            auto start = Clock::now();
+            ctx->team->Run(members,
+                           [&](int index, int count) { host_utils::NumaCopySlice(dst, src, size_, index, count); });
+            if (i >= warmup_) {
+                double copy_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                seconds += copy_seconds;
+                iters++;
+                // The remaining copies are skipped once the bandwidth is confirmed below the baseline
+                if (emitter->Observe(name + "_bw", host_utils::NumaCopyBandwidth(size_, copy_seconds * 1e9))) {
+                    break;
+                }
+            }
+        }
+        if (check_data_ != 0 && !host_utils::NumaCopyCheck(copy, dst, src, size_)) {
+            return false;
+        }
+
+        double copy_ns = seconds * 1e9 / iters;
+        host_utils::ResultTags tags = {{"src", std::to_string(copy.src_node)}, {"dst", std::to_string(copy.dst_node)}};
+        if (copy.sweep_exec) {
+            tags.push_back({"exec", std::to_string(copy.exec_node)});
+        }
+        emitter->Metric(name + "_bw", host_utils::NumaCopyBandwidth(size_, copy_ns), "MB/s", tags);
+        emitter->Metric(name + "_lat", host_utils::NumaCopyLatency(size_, copy_ns), "ns/byte", tags);
+        return true;
+    }
+
+  private:
+    // Size of the copy in bytes.
+    uint64_t size_ = 256ULL << 20;
+
+    // Number of warmup copies.
+    int warmup_ = 1;
+
+    // Number of timed copies.
+    int iters_ = 5;
+
+    // Maximum number of threads per copy, all on the executing node.
+    int threads_ = 1;
+
+    // Whether to copy within a node too, always on a single node.
+    int local_ = 0;
+
+    // Whether to compare the buffers after the copies.
+    int check_data_ = 0;
+
+    // Whether to copy every pair, within a node too, with the threads of every node with cpus.
+    int sweep_exec_ = 0;
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("numa_copy", NumaCopy);
@@ -0,0 +1,502 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Synchronization scaling plugin of the host runner, the atomics and locks that thread pools and progress engines live
+// on. Growing numbers of members contend on fetch_add, a compare-and-swap loop, test-and-test-and-set, ticket and MCS
+// spinlocks and std::mutex for a fixed time, reporting the throughput and how fairly it is shared between the members,
+// and pass a futex-based and a sense-reversing barrier a fixed number of times, reporting the time per episode. The
+// members are placed compactly, filling the hardware threads of a core, the cores of a last level cache and the
+// caches of a node first, or scattered across the nodes, then the caches, then the cores, so that the thread count
+// where a primitive collapses shows which level of the topology it does not survive.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../host_utils/cpu_utils.h"
+#include "host_runner.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Primitives, in the order they run.
+const char *const kPrimitives[] = {"fetch_add", "cas",   "ttas",          "ticket",
+                                   "mcs",       "mutex", "futex_barrier", "sense_barrier"};
+
+// Operations between two looks at the clock.
+constexpr int kBatch = 16;
+
+// Spins after which a waiter yields, so that oversubscribed cpus still make progress.
+constexpr int kSpinsBeforeYield = 1 << 12;
+
+/**
+ * @brief Tell the cpu that the thread is spinning.
+ */
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Spin until a condition holds.
+ */
+template <typename Cond> inline void SpinUntil(Cond cond) {
+    for (int spins = 1; !cond(); spins++) {
+        CpuRelax();
+        if (spins % kSpinsBeforeYield == 0) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Test-and-test-and-set spinlock.
+class TtasLock {
+  public:
+    void Lock(int) {
+        while (true) {
+            SpinUntil([&] { return !locked_.load(std::memory_order_relaxed); });
+            if (!locked_.exchange(true, std::memory_order_acquire)) {
+                return;
+            }
+        }
+    }
+
+    void Unlock(int) { locked_.store(false, std::memory_order_release); }
+
+  private:
+    alignas(64) std::atomic<bool> locked_{false};
+};
+
+// Ticket spinlock, granting the lock in arrival order.
+class TicketLock {
+  public:
+    void Lock(int) {
+        uint64_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+        SpinUntil([&] { return serving_.load(std::memory_order_acquire) == ticket; });
+    }
+
+    void Unlock(int) { serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  private:
+    alignas(64) std::atomic<uint64_t> next_{0};
+    alignas(64) std::atomic<uint64_t> serving_{0};
+};
+
+// MCS queue spinlock, every waiter spinning on its own node.
+class McsLock {
+  public:
+    explicit McsLock(int threads) : nodes_(threads) {}
+
+    void Lock(int index) {
+        Node *node = &nodes_[index];
+        node->next.store(nullptr, std::memory_order_relaxed);
+        node->locked.store(true, std::memory_order_relaxed);
+        Node *prev = tail_.exchange(node, std::memory_order_acq_rel);
+        if (prev != nullptr) {
+            prev->next.store(node, std::memory_order_release);
+            SpinUntil([&] { return !node->locked.load(std::memory_order_acquire); });
+        }
+    }
+
+    void Unlock(int index) {
+        Node *node = &nodes_[index];
+        Node *next = node->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            Node *expected = node;
+            if (tail_.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel)) {
+                return;
+            }
+            // A successor swapped the tail and is about to link itself
+            SpinUntil([&] { return (next = node->next.load(std::memory_order_acquire)) != nullptr; });
+        }
+        next->locked.store(false, std::memory_order_release);
+    }
+
+  private:
+    struct alignas(64) Node {
+        std::atomic<Node *> next{nullptr};
+        std::atomic<bool> locked{false};
+    };
+
+    alignas(64) std::atomic<Node *> tail_{nullptr};
+    std::vector<Node> nodes_;
+};
+
+// std::mutex behind the lock interface.
+class MutexLock {
+  public:
+    void Lock(int) { mutex_.lock(); }
+
+    void Unlock(int) { mutex_.unlock(); }
+
+  private:
+    std::mutex mutex_;
+};
+
+// Barrier whose waiters sleep in the kernel on a generation word.
+class FutexBarrier {
+  public:
+    explicit FutexBarrier(int threads) : threads_(threads) {}
+
+    void Wait(int) {
+        int generation = generation_.load(std::memory_order_acquire);
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) == threads_ - 1) {
+            arrived_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+            syscall(SYS_futex, reinterpret_cast<int *>(&generation_), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr,
+                    0);
+            return;
+        }
+        while (generation_.load(std::memory_order_acquire) == generation) {
+            syscall(SYS_futex, reinterpret_cast<int *>(&generation_), FUTEX_WAIT_PRIVATE, generation, nullptr, nullptr,
+                    0);
+        }
+    }
+
+  private:
+    int threads_;
+    alignas(64) std::atomic<int> arrived_{0};
+    alignas(64) std::atomic<int> generation_{0};
+};
+
+// Centralized sense-reversing spinning barrier.
+class SenseBarrier {
+  public:
+    explicit SenseBarrier(int threads) : threads_(threads), local_sense_(threads) {}
+
+    void Wait(int index) {
+        bool sense = !local_sense_[index].value;
+        local_sense_[index].value = sense;
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) == threads_ - 1) {
+            arrived_.store(0, std::memory_order_relaxed);
+            sense_.store(sense, std::memory_order_release);
+            return;
+        }
+        SpinUntil([&] { return sense_.load(std::memory_order_acquire) == sense; });
+    }
+
+  private:
+    struct alignas(64) LocalSense {
+        bool value = false;
+    };
+
+    int threads_;
+    alignas(64) std::atomic<int> arrived_{0};
+    alignas(64) std::atomic<bool> sense_{false};
+    std::vector<LocalSense> local_sense_;
+};
+
+// Operations and times of one member in a timed run.
+struct alignas(64) MemberResult {
+    uint64_t ops = 0;
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+/**
+ * @brief Read the first cpu of a sysfs cpu list, the id of the group of cpus it describes.
+ *
+ * @return The first cpu, the fallback if the file is missing.
+ */
+int FirstCpuOf(const std::string &path, int fallback) {
+    std::ifstream in(path);
+    std::string list;
+    if (!std::getline(in, list)) {
+        return fallback;
+    }
+    std::vector<int> cpus = host_utils::ParseCpuList(list);
+    return cpus.empty() ? fallback : cpus.front();
+}
+
+/**
+ * @brief Get an operation incrementing a counter under a lock.
+ */
+template <typename Lock> auto Locked(Lock *lock, uint64_t *counter) {
+    return [lock, counter](int index) {
+        lock->Lock(index);
+        ++*static_cast<volatile uint64_t *>(counter);
+        lock->Unlock(index);
+    };
+}
+
+class SyncScaling : public host_runner::HostBenchmark {
+  public:
+    bool Configure(host_runner::Params *params) override {
+        std::string primitives;
+        std::string placements;
+        bool ok = params->IntList("threads", &threads_, 1) && params->Int("ms", &ms_, 1) &&
+                  params->Int("barrier_iters", &barrier_iters_, 1) && params->String("primitives", &primitives) &&
+                  params->String("placements", &placements);
+        if (!ok) {
+            return false;
+        }
+        if (!primitives.empty()) {
+            primitives_ = Split(primitives);
+        }
+        if (!placements.empty()) {
+            placements_ = Split(placements);
+        }
+        for (const auto &name : primitives_) {
+            if (std::find_if(std::begin(kPrimitives), std::end(kPrimitives),
+                             [&](const char *primitive) { return name == primitive; }) == std::end(kPrimitives)) {
+                std::cerr << "Invalid primitives: " << name << "." << std::endl;
+                return false;
+            }
+        }
+        for (const auto &name : placements_) {
+            if (name != "compact" && name != "scatter") {
+                std::cerr << "Invalid placements: " << name << ", use compact or scatter." << std::endl;
+                return false;
+            }
+        }
+        return !primitives_.empty() && !placements_.empty();
+    }
+
+    bool Run(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter) override {
+        std::vector<int> counts = threads_;
+        if (counts.empty()) {
+            // Powers of two up to the team, and the whole team
+            for (int count = 1; count < ctx->team->Size(); count *= 2) {
+                counts.push_back(count);
+            }
+            counts.push_back(ctx->team->Size());
+        }
+        for (const auto &placement : placements_) {
+            std::vector<int> order = Order(ctx, placement == "scatter");
+            for (const auto &primitive : primitives_) {
+                double peak = 0;
+                int peak_threads = 0;
+                bool barrier = primitive.find("barrier") != std::string::npos;
+                for (int count : counts) {
+                    if (count > ctx->team->Size() || emitter->Stopped()) {
+                        continue;
+                    }
+                    std::vector<int> members(order.begin(), order.begin() + count);
+                    std::string name = primitive + "_" + placement + "_t" + std::to_string(count);
+                    host_utils::ResultTags tags = {
+                        {"primitive", primitive}, {"placement", placement}, {"threads", std::to_string(count)}};
+                    if (barrier) {
+                        MeasureBarrier(ctx, emitter, primitive, members, name, tags);
+                        continue;
+                    }
+                    double throughput = MeasureContention(ctx, emitter, primitive, members, name, tags);
+                    if (throughput > peak) {
+                        peak = throughput;
+                        peak_threads = count;
+                    }
+                }
+                if (peak_threads > 0) {
+                    // Beyond this count adding threads only loses throughput
+                    emitter->Metric(primitive + "_" + placement + "_peak_threads", peak_threads, "",
+                                    {{"primitive", primitive}, {"placement", placement}});
+                }
+            }
+        }
+        return true;
+    }
+
+  private:
+    /**
+     * @brief Split a comma separated list.
+     */
+    static std::vector<std::string> Split(const std::string &list) {
+        std::vector<std::string> items;
+        std::stringstream ss(list);
+        for (std::string item; std::getline(ss, item, ',');) {
+            items.push_back(item);
+        }
+        return items;
+    }
+
+    /**
+     * @brief Order the members compactly or scattered over the nodes, last level caches, cores and hardware threads.
+     */
+    static std::vector<int> Order(host_runner::HostContext *ctx, bool scatter) {
+        // Rank of every member within its core, of its core within its cache and of its cache within its node
+        std::map<std::tuple<int, int, int>, int> smt_rank;
+        std::map<std::pair<int, int>, std::vector<int>> cache_cores;
+        std::map<int, std::vector<int>> node_caches;
+        std::vector<std::tuple<int, int, int, int>> keys;
+        for (int cpu : ctx->topology.cpus) {
+            std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+            int node = ctx->topology.cpu_node.at(cpu);
+            int core = FirstCpuOf(dir + "/topology/thread_siblings_list", cpu);
+            int cache = FirstCpuOf(dir + "/cache/index3/shared_cpu_list", -1 - node);
+            auto &cores = cache_cores[{node, cache}];
+            if (std::find(cores.begin(), cores.end(), core) == cores.end()) {
+                cores.push_back(core);
+            }
+            auto &caches = node_caches[node];
+            if (std::find(caches.begin(), caches.end(), cache) == caches.end()) {
+                caches.push_back(cache);
+            }
+            int smt = smt_rank[std::make_tuple(node, cache, core)]++;
+            keys.push_back(std::make_tuple(node, cache, core, smt));
+        }
+        std::vector<std::tuple<int, int, int, int, int>> ranked;
+        for (size_t m = 0; m < keys.size(); m++) {
+            int node, cache, core, smt;
+            std::tie(node, cache, core, smt) = keys[m];
+            const auto &caches = node_caches[node];
+            const auto &cores = cache_cores[{node, cache}];
+            int cache_rank = std::find(caches.begin(), caches.end(), cache) - caches.begin();
+            int core_rank = std::find(cores.begin(), cores.end(), core) - cores.begin();
+            if (scatter) {
+                ranked.push_back(std::make_tuple(smt, core_rank, cache_rank, node, static_cast<int>(m)));
+            } else {
+                ranked.push_back(std::make_tuple(node, cache_rank, core_rank, smt, static_cast<int>(m)));
+            }
+        }
+        std::sort(ranked.begin(), ranked.end());
+        std::vector<int> order;
+        for (const auto &rank : ranked) {
+            order.push_back(std::get<4>(rank));
+        }
+        return order;
+    }
+
+    /**
+     * @brief Contend on a primitive for the duration and emit the throughput and its fairness.
+     *
+     * @return The throughput in millions of operations per second.
+     */
+    double MeasureContention(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter,
+                             const std::string &primitive, const std::vector<int> &members, const std::string &name,
+                             const host_utils::ResultTags &tags) {
+        // The shared counter is what the lock protects
+        alignas(64) std::atomic<uint64_t> counter{0};
+        uint64_t protected_counter = 0;
+        std::vector<MemberResult> results;
+        if (primitive == "fetch_add") {
+            results = Timed(ctx, members, [&](int) { counter.fetch_add(1); });
+        } else if (primitive == "cas") {
+            results = Timed(ctx, members, [&](int) {
+                uint64_t value = counter.load(std::memory_order_relaxed);
+                while (!counter.compare_exchange_weak(value, value + 1)) {
+                }
+            });
+        } else if (primitive == "ttas") {
+            TtasLock lock;
+            results = Timed(ctx, members, Locked(&lock, &protected_counter));
+        } else if (primitive == "ticket") {
+            TicketLock lock;
+            results = Timed(ctx, members, Locked(&lock, &protected_counter));
+        } else if (primitive == "mcs") {
+            McsLock lock(static_cast<int>(members.size()));
+            results = Timed(ctx, members, Locked(&lock, &protected_counter));
+        } else {
+            MutexLock lock;
+            results = Timed(ctx, members, Locked(&lock, &protected_counter));
+        }
+
+        // Throughput over the whole run, and Jain's fairness index of the operations of the members
+        uint64_t total = 0;
+        double squares = 0;
+        Clock::time_point start = results.front().start, end = results.front().end;
+        for (const auto &result : results) {
+            total += result.ops;
+            squares += static_cast<double>(result.ops) * result.ops;
+            start = std::min(start, result.start);
+            end = std::max(end, result.end);
+        }
+        double seconds = std::chrono::duration<double>(end - start).count();
+        double throughput = total / seconds / 1e6;
+        double fairness = squares > 0 ? static_cast<double>(total) * total / (results.size() * squares) : 0;
+        emitter->Metric(name + "_throughput", throughput, "Mops/s", tags);
+        emitter->Metric(name + "_fairness", fairness, "", tags);
+        return throughput;
+    }
+
+    /**
+     * @brief Run an operation on the members, starting together, until the first of them sees the duration over.
+     */
+    template <typename Op>
+    std::vector<MemberResult> Timed(host_runner::HostContext *ctx, const std::vector<int> &members, Op op) {
+        std::vector<MemberResult> results(members.size());
+        std::atomic<int> arrived{0};
+        std::atomic<bool> stop{false};
+        auto duration = std::chrono::milliseconds(ms_);
+        ctx->team->Run(members, [&](int index, int count) {
+            arrived.fetch_add(1);
+            SpinUntil([&] { return arrived.load() == count; });
+            MemberResult &result = results[index];
+            result.start = Clock::now();
+            auto deadline = result.start + duration;
+            uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < kBatch; i++) {
+                    op(index);
+                }
+                ops += kBatch;
+                if (Clock::now() >= deadline) {
+                    stop.store(true, std::memory_order_relaxed);
+                }
+            }
+            result.end = Clock::now();
+            result.ops = ops;
+        });
+        return results;
+    }
+
+    /**
+     * @brief Pass a barrier the given number of times and emit the time per episode.
+     */
+    void MeasureBarrier(host_runner::HostContext *ctx, host_runner::PluginEmitter *emitter,
+                          const std::string &primitive, const std::vector<int> &members, const std::string &name,
+                          const host_utils::ResultTags &tags) {
+        int count = static_cast<int>(members.size());
+        FutexBarrier futex_barrier(count);
+        SenseBarrier sense_barrier(count);
+        bool futex = primitive == "futex_barrier";
+        auto start = Clock::now();
+        ctx->team->Run(members, [&](int index, int) {
+            for (int i = 0; i < barrier_iters_; i++) {
+                if (futex) {
+                    futex_barrier.Wait(index);
+                } else {
+                    sense_barrier.Wait(index);
+                }
+            }
+        });
+        double latency = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / barrier_iters_;
+        emitter->Metric(name + "_latency", latency, "us", tags);
+    }
+
+    // Numbers of contending members, powers of two up to the team and the team if empty.
+    std::vector<int> threads_;
+
+    // Duration in milliseconds of the contention on a primitive.
+    int ms_ = 200;
+
+    // Number of episodes of a barrier.
+    int barrier_iters_ = 10000;
+
+    // Primitives to measure.
+    std::vector<std::string> primitives_ = {std::begin(kPrimitives), std::end(kPrimitives)};
+
+    // Placements of the members.
+    std::vector<std::string> placements_ = {"compact", "scatter"};
+};
+
+} // namespace
+
+REGISTER_HOST_BENCHMARK("sync", SyncScaling);
@@ -0,0 +1,334 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Baseline checks shared by the CPU-side micro-benchmarks.
+// A rules file gives for metric names the expected value and the tolerance, so that every metric is checked as soon
+// as it is produced instead of after the whole suite by the data diagnosis. One rule per line, the first rule whose
+// pattern (an ECMAScript regular expression) matches the whole metric name applies:
+//   <pattern> <expected> <tolerance> [higher|lower|both] [confirm=<n>]
+// The tolerance is relative, e.g. 0.05 for 5%, and the direction tells which side of the expected value is better,
+// "higher" for bandwidths (the default), "lower" for latencies. A metric value fails once it violates the rule
+// confirm times, 1 by default. Samples and per-iteration observations fail only when the one-sided confidence bound of
+// their mean is beyond the tolerance, so that a noisy iteration does not fail a node on its own.
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace host_utils {
+
+// Side of the expected value that is better.
+enum class BaselineDirection { kHigher, kLower, kBoth };
+
+// Outcome of a check.
+enum class BaselineVerdict {
+    // No rule matches the metric
+    kNoRule,
+    // Within the tolerance
+    kPass,
+    // Beyond the tolerance, but not confirmed yet
+    kSuspect,
+    // Beyond the tolerance and confirmed
+    kFail
+};
+
+// Rule of a metric.
+struct BaselineRule {
+    // Pattern of the metric names, as written in the file.
+    std::string pattern;
+
+    // Compiled pattern.
+    std::regex regex;
+
+    // Expected value.
+    double expected = 0;
+
+    // Relative tolerance.
+    double tolerance = 0;
+
+    // Side of the expected value that is better.
+    BaselineDirection direction = BaselineDirection::kHigher;
+
+    // Number of violations of a metric value that confirm a failure.
+    int confirm = 1;
+
+    /**
+     * @brief Get the lowest value within the tolerance, -inf if there is none.
+     */
+    double Lower() const {
+        return direction == BaselineDirection::kLower ? -INFINITY : expected - std::fabs(expected) * tolerance;
+    }
+
+    /**
+     * @brief Get the highest value within the tolerance, +inf if there is none.
+     */
+    double Upper() const {
+        return direction == BaselineDirection::kHigher ? INFINITY : expected + std::fabs(expected) * tolerance;
+    }
+
+    /**
+     * @brief Check whether a value violates the rule.
+     */
+    bool Violates(double value) const { return !(value >= Lower() && value <= Upper()); }
+};
+
+// Rules of a baseline file.
+class Baseline {
+  public:
+    /**
+     * @brief Load the rules of a file.
+     *
+     * @param path The path of the file.
+     * @return true if the file is readable and every line is a valid rule, a blank line or a # comment.
+     */
+    bool Load(const std::string &path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Failed to open baseline " << path << "." << std::endl;
+            return false;
+        }
+        int line_no = 0;
+        for (std::string line; std::getline(in, line);) {
+            line_no++;
+            std::istringstream tokens(line.substr(0, line.find('#')));
+            BaselineRule rule;
+            if (!(tokens >> rule.pattern)) {
+                continue;
+            }
+            bool ok = static_cast<bool>(tokens >> rule.expected >> rule.tolerance) && rule.tolerance >= 0;
+            for (std::string token; ok && tokens >> token;) {
+                const std::map<std::string, BaselineDirection> directions = {{"higher", BaselineDirection::kHigher},
+                                                                             {"lower", BaselineDirection::kLower},
+                                                                             {"both", BaselineDirection::kBoth}};
+                if (directions.count(token) > 0) {
+                    rule.direction = directions.at(token);
+                } else {
+                    ok = 1 == sscanf(token.c_str(), "confirm=%d", &rule.confirm) && rule.confirm >= 1;
+                }
+            }
+            try {
+                rule.regex = std::regex(rule.pattern, std::regex::ECMAScript | std::regex::optimize);
+            } catch (const std::regex_error &e) {
+                ok = false;
+            }
+            if (!ok) {
+                std::cerr << "Invalid rule at " << path << ":" << line_no << ": " << line << std::endl;
+                return false;
+            }
+            rules_.push_back(std::move(rule));
+        }
+        return true;
+    }
+
+    /**
+     * @brief Find the rule of a metric.
+     *
+     * @param name The metric name.
+     * @return The first rule matching the whole name, nullptr if none.
+     */
+    const BaselineRule *Find(const std::string &name) const {
+        for (const auto &rule : rules_) {
+            if (std::regex_match(name, rule.regex)) {
+                return &rule;
+            }
+        }
+        return nullptr;
+    }
+
+  private:
+    std::vector<BaselineRule> rules_;
+};
+
+// Degrees of freedom up to which the quantile of the Student's t-distribution is exact.
+constexpr int64_t kExactStudentDf = 30;
+
+/**
+ * @brief Get the cumulative distribution function of the Student's t-distribution for an integer degrees of freedom.
+ *
+ * The closed form of Abramowitz and Stegun 26.7.3 and 26.7.4, a finite series in theta = atan(t / sqrt(df)).
+ *
+ * @param theta The angle of t in [0, pi/2).
+ * @param df The degrees of freedom, at least 1.
+ * @return The probability of a value at most t.
+ */
+inline double StudentCdf(double theta, int64_t df) {
+    double c2 = std::cos(theta) * std::cos(theta);
+    double term = 1, sum = 1;
+    if (df % 2 == 0) {
+        for (int64_t k = 2; k < df; k += 2) {
+            term *= c2 * (k - 1) / k;
+            sum += term;
+        }
+        return 0.5 + 0.5 * std::sin(theta) * sum;
+    }
+    for (int64_t k = 3; k < df; k += 2) {
+        term *= c2 * (k - 1) / k;
+        sum += term;
+    }
+    double series = df == 1 ? 0 : std::sin(theta) * std::cos(theta) * sum;
+    return 0.5 + (theta + series) / M_PI;
+}
+
+/**
+ * @brief Get the one-sided quantile of the Student's t-distribution.
+ *
+ * Up to kExactStudentDf degrees of freedom the quantile is found by bisection on StudentCdf(), so that the few values
+ * of a fail-fast check are not judged with a too narrow bound. Beyond, the normal quantile is found by bisection on
+ * erfc and corrected for the degrees of freedom with the Cornish-Fisher expansion, within 0.1% for confidences up to
+ * 0.999.
+ *
+ * @param confidence The confidence in (0.5, 1), e.g. 0.99.
+ * @param df The degrees of freedom, at least 1.
+ * @return The quantile.
+ */
+inline double StudentQuantile(double confidence, int64_t df) {
+    if (df <= kExactStudentDf) {
+        double lo = 0, hi = M_PI / 2;
+        for (int i = 0; i < 60; i++) {
+            double mid = (lo + hi) / 2;
+            (StudentCdf(mid, df) < confidence ? lo : hi) = mid;
+        }
+        return std::sqrt(static_cast<double>(df)) * std::tan(lo);
+    }
+    double lo = 0, hi = 10;
+    for (int i = 0; i < 60; i++) {
+        double mid = (lo + hi) / 2;
+        (0.5 * std::erfc(-mid / std::sqrt(2.0)) < confidence ? lo : hi) = mid;
+    }
+    double z = lo;
+    double n = static_cast<double>(df);
+    return z + (z * z * z + z) / (4 * n) + (5 * std::pow(z, 5) + 16 * z * z * z + 3 * z) / (96 * n * n);
+}
+
+// Checker of the metrics of a benchmark against a baseline.
+class BaselineChecker {
+  public:
+    /**
+     * @brief Create a checker.
+     *
+     * @param baseline The rules.
+     * @param confidence The confidence of the checks of samples and observations.
+     */
+    BaselineChecker(std::shared_ptr<const Baseline> baseline, double confidence)
+        : baseline_(std::move(baseline)), confidence_(confidence) {}
+
+    /**
+     * @brief Check a metric value.
+     *
+     * @param name The metric name.
+     * @param value The value.
+     * @return The verdict, kFail once the metric violated its rule confirm times.
+     */
+    BaselineVerdict CheckValue(const std::string &name, double value) {
+        const BaselineRule *rule = baseline_->Find(name);
+        if (rule == nullptr) {
+            return BaselineVerdict::kNoRule;
+        }
+        if (!rule->Violates(value)) {
+            return BaselineVerdict::kPass;
+        }
+        return Verdict(name, ++violations_[name] >= rule->confirm);
+    }
+
+    /**
+     * @brief Check the samples of a metric by their mean.
+     *
+     * @param name The metric name.
+     * @param samples The samples.
+     * @return The verdict, kFail if the confidence bound of the mean is beyond the tolerance.
+     */
+    BaselineVerdict CheckSamples(const std::string &name, const std::vector<double> &samples) {
+        RunningStats stats;
+        for (double sample : samples) {
+            stats.Add(sample);
+        }
+        return CheckStats(name, stats);
+    }
+
+    /**
+     * @brief Check one more observation of a metric, e.g. the value of an iteration, by the mean of all so far.
+     *
+     * @param name The metric name.
+     * @param value The value.
+     * @return The verdict, kFail if the confidence bound of the mean is beyond the tolerance.
+     */
+    BaselineVerdict Observe(const std::string &name, double value) {
+        auto &stats = observations_[name];
+        stats.Add(value);
+        return CheckStats(name, stats);
+    }
+
+    /**
+     * @brief Get the number of confirmed failures.
+     */
+    int Failures() const { return static_cast<int>(failed_.size()); }
+
+  private:
+    // Mean and variance updated one value at a time with Welford's method.
+    struct RunningStats {
+        int64_t count = 0;
+        double mean = 0;
+        double m2 = 0;
+
+        void Add(double value) {
+            count++;
+            double delta = value - mean;
+            mean += delta / count;
+            m2 += delta * (value - mean);
+        }
+    };
+
+    // Fewest values whose mean is checked with a confidence bound.
+    static constexpr int64_t kMinCount = 3;
+
+    BaselineVerdict CheckStats(const std::string &name, const RunningStats &stats) {
+        const BaselineRule *rule = baseline_->Find(name);
+        if (rule == nullptr) {
+            return BaselineVerdict::kNoRule;
+        }
+        if (stats.count == 0 || !rule->Violates(stats.mean)) {
+            return BaselineVerdict::kPass;
+        }
+        if (stats.count < kMinCount) {
+            return BaselineVerdict::kSuspect;
+        }
+        double margin = StudentQuantile(confidence_, stats.count - 1) * std::sqrt(stats.m2 / (stats.count - 1)) /
+                        std::sqrt(static_cast<double>(stats.count));
+        // The whole confidence interval of the mean is on the failing side
+        return Verdict(name, stats.mean + margin < rule->Lower() || stats.mean - margin > rule->Upper());
+    }
+
+    BaselineVerdict Verdict(const std::string &name, bool confirmed) {
+        if (!confirmed) {
+            return BaselineVerdict::kSuspect;
+        }
+        // A metric fails once
+        failed_.insert(name);
+        return BaselineVerdict::kFail;
+    }
+
+    std::shared_ptr<const Baseline> baseline_;
+    double confidence_;
+
+    // Violations of every metric checked by value.
+    std::map<std::string, int> violations_;
+
+    // Observations of every metric checked by iteration.
+    std::map<std::string, RunningStats> observations_;
+
+    // Metrics that failed.
+    std::set<std::string> failed_;
+};
+
+} // namespace host_utils
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Tests of the baseline checks, run by ctest from the build of the host runner.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include <unistd.h>
+
+#include "baseline_utils.h"
+
+namespace {
+
+int failures = 0;
+
+/**
+ * @brief Check that a value is within a relative tolerance of the expected one.
+ */
+void ExpectNear(const char *what, double value, double expected, double tolerance) {
+    if (!(std::fabs(value - expected) <= std::fabs(expected) * tolerance)) {
+        std::cerr << what << " is " << value << ", expected " << expected << "." << std::endl;
+        failures++;
+    }
+}
+
+/**
+ * @brief Check the quantiles of the Student's t-distribution against the exact values of the tables.
+ */
+void TestStudentQuantile() {
+    // The small degrees of freedom of the fewest values a fail-fast check judges
+    ExpectNear("t(0.99, 2)", host_utils::StudentQuantile(0.99, 2), 6.964557, 1e-5);
+    ExpectNear("t(0.99, 3)", host_utils::StudentQuantile(0.99, 3), 4.540703, 1e-5);
+    ExpectNear("t(0.99, 5)", host_utils::StudentQuantile(0.99, 5), 3.364930, 1e-5);
+    ExpectNear("t(0.95, 2)", host_utils::StudentQuantile(0.95, 2), 2.919986, 1e-5);
+    ExpectNear("t(0.95, 3)", host_utils::StudentQuantile(0.95, 3), 2.353363, 1e-5);
+    ExpectNear("t(0.95, 5)", host_utils::StudentQuantile(0.95, 5), 2.015048, 1e-5);
+    ExpectNear("t(0.99, 1)", host_utils::StudentQuantile(0.99, 1), 31.820516, 1e-5);
+    ExpectNear("t(0.99, 30)", host_utils::StudentQuantile(0.99, 30), 2.457262, 1e-5);
+    // The expansion beyond the exact degrees of freedom
+    ExpectNear("t(0.99, 31)", host_utils::StudentQuantile(0.99, 31), 2.452824, 1e-3);
+    ExpectNear("t(0.999, 31)", host_utils::StudentQuantile(0.999, 31), 3.374852, 1e-3);
+    ExpectNear("t(0.99, 100)", host_utils::StudentQuantile(0.99, 100), 2.364217, 1e-3);
+}
+
+/**
+ * @brief Check that three noisy observations beyond the tolerance are not a confirmed failure yet.
+ */
+void TestObserveFewValues() {
+    auto baseline = std::make_shared<host_utils::Baseline>();
+    char path[] = "/tmp/baseline_utils_test_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || write(fd, "bw 100 0.1\n", 11) != 11) {
+        std::cerr << "Failed to write the rules." << std::endl;
+        failures++;
+        return;
+    }
+    close(fd);
+    bool loaded = baseline->Load(path);
+    remove(path);
+    if (!loaded) {
+        failures++;
+        return;
+    }
+    // Mean 80 and standard deviation 2.8, whose 0.99 upper bound of 91.3 with 2 degrees of freedom is within 10%
+    host_utils::BaselineChecker checker(baseline, 0.99);
+    host_utils::BaselineVerdict verdict = host_utils::BaselineVerdict::kPass;
+    for (double value : {77.2, 80.0, 82.8}) {
+        verdict = checker.Observe("bw", value);
+    }
+    if (verdict != host_utils::BaselineVerdict::kSuspect) {
+        std::cerr << "Three observations around 80 failed the rule of 100 within 10%." << std::endl;
+        failures++;
+    }
+}
+
+} // namespace
+
+int main() {
+    TestStudentQuantile();
+    TestObserveFewValues();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,475 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// NUMA-aware buffer arena shared by the host buffers of the micro-benchmarks.
+// Buffers are carved from blocks mapped per NUMA node, backed by small pages, transparent huge pages or hugetlbfs
+// pages, aligned to at least the page size and to the requested alignment, bound to their node and pre-faulted in
+// parallel by threads pinned to the cpus of the node. A released buffer returns its block to the pool of its node,
+// where the smallest block large enough serves the next request, so that the pages are faulted once per run rather than
+// once per iteration or configuration. The memory policy is set with the raw mbind system call, so that binaries which
+// do not link libnuma can use the arena too.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "cpu_utils.h"
+
+namespace host_utils {
+
+// Size of a cache line, the smallest alignment of the buffers.
+constexpr size_t kCacheLineSize = 64;
+
+// Size of a huge page.
+constexpr size_t kHugePageSize = 2 << 20;
+
+// Pages backing the buffers.
+enum class PageBacking {
+    // Small pages, or transparent huge pages if the system enables them always.
+    kDefault,
+    // Small pages only.
+    kSmall,
+    // Transparent huge pages, requested with madvise.
+    kTransparentHuge,
+    // Huge pages reserved in hugetlbfs, transparent huge pages if none is left.
+    kHugetlbfs
+};
+
+/**
+ * @brief Parse the name of a page backing.
+ *
+ * @param name One of "default", "small", "thp" and "hugetlb".
+ * @param backing The backing.
+ * @return true if the name is valid.
+ */
+inline bool ParsePageBacking(const std::string &name, PageBacking *backing) {
+    const std::pair<const char *, PageBacking> backings[] = {{"default", PageBacking::kDefault},
+                                                              {"small", PageBacking::kSmall},
+                                                              {"thp", PageBacking::kTransparentHuge},
+                                                              {"hugetlb", PageBacking::kHugetlbfs}};
+    for (const auto &b : backings) {
+        if (name == b.first) {
+            *backing = b.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Get the cpus of a NUMA node from sysfs.
+ *
+ * @param node The node.
+ * @return The cpus, empty for a negative node, a node without cpus or a system without NUMA in sysfs.
+ */
+inline std::vector<int> NodeCpus(int node) {
+    if (node < 0) {
+        return {};
+    }
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!std::getline(in, list)) {
+        return {};
+    }
+    try {
+        return ParseCpuList(list);
+    } catch (const std::exception &e) {
+        return {};
+    }
+}
+
+// Options of a buffer arena.
+struct ArenaOpts {
+    // Pages backing the buffers.
+    PageBacking backing = PageBacking::kDefault;
+
+    // Alignment of the buffers, a power of two, raised to the cache line and page sizes.
+    size_t alignment = kCacheLineSize;
+
+    // Number of threads pre-faulting a block, 0 for one per cpu of its node.
+    int prefault_threads = 0;
+
+    // Pre-faulting of a block instead of the pinned threads, e.g. by a team of threads started once, called with the
+    // node, the block, its size and the page size. Every page is to be written once by a cpu of the node.
+    std::function<void(int, char *, size_t, size_t)> prefault;
+};
+
+class BufferArena;
+
+// Buffer of an arena, returned to the pool of its node when destroyed or released.
+class ArenaBuffer {
+  public:
+    ArenaBuffer() = default;
+
+    ArenaBuffer(ArenaBuffer &&other) noexcept { *this = std::move(other); }
+
+    ArenaBuffer &operator=(ArenaBuffer &&other) noexcept {
+        if (this != &other) {
+            Release();
+            arena_ = other.arena_;
+            block_ = other.block_;
+            data_ = other.data_;
+            size_ = other.size_;
+            node_ = other.node_;
+            backing_ = other.backing_;
+            other.arena_ = nullptr;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    ArenaBuffer(const ArenaBuffer &) = delete;
+    ArenaBuffer &operator=(const ArenaBuffer &) = delete;
+
+    ~ArenaBuffer() { Release(); }
+
+    /**
+     * @brief Return the buffer to its arena, which must still exist.
+     */
+    inline void Release();
+
+    /**
+     * @brief Get the buffer, nullptr if empty.
+     */
+    char *Data() const { return data_; }
+
+    /**
+     * @brief Get the buffer as an array.
+     */
+    template <typename T> T *As() const { return reinterpret_cast<T *>(data_); }
+
+    /**
+     * @brief Get the requested size in bytes.
+     */
+    size_t Size() const { return size_; }
+
+    /**
+     * @brief Get the NUMA node, negative if not bound.
+     */
+    int Node() const { return node_; }
+
+    /**
+     * @brief Get the pages actually backing the buffer, after the fallback from hugetlbfs if any.
+     */
+    PageBacking Backing() const { return backing_; }
+
+    explicit operator bool() const { return data_ != nullptr; }
+
+  private:
+    friend class BufferArena;
+
+    BufferArena *arena_ = nullptr;
+    uint64_t block_ = 0;
+    char *data_ = nullptr;
+    size_t size_ = 0;
+    int node_ = -1;
+    PageBacking backing_ = PageBacking::kDefault;
+};
+
+// Pools of pre-faulted blocks per NUMA node, growing only until trimmed or destroyed.
+class BufferArena {
+  public:
+    /**
+     * @brief Create an empty arena.
+     *
+     * @param opts The options.
+     */
+    explicit BufferArena(const ArenaOpts &opts = ArenaOpts()) : opts_(opts) {
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        alignment_ = std::max({opts_.alignment, kCacheLineSize, page});
+        if (opts_.backing == PageBacking::kTransparentHuge || opts_.backing == PageBacking::kHugetlbfs) {
+            alignment_ = std::max(alignment_, kHugePageSize);
+        }
+    }
+
+    /**
+     * @brief Unmap all the blocks, the buffers must be released before.
+     */
+    ~BufferArena() {
+        for (auto &block : blocks_) {
+            munmap(block.second.data, block.second.capacity);
+        }
+    }
+
+    BufferArena(const BufferArena &) = delete;
+    BufferArena &operator=(const BufferArena &) = delete;
+
+    /**
+     * @brief Get a pre-faulted buffer, from the smallest free block of the node large enough or a new block.
+     *
+     * The content of a reused block is what its last buffer left.
+     *
+     * @param node The NUMA node, negative for no binding, the pages then being placed by the pre-faulting threads.
+     * @param size The size in bytes.
+     * @return The buffer, empty on failure.
+     */
+    ArenaBuffer Acquire(int node, size_t size) {
+        ArenaBuffer buffer;
+        if (size == 0) {
+            return buffer;
+        }
+        node = std::max(node, -1);
+        std::unique_lock<std::mutex> lock(mutex_);
+        Block *best = nullptr;
+        uint64_t best_id = 0;
+        for (auto &block : blocks_) {
+            Block &b = block.second;
+            if (!b.in_use && b.node == node && b.capacity >= size && (best == nullptr || b.capacity < best->capacity)) {
+                best = &b;
+                best_id = block.first;
+            }
+        }
+        if (best != nullptr) {
+            reuses_++;
+        } else {
+            lock.unlock();
+            Block block;
+            if (!Map(node, size, &block)) {
+                return buffer;
+            }
+            lock.lock();
+            best_id = next_id_++;
+            best = &blocks_.emplace(best_id, block).first->second;
+        }
+        best->in_use = true;
+        buffer.arena_ = this;
+        buffer.block_ = best_id;
+        buffer.data_ = best->data;
+        buffer.size_ = size;
+        buffer.node_ = node;
+        buffer.backing_ = best->backing;
+        return buffer;
+    }
+
+    /**
+     * @brief Unmap the free blocks.
+     *
+     * @return The bytes unmapped.
+     */
+    size_t Trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t trimmed = 0;
+        for (auto it = blocks_.begin(); it != blocks_.end();) {
+            if (it->second.in_use) {
+                ++it;
+                continue;
+            }
+            munmap(it->second.data, it->second.capacity);
+            trimmed += it->second.capacity;
+            it = blocks_.erase(it);
+        }
+        return trimmed;
+    }
+
+    /**
+     * @brief Get the total size of the blocks.
+     */
+    size_t Capacity() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t capacity = 0;
+        for (const auto &block : blocks_) {
+            capacity += block.second.capacity;
+        }
+        return capacity;
+    }
+
+    /**
+     * @brief Get the number of requests served by a free block.
+     */
+    uint64_t Reuses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return reuses_;
+    }
+
+    /**
+     * @brief Get the number of blocks mapped with transparent huge pages because hugetlbfs had no page left.
+     */
+    uint64_t HugetlbFallbacks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hugetlb_fallbacks_;
+    }
+
+    /**
+     * @brief Get the time spent pre-faulting the blocks.
+     *
+     * @return The time in seconds.
+     */
+    double PrefaultTime() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return prefault_time_;
+    }
+
+  private:
+    friend class ArenaBuffer;
+
+    // Mapped block.
+    struct Block {
+        char *data = nullptr;
+        size_t capacity = 0;
+        int node = -1;
+        PageBacking backing = PageBacking::kDefault;
+        bool in_use = false;
+    };
+
+    /**
+     * @brief Return a block to its pool.
+     *
+     * @param id The block.
+     */
+    void Release(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(id);
+        if (it != blocks_.end()) {
+            it->second.in_use = false;
+        }
+    }
+
+    /**
+     * @brief Map, bind and pre-fault a block.
+     *
+     * @param node The NUMA node, negative for no binding.
+     * @param size The size in bytes.
+     * @param block The block.
+     * @return true on success.
+     */
+    bool Map(int node, size_t size, Block *block) {
+        PageBacking backing = opts_.backing;
+        size_t capacity = (size + alignment_ - 1) / alignment_ * alignment_;
+        void *mapping = MAP_FAILED;
+        size_t length = capacity;
+        if (backing == PageBacking::kHugetlbfs) {
+            // Huge pages of hugetlbfs are aligned to their size, more is only got by mapping more
+            length = capacity + (alignment_ > kHugePageSize ? alignment_ : 0);
+            mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (mapping == MAP_FAILED) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (hugetlb_fallbacks_++ == 0) {
+                    std::cerr << "No hugetlbfs page left for " << capacity
+                              << " bytes, falling back to transparent huge pages." << std::endl;
+                }
+                backing = PageBacking::kTransparentHuge;
+            }
+        }
+        if (mapping == MAP_FAILED) {
+            length = capacity + alignment_ - static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map " << capacity << " bytes. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        // Unmap the ends around the aligned block
+        char *begin = static_cast<char *>(mapping);
+        char *data = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(begin) + alignment_ - 1) / alignment_ *
+                                              alignment_);
+        if (data > begin) {
+            munmap(begin, data - begin);
+        }
+        if (begin + length > data + capacity) {
+            munmap(data + capacity, begin + length - (data + capacity));
+        }
+
+        if (backing == PageBacking::kSmall) {
+            madvise(data, capacity, MADV_NOHUGEPAGE);
+        } else if (backing == PageBacking::kTransparentHuge) {
+            madvise(data, capacity, MADV_HUGEPAGE);
+        }
+        if (node >= 0) {
+            // MPOL_BIND of linux/mempolicy.h, the system call fails without NUMA and first touch then places the pages
+            const int kMpolBind = 2;
+            std::vector<unsigned long> mask(node / (8 * sizeof(unsigned long)) + 1, 0);
+            mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            syscall(SYS_mbind, data, capacity, kMpolBind, mask.data(), mask.size() * 8 * sizeof(unsigned long) + 1, 0);
+        }
+
+        // Small pages are written even under transparent huge pages, which the kernel may fail to get
+        size_t page = backing == PageBacking::kHugetlbfs ? kHugePageSize : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto start = std::chrono::steady_clock::now();
+        if (opts_.prefault) {
+            opts_.prefault(node, data, capacity, page);
+        } else {
+            Prefault(node, data, capacity, page);
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            prefault_time_ += elapsed;
+        }
+
+        block->data = data;
+        block->capacity = capacity;
+        block->node = node;
+        block->backing = backing;
+        return true;
+    }
+
+    /**
+     * @brief Write every page of a block once with threads pinned to the cpus of its node.
+     *
+     * @param node The NUMA node, negative for threads not pinned.
+     * @param data The block.
+     * @param size The size in bytes.
+     * @param page The page size.
+     */
+    void Prefault(int node, char *data, size_t size, size_t page) {
+        std::vector<int> cpus = NodeCpus(node);
+        size_t threads = opts_.prefault_threads > 0 ? opts_.prefault_threads
+                         : cpus.empty()             ? std::max(std::thread::hardware_concurrency(), 1u)
+                                                    : cpus.size();
+        size_t pages = size / page;
+        threads = std::max<size_t>(std::min(threads, pages), 1);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                if (!cpus.empty()) {
+                    PinThreadToCpu(cpus[t % cpus.size()]);
+                }
+                for (size_t p = pages * t / threads; p < pages * (t + 1) / threads; p++) {
+                    *static_cast<volatile char *>(data + p * page) = 0;
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    ArenaOpts opts_;
+    size_t alignment_ = kCacheLineSize;
+
+    mutable std::mutex mutex_;
+    std::map<uint64_t, Block> blocks_;
+    uint64_t next_id_ = 0;
+    uint64_t reuses_ = 0;
+    uint64_t hugetlb_fallbacks_ = 0;
+    double prefault_time_ = 0;
+};
+
+inline void ArenaBuffer::Release() {
+    if (arena_ != nullptr) {
+        arena_->Release(block_);
+    }
+    arena_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace host_utils
@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Clock alignment of MPI ranks shared by the MPI micro-benchmarks.
+// The offset of the monotonic clock of every rank to the clock of rank 0 is estimated by NTP-style ping-pongs, keeping
+// the exchange of the smallest round-trip time, and the drift is fitted over the last estimations, so that the local
+// timestamps of all ranks are converted to one global timeline to tell which rank started late or stalled a round.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <vector>
+
+#include <mpi.h>
+
+namespace host_utils {
+
+/**
+ * @brief Get the time of the monotonic clock.
+ *
+ * @return The time in nanoseconds.
+ */
+inline int64_t MonotonicNs() {
+    timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// One estimation of the clock offset of a rank to rank 0.
+struct ClockSample {
+    // Local time of the estimation in nanoseconds.
+    int64_t local_ns = 0;
+
+    // Local time minus the time of rank 0 in nanoseconds.
+    double offset_ns = 0;
+
+    // Smallest round-trip time of the ping-pongs in nanoseconds, the offset being exact within half of it.
+    double rtt_ns = 0;
+};
+
+// Offset and drift of the clock of this rank to the clock of rank 0.
+class ClockSync {
+  public:
+    /**
+     * @brief Construct the clock alignment of a communicator, nothing is exchanged before Estimate().
+     *
+     * @param comm The communicator, rank 0 holding the reference clock.
+     * @param rounds The number of ping-pongs with every rank per estimation.
+     * @param history The number of last estimations the drift is fitted over.
+     */
+    explicit ClockSync(MPI_Comm comm, int rounds = 64, size_t history = 8)
+        : comm_(comm), rounds_(std::max(rounds, 1)), history_(std::max<size_t>(history, 1)) {
+        MPI_Comm_rank(comm_, &rank_);
+        MPI_Comm_size(comm_, &nranks_);
+    }
+
+    /**
+     * @brief Estimate the offset of every rank to rank 0, collective on the communicator.
+     *
+     * Rank 0 ping-pongs with the other ranks in turn, the offset of a round being the remote time minus the midpoint
+     * of the local send and receive times. Call it periodically, e.g. between the message sizes of a sweep, so that
+     * the drift is followed during long runs.
+     */
+    void Estimate() {
+        const int kTag = 0x5c10;
+        if (rank_ == 0) {
+            for (int peer = 1; peer < nranks_; peer++) {
+                double best[3] = {0, 0, -1};
+                for (int round = 0; round < rounds_; round++) {
+                    int64_t remote_ns = 0;
+                    int64_t send_ns = MonotonicNs();
+                    MPI_Send(&round, 1, MPI_INT, peer, kTag, comm_);
+                    MPI_Recv(&remote_ns, 1, MPI_INT64_T, peer, kTag, comm_, MPI_STATUS_IGNORE);
+                    int64_t recv_ns = MonotonicNs();
+                    double rtt_ns = static_cast<double>(recv_ns - send_ns);
+                    if (best[2] < 0 || rtt_ns < best[2]) {
+                        best[0] = static_cast<double>(remote_ns);
+                        best[1] = remote_ns - (send_ns + rtt_ns / 2);
+                        best[2] = rtt_ns;
+                    }
+                }
+                MPI_Send(best, 3, MPI_DOUBLE, peer, kTag, comm_);
+            }
+            Add({MonotonicNs(), 0, 0});
+        } else {
+            for (int round = 0; round < rounds_; round++) {
+                int index = 0;
+                MPI_Recv(&index, 1, MPI_INT, 0, kTag, comm_, MPI_STATUS_IGNORE);
+                int64_t remote_ns = MonotonicNs();
+                MPI_Send(&remote_ns, 1, MPI_INT64_T, 0, kTag, comm_);
+            }
+            double best[3] = {};
+            MPI_Recv(best, 3, MPI_DOUBLE, 0, kTag, comm_, MPI_STATUS_IGNORE);
+            Add({static_cast<int64_t>(best[0]), best[1], best[2]});
+        }
+    }
+
+    /**
+     * @brief Get the offset of the local clock to the clock of rank 0 at a local time.
+     *
+     * @param local_ns The local time in nanoseconds.
+     * @return The local time minus the time of rank 0 in nanoseconds, 0 before the first estimation.
+     */
+    double OffsetNs(int64_t local_ns) const { return intercept_ns_ + drift_ * (local_ns - reference_ns_); }
+
+    /**
+     * @brief Convert a local timestamp of the monotonic clock to the timeline of rank 0.
+     *
+     * @param local_ns The local time in nanoseconds.
+     * @return The time of rank 0 in nanoseconds.
+     */
+    double ToGlobal(int64_t local_ns) const { return local_ns - OffsetNs(local_ns); }
+
+    /**
+     * @brief Get the drift of the local clock to the clock of rank 0.
+     *
+     * @return The drift in parts per million, 0 until the estimations span one second.
+     */
+    double DriftPpm() const { return drift_ * 1e6; }
+
+    /**
+     * @brief Get the uncertainty of the last estimation.
+     *
+     * @return Half of the smallest round-trip time in nanoseconds.
+     */
+    double ErrorNs() const { return samples_.empty() ? 0 : samples_.back().rtt_ns / 2; }
+
+    /**
+     * @brief Get the last estimations.
+     *
+     * @return The estimations, oldest first.
+     */
+    const std::deque<ClockSample> &Samples() const { return samples_; }
+
+  private:
+    // Shortest time span of the estimations to fit the drift over.
+    static constexpr int64_t kMinDriftSpanNs = 1000000000;
+
+    /**
+     * @brief Add an estimation and fit the offset and drift over the kept ones by least squares.
+     *
+     * @param sample The estimation.
+     */
+    void Add(const ClockSample &sample) {
+        samples_.push_back(sample);
+        if (samples_.size() > history_) {
+            samples_.pop_front();
+        }
+        reference_ns_ = samples_.back().local_ns;
+        double mean_t = 0, mean_offset = 0;
+        for (const auto &s : samples_) {
+            mean_t += static_cast<double>(s.local_ns - reference_ns_) / samples_.size();
+            mean_offset += s.offset_ns / samples_.size();
+        }
+        double cov = 0, var = 0;
+        for (const auto &s : samples_) {
+            double dt = static_cast<double>(s.local_ns - reference_ns_) - mean_t;
+            cov += dt * (s.offset_ns - mean_offset);
+            var += dt * dt;
+        }
+        // Over shorter spans the fit gives the jitter of the round-trip times rather than the drift
+        bool long_enough = samples_.back().local_ns - samples_.front().local_ns >= kMinDriftSpanNs;
+        drift_ = var > 0 && long_enough ? cov / var : 0;
+        intercept_ns_ = mean_offset - drift_ * mean_t;
+    }
+
+    MPI_Comm comm_;
+    int rounds_;
+    size_t history_;
+    int rank_ = 0;
+    int nranks_ = 1;
+    std::deque<ClockSample> samples_;
+    int64_t reference_ns_ = 0;
+    double intercept_ns_ = 0;
+    double drift_ = 0;
+};
+
+// Start skew and straggler attribution over rounds of a collective operation.
+class SkewTracker {
+  public:
+    /**
+     * @brief Construct a tracker.
+     *
+     * @param nranks The number of ranks.
+     */
+    explicit SkewTracker(int nranks) : straggler_counts_(nranks, 0) {}
+
+    /**
+     * @brief Add one round.
+     *
+     * @param starts_ns The global start times of the round on every rank, in nanoseconds.
+     */
+    void AddRound(const double *starts_ns) {
+        auto minmax = std::minmax_element(starts_ns, starts_ns + straggler_counts_.size());
+        double skew_ns = *minmax.second - *minmax.first;
+        skew_sum_ns_ += skew_ns;
+        max_skew_ns_ = std::max(max_skew_ns_, skew_ns);
+        straggler_counts_[minmax.second - starts_ns]++;
+        rounds_++;
+    }
+
+    /**
+     * @brief Get the average start skew, the latest minus the earliest start of a round.
+     *
+     * @return The skew in nanoseconds, 0 if there is no round.
+     */
+    double MeanSkewNs() const { return rounds_ > 0 ? skew_sum_ns_ / rounds_ : 0; }
+
+    /**
+     * @brief Get the largest start skew.
+     *
+     * @return The skew in nanoseconds.
+     */
+    double MaxSkewNs() const { return max_skew_ns_; }
+
+    /**
+     * @brief Get the number of rounds.
+     */
+    uint64_t Rounds() const { return rounds_; }
+
+    /**
+     * @brief Get the ranks that started last most often.
+     *
+     * @param top The number of ranks to return.
+     * @return The ranks and the number of rounds they started last, most often first.
+     */
+    std::vector<std::pair<int, uint64_t>> Stragglers(size_t top) const {
+        std::vector<std::pair<int, uint64_t>> ranks;
+        for (size_t r = 0; r < straggler_counts_.size(); r++) {
+            if (straggler_counts_[r] > 0) {
+                ranks.emplace_back(static_cast<int>(r), straggler_counts_[r]);
+            }
+        }
+        std::stable_sort(ranks.begin(), ranks.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+        ranks.resize(std::min(top, ranks.size()));
+        return ranks;
+    }
+
+  private:
+    std::vector<uint64_t> straggler_counts_;
+    uint64_t rounds_ = 0;
+    double skew_sum_ns_ = 0;
+    double max_skew_ns_ = 0;
+};
+
+} // namespace host_utils
@@ -0,0 +1,160 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Host CPU helpers shared by the CPU-side micro-benchmarks: cpu and integer list parsing, thread pinning and
+// per-core utilization sampling from /proc/stat.
+
+#pragma once
+
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+namespace host_utils {
+
+/**
+ * @brief Parse a cpu list string such as "0-3,8,10-11" into a list of cpu ids.
+ *
+ * @param cpu_list The cpu list string in the same format as taskset/numactl.
+ * @return The list of cpu ids in the order they appear, empty if the string is empty.
+ */
+inline std::vector<int> ParseCpuList(const std::string &cpu_list) {
+    std::vector<int> cpus;
+    std::stringstream ss(cpu_list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t dash = item.find('-');
+        if (dash == std::string::npos) {
+            cpus.push_back(std::stoi(item));
+        } else {
+            int first = std::stoi(item.substr(0, dash));
+            int last = std::stoi(item.substr(dash + 1));
+            if (first > last) {
+                throw std::invalid_argument("Invalid cpu range: " + item);
+            }
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+/**
+ * @brief Format a list of cpu ids as a cpu list string such as "0-3,8,10-11", the inverse of ParseCpuList().
+ *
+ * @param cpus The cpu ids, in ascending order.
+ * @return The cpu list string, empty if there is no cpu.
+ */
+inline std::string FormatCpuList(const std::vector<int> &cpus) {
+    std::string list;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            j++;
+        }
+        list += (list.empty() ? "" : ",") + std::to_string(cpus[i]);
+        if (j > i) {
+            list += "-" + std::to_string(cpus[j]);
+        }
+        i = j + 1;
+    }
+    return list;
+}
+
+/**
+ * @brief Parse a comma separated list of integers such as "64,256,1024".
+ *
+ * @param str The string to parse.
+ * @param values The parsed values.
+ * @return true if every element is a valid integer and the list is not empty.
+ */
+inline bool ParseIntList(const char *str, std::vector<int> *values) {
+    values->clear();
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int value = 0;
+        if (1 != sscanf(item.c_str(), "%d", &value)) {
+            return false;
+        }
+        values->push_back(value);
+    }
+    return !values->empty();
+}
+
+/**
+ * @brief Pin the calling thread to a single cpu.
+ *
+ * @param cpu The cpu id to pin to, negative value means no pinning.
+ * @return 0 on success, the pthread error number otherwise.
+ */
+inline int PinThreadToCpu(int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(cpu, &cpuset);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+// Accumulated jiffies of one cpu read from /proc/stat.
+struct CpuTimes {
+    uint64_t busy = 0;
+    uint64_t total = 0;
+};
+
+/**
+ * @brief Read the accumulated busy and total time of every cpu from /proc/stat.
+ *
+ * @return Map from cpu id to its accumulated times, empty if /proc/stat is not readable.
+ */
+inline std::map<int, CpuTimes> ReadCpuTimes() {
+    std::map<int, CpuTimes> times;
+    std::ifstream in("/proc/stat");
+    std::string line;
+    while (std::getline(in, line)) {
+        // Only per-cpu lines such as "cpu3 ..." are of interest, skip the aggregated "cpu " line
+        if (line.compare(0, 3, "cpu") != 0 || line.size() < 4 || !std::isdigit(line[3])) {
+            continue;
+        }
+        std::istringstream fields(line.substr(3));
+        int cpu = 0;
+        uint64_t user = 0, nice = 0, system = 0, idle = 0, iowait = 0, irq = 0, softirq = 0, steal = 0;
+        fields >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq >> steal;
+        CpuTimes &t = times[cpu];
+        t.busy = user + nice + system + irq + softirq + steal;
+        t.total = t.busy + idle + iowait;
+    }
+    return times;
+}
+
+/**
+ * @brief Compute the utilization of one cpu between two /proc/stat samples.
+ *
+ * @param begin The sample taken at the beginning of the interval.
+ * @param end The sample taken at the end of the interval.
+ * @return The utilization in percent, 0 if no time elapsed.
+ */
+inline double CpuUtilization(const CpuTimes &begin, const CpuTimes &end) {
+    uint64_t total = end.total - begin.total;
+    if (total == 0) {
+        return 0;
+    }
+    return 100.0 * (end.busy - begin.busy) / total;
+}
+
+} // namespace host_utils
@@ -0,0 +1,314 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Minimal io_uring wrapper over the raw system calls shared by the storage micro-benchmarks, so that they build
+// against the kernel uapi headers alone without liburing.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace host_utils {
+
+/**
+ * @brief A single io_uring instance with its submission and completion rings mapped.
+ *
+ * The instance is not thread safe, every thread is expected to own its own ring.
+ */
+class IoUring {
+  public:
+    IoUring() = default;
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+    ~IoUring() { Close(); }
+
+    /**
+     * @brief Create the ring and map its submission queue, completion queue and SQE array.
+     *
+     * @param entries The number of submission queue entries.
+     * @param sqpoll Whether to let a kernel thread poll the submission queue.
+     * @param sq_thread_idle The idle time in milliseconds before the polling thread sleeps.
+     * @return 0 on success, negative errno on failure.
+     */
+    int Init(unsigned entries, bool sqpoll = false, unsigned sq_thread_idle = 2000) {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        if (sqpoll) {
+            params.flags |= IORING_SETUP_SQPOLL;
+            params.sq_thread_idle = sq_thread_idle;
+        }
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0) {
+            return -errno;
+        }
+        flags_ = params.flags;
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = MapRing(sq_ring_size_, IORING_OFF_SQ_RING);
+        cq_ring_ = single_mmap ? sq_ring_ : MapRing(cq_ring_size_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = MapRing(sqes_size_, IORING_OFF_SQES);
+        if (sq_ring_ == nullptr || cq_ring_ == nullptr || sqes == nullptr) {
+            int err = errno;
+            if (sqes != nullptr) {
+                munmap(sqes, sqes_size_);
+            }
+            Close();
+            return -err;
+        }
+        sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+        char *sq = static_cast<char *>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_flags_ = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+        sqe_tail_ = *sq_tail_;
+
+        char *cq = static_cast<char *>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        return 0;
+    }
+
+    /**
+     * @brief Unmap the rings and close the ring fd.
+     */
+    void Close() {
+        if (sqes_ != nullptr) {
+            munmap(sqes_, sqes_size_);
+            sqes_ = nullptr;
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            munmap(sq_ring_, sq_ring_size_);
+        }
+        sq_ring_ = cq_ring_ = nullptr;
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    /**
+     * @brief Get a zeroed submission queue entry to fill.
+     *
+     * @return The entry, nullptr if the submission queue is full.
+     */
+    io_uring_sqe *GetSqe() {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sqe_tail_ - head >= sq_entries_) {
+            return nullptr;
+        }
+        unsigned idx = sqe_tail_ & sq_mask_;
+        io_uring_sqe *sqe = &sqes_[idx];
+        memset(sqe, 0, sizeof(*sqe));
+        sq_array_[idx] = idx;
+        sqe_tail_++;
+        return sqe;
+    }
+
+    /**
+     * @brief Publish the filled entries to the kernel and optionally wait for completions.
+     *
+     * @param wait_nr The number of completions to wait for.
+     * @return The number of entries submitted, negative errno on failure.
+     */
+    int Submit(unsigned wait_nr = 0) {
+        unsigned to_submit = sqe_tail_ - *sq_tail_;
+        __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+        unsigned enter_flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+        if (flags_ & IORING_SETUP_SQPOLL) {
+            // The polling thread picks up the entries by itself unless it went to sleep
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (__atomic_load_n(sq_flags_, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+                enter_flags |= IORING_ENTER_SQ_WAKEUP;
+            }
+            if (enter_flags != 0 && Enter(to_submit, wait_nr, enter_flags) < 0) {
+                return -errno;
+            }
+            return static_cast<int>(to_submit);
+        }
+        if (to_submit == 0 && wait_nr == 0) {
+            return 0;
+        }
+        int ret = Enter(to_submit, wait_nr, enter_flags);
+        return ret < 0 ? -errno : ret;
+    }
+
+    /**
+     * @brief Get the next completion queue entry without waiting.
+     *
+     * @return The entry, nullptr if there is no completion. Call SeenCqe() once it is consumed.
+     */
+    io_uring_cqe *PeekCqe() {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            return nullptr;
+        }
+        return &cqes_[head & cq_mask_];
+    }
+
+    /**
+     * @brief Wait for the next completion queue entry.
+     *
+     * @param cqe The entry. Call SeenCqe() once it is consumed.
+     * @return 0 on success, negative errno on failure.
+     */
+    int WaitCqe(io_uring_cqe **cqe) {
+        while ((*cqe = PeekCqe()) == nullptr) {
+            if (Enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                return -errno;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Mark the entry returned by PeekCqe() or WaitCqe() as consumed.
+     */
+    void SeenCqe() { __atomic_store_n(cq_head_, *cq_head_ + 1, __ATOMIC_RELEASE); }
+
+    /**
+     * @brief Register buffers used by the fixed read/write operations.
+     *
+     * @param iovs The buffers.
+     * @param nr The number of buffers.
+     * @return 0 on success, negative errno on failure.
+     */
+    int RegisterBuffers(const iovec *iovs, unsigned nr) { return Register(IORING_REGISTER_BUFFERS, iovs, nr); }
+
+    /**
+     * @brief Register files referenced by index with IOSQE_FIXED_FILE.
+     *
+     * @param fds The files.
+     * @param nr The number of files.
+     * @return 0 on success, negative errno on failure.
+     */
+    int RegisterFiles(const int *fds, unsigned nr) { return Register(IORING_REGISTER_FILES, fds, nr); }
+
+  private:
+    void *MapRing(size_t size, off_t offset) {
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, offset);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    int Enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    int Register(unsigned opcode, const void *arg, unsigned nr) {
+        return syscall(__NR_io_uring_register, fd_, opcode, arg, nr) < 0 ? -errno : 0;
+    }
+
+    int fd_ = -1;
+    unsigned flags_ = 0;
+
+    void *sq_ring_ = nullptr;
+    void *cq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_flags_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sqe_tail_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+
+/**
+ * @brief Fill a read/write style submission queue entry.
+ *
+ * @param sqe The entry.
+ * @param opcode The operation, e.g. IORING_OP_READ or IORING_OP_WRITE_FIXED.
+ * @param fd The file, or its index when IOSQE_FIXED_FILE is set.
+ * @param addr The buffer address.
+ * @param len The buffer length.
+ * @param offset The file offset.
+ * @param user_data The value returned in the completion.
+ */
+inline void PrepRw(io_uring_sqe *sqe, uint8_t opcode, int fd, const void *addr, unsigned len, uint64_t offset,
+                   uint64_t user_data) {
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+}
+
+/**
+ * @brief Fill an openat entry that installs the opened file in a slot of the registered file table.
+ *
+ * @param sqe The entry.
+ * @param path The path, resolved relative to the current directory.
+ * @param flags The open flags.
+ * @param slot The slot of the registered file table, then used as fd with IOSQE_FIXED_FILE.
+ * @param user_data The value returned in the completion.
+ * @param mode The mode of the file created with O_CREAT.
+ */
+inline void PrepOpenatDirect(io_uring_sqe *sqe, const char *path, int flags, unsigned slot, uint64_t user_data,
+                             mode_t mode = 0) {
+    PrepRw(sqe, IORING_OP_OPENAT, AT_FDCWD, path, mode, 0, user_data);
+    sqe->open_flags = flags;
+    sqe->file_index = slot + 1;
+}
+
+/**
+ * @brief Fill a close entry that releases a slot of the registered file table.
+ *
+ * @param sqe The entry.
+ * @param slot The slot of the registered file table.
+ * @param user_data The value returned in the completion.
+ */
+inline void PrepCloseDirect(io_uring_sqe *sqe, unsigned slot, uint64_t user_data) {
+    PrepRw(sqe, IORING_OP_CLOSE, 0, nullptr, 0, 0, user_data);
+    sqe->file_index = slot + 1;
+}
+
+/**
+ * @brief Fill a statx entry.
+ *
+ * @param sqe The entry.
+ * @param path The path, resolved relative to the current directory.
+ * @param mask The fields to get, e.g. STATX_BASIC_STATS.
+ * @param buf The buffer of the result, which must stay valid until the completion.
+ * @param user_data The value returned in the completion.
+ */
+inline void PrepStatx(io_uring_sqe *sqe, const char *path, unsigned mask, struct statx *buf, uint64_t user_data) {
+    PrepRw(sqe, IORING_OP_STATX, AT_FDCWD, path, mask, reinterpret_cast<uint64_t>(buf), user_data);
+}
+
+} // namespace host_utils
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Storage helpers shared by the file system and disk micro-benchmarks.
+
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <strings.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace host_utils {
+
+// Alignment of O_DIRECT buffers, offsets and sizes.
+constexpr size_t kDirectAlignment = 4096;
+
+/**
+ * @brief Parse a size with an optional k/m/g/t suffix in powers of 1024, e.g. "128k" or "4GiB".
+ *
+ * @param str The string to parse.
+ * @param value The parsed size in bytes.
+ * @return true if the size is valid.
+ */
+inline bool ParseSize(const char *str, uint64_t *value) {
+    char *end = nullptr;
+    double number = strtod(str, &end);
+    if (end == str || number < 0) {
+        return false;
+    }
+    uint64_t multiplier = 1;
+    switch (tolower(*end)) {
+    case 't':
+        multiplier <<= 10;
+        // fall through
+    case 'g':
+        multiplier <<= 10;
+        // fall through
+    case 'm':
+        multiplier <<= 10;
+        // fall through
+    case 'k':
+        multiplier <<= 10;
+        end++;
+        break;
+    default:
+        break;
+    }
+    *value = static_cast<uint64_t>(number * multiplier);
+    return *end == '\0' || strcasecmp(end, "b") == 0 || strcasecmp(end, "ib") == 0;
+}
+
+/**
+ * @brief Evict the pages of a file from the page cache, so that the next read is served by the storage.
+ *
+ * Dirty pages are written back first, since only clean pages can be dropped.
+ *
+ * @param path The file path.
+ * @return true on success.
+ */
+inline bool DropFileCache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return ok;
+}
+
+} // namespace host_utils
@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Socket helpers shared by the host network micro-benchmarks.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+namespace host_utils {
+
+/**
+ * @brief Fill an IPv4 socket address.
+ *
+ * @param addr The dotted IPv4 address.
+ * @param port The port.
+ * @param sockaddr The socket address to fill.
+ * @return true if the address is valid.
+ */
+inline bool FillSockAddr(const std::string &addr, int port, sockaddr_in *sockaddr) {
+    memset(sockaddr, 0, sizeof(*sockaddr));
+    sockaddr->sin_family = AF_INET;
+    sockaddr->sin_port = htons(port);
+    return inet_pton(AF_INET, addr.c_str(), &sockaddr->sin_addr) == 1;
+}
+
+/**
+ * @brief Read the TcpExt counters from /proc/net/netstat, e.g. ListenOverflows and ListenDrops.
+ *
+ * The file holds pairs of lines, a header line with counter names followed by a line with their values.
+ *
+ * @return Map from counter name to value, empty if the file is not readable.
+ */
+inline std::map<std::string, uint64_t> ReadTcpExtCounters() {
+    std::map<std::string, uint64_t> counters;
+    std::ifstream in("/proc/net/netstat");
+    std::string names, values;
+    while (std::getline(in, names) && std::getline(in, values)) {
+        if (names.compare(0, 7, "TcpExt:") != 0) {
+            continue;
+        }
+        std::istringstream name_stream(names.substr(7)), value_stream(values.substr(7));
+        std::string name;
+        uint64_t value = 0;
+        while (name_stream >> name && value_stream >> value) {
+            counters[name] = value;
+        }
+    }
+    return counters;
+}
+
+/**
+ * @brief Read an integer sysctl value from /proc/sys.
+ *
+ * @param path The path under /proc/sys, e.g. "net/core/somaxconn".
+ * @param default_value The value returned if the sysctl is not readable.
+ * @return The sysctl value.
+ */
+inline int64_t ReadSysctl(const std::string &path, int64_t default_value) {
+    std::ifstream in("/proc/sys/" + path);
+    int64_t value = default_value;
+    if (!(in >> value)) {
+        return default_value;
+    }
+    return value;
+}
+
+} // namespace host_utils
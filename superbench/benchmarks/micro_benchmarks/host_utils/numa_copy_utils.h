@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// NUMA copy matrix shared by cpu_copy and the numa_copy plugin of the host runner.
+// Every pair of NUMA nodes with memory is copied between with memcpy by the cpus of the source node, or of the
+// destination node when the source has none. With the executing node swept, every pair, within a node too, is copied by
+// the cpus of every node that has some instead, such as a proxy or I/O thread on a third socket. The bandwidth is
+// reported in MB/s and the latency in ns/byte.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace host_utils {
+
+// One copy of the matrix.
+struct NumaCopy {
+    // Node of the source buffer.
+    int src_node = 0;
+
+    // Node of the destination buffer.
+    int dst_node = 0;
+
+    // Node whose cpus run the copy.
+    int exec_node = 0;
+
+    // Whether the executing node is swept, named in the metrics.
+    bool sweep_exec = false;
+
+    /**
+     * @brief Get the metric name of the copy, without the _bw and _lat suffixes.
+     */
+    std::string Name() const {
+        std::string name = "mem_bandwidth_matrix_numa_" + std::to_string(src_node) + "_" + std::to_string(dst_node);
+        return sweep_exec ? name + "_by_numa_" + std::to_string(exec_node) : name;
+    }
+};
+
+/**
+ * @brief List the copies of the matrix.
+ *
+ * @param mem_nodes The nodes with memory, in ascending order.
+ * @param cpu_nodes The nodes with cpus to copy with, in ascending order.
+ * @param local Whether to copy within a node too without sweeping the executing node.
+ * @param sweep_exec Whether every pair, within a node too, is copied by the cpus of every node of cpu_nodes.
+ * @return The copies, by source then destination then executing node.
+ */
+inline std::vector<NumaCopy> NumaCopyMatrix(const std::vector<int> &mem_nodes, const std::vector<int> &cpu_nodes,
+                                            bool local, bool sweep_exec) {
+    auto has_cpus = [&](int node) { return std::find(cpu_nodes.begin(), cpu_nodes.end(), node) != cpu_nodes.end(); };
+    std::vector<NumaCopy> copies;
+    for (int src_node : mem_nodes) {
+        for (int dst_node : mem_nodes) {
+            if (src_node == dst_node && !local && !sweep_exec) {
+                continue;
+            }
+            if (sweep_exec) {
+                for (int exec_node : cpu_nodes) {
+                    copies.push_back({src_node, dst_node, exec_node, true});
+                }
+            } else if (has_cpus(src_node) || has_cpus(dst_node)) {
+                copies.push_back({src_node, dst_node, has_cpus(src_node) ? src_node : dst_node, false});
+            }
+        }
+    }
+    return copies;
+}
+
+/**
+ * @brief Copy the share of one of the threads copying a buffer.
+ *
+ * @param dst The destination buffer.
+ * @param src The source buffer.
+ * @param size The size of the buffers in bytes.
+ * @param index The index of the thread.
+ * @param count The number of threads.
+ */
+inline void NumaCopySlice(char *dst, const char *src, uint64_t size, int index, int count) {
+    uint64_t begin = size * index / count;
+    uint64_t end = size * (index + 1) / count;
+    memcpy(dst + begin, src + begin, end - begin);
+}
+
+/**
+ * @brief Check that the destination buffer holds the source after a copy, reporting a mismatch on stderr.
+ *
+ * @return true if the buffers are equal.
+ */
+inline bool NumaCopyCheck(const NumaCopy &copy, const char *dst, const char *src, uint64_t size) {
+    if (memcmp(dst, src, size) == 0) {
+        return true;
+    }
+    std::cerr << "Data integrity check failed from NUMA node " << copy.src_node << " to " << copy.dst_node << "."
+              << std::endl;
+    return false;
+}
+
+/**
+ * @brief Get the bandwidth of a copy in MB/s.
+ *
+ * @param size The size of the copy in bytes.
+ * @param time_ns The time of one copy in nanoseconds.
+ */
+inline double NumaCopyBandwidth(uint64_t size, double time_ns) { return size / (time_ns / 1e9) / 1e6; }
+
+/**
+ * @brief Get the latency of a copy in ns/byte.
+ *
+ * @param size The size of the copy in bytes.
+ * @param time_ns The time of one copy in nanoseconds.
+ */
+inline double NumaCopyLatency(uint64_t size, double time_ns) { return time_ns / size; }
+
+} // namespace host_utils
@@ -0,0 +1,402 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Result records shared by the CPU-side micro-benchmarks.
+// A benchmark emits typed records (metric or samples, with unit and tags) through a ResultEmitter, which writes them
+// to a file descriptor as human-readable "name: value" lines, JSON Lines, or a compact binary framing. The records are
+// decoded by superbench/benchmarks/micro_benchmarks/result_records.py.
+//
+// JSON Lines, one record per line:
+//   {"v":1,"kind":"metric","name":"...","unit":"...","tags":{"k":"v"},"value":1.5}
+//   {"v":1,"kind":"samples","name":"...","unit":"...","tags":{},"samples":[1.5,2.5]}
+// Binary, little-endian: the magic "SBRR" and a u8 version, then for every record a u32 length of the rest of the
+// record, a u8 kind (1 metric, 2 samples), the name and the unit as u16 length and bytes, a u16 count of tags each as
+// two such strings, then an f64 value for a metric, or a u64 count and as many f64 for samples.
+//
+// With --baseline, every metric is also checked against the rules of baseline_utils.h as it is emitted, the failures
+// are reported on stderr and counted in a final baseline_failures metric. With --fail_fast, Stopped() turns true at the
+// first confirmed failure, for the benchmark to skip its remaining iterations and configurations and exit non-zero.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include "baseline_utils.h"
+#include "stats_utils.h"
+
+namespace host_utils {
+
+// Version of the records, bumped on incompatible changes.
+constexpr int kResultRecordVersion = 1;
+
+// Formats of the records.
+enum class ResultFormat { kText, kJsonLines, kBinary };
+
+// Tags of a record, in order.
+using ResultTags = std::vector<std::pair<std::string, std::string>>;
+
+// Options of the result emitter, a member of the options of every benchmark.
+struct ResultOpts {
+    // Format of the records.
+    ResultFormat format = ResultFormat::kText;
+
+    // File descriptor to write the records to.
+    int fd = STDOUT_FILENO;
+
+    // Rules to check the metrics against, none if null.
+    std::shared_ptr<const Baseline> baseline;
+
+    // Confidence of the checks of samples and per-iteration observations.
+    double confidence = 0.99;
+
+    // Whether to stop the benchmark at the first confirmed failure.
+    bool fail_fast = false;
+};
+
+// Values of the long options of the result emitter, above those of the benchmarks.
+enum ResultOptIdx { kResultFormatOpt = 1024, kResultFdOpt, kBaselineOpt, kBaselineConfidenceOpt, kFailFastOpt };
+
+// Long options of the result emitter, to list after those of a benchmark.
+#define RESULT_LONG_OPTIONS                                                                                            \
+    {"result_format", required_argument, nullptr, host_utils::kResultFormatOpt},                                      \
+        {"result_fd", required_argument, nullptr, host_utils::kResultFdOpt},                                           \
+        {"baseline", required_argument, nullptr, host_utils::kBaselineOpt},                                            \
+        {"baseline_confidence", required_argument, nullptr, host_utils::kBaselineConfidenceOpt},                       \
+        {"fail_fast", no_argument, nullptr, host_utils::kFailFastOpt}
+
+/**
+ * @brief Check whether a getopt_long() value is an option of the result emitter.
+ *
+ * @param opt The option value.
+ * @return true if it is one of RESULT_LONG_OPTIONS.
+ */
+inline bool IsResultOpt(int opt) { return opt >= kResultFormatOpt && opt <= kFailFastOpt; }
+
+/**
+ * @brief Parse an option of the result emitter.
+ *
+ * @param opt The option value.
+ * @param arg The option argument.
+ * @param opts The parsed options.
+ * @return true if the argument is valid.
+ */
+inline bool ParseResultOpt(int opt, const char *arg, ResultOpts *opts) {
+    if (opt == kResultFdOpt) {
+        return 1 == sscanf(arg, "%d", &opts->fd) && opts->fd >= 0;
+    } else if (opt == kBaselineOpt) {
+        auto baseline = std::make_shared<Baseline>();
+        opts->baseline = baseline;
+        return baseline->Load(arg);
+    } else if (opt == kBaselineConfidenceOpt) {
+        return 1 == sscanf(arg, "%lf", &opts->confidence) && opts->confidence > 0.5 && opts->confidence < 1;
+    } else if (opt == kFailFastOpt) {
+        opts->fail_fast = true;
+        return true;
+    }
+    const std::pair<const char *, ResultFormat> formats[] = {
+        {"text", ResultFormat::kText}, {"jsonl", ResultFormat::kJsonLines}, {"binary", ResultFormat::kBinary}};
+    for (const auto &format : formats) {
+        if (strcmp(arg, format.first) == 0) {
+            opts->format = format.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Usage of the options of the result emitter.
+constexpr const char *kResultOptsUsage = "[--result_format text|jsonl|binary] [--result_fd <fd>] "
+                                         "[--baseline <rules>] [--baseline_confidence <0.5-1>] [--fail_fast]";
+
+// Writer of the result records of a benchmark.
+class ResultEmitter {
+  public:
+    /**
+     * @brief Create an emitter, writing the binary header right away.
+     *
+     * @param opts The options.
+     */
+    explicit ResultEmitter(const ResultOpts &opts) : opts_(opts) {
+        if (opts_.format == ResultFormat::kBinary) {
+            buffer_.append("SBRR", 4);
+            buffer_.push_back(static_cast<char>(kResultRecordVersion));
+            complete_ = buffer_.size();
+        }
+        if (opts_.baseline) {
+            checker_.reset(new BaselineChecker(opts_.baseline, opts_.confidence));
+        }
+    }
+
+    ~ResultEmitter() {
+        if (checker_) {
+            Metric("baseline_failures", checker_->Failures());
+        }
+        Flush();
+    }
+
+    ResultEmitter(const ResultEmitter &) = delete;
+    ResultEmitter &operator=(const ResultEmitter &) = delete;
+
+    /**
+     * @brief Emit a metric.
+     *
+     * @param name The metric name.
+     * @param value The value.
+     * @param unit The unit, e.g. "GB/s", empty if dimensionless.
+     * @param tags The tags, e.g. {{"method", "sync"}}.
+     */
+    void Metric(const std::string &name, double value, const std::string &unit = "", const ResultTags &tags = {}) {
+        std::string text;
+        if (opts_.format == ResultFormat::kText) {
+            char str[32];
+            snprintf(str, sizeof(str), "%.9g", value);
+            text = name + ": " + str;
+        }
+        Metric(name, value, unit, tags, text);
+    }
+
+    /**
+     * @brief Emit a metric with its own line in the text format, for benchmarks keeping the text output they had
+     * before the records.
+     *
+     * @param name The metric name.
+     * @param value The value.
+     * @param unit The unit.
+     * @param tags The tags.
+     * @param text The line in the text format, without the newline, empty if the metric is on the line of another.
+     */
+    void Metric(const std::string &name, double value, const std::string &unit, const ResultTags &tags,
+                const std::string &text) {
+        if (opts_.format == ResultFormat::kText) {
+            buffer_ += text.empty() ? text : text + "\n";
+        } else if (opts_.format == ResultFormat::kJsonLines) {
+            JsonHead("metric", name, unit, tags);
+            buffer_ += ",\"value\":";
+            JsonNumber(value);
+            buffer_ += "}\n";
+        } else {
+            size_t start = BinaryHead(1, name, unit, tags);
+            BinaryPut(value);
+            BinaryEnd(start);
+        }
+        Flush();
+        if (checker_) {
+            Report(checker_->CheckValue(name, value), name, value);
+        }
+    }
+
+    /**
+     * @brief Emit the samples of a metric, left out of the text format.
+     *
+     * @param name The metric name.
+     * @param samples The samples.
+     * @param unit The unit.
+     * @param tags The tags.
+     */
+    void Samples(const std::string &name, const std::vector<double> &samples, const std::string &unit = "",
+                 const ResultTags &tags = {}) {
+        if (opts_.format == ResultFormat::kText) {
+            return;
+        } else if (opts_.format == ResultFormat::kJsonLines) {
+            JsonHead("samples", name, unit, tags);
+            buffer_ += ",\"samples\":[";
+            for (size_t i = 0; i < samples.size(); i++) {
+                if (i > 0) {
+                    buffer_ += ',';
+                }
+                JsonNumber(samples[i]);
+                FlushIfFull();
+            }
+            buffer_ += "]}\n";
+        } else {
+            size_t start = BinaryHead(2, name, unit, tags);
+            BinaryPut(static_cast<uint64_t>(samples.size()));
+            buffer_.append(reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(double));
+            BinaryEnd(start);
+        }
+        Flush();
+        if (checker_) {
+            Report(checker_->CheckSamples(name, samples), name, Mean(samples));
+        }
+    }
+
+    /**
+     * @brief Check one more observation of a metric against the baseline without emitting it, e.g. the value of an
+     * iteration, so that a benchmark can stop before its remaining iterations.
+     *
+     * @param name The metric name.
+     * @param value The value.
+     * @return true if the benchmark should stop, see Stopped().
+     */
+    bool Observe(const std::string &name, double value) {
+        if (checker_) {
+            Report(checker_->Observe(name, value), name, value);
+        }
+        return Stopped();
+    }
+
+    /**
+     * @brief Check whether the benchmark should stop, after a confirmed failure with --fail_fast.
+     *
+     * @return true to stop.
+     */
+    bool Stopped() const { return opts_.fail_fast && checker_ && checker_->Failures() > 0; }
+
+    /**
+     * @brief Write the buffered records, done after every record so that results stream out as they are measured.
+     *
+     * @return true on success.
+     */
+    bool Flush() {
+        if (opts_.fd == STDOUT_FILENO) {
+            // Keep the order with the other output of the benchmark
+            std::cout.flush();
+            fflush(stdout);
+        }
+        // A binary record is written whole, since its length is patched in after its content
+        size_t size = opts_.format == ResultFormat::kBinary ? complete_ : buffer_.size();
+        size_t offset = 0;
+        while (offset < size) {
+            ssize_t ret = write(opts_.fd, buffer_.data() + offset, size - offset);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            } else if (ret < 0) {
+                std::cerr << "Failed to write the results to fd " << opts_.fd << ". ERROR: " << strerror(errno)
+                          << std::endl;
+                buffer_.clear();
+                complete_ = 0;
+                return false;
+            }
+            offset += ret;
+        }
+        buffer_.erase(0, size);
+        complete_ = 0;
+        return true;
+    }
+
+  private:
+    void Report(BaselineVerdict verdict, const std::string &name, double value) {
+        if (verdict != BaselineVerdict::kFail || reported_.count(name) > 0) {
+            return;
+        }
+        reported_.insert(name);
+        const BaselineRule *rule = opts_.baseline->Find(name);
+        std::cerr << "Baseline check failed: " << name << " is " << value << ", expected " << rule->expected
+                  << " within " << rule->tolerance * 100 << "% by rule " << rule->pattern << "." << std::endl;
+    }
+
+    // Size of the buffer that triggers a write while emitting samples.
+    static constexpr size_t kFlushSize = 1 << 20;
+
+    void FlushIfFull() {
+        if (buffer_.size() >= kFlushSize) {
+            Flush();
+        }
+    }
+
+    void JsonString(const std::string &str) {
+        buffer_ += '"';
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                buffer_ += '\\';
+                buffer_ += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                buffer_ += escaped;
+            } else {
+                buffer_ += c;
+            }
+        }
+        buffer_ += '"';
+    }
+
+    void JsonNumber(double value) {
+        // JSON has no NaN nor infinity
+        if (!std::isfinite(value)) {
+            buffer_ += "null";
+            return;
+        }
+        // The shortest of 15 and 17 digits that reads back the same value
+        char str[32];
+        snprintf(str, sizeof(str), "%.15g", value);
+        if (strtod(str, nullptr) != value) {
+            snprintf(str, sizeof(str), "%.17g", value);
+        }
+        buffer_ += str;
+    }
+
+    void JsonHead(const char *kind, const std::string &name, const std::string &unit, const ResultTags &tags) {
+        buffer_ += "{\"v\":" + std::to_string(kResultRecordVersion) + ",\"kind\":\"" + kind + "\",\"name\":";
+        JsonString(name);
+        buffer_ += ",\"unit\":";
+        JsonString(unit);
+        buffer_ += ",\"tags\":{";
+        for (size_t i = 0; i < tags.size(); i++) {
+            buffer_ += i > 0 ? "," : "";
+            JsonString(tags[i].first);
+            buffer_ += ':';
+            JsonString(tags[i].second);
+        }
+        buffer_ += '}';
+    }
+
+    template <typename T> void BinaryPut(T value) {
+        buffer_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void BinaryString(const std::string &str) {
+        uint16_t len = static_cast<uint16_t>(std::min<size_t>(str.size(), UINT16_MAX));
+        BinaryPut(len);
+        buffer_.append(str.data(), len);
+    }
+
+    size_t BinaryHead(uint8_t kind, const std::string &name, const std::string &unit, const ResultTags &tags) {
+        size_t start = buffer_.size();
+        BinaryPut(static_cast<uint32_t>(0));
+        BinaryPut(kind);
+        BinaryString(name);
+        BinaryString(unit);
+        BinaryPut(static_cast<uint16_t>(tags.size()));
+        for (const auto &tag : tags) {
+            BinaryString(tag.first);
+            BinaryString(tag.second);
+        }
+        return start;
+    }
+
+    void BinaryEnd(size_t start) {
+        uint32_t len = static_cast<uint32_t>(buffer_.size() - start - sizeof(uint32_t));
+        memcpy(&buffer_[start], &len, sizeof(len));
+        complete_ = buffer_.size();
+    }
+
+    ResultOpts opts_;
+    std::string buffer_;
+
+    // Size of the complete binary records at the start of the buffer.
+    size_t complete_ = 0;
+
+    // Checker of the metrics against the baseline, null without --baseline.
+    std::unique_ptr<BaselineChecker> checker_;
+
+    // Failed metrics already reported.
+    std::set<std::string> reported_;
+};
+
+} // namespace host_utils
@@ -0,0 +1,153 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Statistics helpers shared by the CPU-side micro-benchmarks.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace host_utils {
+
+// Percentiles reported by the latency metrics of the CPU-side micro-benchmarks.
+const std::vector<double> kLatencyPercentiles = {50, 90, 95, 99, 99.9};
+
+/**
+ * @brief Get a percentile of sorted samples using the nearest-rank method.
+ *
+ * @param sorted The samples sorted in ascending order.
+ * @param percentile The percentile in (0, 100].
+ * @return The percentile value, 0 if there is no sample.
+ */
+inline double Percentile(const std::vector<double> &sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+    rank = std::min(std::max(rank, static_cast<size_t>(1)), sorted.size());
+    return sorted[rank - 1];
+}
+
+/**
+ * @brief Get the arithmetic mean of samples.
+ *
+ * @param samples The samples.
+ * @return The mean value, 0 if there is no sample.
+ */
+inline double Mean(const std::vector<double> &samples) {
+    if (samples.empty()) {
+        return 0;
+    }
+    return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+/**
+ * @brief Format a percentile for metric names, e.g. 99 -> "99", 99.9 -> "99.9".
+ *
+ * @param percentile The percentile.
+ * @return The formatted percentile.
+ */
+inline std::string PercentileName(double percentile) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%g", percentile);
+    return buf;
+}
+
+/**
+ * @brief Log-linear latency histogram in the spirit of HdrHistogram.
+ *
+ * Values are bucketed by their power of two and then linearly into kSubBuckets sub-buckets, so recording is O(1),
+ * histograms of different threads can be merged, and the relative error of every percentile is below
+ * 1 / kSubBuckets regardless of the value range.
+ */
+class LatencyHistogram {
+  public:
+    /**
+     * @brief Record one value.
+     *
+     * @param value The value, e.g. a latency in nanoseconds.
+     */
+    void Record(uint64_t value) {
+        counts_[BucketIndex(value)]++;
+        count_++;
+        sum_ += value;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    /**
+     * @brief Add the values recorded by another histogram.
+     *
+     * @param other The other histogram.
+     */
+    void Merge(const LatencyHistogram &other) {
+        for (size_t i = 0; i < counts_.size(); i++) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t Count() const { return count_; }
+    uint64_t Min() const { return count_ > 0 ? min_ : 0; }
+    uint64_t Max() const { return max_; }
+    double Mean() const { return count_ > 0 ? sum_ / count_ : 0; }
+
+    /**
+     * @brief Get a percentile using the nearest-rank method.
+     *
+     * @param percentile The percentile in (0, 100].
+     * @return The middle of the bucket holding the percentile, clamped to [min, max], 0 if there is no value.
+     */
+    uint64_t Percentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * count_));
+        rank = std::min(std::max(rank, static_cast<uint64_t>(1)), count_);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); i++) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(std::max(BucketMiddle(i), min_), max_);
+            }
+        }
+        return max_;
+    }
+
+  private:
+    static constexpr int kSubBucketBits = 7;
+    static constexpr uint64_t kSubBuckets = 1 << kSubBucketBits;
+
+    static size_t BucketIndex(uint64_t value) {
+        int msb = value == 0 ? 0 : 63 - __builtin_clzll(value);
+        int shift = std::max(msb - kSubBucketBits, 0);
+        return shift * kSubBuckets + (value >> shift);
+    }
+
+    static uint64_t BucketMiddle(size_t index) {
+        if (index < 2 * kSubBuckets) {
+            return index;
+        }
+        int shift = static_cast<int>(index / kSubBuckets) - 1;
+        uint64_t lower = (index - shift * kSubBuckets) << shift;
+        return lower + (static_cast<uint64_t>(1) << shift) / 2;
+    }
+
+    std::vector<uint64_t> counts_ = std::vector<uint64_t>((64 - kSubBucketBits + 1) * kSubBuckets, 0);
+    uint64_t count_ = 0;
+    double sum_ = 0;
+    uint64_t min_ = std::numeric_limits<uint64_t>::max();
+    uint64_t max_ = 0;
+};
+
+} // namespace host_utils
@@ -34,11 +34,11 @@
 #include <sys/time.h>
 #include <sys/types.h>
 
+#include "ib_validation_utils.h"
+
 using namespace std;
 
 #define ROOT_RANK 0
-#define SERVER_MAX_THREADS 25000
-#define MAX_THREADS 65535
 
 int g_world_size;
 int g_world_rank;
@@ -97,76 +97,6 @@ void load_args(int argc, char *argv[], Args &args) {
     }
 }
 
-// Load and parse config file to vector
-vector<vector<std::pair<int, int>>> load_config(string filename = "config.txt") {
-    // read contents from file
-    vector<std::string> config;
-    ifstream in(filename);
-    string line;
-
-    if (in) {
-        while (getline(in, line)) {
-            if (line.size() > 0)
-                config.push_back(line);
-        }
-    } else {
-        throw std::runtime_error("Error: Failed to open config file.");
-    }
-
-    // parse the string contents to vector
-    vector<vector<std::pair<int, int>>> run_in_total;
-    try {
-        for (const auto &single_line : config) {
-            // parse each line like "1,2;2,3;3,4" to vector<std::pair<int, int>>
-            vector<string> run_in_parallel;
-            vector<std::pair<int, int>> run_pairs_in_parallel;
-            // split line to pair by ";"
-            boost::split(run_in_parallel, single_line, boost::is_any_of(";"), boost::token_compress_on);
-            vector<int> s_occurrence(g_world_size / local_size, 0), occurrence(g_world_size / local_size, 0);
-            for (const auto &pair : run_in_parallel) {
-                // split pair by ","
-                size_t quote = pair.find(',');
-                if (quote == pair.npos) {
-                    throw std::runtime_error("Error: Invalid config format.");
-                }
-                int first = stoi(pair.substr(0, quote));
-                int second = stoi(pair.substr(quote + 1));
-
-                occurrence[first]++;
-                occurrence[second]++;
-                s_occurrence[first]++;
-                // limit the maximum threads of each node no more than 65535 and server threads no more than 25000 at
-                // the same time because by default a node can use (32768-60999) ports
-                if (s_occurrence[first] * local_size >= SERVER_MAX_THREADS ||
-                    occurrence[second] * local_size >= MAX_THREADS || occurrence[first] * local_size >= MAX_THREADS) {
-                    if (g_world_rank == ROOT_RANK)
-                        std::cout << "Warning: split the line due to the limit of maximum threads nums" << std::endl;
-                    run_in_total.emplace_back(run_pairs_in_parallel);
-                    run_pairs_in_parallel.clear();
-                    occurrence.assign(g_world_size / local_size, 0);
-                    s_occurrence.assign(g_world_size / local_size, 0);
-                }
-                run_pairs_in_parallel.emplace_back(first, second);
-            }
-            run_in_total.emplace_back(run_pairs_in_parallel);
-        }
-    } catch (...) {
-        std::throw_with_nested(std::runtime_error("Error: Invalid config format."));
-    }
-    if (g_world_rank == ROOT_RANK) {
-        std::cout << "config: " << std::endl;
-        for (const vector<std::pair<int, int>> &line : run_in_total) {
-            for (const std::pair<int, int> &pair : line) {
-                std::cout << pair.first << "," << pair.second << ";";
-            }
-            std::cout << endl;
-        }
-        std::cout << "config end" << std::endl;
-    }
-
-    return run_in_total;
-}
-
 // Execute shell cmd in termial and get output
 std::string exec(const char *cmd) {
     char buffer[128];
@@ -264,41 +194,6 @@ void gather_hostnames(vector<string> &hostnames, string filename) {
     }
 }
 
-// Parse raw output of ib command
-// Sample of ib bw command raw
-// #bytes     #iterations BW peak[Gb/sec]    BW average[Gb/sec]  MsgRate[Mpps]
-// 8388608    5000            196.08             195.76            0.002917
-// Sample of ib latency command raw output
-// #bytes  #iterations    t_min    t_max  t_typical   t_avg    t_stdev  99% percentile   99.9% percentile
-// 8388608    5000        581.27   876.26   594.87    595.50     3.33       601.65          621.14
-// parsed result:
-// 195.76 (BW average)
-// 595.50 (t_avg)
-float process_raw_output(string output) {
-    float res = -1.0;
-    try {
-        string pattern;
-        vector<string> lines;
-        boost::split(lines, output, boost::is_any_of("\n"), boost::token_compress_on);
-        if (output.find("BW") != string::npos) {
-            pattern = "\\d+\\s+\\d+\\s+\\d+\\.\\d+\\s+(\\d+\\.\\d+)\\s+\\d+\\.\\d+";
-        } else {
-            pattern = "\\d+\\s+\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+"
-                      "\\s+(\\d+\\.\\d+)\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+";
-        }
-        regex re(pattern);
-        for (string line : lines) {
-            smatch m;
-            if (regex_search(line, m, re))
-                res = std::max(res, stof(m.str(1)));
-        }
-    } catch (const std::exception &e) {
-        std::cout << "Error: failed to parse raw_output: " << output << std::endl;
-    }
-
-    return res;
-}
-
 // Run ib command on server/client with server hostname
 float run_cmd(string cmd_prefix, int timeout, int port, bool server, string hostname) {
     // client sleep 1s in case that client starts before server
@@ -470,7 +365,8 @@ int main(int argc, char **argv) {
 #endif
 
         // Load and parse running config from file
-        vector<vector<std::pair<int, int>>> config = load_config(args.input_config);
+        vector<vector<std::pair<int, int>>> config =
+            load_config(args.input_config, g_world_size, local_size, g_world_rank == ROOT_RANK);
 
         // Get hostnames of all ranks
         vector<string> hostnames;
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Parsing helpers of the IB validation tool, the config file and the raw output of the ib commands, kept apart from
+// MPI so that they are also benchmarked by the harness micro-benchmarks.
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <regex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+
+#define SERVER_MAX_THREADS 25000
+#define MAX_THREADS 65535
+
+// Load and parse config file to vector
+inline std::vector<std::vector<std::pair<int, int>>> load_config(const std::string &filename, int world_size,
+                                                                 int local_size, bool verbose) {
+    // read contents from file
+    std::vector<std::string> config;
+    std::ifstream in(filename);
+    std::string line;
+
+    if (in) {
+        while (getline(in, line)) {
+            if (line.size() > 0)
+                config.push_back(line);
+        }
+    } else {
+        throw std::runtime_error("Error: Failed to open config file.");
+    }
+
+    // parse the string contents to vector
+    std::vector<std::vector<std::pair<int, int>>> run_in_total;
+    try {
+        for (const auto &single_line : config) {
+            // parse each line like "1,2;2,3;3,4" to vector<std::pair<int, int>>
+            std::vector<std::string> run_in_parallel;
+            std::vector<std::pair<int, int>> run_pairs_in_parallel;
+            // split line to pair by ";"
+            boost::split(run_in_parallel, single_line, boost::is_any_of(";"), boost::token_compress_on);
+            std::vector<int> s_occurrence(world_size / local_size, 0), occurrence(world_size / local_size, 0);
+            for (const auto &pair : run_in_parallel) {
+                // split pair by ","
+                size_t quote = pair.find(',');
+                if (quote == pair.npos) {
+                    throw std::runtime_error("Error: Invalid config format.");
+                }
+                int first = stoi(pair.substr(0, quote));
+                int second = stoi(pair.substr(quote + 1));
+
+                occurrence[first]++;
+                occurrence[second]++;
+                s_occurrence[first]++;
+                // limit the maximum threads of each node no more than 65535 and server threads no more than 25000 at
+                // the same time because by default a node can use (32768-60999) ports
+                if (s_occurrence[first] * local_size >= SERVER_MAX_THREADS ||
+                    occurrence[second] * local_size >= MAX_THREADS || occurrence[first] * local_size >= MAX_THREADS) {
+                    if (verbose)
+                        std::cout << "Warning: split the line due to the limit of maximum threads nums" << std::endl;
+                    run_in_total.emplace_back(run_pairs_in_parallel);
+                    run_pairs_in_parallel.clear();
+                    occurrence.assign(world_size / local_size, 0);
+                    s_occurrence.assign(world_size / local_size, 0);
+                }
+                run_pairs_in_parallel.emplace_back(first, second);
+            }
+            run_in_total.emplace_back(run_pairs_in_parallel);
+        }
+    } catch (...) {
+        std::throw_with_nested(std::runtime_error("Error: Invalid config format."));
+    }
+    if (verbose) {
+        std::cout << "config: " << std::endl;
+        for (const std::vector<std::pair<int, int>> &line : run_in_total) {
+            for (const std::pair<int, int> &pair : line) {
+                std::cout << pair.first << "," << pair.second << ";";
+            }
+            std::cout << std::endl;
+        }
+        std::cout << "config end" << std::endl;
+    }
+
+    return run_in_total;
+}
+
+// Parse raw output of ib command
+// Sample of ib bw command raw
+// #bytes     #iterations BW peak[Gb/sec]    BW average[Gb/sec]  MsgRate[Mpps]
+// 8388608    5000            196.08             195.76            0.002917
+// Sample of ib latency command raw output
+// #bytes  #iterations    t_min    t_max  t_typical   t_avg    t_stdev  99% percentile   99.9% percentile
+// 8388608    5000        581.27   876.26   594.87    595.50     3.33       601.65          621.14
+// parsed result:
+// 195.76 (BW average)
+// 595.50 (t_avg)
+inline float process_raw_output(const std::string &output) {
+    float res = -1.0;
+    try {
+        std::string pattern;
+        std::vector<std::string> lines;
+        boost::split(lines, output, boost::is_any_of("\n"), boost::token_compress_on);
+        if (output.find("BW") != std::string::npos) {
+            pattern = "\\d+\\s+\\d+\\s+\\d+\\.\\d+\\s+(\\d+\\.\\d+)\\s+\\d+\\.\\d+";
+        } else {
+            pattern = "\\d+\\s+\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+"
+                      "\\s+(\\d+\\.\\d+)\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+\\s+\\d+\\.\\d+";
+        }
+        std::regex re(pattern);
+        for (std::string line : lines) {
+            std::smatch m;
+            if (std::regex_search(line, m, re))
+                res = std::max(res, std::stof(m.str(1)));
+        }
+    } catch (const std::exception &e) {
+        std::cout << "Error: failed to parse raw_output: " << output << std::endl;
+    }
+
+    return res;
+}
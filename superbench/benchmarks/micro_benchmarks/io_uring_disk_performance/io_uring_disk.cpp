@@ -0,0 +1,615 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Native io_uring disk benchmark.
+// Runs seq/rand read/write/mixed jobs against a block device or a regular file with O_DIRECT, optional registered
+// buffers and files and optional SQ polling. It accepts the subset of fio options used by the disk-benchmark
+// wrapper and prints a fio compatible JSON report (group reporting, IOPS, bandwidth and latency percentiles), so
+// the disk-benchmark metrics are produced without fio installed.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../host_utils/io_uring_utils.h"
+#include "../host_utils/io_utils.h"
+#include "../host_utils/stats_utils.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Chunk size used to lay out regular files before reading them.
+constexpr size_t kLayoutChunk = 1 << 20;
+// Percentiles reported in the same format as fio.
+const std::vector<double> kFioPercentiles = {1,  5,  10, 20, 30, 40, 50,   60,    70,
+                                             80, 90, 95, 99, 99.5, 99.9, 99.95, 99.99};
+
+// Directions of an IO, also the index of per-direction statistics.
+enum Direction { kRead = 0, kWrite = 1 };
+
+// Options accepted by this program, named after the fio options they emulate.
+struct Opts {
+    // Block device or regular file to test.
+    std::string filename;
+
+    // Job name reported in the output.
+    std::string name = "io_uring_disk";
+
+    // IO pattern, one of read, write, rw, randread, randwrite and randrw.
+    std::string rw = "read";
+
+    // Block size in bytes.
+    uint64_t bs = 4096;
+
+    // Number of IOs in flight per job.
+    int iodepth = 1;
+
+    // Number of jobs, each runs in its own thread with its own ring.
+    int numjobs = 1;
+
+    // Duration in seconds of the measurement, 0 means until the whole size is done.
+    double runtime = 0;
+
+    // Duration in seconds to run before the measurement starts.
+    double ramp_time = 0;
+
+    // Whether to keep running for the whole runtime instead of stopping once the size is done.
+    bool time_based = false;
+
+    // Number of passes over the size when not time based.
+    int loops = 1;
+
+    // Percentage of reads in mixed workloads.
+    int rwmixread = 50;
+
+    // Size in bytes to test, 0 to use the whole device or file.
+    uint64_t size = 0;
+
+    // Whether to open the file with O_DIRECT.
+    bool direct = true;
+
+    // Whether to let a kernel thread poll the submission queue.
+    bool sqthread_poll = false;
+
+    // Whether to register the IO buffers with the ring.
+    bool fixedbufs = false;
+
+    // Whether to register the file with the ring.
+    bool registerfiles = false;
+
+    // Whether to use a fixed random seed per job.
+    bool randrepeat = true;
+};
+
+// Statistics of one job, indexed by direction.
+struct JobStats {
+    uint64_t ios[2] = {0, 0};
+    uint64_t bytes[2] = {0, 0};
+    host_utils::LatencyHistogram lat_ns[2];
+    Clock::time_point end;
+    int error = 0;
+};
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: io_uring_disk --filename=<path> "
+              << "[--name=<job name>] "
+              << "[--rw=<read|write|rw|randread|randwrite|randrw>] "
+              << "[--bs=<bytes>] "
+              << "[--iodepth=<num>] "
+              << "[--numjobs=<num>] "
+              << "[--runtime=<seconds>] "
+              << "[--ramp_time=<seconds>] "
+              << "[--time_based=<0|1>] "
+              << "[--loops=<num>] "
+              << "[--rwmixread=<percent>] "
+              << "[--size=<bytes>] "
+              << "[--direct=<0|1>] "
+              << "[--sqthread_poll=<0|1>] "
+              << "[--fixedbufs=<0|1>] "
+              << "[--registerfiles=<0|1>] "
+              << "[--randrepeat=<0|1>]" << std::endl;
+}
+
+/**
+ * @brief Parse a duration with an optional s/m/ms suffix, seconds by default as in fio, e.g. "10s".
+ *
+ * @param str The string to parse.
+ * @param value The parsed duration in seconds.
+ * @return true if the duration is valid.
+ */
+bool ParseDuration(const char *str, double *value) {
+    char *end = nullptr;
+    *value = strtod(str, &end);
+    if (end == str || *value < 0) {
+        return false;
+    }
+    if (strcmp(end, "ms") == 0) {
+        *value /= 1000;
+    } else if (strcmp(end, "m") == 0) {
+        *value *= 60;
+    } else if (*end != '\0' && strcmp(end, "s") != 0) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses command-line options for the io_uring disk benchmark.
+ *
+ * Options only meaningful to fio, such as ioengine and output-format, are accepted and ignored.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kFilename,
+        kName,
+        kRw,
+        kBs,
+        kIodepth,
+        kNumjobs,
+        kRuntime,
+        kRampTime,
+        kTimeBased,
+        kLoops,
+        kRwmixread,
+        kSize,
+        kDirect,
+        kSqthreadPoll,
+        kFixedbufs,
+        kRegisterfiles,
+        kRandrepeat,
+        kIgnored
+    };
+    const struct option options[] = {
+        {"filename", required_argument, nullptr, static_cast<int>(OptIdx::kFilename)},
+        {"name", required_argument, nullptr, static_cast<int>(OptIdx::kName)},
+        {"rw", required_argument, nullptr, static_cast<int>(OptIdx::kRw)},
+        {"bs", required_argument, nullptr, static_cast<int>(OptIdx::kBs)},
+        {"iodepth", required_argument, nullptr, static_cast<int>(OptIdx::kIodepth)},
+        {"numjobs", required_argument, nullptr, static_cast<int>(OptIdx::kNumjobs)},
+        {"runtime", required_argument, nullptr, static_cast<int>(OptIdx::kRuntime)},
+        {"ramp_time", required_argument, nullptr, static_cast<int>(OptIdx::kRampTime)},
+        {"time_based", required_argument, nullptr, static_cast<int>(OptIdx::kTimeBased)},
+        {"loops", required_argument, nullptr, static_cast<int>(OptIdx::kLoops)},
+        {"rwmixread", required_argument, nullptr, static_cast<int>(OptIdx::kRwmixread)},
+        {"size", required_argument, nullptr, static_cast<int>(OptIdx::kSize)},
+        {"direct", required_argument, nullptr, static_cast<int>(OptIdx::kDirect)},
+        {"sqthread_poll", required_argument, nullptr, static_cast<int>(OptIdx::kSqthreadPoll)},
+        {"fixedbufs", required_argument, nullptr, static_cast<int>(OptIdx::kFixedbufs)},
+        {"registerfiles", required_argument, nullptr, static_cast<int>(OptIdx::kRegisterfiles)},
+        {"randrepeat", required_argument, nullptr, static_cast<int>(OptIdx::kRandrepeat)},
+        {"ioengine", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {"thread", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {"norandommap", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {"lat_percentiles", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {"group_reporting", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {"output-format", required_argument, nullptr, static_cast<int>(OptIdx::kIgnored)},
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kIodepth), {&opts->iodepth, 1}},
+        {static_cast<int>(OptIdx::kNumjobs), {&opts->numjobs, 1}},
+        {static_cast<int>(OptIdx::kLoops), {&opts->loops, 1}},
+        {static_cast<int>(OptIdx::kRwmixread), {&opts->rwmixread, 0}}};
+    // Boolean options given as 0 or 1, indexed by OptIdx
+    std::map<int, bool *> bool_opts = {
+        {static_cast<int>(OptIdx::kTimeBased), &opts->time_based},
+        {static_cast<int>(OptIdx::kDirect), &opts->direct},
+        {static_cast<int>(OptIdx::kSqthreadPoll), &opts->sqthread_poll},
+        {static_cast<int>(OptIdx::kFixedbufs), &opts->fixedbufs},
+        {static_cast<int>(OptIdx::kRegisterfiles), &opts->registerfiles},
+        {static_cast<int>(OptIdx::kRandrepeat), &opts->randrepeat}};
+    const std::vector<std::string> patterns = {"read", "write", "rw", "readwrite", "randread", "randwrite", "randrw"};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        int idx = options[opt_idx].val;
+        auto int_opt = int_opts.find(idx);
+        auto bool_opt = bool_opts.find(idx);
+        if (int_opt != int_opts.end()) {
+            if (1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second) {
+                parse_err = true;
+            }
+        } else if (bool_opt != bool_opts.end()) {
+            int value = 0;
+            parse_err = 1 != sscanf(optarg, "%d", &value);
+            *bool_opt->second = value != 0;
+        } else if (idx == static_cast<int>(OptIdx::kFilename)) {
+            opts->filename = optarg;
+        } else if (idx == static_cast<int>(OptIdx::kName)) {
+            opts->name = optarg;
+        } else if (idx == static_cast<int>(OptIdx::kRw)) {
+            opts->rw = optarg;
+            parse_err = std::find(patterns.begin(), patterns.end(), opts->rw) == patterns.end();
+        } else if (idx == static_cast<int>(OptIdx::kBs)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->bs) || opts->bs == 0;
+        } else if (idx == static_cast<int>(OptIdx::kSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->size);
+        } else if (idx == static_cast<int>(OptIdx::kRuntime)) {
+            parse_err = !ParseDuration(optarg, &opts->runtime);
+        } else if (idx == static_cast<int>(OptIdx::kRampTime)) {
+            parse_err = !ParseDuration(optarg, &opts->ramp_time);
+        } else if (idx != static_cast<int>(OptIdx::kIgnored)) {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+            break;
+        }
+    }
+
+    if (!parse_err && opts->filename.empty()) {
+        std::cerr << "The filename is required." << std::endl;
+        parse_err = true;
+    }
+    if (!parse_err && opts->direct && opts->bs % host_utils::kDirectAlignment != 0) {
+        std::cerr << "The block size must be a multiple of " << host_utils::kDirectAlignment << " with direct IO."
+                  << std::endl;
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    if (opts->rw == "readwrite") {
+        opts->rw = "rw";
+    }
+    // SQ polling needs registered files on older kernels
+    opts->registerfiles |= opts->sqthread_poll;
+
+    return 0;
+}
+
+/**
+ * @brief Open the file to test and get the size to test, laying out regular files shorter than the size.
+ *
+ * @param opts The benchmark options.
+ * @param size The size in bytes to test.
+ * @return The file fd, -1 on failure.
+ */
+int OpenTestFile(const Opts &opts, uint64_t *size) {
+    bool writes = opts.rw != "read" && opts.rw != "randread";
+    struct stat st;
+    bool exists = stat(opts.filename.c_str(), &st) == 0;
+    bool block_device = exists && S_ISBLK(st.st_mode);
+
+    uint64_t file_size = 0;
+    if (block_device) {
+        int fd = open(opts.filename.c_str(), O_RDONLY);
+        if (fd < 0 || ioctl(fd, BLKGETSIZE64, &file_size) != 0) {
+            std::cerr << "Failed to get the size of " << opts.filename << ". ERROR: " << strerror(errno) << std::endl;
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        close(fd);
+    } else if (exists) {
+        file_size = st.st_size;
+    }
+    *size = opts.size > 0 ? opts.size : file_size;
+    *size -= *size % opts.bs;
+    if (*size == 0 || (block_device && *size > file_size)) {
+        std::cerr << "Invalid size to test on " << opts.filename << ": " << *size << std::endl;
+        return -1;
+    }
+
+    // Regular files are written out once so that reads do not hit holes
+    if (!block_device && file_size < *size) {
+        int fd = open(opts.filename.c_str(), O_WRONLY | O_CREAT, 0644);
+        std::vector<char> chunk(kLayoutChunk);
+        std::mt19937_64 rng(0);
+        std::generate(chunk.begin(), chunk.end(), [&rng]() { return static_cast<char>(rng()); });
+        for (uint64_t offset = file_size - file_size % kLayoutChunk; fd >= 0 && offset < *size;
+             offset += kLayoutChunk) {
+            size_t len = std::min<uint64_t>(kLayoutChunk, *size - offset);
+            if (pwrite(fd, chunk.data(), len, offset) != static_cast<ssize_t>(len)) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (fd < 0 || fsync(fd) != 0) {
+            std::cerr << "Failed to lay out " << opts.filename << ". ERROR: " << strerror(errno) << std::endl;
+            return -1;
+        }
+        close(fd);
+    }
+
+    int flags = (writes ? O_RDWR : O_RDONLY) | (opts.direct ? O_DIRECT : 0);
+    int fd = open(opts.filename.c_str(), flags);
+    if (fd < 0) {
+        std::cerr << "Failed to open " << opts.filename << ". ERROR: " << strerror(errno) << std::endl;
+    }
+    return fd;
+}
+
+/**
+ * @brief Job thread body, keeps iodepth IOs in flight on its own ring until the job is done.
+ *
+ * @param opts The benchmark options.
+ * @param fd The file to test.
+ * @param size The size in bytes to test.
+ * @param job The index of this job.
+ * @param start The time all jobs start, the measurement starts after the ramp time.
+ * @param stats The statistics of this job.
+ */
+void JobThread(const Opts &opts, int fd, uint64_t size, int job, Clock::time_point start, JobStats *stats) {
+    host_utils::IoUring ring;
+    stats->error = -ring.Init(opts.iodepth, opts.sqthread_poll);
+    if (stats->error != 0) {
+        std::cerr << "Failed to set up io_uring. ERROR: " << strerror(stats->error) << std::endl;
+        return;
+    }
+
+    // One buffer per IO slot, filled with random data so that writes are not compressible
+    size_t buffers_size = opts.iodepth * opts.bs;
+    char *buffers = static_cast<char *>(aligned_alloc(host_utils::kDirectAlignment, buffers_size));
+    std::mt19937_64 rng(opts.randrepeat ? job : std::random_device()());
+    std::generate(buffers, buffers + buffers_size, [&rng]() { return static_cast<char>(rng()); });
+    std::vector<iovec> iovs(opts.iodepth);
+    for (int i = 0; i < opts.iodepth; i++) {
+        iovs[i] = {buffers + i * opts.bs, opts.bs};
+    }
+    if (opts.fixedbufs && (stats->error = -ring.RegisterBuffers(iovs.data(), opts.iodepth)) != 0) {
+        std::cerr << "Failed to register buffers. ERROR: " << strerror(stats->error) << std::endl;
+    }
+    int file = fd;
+    if (stats->error == 0 && opts.registerfiles) {
+        stats->error = -ring.RegisterFiles(&fd, 1);
+        file = 0;
+        if (stats->error != 0) {
+            std::cerr << "Failed to register files. ERROR: " << strerror(stats->error) << std::endl;
+        }
+    }
+    if (stats->error != 0) {
+        free(buffers);
+        return;
+    }
+
+    bool random = opts.rw.compare(0, 4, "rand") == 0;
+    int read_percent = opts.rw == "read" || opts.rw == "randread" ? 100
+                       : opts.rw == "write" || opts.rw == "randwrite" ? 0
+                                                                        : opts.rwmixread;
+    // Sequential jobs work on their own region, random jobs on the whole size
+    uint64_t blocks = size / opts.bs;
+    uint64_t region_first = random ? 0 : blocks * job / opts.numjobs;
+    uint64_t region_blocks = std::max<uint64_t>(random ? blocks : blocks * (job + 1) / opts.numjobs - region_first, 1);
+    uint64_t block_budget = opts.time_based ? UINT64_MAX : region_blocks * opts.loops;
+    std::uniform_int_distribution<uint64_t> block_dist(0, blocks - 1);
+    std::uniform_int_distribution<int> percent_dist(0, 99);
+
+    auto measure_start = start + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(opts.ramp_time));
+    auto end = opts.runtime > 0 ? measure_start + std::chrono::duration_cast<Clock::duration>(
+                                                      std::chrono::duration<double>(opts.runtime))
+                                : Clock::time_point::max();
+    std::vector<Clock::time_point> submit_time(opts.iodepth);
+    std::vector<Direction> direction(opts.iodepth);
+    std::vector<int> free_slots(opts.iodepth);
+    for (int i = 0; i < opts.iodepth; i++) {
+        free_slots[i] = i;
+    }
+    uint64_t issued = 0;
+    int inflight = 0;
+    bool issuing = true;
+
+    while (stats->error == 0) {
+        auto now = Clock::now();
+        issuing = issuing && issued < block_budget && now < end;
+        while (issuing && !free_slots.empty() && issued < block_budget) {
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            uint64_t block = random ? block_dist(rng) : region_first + issued % region_blocks;
+            direction[slot] = percent_dist(rng) < read_percent ? kRead : kWrite;
+            uint8_t opcode = direction[slot] == kRead ? (opts.fixedbufs ? IORING_OP_READ_FIXED : IORING_OP_READ)
+                                                      : (opts.fixedbufs ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+            io_uring_sqe *sqe = ring.GetSqe();
+            host_utils::PrepRw(sqe, opcode, file, iovs[slot].iov_base, opts.bs, block * opts.bs, slot);
+            sqe->buf_index = slot;
+            sqe->flags = opts.registerfiles ? IOSQE_FIXED_FILE : 0;
+            submit_time[slot] = now;
+            inflight++;
+            issued++;
+        }
+        if (inflight == 0) {
+            break;
+        }
+        int ret = ring.Submit(1);
+        if (ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            stats->error = -ret;
+            break;
+        }
+        io_uring_cqe *cqe = nullptr;
+        if (ring.PeekCqe() == nullptr && (ret = ring.WaitCqe(&cqe)) != 0) {
+            stats->error = -ret;
+            break;
+        }
+        now = Clock::now();
+        while ((cqe = ring.PeekCqe()) != nullptr) {
+            int slot = static_cast<int>(cqe->user_data);
+            if (cqe->res != static_cast<int>(opts.bs)) {
+                stats->error = cqe->res < 0 ? -cqe->res : EIO;
+            } else if (now >= measure_start && now <= end) {
+                Direction dir = direction[slot];
+                stats->ios[dir]++;
+                stats->bytes[dir] += opts.bs;
+                stats->lat_ns[dir].Record(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(now - submit_time[slot]).count());
+            }
+            ring.SeenCqe();
+            free_slots.push_back(slot);
+            inflight--;
+        }
+    }
+    stats->end = std::min(Clock::now(), end);
+    if (stats->error != 0) {
+        std::cerr << "IO failed on job " << job << ". ERROR: " << strerror(stats->error) << std::endl;
+    }
+    ring.Close();
+    free(buffers);
+}
+
+/**
+ * @brief Print the statistics of one direction in fio JSON format.
+ *
+ * @param name The direction name, read or write.
+ * @param ios The number of IOs.
+ * @param bytes The number of bytes.
+ * @param seconds The measurement duration in seconds.
+ * @param lat_ns The latency histogram in nanoseconds.
+ * @param last Whether this is the last direction printed.
+ */
+void PrintDirection(const char *name, uint64_t ios, uint64_t bytes, double seconds,
+                    const host_utils::LatencyHistogram &lat_ns, bool last) {
+    double bw_bytes = seconds > 0 ? bytes / seconds : 0;
+    std::cout << "      \"" << name << "\" : {" << std::endl;
+    std::cout << "        \"io_bytes\" : " << bytes << "," << std::endl;
+    std::cout << "        \"io_kbytes\" : " << bytes / 1024 << "," << std::endl;
+    std::cout << "        \"bw_bytes\" : " << static_cast<uint64_t>(bw_bytes) << "," << std::endl;
+    std::cout << "        \"bw\" : " << static_cast<uint64_t>(bw_bytes / 1024) << "," << std::endl;
+    std::cout << "        \"iops\" : " << (seconds > 0 ? ios / seconds : 0) << "," << std::endl;
+    std::cout << "        \"runtime\" : " << static_cast<uint64_t>(seconds * 1000) << "," << std::endl;
+    std::cout << "        \"total_ios\" : " << ios << "," << std::endl;
+    std::cout << "        \"lat_ns\" : {" << std::endl;
+    std::cout << "          \"min\" : " << lat_ns.Min() << "," << std::endl;
+    std::cout << "          \"max\" : " << lat_ns.Max() << "," << std::endl;
+    std::cout << "          \"mean\" : " << lat_ns.Mean() << "," << std::endl;
+    std::cout << "          \"N\" : " << lat_ns.Count();
+    // Like fio, percentiles are only reported for directions with IOs
+    if (lat_ns.Count() > 0) {
+        std::cout << "," << std::endl << "          \"percentile\" : {" << std::endl;
+        for (size_t i = 0; i < kFioPercentiles.size(); i++) {
+            char key[32];
+            snprintf(key, sizeof(key), "%f", kFioPercentiles[i]);
+            std::cout << "            \"" << key << "\" : " << lat_ns.Percentile(kFioPercentiles[i])
+                      << (i + 1 < kFioPercentiles.size() ? "," : "") << std::endl;
+        }
+        std::cout << "          }";
+    }
+    std::cout << std::endl << "        }" << std::endl;
+    std::cout << "      }" << (last ? "" : ",") << std::endl;
+}
+
+/**
+ * @brief Print the group reported result of all jobs in fio JSON format.
+ *
+ * @param opts The benchmark options.
+ * @param stats The statistics of all jobs.
+ * @param start The time all jobs started.
+ */
+void PrintReport(const Opts &opts, const std::vector<JobStats> &stats, Clock::time_point start) {
+    uint64_t ios[2] = {0, 0};
+    uint64_t bytes[2] = {0, 0};
+    host_utils::LatencyHistogram lat_ns[2];
+    Clock::time_point end = start;
+    for (const auto &job : stats) {
+        for (int dir : {kRead, kWrite}) {
+            ios[dir] += job.ios[dir];
+            bytes[dir] += job.bytes[dir];
+            lat_ns[dir].Merge(job.lat_ns[dir]);
+        }
+        end = std::max(end, job.end);
+    }
+    double seconds = std::max(std::chrono::duration<double>(end - start).count() - opts.ramp_time, 0.0);
+    char ramp_time[32], runtime[32];
+    snprintf(ramp_time, sizeof(ramp_time), "%gs", opts.ramp_time);
+    snprintf(runtime, sizeof(runtime), "%gs", opts.runtime);
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "{" << std::endl;
+    std::cout << "  \"fio version\" : \"io_uring_disk\"," << std::endl;
+    std::cout << "  \"global options\" : {" << std::endl;
+    std::cout << "    \"filename\" : \"" << opts.filename << "\"," << std::endl;
+    std::cout << "    \"ramp_time\" : \"" << ramp_time << "\"," << std::endl;
+    std::cout << "    \"runtime\" : \"" << runtime << "\"," << std::endl;
+    std::cout << "    \"iodepth\" : \"" << opts.iodepth << "\"," << std::endl;
+    std::cout << "    \"numjobs\" : \"" << opts.numjobs << "\"," << std::endl;
+    std::cout << "    \"ioengine\" : \"io_uring\"," << std::endl;
+    std::cout << "    \"direct\" : \"" << opts.direct << "\"," << std::endl;
+    std::cout << "    \"sqthread_poll\" : \"" << opts.sqthread_poll << "\"," << std::endl;
+    std::cout << "    \"fixedbufs\" : \"" << opts.fixedbufs << "\"," << std::endl;
+    std::cout << "    \"registerfiles\" : \"" << opts.registerfiles << "\"" << std::endl;
+    std::cout << "  }," << std::endl;
+    std::cout << "  \"jobs\" : [" << std::endl;
+    std::cout << "    {" << std::endl;
+    std::cout << "      \"jobname\" : \"" << opts.name << "\"," << std::endl;
+    std::cout << "      \"groupid\" : 0," << std::endl;
+    std::cout << "      \"error\" : 0," << std::endl;
+    std::cout << "      \"job options\" : {" << std::endl;
+    std::cout << "        \"name\" : \"" << opts.name << "\"," << std::endl;
+    std::cout << "        \"rw\" : \"" << opts.rw << "\"," << std::endl;
+    std::cout << "        \"bs\" : \"" << opts.bs << "\"" << std::endl;
+    std::cout << "      }," << std::endl;
+    PrintDirection("read", ios[kRead], bytes[kRead], seconds, lat_ns[kRead], false);
+    PrintDirection("write", ios[kWrite], bytes[kWrite], seconds, lat_ns[kWrite], true);
+    std::cout << "    }" << std::endl;
+    std::cout << "  ]" << std::endl;
+    std::cout << "}" << std::endl;
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    uint64_t size = 0;
+    int fd = OpenTestFile(opts, &size);
+    if (fd < 0) {
+        return 1;
+    }
+
+    std::vector<JobStats> stats(opts.numjobs);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (int job = 0; job < opts.numjobs; job++) {
+        threads.emplace_back(JobThread, std::cref(opts), fd, size, job, start, &stats[job]);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    close(fd);
+
+    for (const auto &job : stats) {
+        if (job.error != 0) {
+            return 1;
+        }
+    }
+    PrintReport(opts, stats, start);
+    return 0;
+}
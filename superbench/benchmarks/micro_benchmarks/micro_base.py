@@ -11,6 +11,7 @@
 from superbench.common.utils import logger, run_command
 from superbench.benchmarks import BenchmarkType, ReturnCode
 from superbench.benchmarks.base import Benchmark
+from superbench.benchmarks.micro_benchmarks import result_records
 
 
 class MicroBenchmark(Benchmark):
@@ -204,7 +205,15 @@ def _benchmark(self):
             )
 
             output = run_command(self._commands[cmd_idx], flush_output=self._args.log_flushing, cwd=self._args.bin_dir)
-            if output.returncode != 0:
+            if output.returncode != 0 and self._stopped_by_baseline(cmd_idx, output.stdout):
+                self._result.set_return_code(ReturnCode.MICROBENCHMARK_BASELINE_FAILURE)
+                logger.error(
+                    'Microbenchmark stopped at a baseline failure - round: {}, benchmark: {}.'.format(
+                        self._curr_run_index, self._name
+                    )
+                )
+                ret = False
+            elif output.returncode != 0:
                 self._result.set_return_code(ReturnCode.MICROBENCHMARK_EXECUTION_FAILURE)
                 logger.error(
                     'Microbenchmark execution failed - round: {}, benchmark: {}, error message: {}.'.format(
@@ -221,6 +230,103 @@ def _benchmark(self):
 
         return ret
 
+    def _add_result_record_arguments(self):
+        """Add the arguments of the binaries writing result records, checked against a baseline as produced."""
+        self._parser.add_argument(
+            '--baseline',
+            type=str,
+            default=None,
+            required=False,
+            help='Baseline rules file, one "<pattern> <expected> <tolerance> [higher|lower|both] [confirm=<n>]" '
+            'per line, to check every metric against as it is produced.',
+        )
+        self._parser.add_argument(
+            '--baseline_confidence',
+            type=float,
+            default=0.99,
+            required=False,
+            help='Confidence of the baseline checks of samples and iterations.',
+        )
+        self._parser.add_argument(
+            '--fail_fast',
+            action='store_true',
+            default=False,
+            help='Stop the benchmark at the first metric failing the baseline.',
+        )
+
+    def _result_record_args(self):
+        """Get the command line arguments of the binaries writing result records.
+
+        Return:
+            The arguments to write jsonl records and check them against the baseline if any.
+        """
+        args = ' --result_format jsonl'
+        if self._args.baseline:
+            args += ' --baseline %s --baseline_confidence %s' % (self._args.baseline, self._args.baseline_confidence)
+            if self._args.fail_fast:
+                args += ' --fail_fast'
+        return args
+
+    def _stopped_by_baseline(self, cmd_idx, raw_output):
+        """Check whether a binary run with --fail_fast exited at a baseline failure, saving the results it wrote.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the results written before the exit count baseline failures.
+        """
+        if not getattr(self._args, 'fail_fast', False) or not self._args.baseline:
+            return False
+        try:
+            records = result_records.decode_jsonl(raw_output)
+        except ValueError:
+            return False
+        # Only the records of this run tell a baseline stop from a crash, whose partial results are not kept
+        if not any(
+            record['kind'] == 'metric' and record['name'].endswith('baseline_failures') and record['value'] > 0
+            for record in records
+        ):
+            return False
+        self._process_raw_result(cmd_idx, raw_output)
+        return True
+
+    def _process_result_records(self, cmd_idx, raw_output, prefix=''):
+        """Function to save the results from the records of a binary run with --result_format jsonl.
+
+          Metric records are saved as results and sample records as raw data.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+            prefix (str): prefix of the metric names.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        self._result.add_raw_data('raw_output_' + str(cmd_idx), raw_output, self._args.log_raw_data)
+
+        try:
+            records = result_records.decode_jsonl(raw_output)
+            if len(records) == 0:
+                raise ValueError('no result records')
+            for record in records:
+                if record['kind'] == 'metric':
+                    self._result.add_result(prefix + record['name'], record['value'])
+                else:
+                    self._result.add_raw_data(prefix + record['name'], record['samples'], self._args.log_raw_data)
+        except BaseException as e:
+            self._result.set_return_code(ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+            logger.error(
+                'The result format is invalid - round: {}, benchmark: {}, raw output: {}, message: {}.'.format(
+                    self._curr_run_index, self._name, raw_output, str(e)
+                )
+            )
+            return False
+
+        return True
+
     @abstractmethod
     def _process_raw_result(self, cmd_idx, raw_output):
         """Function to process raw results and save the summarized results.
@@ -0,0 +1,176 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the MoE expert-parallel alltoallv dispatch/combine benchmark.
+
+It is expected to run in the mpi mode, where every rank runs one process and rank 0 prints the results.
+"""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class MoeAlltoallvBenchmark(MicroBenchmarkWithInvoke):
+    """The MoE alltoallv dispatch/combine benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'moe_alltoallv'
+        self._transports = ['mpi', 'shm']
+        self._dists = ['uniform', 'zipf']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--transports',
+            type=str,
+            nargs='+',
+            default=['mpi'],
+            help='Token exchanges to test, shm needs all ranks on one node. E.g. {}.'.format(
+                ' '.join(self._transports)
+            ),
+        )
+        self._parser.add_argument(
+            '--dist',
+            type=str,
+            default='uniform',
+            required=False,
+            help='Distribution of the expert popularity in the routing, e.g. {}.'.format(' '.join(self._dists)),
+        )
+        self._parser.add_argument(
+            '--zipf_alpha',
+            type=float,
+            default=1.2,
+            required=False,
+            help='Exponent of the Zipf distribution, larger values route more tokens to the first experts.',
+        )
+        self._parser.add_argument(
+            '--tokens',
+            type=int,
+            default=1024,
+            required=False,
+            help='Number of tokens per rank per step.',
+        )
+        self._parser.add_argument(
+            '--hidden',
+            type=int,
+            default=512,
+            required=False,
+            help='Hidden size of a token.',
+        )
+        self._parser.add_argument(
+            '--ffn',
+            type=int,
+            default=1024,
+            required=False,
+            help='Intermediate size of the expert FFN, 0 to skip the expert GEMMs.',
+        )
+        self._parser.add_argument(
+            '--experts_per_rank',
+            type=int,
+            default=2,
+            required=False,
+            help='Number of experts owned by every rank.',
+        )
+        self._parser.add_argument(
+            '--topk',
+            type=int,
+            default=2,
+            required=False,
+            help='Number of experts every token is routed to.',
+        )
+        self._parser.add_argument(
+            '--steps',
+            type=int,
+            default=20,
+            required=False,
+            help='Number of timed steps.',
+        )
+        self._parser.add_argument(
+            '--warmup',
+            type=int,
+            default=5,
+            required=False,
+            help='Number of warmup steps.',
+        )
+        self._parser.add_argument(
+            '--seed',
+            type=int,
+            default=1,
+            required=False,
+            help='Seed of the routing decisions.',
+        )
+        self._parser.add_argument(
+            '--check',
+            action='store_true',
+            help='Check the round trip of the tokens through identity experts before the steps.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for transport in self._args.transports:
+            if transport not in self._transports:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid transport - benchmark: {}, transport: {}.'.format(self._name, transport))
+                return False
+        if self._args.dist not in self._dists:
+            self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+            logger.error('Invalid distribution - benchmark: {}, dist: {}.'.format(self._name, self._args.dist))
+            return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = '--dist %s --zipf_alpha %g --tokens %d --hidden %d --ffn %d --experts_per_rank %d --topk %d ' \
+            '--steps %d --warmup %d --seed %d --check %d' % (
+                self._args.dist, self._args.zipf_alpha, self._args.tokens, self._args.hidden, self._args.ffn,
+                self._args.experts_per_rank, self._args.topk, self._args.steps, self._args.warmup, self._args.seed,
+                1 if self._args.check else 0
+            )
+        args += self._result_record_args()
+        self._commands = [
+            '%s --transport %s %s' % (self.__bin_path, transport, args) for transport in self._args.transports
+        ]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        # If it's invoked by MPI and rank is not 0, empty content is expected
+        if os.getenv('OMPI_COMM_WORLD_RANK'):
+            rank = int(os.getenv('OMPI_COMM_WORLD_RANK'))
+            if rank > 0:
+                return True
+
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('moe-alltoallv', MoeAlltoallvBenchmark)
@@ -0,0 +1,755 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// MoE expert-parallel dispatch/combine benchmark.
+// Every step, each rank routes its tokens to the top-k of all experts drawn from a uniform or Zipf distribution, sends
+// every routed token to the rank owning the expert (dispatch), runs the two GEMMs of the local experts, and returns the
+// outputs to the token owners which sum them by gate weight (combine). The exchanges go through MPI_Alltoallv, or
+// through an MPI shared-memory window on a single node. Launch it with mpirun, e.g. mpirun -np 8 moe_alltoallv.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <map>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+
+#include "../host_utils/result_emitter.h"
+
+// Ways to exchange the tokens between ranks.
+enum class Transport { kMpi, kShm };
+
+// Distributions of the routing decisions.
+enum class Distribution { kUniform, kZipf };
+
+// Options accepted by this program.
+struct Opts {
+    // Way to exchange the tokens.
+    Transport transport = Transport::kMpi;
+
+    // Distribution of the expert popularity.
+    Distribution dist = Distribution::kUniform;
+
+    // Exponent of the Zipf distribution.
+    double zipf_alpha = 1.2;
+
+    // Number of tokens per rank per step.
+    int tokens = 1024;
+
+    // Hidden size of a token.
+    int hidden = 512;
+
+    // Intermediate size of the expert FFN, 0 for identity experts.
+    int ffn = 1024;
+
+    // Number of experts owned by every rank.
+    int experts_per_rank = 2;
+
+    // Number of experts every token is routed to.
+    int topk = 2;
+
+    // Number of timed steps.
+    int steps = 20;
+
+    // Number of warmup steps.
+    int warmup = 5;
+
+    // Seed of the routing decisions.
+    int seed = 1;
+
+    // Whether to check the round trip of the tokens with identity experts.
+    int check = 0;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Phases of a step.
+enum Phase { kRoute, kDispatch, kExpert, kCombine, kNumPhases };
+
+// Statistics of a step, the times are the maxima over ranks.
+struct StepStats {
+    double time[kNumPhases] = {};
+    double dispatch_bytes = 0;
+    double rank_imbalance = 0;
+    double expert_imbalance = 0;
+    double flops = 0;
+};
+
+// State of this rank.
+struct Rank {
+    const Opts *opts;
+    int rank;
+    int nranks;
+    int num_experts;
+    std::mt19937_64 rng;
+
+    // Cumulative distribution of the expert popularity.
+    std::vector<double> cdf;
+
+    // Input and output tokens.
+    std::vector<float> x;
+    std::vector<float> y;
+
+    // Up and down projections of the local experts.
+    std::vector<float> w_up;
+    std::vector<float> w_down;
+
+    // Routed rows sorted by global expert, their token and gate weight, and the count per global expert.
+    float *send = nullptr;
+    std::vector<int> row_token;
+    std::vector<float> row_weight;
+    std::vector<int> send_counts;
+
+    // Rows received from every source, ordered by source then local expert, and their count per source and expert.
+    std::vector<float> recv;
+    std::vector<float> mid;
+    std::vector<float> out;
+    std::vector<int> recv_counts;
+
+    // Expert outputs back in the order of the routed rows.
+    float *combine = nullptr;
+
+    // Shared-memory window holding the send and combine regions of every rank.
+    MPI_Win win = MPI_WIN_NULL;
+    std::vector<float *> peer_send;
+    std::vector<float *> peer_combine;
+
+    // Count matrix of every source and global expert, for the shared-memory transport.
+    std::vector<int> count_matrix;
+};
+
+// GEMM compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+/**
+ * @brief Compute c = a * b of row-major matrices, optionally followed by a ReLU.
+ *
+ * @param a The m x k matrix.
+ * @param b The k x n matrix.
+ * @param c The m x n matrix.
+ * @param m The number of rows of a.
+ * @param k The number of columns of a.
+ * @param n The number of columns of b.
+ * @param relu Whether to apply a ReLU to the result.
+ */
+SIMD_CLONES void Gemm(const float *a, const float *b, float *c, size_t m, size_t k, size_t n, bool relu) {
+    for (size_t i = 0; i < m; i++) {
+        float *row = c + i * n;
+        std::fill(row, row + n, 0.0f);
+        for (size_t p = 0; p < k; p++) {
+            float aip = a[i * k + p];
+            const float *brow = b + p * n;
+            for (size_t j = 0; j < n; j++) {
+                row[j] += aip * brow[j];
+            }
+        }
+        for (size_t j = 0; relu && j < n; j++) {
+            row[j] = std::max(row[j], 0.0f);
+        }
+    }
+}
+
+/**
+ * @brief Draw the distinct experts of a token.
+ *
+ * @param ctx The rank.
+ * @param experts The drawn experts, topk of them.
+ */
+void DrawExperts(Rank *ctx, int *experts) {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    int topk = ctx->opts->topk;
+    for (int i = 0; i < topk; i++) {
+        int expert = 0;
+        bool taken = true;
+        // Redraw the experts already taken, then fall back to the next free one under heavy skew
+        for (int tries = 0; taken && tries < 64; tries++) {
+            expert = std::upper_bound(ctx->cdf.begin(), ctx->cdf.end(), uniform(ctx->rng)) - ctx->cdf.begin();
+            expert = std::min(expert, ctx->num_experts - 1);
+            taken = std::find(experts, experts + i, expert) != experts + i;
+        }
+        while (std::find(experts, experts + i, expert) != experts + i) {
+            expert = (expert + 1) % ctx->num_experts;
+        }
+        experts[i] = expert;
+    }
+}
+
+/**
+ * @brief Route the tokens of this rank and pack the routed rows by global expert.
+ *
+ * @param ctx The rank.
+ */
+void Route(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    size_t hidden = opts.hidden;
+    size_t rows = static_cast<size_t>(opts.tokens) * opts.topk;
+    std::vector<int> experts(rows);
+    std::vector<float> weights(rows);
+    std::uniform_real_distribution<float> uniform(0.01f, 1.0f);
+    for (int t = 0; t < opts.tokens; t++) {
+        DrawExperts(ctx, &experts[t * opts.topk]);
+        float sum = 0;
+        for (int i = 0; i < opts.topk; i++) {
+            weights[t * opts.topk + i] = uniform(ctx->rng);
+            sum += weights[t * opts.topk + i];
+        }
+        for (int i = 0; i < opts.topk; i++) {
+            weights[t * opts.topk + i] /= sum;
+        }
+    }
+
+    // Counting sort of the rows by global expert, which also groups them by destination rank
+    std::fill(ctx->send_counts.begin(), ctx->send_counts.end(), 0);
+    for (int expert : experts) {
+        ctx->send_counts[expert]++;
+    }
+    std::vector<size_t> offsets(ctx->num_experts, 0);
+    for (int e = 1; e < ctx->num_experts; e++) {
+        offsets[e] = offsets[e - 1] + ctx->send_counts[e - 1];
+    }
+    for (size_t r = 0; r < rows; r++) {
+        size_t row = offsets[experts[r]]++;
+        int token = static_cast<int>(r / opts.topk);
+        ctx->row_token[row] = token;
+        ctx->row_weight[row] = weights[r];
+        memcpy(ctx->send + row * hidden, &ctx->x[token * hidden], hidden * sizeof(float));
+    }
+}
+
+/**
+ * @brief Sum the rows received from a range of sources and local experts.
+ *
+ * @param ctx The rank.
+ * @param end_source The first source not counted.
+ * @return The number of rows.
+ */
+size_t RecvRowsBefore(const Rank *ctx, int end_source) {
+    size_t rows = 0;
+    for (int i = 0; i < end_source * ctx->opts->experts_per_rank; i++) {
+        rows += ctx->recv_counts[i];
+    }
+    return rows;
+}
+
+/**
+ * @brief Exchange the routed rows so that every rank holds the rows of its local experts.
+ *
+ * @param ctx The rank.
+ */
+void Dispatch(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    int n = ctx->nranks;
+    int epr = opts.experts_per_rank;
+    size_t hidden = opts.hidden;
+    if (opts.transport == Transport::kMpi) {
+        MPI_Alltoall(ctx->send_counts.data(), epr, MPI_INT, ctx->recv_counts.data(), epr, MPI_INT, MPI_COMM_WORLD);
+    } else {
+        // The count matrix tells every rank where its rows are in the send region of each source
+        MPI_Win_sync(ctx->win);
+        MPI_Allgather(ctx->send_counts.data(), ctx->num_experts, MPI_INT, ctx->count_matrix.data(), ctx->num_experts,
+                      MPI_INT, MPI_COMM_WORLD);
+        MPI_Win_sync(ctx->win);
+        for (int s = 0; s < n; s++) {
+            std::copy_n(&ctx->count_matrix[s * ctx->num_experts + ctx->rank * epr], epr, &ctx->recv_counts[s * epr]);
+        }
+    }
+    size_t recv_rows = RecvRowsBefore(ctx, n);
+    ctx->recv.resize(recv_rows * hidden);
+
+    std::vector<int> sendcounts(n, 0), sdispls(n, 0), recvcounts(n, 0), rdispls(n, 0);
+    for (int p = 0; p < n; p++) {
+        for (int e = 0; e < epr; e++) {
+            sendcounts[p] += ctx->send_counts[p * epr + e];
+            recvcounts[p] += ctx->recv_counts[p * epr + e];
+        }
+        sdispls[p] = p == 0 ? 0 : sdispls[p - 1] + sendcounts[p - 1];
+        rdispls[p] = p == 0 ? 0 : rdispls[p - 1] + recvcounts[p - 1];
+    }
+    if (opts.transport == Transport::kMpi) {
+        MPI_Datatype row_type;
+        MPI_Type_contiguous(opts.hidden, MPI_FLOAT, &row_type);
+        MPI_Type_commit(&row_type);
+        MPI_Alltoallv(ctx->send, sendcounts.data(), sdispls.data(), row_type, ctx->recv.data(), recvcounts.data(),
+                      rdispls.data(), row_type, MPI_COMM_WORLD);
+        MPI_Type_free(&row_type);
+        return;
+    }
+    // Pull the rows from the send region of every source, starting with the next rank to spread the load
+    for (int j = 0; j < n; j++) {
+        int s = (ctx->rank + j) % n;
+        const int *counts = &ctx->count_matrix[s * ctx->num_experts];
+        size_t offset = std::accumulate(counts, counts + ctx->rank * epr, size_t(0));
+        memcpy(&ctx->recv[rdispls[s] * hidden], ctx->peer_send[s] + offset * hidden,
+               recvcounts[s] * hidden * sizeof(float));
+    }
+}
+
+/**
+ * @brief Run the local experts on the received rows.
+ *
+ * @param ctx The rank.
+ * @param identity Whether the experts copy their input, for the check.
+ * @return The number of floating-point operations.
+ */
+double RunExperts(Rank *ctx, bool identity) {
+    const Opts &opts = *ctx->opts;
+    int epr = opts.experts_per_rank;
+    size_t hidden = opts.hidden;
+    size_t ffn = opts.ffn;
+    size_t rows = ctx->recv.size() / hidden;
+    ctx->out.resize(rows * hidden);
+    if (identity || ffn == 0) {
+        std::copy(ctx->recv.begin(), ctx->recv.end(), ctx->out.begin());
+        return 0;
+    }
+    ctx->mid.resize(rows * ffn);
+    // The rows of a local expert come in one segment per source
+    size_t row = 0;
+    for (int s = 0; s < ctx->nranks; s++) {
+        for (int e = 0; e < epr; e++) {
+            size_t m = ctx->recv_counts[s * epr + e];
+            Gemm(&ctx->recv[row * hidden], &ctx->w_up[e * hidden * ffn], &ctx->mid[row * ffn], m, hidden, ffn, true);
+            Gemm(&ctx->mid[row * ffn], &ctx->w_down[e * ffn * hidden], &ctx->out[row * hidden], m, ffn, hidden, false);
+            row += m;
+        }
+    }
+    return 4.0 * rows * hidden * ffn;
+}
+
+/**
+ * @brief Return the expert outputs to the token owners and sum them by gate weight.
+ *
+ * @param ctx The rank.
+ */
+void Combine(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    int n = ctx->nranks;
+    int epr = opts.experts_per_rank;
+    size_t hidden = opts.hidden;
+    std::vector<int> sendcounts(n, 0), sdispls(n, 0), recvcounts(n, 0), rdispls(n, 0);
+    for (int p = 0; p < n; p++) {
+        for (int e = 0; e < epr; e++) {
+            sendcounts[p] += ctx->recv_counts[p * epr + e];
+            recvcounts[p] += ctx->send_counts[p * epr + e];
+        }
+        sdispls[p] = p == 0 ? 0 : sdispls[p - 1] + sendcounts[p - 1];
+        rdispls[p] = p == 0 ? 0 : rdispls[p - 1] + recvcounts[p - 1];
+    }
+    if (opts.transport == Transport::kMpi) {
+        MPI_Datatype row_type;
+        MPI_Type_contiguous(opts.hidden, MPI_FLOAT, &row_type);
+        MPI_Type_commit(&row_type);
+        MPI_Alltoallv(ctx->out.data(), sendcounts.data(), sdispls.data(), row_type, ctx->combine, recvcounts.data(),
+                      rdispls.data(), row_type, MPI_COMM_WORLD);
+        MPI_Type_free(&row_type);
+    } else {
+        // Push the outputs into the combine region of every source, at the place of the rows it sent
+        for (int j = 0; j < n; j++) {
+            int s = (ctx->rank + j) % n;
+            const int *counts = &ctx->count_matrix[s * ctx->num_experts];
+            size_t offset = std::accumulate(counts, counts + ctx->rank * epr, size_t(0));
+            memcpy(ctx->peer_combine[s] + offset * hidden, &ctx->out[sdispls[s] * hidden],
+                   sendcounts[s] * hidden * sizeof(float));
+        }
+        MPI_Win_sync(ctx->win);
+        MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Win_sync(ctx->win);
+    }
+
+    std::fill(ctx->y.begin(), ctx->y.end(), 0.0f);
+    size_t rows = static_cast<size_t>(opts.tokens) * opts.topk;
+    for (size_t row = 0; row < rows; row++) {
+        float *dst = &ctx->y[ctx->row_token[row] * hidden];
+        const float *src = ctx->combine + row * hidden;
+        float weight = ctx->row_weight[row];
+        for (size_t j = 0; j < hidden; j++) {
+            dst[j] += weight * src[j];
+        }
+    }
+}
+
+/**
+ * @brief Run one step and gather its statistics over the ranks.
+ *
+ * @param ctx The rank.
+ * @param identity Whether the experts copy their input, for the check.
+ * @param stats The statistics, valid on every rank.
+ */
+void RunStep(Rank *ctx, bool identity, StepStats *stats) {
+    const Opts &opts = *ctx->opts;
+    int epr = opts.experts_per_rank;
+    double time[kNumPhases] = {};
+    double flops = 0;
+    // Align the ranks before every phase, so that a phase does not absorb the imbalance of the previous one
+    for (int phase = 0; phase < kNumPhases; phase++) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        if (phase == kRoute) {
+            Route(ctx);
+        } else if (phase == kDispatch) {
+            Dispatch(ctx);
+        } else if (phase == kExpert) {
+            flops = RunExperts(ctx, identity);
+        } else {
+            Combine(ctx);
+        }
+        time[phase] = MPI_Wtime() - start;
+    }
+
+    // The slowest rank bounds every phase
+    MPI_Allreduce(time, stats->time, kNumPhases, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    // Only the rows leaving this rank cross the transport
+    double remote_rows = 0;
+    for (int e = 0; e < ctx->num_experts; e++) {
+        remote_rows += e / epr == ctx->rank ? 0 : ctx->send_counts[e];
+    }
+    double recv_rows = RecvRowsBefore(ctx, ctx->nranks);
+    double local[3] = {remote_rows * opts.hidden * sizeof(float), flops, recv_rows};
+    double sums[3] = {}, max_rows = 0;
+    MPI_Allreduce(local, sums, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    MPI_Allreduce(&local[2], &max_rows, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    std::vector<int> expert_load(ctx->num_experts, 0);
+    MPI_Allreduce(ctx->send_counts.data(), expert_load.data(), ctx->num_experts, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+
+    stats->dispatch_bytes = sums[0];
+    stats->flops = sums[1];
+    stats->rank_imbalance = max_rows / (sums[2] / ctx->nranks);
+    stats->expert_imbalance = *std::max_element(expert_load.begin(), expert_load.end()) / (sums[2] / ctx->num_experts);
+}
+
+/**
+ * @brief Check that the tokens come back unchanged through identity experts, whose gate weights sum to one.
+ *
+ * @param ctx The rank.
+ * @return The number of wrong elements over all ranks.
+ */
+uint64_t CheckRoundTrip(Rank *ctx) {
+    StepStats stats;
+    RunStep(ctx, true, &stats);
+    uint64_t wrong = 0;
+    for (size_t i = 0; i < ctx->x.size(); i++) {
+        wrong += std::fabs(ctx->y[i] - ctx->x[i]) > 1e-4f * std::fabs(ctx->x[i]) + 1e-5f;
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &wrong, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    return wrong;
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    printf("Usage: mpirun -np <ranks> moe_alltoallv "
+           "[--transport mpi|shm] "
+           "[--dist uniform|zipf] "
+           "[--zipf_alpha <num>] "
+           "[--tokens <num>] "
+           "[--hidden <num>] "
+           "[--ffn <num>] "
+           "[--experts_per_rank <num>] "
+           "[--topk <num>] "
+           "[--steps <num>] "
+           "[--warmup <num>] "
+           "[--seed <num>] "
+           "[--check <0|1>] %s\n",
+           host_utils::kResultOptsUsage);
+}
+
+/**
+ * @brief Parses command-line options for the MoE alltoallv benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param nranks The number of ranks.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, int nranks, Opts *opts) {
+    enum class OptIdx {
+        kTransport,
+        kDist,
+        kZipfAlpha,
+        kTokens,
+        kHidden,
+        kFfn,
+        kExpertsPerRank,
+        kTopk,
+        kSteps,
+        kWarmup,
+        kSeed,
+        kCheck
+    };
+    const struct option options[] = {
+        {"transport", required_argument, nullptr, static_cast<int>(OptIdx::kTransport)},
+        {"dist", required_argument, nullptr, static_cast<int>(OptIdx::kDist)},
+        {"zipf_alpha", required_argument, nullptr, static_cast<int>(OptIdx::kZipfAlpha)},
+        {"tokens", required_argument, nullptr, static_cast<int>(OptIdx::kTokens)},
+        {"hidden", required_argument, nullptr, static_cast<int>(OptIdx::kHidden)},
+        {"ffn", required_argument, nullptr, static_cast<int>(OptIdx::kFfn)},
+        {"experts_per_rank", required_argument, nullptr, static_cast<int>(OptIdx::kExpertsPerRank)},
+        {"topk", required_argument, nullptr, static_cast<int>(OptIdx::kTopk)},
+        {"steps", required_argument, nullptr, static_cast<int>(OptIdx::kSteps)},
+        {"warmup", required_argument, nullptr, static_cast<int>(OptIdx::kWarmup)},
+        {"seed", required_argument, nullptr, static_cast<int>(OptIdx::kSeed)},
+        {"check", required_argument, nullptr, static_cast<int>(OptIdx::kCheck)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by option value
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kTokens), {&opts->tokens, 1}},
+        {static_cast<int>(OptIdx::kHidden), {&opts->hidden, 1}},
+        {static_cast<int>(OptIdx::kFfn), {&opts->ffn, 0}},
+        {static_cast<int>(OptIdx::kExpertsPerRank), {&opts->experts_per_rank, 1}},
+        {static_cast<int>(OptIdx::kTopk), {&opts->topk, 1}},
+        {static_cast<int>(OptIdx::kSteps), {&opts->steps, 1}},
+        {static_cast<int>(OptIdx::kWarmup), {&opts->warmup, 0}},
+        {static_cast<int>(OptIdx::kSeed), {&opts->seed, 0}},
+        {static_cast<int>(OptIdx::kCheck), {&opts->check, 0}}};
+    std::map<std::string, Transport> transports = {{"mpi", Transport::kMpi}, {"shm", Transport::kShm}};
+    std::map<std::string, Distribution> dists = {{"uniform", Distribution::kUniform}, {"zipf", Distribution::kZipf}};
+    int opt = 0;
+    bool parse_err = false;
+
+    while (!parse_err && (opt = getopt_long(argc, argv, "", options, nullptr)) != -1) {
+        auto int_opt = int_opts.find(opt);
+        if (opt == '?') {
+            parse_err = true;
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt == static_cast<int>(OptIdx::kZipfAlpha)) {
+            parse_err = 1 != sscanf(optarg, "%lf", &opts->zipf_alpha) || opts->zipf_alpha < 0;
+        } else if (opt == static_cast<int>(OptIdx::kTransport)) {
+            parse_err = transports.count(optarg) == 0;
+            opts->transport = parse_err ? opts->transport : transports[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kDist)) {
+            parse_err = dists.count(optarg) == 0;
+            opts->dist = parse_err ? opts->dist : dists[optarg];
+        } else if (host_utils::IsResultOpt(opt)) {
+            parse_err = !host_utils::ParseResultOpt(opt, optarg, &opts->result);
+        }
+        if (parse_err && opt != '?') {
+            fprintf(stderr, "Invalid option value: %s\n", optarg);
+        }
+    }
+
+    if (!parse_err && opts->topk > nranks * opts->experts_per_rank) {
+        fprintf(stderr, "The topk must not exceed the number of experts.\n");
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Allocate the buffers of this rank, the send and combine regions in a shared-memory window if needed.
+ *
+ * @param ctx The rank.
+ * @return 0 on success, non-zero value on failure.
+ */
+int Setup(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    size_t hidden = opts.hidden;
+    size_t ffn = opts.ffn;
+    size_t rows = static_cast<size_t>(opts.tokens) * opts.topk;
+    int epr = opts.experts_per_rank;
+
+    ctx->num_experts = ctx->nranks * epr;
+    ctx->rng.seed(static_cast<uint64_t>(opts.seed) * 1000003 + ctx->rank);
+    ctx->cdf.resize(ctx->num_experts);
+    double sum = 0;
+    for (int e = 0; e < ctx->num_experts; e++) {
+        sum += opts.dist == Distribution::kZipf ? 1.0 / std::pow(e + 1, opts.zipf_alpha) : 1.0;
+        ctx->cdf[e] = sum;
+    }
+    for (double &c : ctx->cdf) {
+        c /= sum;
+    }
+
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    ctx->x.resize(opts.tokens * hidden);
+    ctx->y.resize(opts.tokens * hidden);
+    for (float &v : ctx->x) {
+        v = uniform(ctx->rng);
+    }
+    // Scale the weights so that the activations keep their magnitude
+    ctx->w_up.resize(epr * hidden * ffn);
+    ctx->w_down.resize(epr * ffn * hidden);
+    for (float &v : ctx->w_up) {
+        v = uniform(ctx->rng) / std::sqrt(static_cast<float>(hidden));
+    }
+    for (float &v : ctx->w_down) {
+        v = uniform(ctx->rng) / std::sqrt(static_cast<float>(ffn));
+    }
+    ctx->row_token.resize(rows);
+    ctx->row_weight.resize(rows);
+    ctx->send_counts.resize(ctx->num_experts);
+    ctx->recv_counts.resize(ctx->num_experts);
+
+    size_t region = rows * hidden;
+    if (opts.transport == Transport::kMpi) {
+        ctx->peer_send.assign(1, new float[region]);
+        ctx->peer_combine.assign(1, new float[region]);
+        ctx->send = ctx->peer_send[0];
+        ctx->combine = ctx->peer_combine[0];
+        return 0;
+    }
+
+    MPI_Comm node_comm;
+    int node_size = 0;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, ctx->rank, MPI_INFO_NULL, &node_comm);
+    MPI_Comm_size(node_comm, &node_size);
+    MPI_Comm_free(&node_comm);
+    if (node_size != ctx->nranks) {
+        fprintf(stderr, "The shm transport needs all ranks on one node, %d of %d are.\n", node_size, ctx->nranks);
+        return -1;
+    }
+    float *base = nullptr;
+    int ret = MPI_Win_allocate_shared(2 * region * sizeof(float), sizeof(float), MPI_INFO_NULL, MPI_COMM_WORLD, &base,
+                                      &ctx->win);
+    if (ret != MPI_SUCCESS) {
+        fprintf(stderr, "Failed to allocate the shared-memory window with MPI error %d.\n", ret);
+        return -1;
+    }
+    ctx->peer_send.resize(ctx->nranks);
+    ctx->peer_combine.resize(ctx->nranks);
+    for (int r = 0; r < ctx->nranks; r++) {
+        MPI_Aint size = 0;
+        int disp_unit = 0;
+        MPI_Win_shared_query(ctx->win, r, &size, &disp_unit, &ctx->peer_send[r]);
+        ctx->peer_combine[r] = ctx->peer_send[r] + region;
+    }
+    ctx->send = base;
+    ctx->combine = base + region;
+    ctx->count_matrix.resize(ctx->nranks * ctx->num_experts);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, ctx->win);
+    return 0;
+}
+
+/**
+ * @brief Release the buffers of this rank.
+ *
+ * @param ctx The rank.
+ */
+void Teardown(Rank *ctx) {
+    if (ctx->win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(ctx->win);
+        MPI_Win_free(&ctx->win);
+    } else {
+        delete[] ctx->send;
+        delete[] ctx->combine;
+    }
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    Rank ctx;
+    MPI_Comm_rank(MPI_COMM_WORLD, &ctx.rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ctx.nranks);
+
+    // Rank 0 parses the options first and reports the errors once for the job, then the other ranks parse the same
+    // arguments, loading the baseline themselves, so that an options struct is never copied across ranks
+    Opts opts;
+    int ret = ctx.rank == 0 ? ParseOpts(argc, argv, ctx.nranks, &opts) : 0;
+    MPI_Bcast(&ret, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (0 == ret && ctx.rank != 0) {
+        ret = ParseOpts(argc, argv, ctx.nranks, &opts);
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &ret, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    ctx.opts = &opts;
+    if (0 == ret) {
+        ret = Setup(&ctx);
+        MPI_Allreduce(MPI_IN_PLACE, &ret, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    }
+    if (0 != ret) {
+        MPI_Finalize();
+        return ret;
+    }
+
+    uint64_t wrong = opts.check ? CheckRoundTrip(&ctx) : 0;
+    for (int i = 0; i < opts.warmup; i++) {
+        StepStats stats;
+        RunStep(&ctx, false, &stats);
+    }
+    std::string prefix = opts.transport == Transport::kMpi ? "mpi" : "shm";
+    host_utils::ResultEmitter *emitter = ctx.rank == 0 ? new host_utils::ResultEmitter(opts.result) : nullptr;
+    StepStats total;
+    int steps = 0;
+    while (steps < opts.steps) {
+        StepStats stats;
+        RunStep(&ctx, false, &stats);
+        steps++;
+        for (int p = 0; p < kNumPhases; p++) {
+            total.time[p] += stats.time[p];
+        }
+        total.dispatch_bytes += stats.dispatch_bytes;
+        total.flops += stats.flops;
+        total.rank_imbalance += stats.rank_imbalance;
+        total.expert_imbalance += stats.expert_imbalance;
+        if (opts.result.fail_fast) {
+            // Rank 0 checks the step time and all ranks stop together at a confirmed failure
+            int stop = 0;
+            if (ctx.rank == 0) {
+                double step_time = std::accumulate(stats.time, stats.time + kNumPhases, 0.0);
+                stop = emitter->Observe(prefix + "_step_time_us", step_time * 1e6);
+            }
+            MPI_Bcast(&stop, 1, MPI_INT, 0, MPI_COMM_WORLD);
+            if (stop) {
+                break;
+            }
+        }
+    }
+    for (int p = 0; p < kNumPhases; p++) {
+        total.time[p] /= steps;
+    }
+    total.dispatch_bytes /= steps;
+    total.flops /= steps;
+    total.rank_imbalance /= steps;
+    total.expert_imbalance /= steps;
+    Teardown(&ctx);
+
+    bool stopped = false;
+    if (ctx.rank == 0) {
+        host_utils::ResultTags tags = {{"transport", prefix}};
+        const char *phase_names[] = {"route", "dispatch", "expert", "combine"};
+        double step_time = 0;
+        for (int p = 0; p < kNumPhases; p++) {
+            emitter->Metric(prefix + "_" + phase_names[p] + "_time_us", total.time[p] * 1e6, "us",
+                            {{"transport", prefix}, {"phase", phase_names[p]}});
+            step_time += total.time[p];
+        }
+        emitter->Metric(prefix + "_step_time_us", step_time * 1e6, "us", tags);
+        emitter->Metric(prefix + "_tokens_per_sec", static_cast<double>(opts.tokens) * ctx.nranks / step_time,
+                        "tokens/s", tags);
+        // The combine moves back as many bytes as the dispatch
+        emitter->Metric(prefix + "_dispatch_bw", total.dispatch_bytes / total.time[kDispatch] / 1e9, "GB/s", tags);
+        emitter->Metric(prefix + "_combine_bw", total.dispatch_bytes / total.time[kCombine] / 1e9, "GB/s", tags);
+        emitter->Metric(prefix + "_expert_gflops", total.flops / total.time[kExpert] / 1e9, "GFLOPS", tags);
+        emitter->Metric(prefix + "_rank_imbalance", total.rank_imbalance, "", tags);
+        emitter->Metric(prefix + "_expert_imbalance", total.expert_imbalance, "", tags);
+        if (opts.check) {
+            emitter->Metric(prefix + "_check_wrong", wrong, "", tags);
+        }
+        stopped = emitter->Stopped();
+    }
+    delete emitter;
+    MPI_Finalize();
+    return wrong == 0 && !stopped ? 0 : 1;
+}
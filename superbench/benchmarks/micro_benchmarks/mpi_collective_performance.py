@@ -0,0 +1,159 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the MPI collective benchmark.
+
+The benchmark prints the same table as nccl-tests, so the result parsing is inherited from the NCCL benchmark.
+It is expected to run in the mpi mode, where every rank runs one process and rank 0 prints the results.
+With --start_skew, the start skew of the iterations on the clock-aligned timeline of rank 0 and the rank which started
+last most often are parsed from the footer of the table.
+"""
+
+import os
+import re
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+from superbench.benchmarks.micro_benchmarks.cuda_nccl_bw_performance import CudaNcclBwBenchmark
+
+
+class MpiCollectiveBenchmark(CudaNcclBwBenchmark):
+    """The MPI collective bus bandwidth benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'mpi_collective'
+        self._operations = ['allreduce', 'allgather', 'reducescatter', 'alltoall', 'broadcast', 'reduce']
+        self._modes = ['blocking', 'nonblocking', 'persistent']
+        self._data_types = ['float', 'double', 'int32', 'int64']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+
+        # Every rank holds a send and a recv buffer of the largest size in host memory
+        self._parser.set_defaults(maxbytes='128M')
+        self._parser.add_argument(
+            '--mode',
+            type=str,
+            default='blocking',
+            help='How the collectives are issued, e.g., {}. Persistent needs MPI 4.0 or Open MPI 4.0+.'.format(
+                ' '.join(self._modes)
+            ),
+        )
+        self._parser.add_argument(
+            '--root',
+            type=int,
+            default=0,
+            help='Root rank of broadcast and reduce.',
+        )
+        self._parser.add_argument(
+            '--start_skew',
+            action='store_true',
+            default=False,
+            help='Align the clocks of the ranks and report the start skew of the iterations and the stragglers.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        # Skip the nccl-tests binary selection of the parent class
+        if not MicroBenchmarkWithInvoke._preprocess(self):
+            return False
+
+        self._args.operation = self._args.operation.lower()
+        for name, value, choices in [
+            ('operation', self._args.operation, self._operations),
+            ('mode', self._args.mode, self._modes),
+            ('data_type', self._args.data_type, self._data_types),
+        ]:
+            if value not in choices:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error(
+                    'Unsupported {} - benchmark: {}, {}: {}, expected: {}.'.format(
+                        name, self._name, name, value, ' '.join(choices)
+                    )
+                )
+                return False
+
+        command = os.path.join(self._args.bin_dir, self._bin_name)
+        command += ' --operation {} --mode {} -b {} -e {} -f {} -c {} -n {} -w {} -d {} -r {}'.format(
+            self._args.operation, self._args.mode, self._args.minbytes, self._args.maxbytes, self._args.stepfactor,
+            self._args.check, self._args.iters, self._args.warmup_iters, self._args.data_type, self._args.root
+        )
+        if self._args.start_skew:
+            command += ' --start_skew 1'
+        self._commands = [command]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+        The table is parsed by the NCCL benchmark, and the start skew footer on top.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        if not super()._process_raw_result(cmd_idx, raw_output):
+            return False
+        if not self._args.start_skew or int(os.getenv('OMPI_COMM_WORLD_RANK', '0')) > 0:
+            return True
+
+        try:
+            skew = self.__match_footer(
+                raw_output, '# Start skew', r'# Start skew \(us\)\s*: avg (\d+\.\d+) max (\d+\.\d+) over \d+ rounds'
+            )
+            clock = self.__match_footer(raw_output, '# Clock error', r'# Clock error \(us\)\s*: (-?\d+\.\d+) max drift')
+        except ValueError as e:
+            self._result.set_return_code(ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+            logger.error(
+                'The start skew footer is invalid - round: {}, benchmark: {}, message: {}.'.format(
+                    self._curr_run_index, self._name, str(e)
+                )
+            )
+            return False
+        stragglers = re.search(r'^# Stragglers\s*:\s*rank (\d+)', raw_output, re.MULTILINE)
+        self._result.add_result(self._args.operation + '_start_skew_avg', float(skew.group(1)))
+        self._result.add_result(self._args.operation + '_start_skew_max', float(skew.group(2)))
+        self._result.add_result(self._args.operation + '_clock_error', float(clock.group(1)))
+        if stragglers is not None:
+            self._result.add_result(self._args.operation + '_top_straggler_rank', int(stragglers.group(1)))
+
+        return True
+
+    def __match_footer(self, raw_output, prefix, pattern):
+        """Match a line of the start skew footer, raising ValueError with the line if it is missing or malformed.
+
+        Args:
+            raw_output (str): raw output string of the micro-benchmark.
+            prefix (str): prefix of the footer line.
+            pattern (str): pattern of the whole footer line.
+
+        Return:
+            The match of the footer line.
+        """
+        line = next((line for line in raw_output.splitlines() if line.startswith(prefix)), None)
+        if line is None:
+            raise ValueError('missing footer line {}'.format(prefix))
+        match = re.match(pattern, line)
+        if match is None:
+            raise ValueError('malformed footer line {}'.format(line))
+        return match
+
+
+BenchmarkRegistry.register_benchmark('mpi-collective', MpiCollectiveBenchmark)
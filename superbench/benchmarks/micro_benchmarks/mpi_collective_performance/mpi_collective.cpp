@@ -0,0 +1,751 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// MPI collective benchmark.
+// Allreduce, allgather, reducescatter, alltoall, broadcast and reduce of the MPI library are swept over message sizes
+// with blocking, non-blocking or persistent calls, and printed in the same table as nccl-tests, so that the output is
+// parsed by the nccl-bw benchmark. Launch it with mpirun, e.g. mpirun -np 8 mpi_collective --operation allreduce.
+// With --start_skew 1, the clocks of the ranks are aligned before every size and the start times of every iteration are
+// compared on the timeline of rank 0, to report the start skew and the ranks which started last most often.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mpi.h>
+#include <unistd.h>
+
+#include "../host_utils/clock_sync_utils.h"
+
+#if defined(OPEN_MPI) && OPEN_MPI
+#include <mpi-ext.h>
+#endif
+
+// Persistent collectives are standard since MPI 4.0, and an extension of Open MPI before.
+#if MPI_VERSION >= 4
+#define HAVE_PERSISTENT_COLLECTIVES 1
+#define PERSISTENT_INIT(name) MPI_##name##_init
+#elif defined(OMPI_HAVE_MPI_EXT_PCOLLREQ) && OMPI_HAVE_MPI_EXT_PCOLLREQ
+#define HAVE_PERSISTENT_COLLECTIVES 1
+#define PERSISTENT_INIT(name) MPIX_##name##_init
+#else
+#define HAVE_PERSISTENT_COLLECTIVES 0
+#define PERSISTENT_INIT(name) PersistentUnsupported
+template <typename... Args> int PersistentUnsupported(Args...) { return MPI_ERR_OTHER; }
+#endif
+
+// Collective operations.
+enum class Operation { kAllReduce, kAllGather, kReduceScatter, kAllToAll, kBroadcast, kReduce };
+
+// How a collective is issued.
+enum class Mode { kBlocking, kNonBlocking, kPersistent };
+
+// Element types.
+enum class DataType { kFloat, kDouble, kInt32, kInt64 };
+
+// Alignment of the buffers.
+constexpr size_t kBufAlignment = 4096;
+
+// Options accepted by this program, named after their nccl-tests counterparts.
+struct Opts {
+    // Collective operation.
+    Operation operation = Operation::kAllReduce;
+
+    // How the collective is issued.
+    Mode mode = Mode::kBlocking;
+
+    // Element type.
+    DataType data_type = DataType::kFloat;
+
+    // Smallest message size in bytes.
+    size_t min_bytes = 8;
+
+    // Largest message size in bytes.
+    size_t max_bytes = 32 << 20;
+
+    // Multiplication factor between sizes.
+    int step_factor = 2;
+
+    // Number of timed iterations.
+    int iters = 20;
+
+    // Number of warmup iterations.
+    int warmup_iters = 5;
+
+    // Whether to check the results.
+    int check = 0;
+
+    // Root rank of broadcast and reduce.
+    int root = 0;
+
+    // Whether to report the start skew of the iterations and the stragglers.
+    int start_skew = 0;
+};
+
+// Arguments of one collective call.
+struct CollArgs {
+    // Input, MPI_IN_PLACE for the in-place variants.
+    const void *send;
+
+    // Output, also the input of the in-place variants.
+    void *recv;
+
+    // Number of elements of allreduce, broadcast and reduce, of the block exchanged with each rank otherwise.
+    int count;
+
+    // Element type.
+    MPI_Datatype type;
+
+    // Root rank.
+    int root;
+};
+
+/**
+ * @brief Issue one collective.
+ *
+ * @param operation The operation.
+ * @param mode How to issue it, blocking calls complete before returning, the others return a request.
+ * @param a The arguments.
+ * @param comm The communicator.
+ * @param req The request to complete, or to start for the persistent mode.
+ * @return MPI_SUCCESS on success, an MPI error code on failure.
+ */
+int IssueCollective(Operation operation, Mode mode, const CollArgs &a, MPI_Comm comm, MPI_Request *req) {
+#define ISSUE_COLLECTIVE(name, iname, ...)                                                                             \
+    switch (mode) {                                                                                                    \
+    case Mode::kBlocking:                                                                                              \
+        *req = MPI_REQUEST_NULL;                                                                                       \
+        return MPI_##name(__VA_ARGS__);                                                                                \
+    case Mode::kNonBlocking:                                                                                           \
+        return MPI_##iname(__VA_ARGS__, req);                                                                          \
+    case Mode::kPersistent:                                                                                            \
+        return PERSISTENT_INIT(name)(__VA_ARGS__, MPI_INFO_NULL, req);                                                 \
+    }                                                                                                                  \
+    break
+
+    switch (operation) {
+    case Operation::kAllReduce:
+        ISSUE_COLLECTIVE(Allreduce, Iallreduce, a.send, a.recv, a.count, a.type, MPI_SUM, comm);
+    case Operation::kAllGather:
+        ISSUE_COLLECTIVE(Allgather, Iallgather, a.send, a.count, a.type, a.recv, a.count, a.type, comm);
+    case Operation::kReduceScatter:
+        ISSUE_COLLECTIVE(Reduce_scatter_block, Ireduce_scatter_block, a.send, a.recv, a.count, a.type, MPI_SUM, comm);
+    case Operation::kAllToAll:
+        ISSUE_COLLECTIVE(Alltoall, Ialltoall, a.send, a.count, a.type, a.recv, a.count, a.type, comm);
+    case Operation::kBroadcast:
+        ISSUE_COLLECTIVE(Bcast, Ibcast, a.recv, a.count, a.type, a.root, comm);
+    case Operation::kReduce:
+        ISSUE_COLLECTIVE(Reduce, Ireduce, a.send, a.recv, a.count, a.type, MPI_SUM, a.root, comm);
+    }
+#undef ISSUE_COLLECTIVE
+    return MPI_ERR_OTHER;
+}
+
+/**
+ * @brief Run one collective to completion, aborting the job on failure.
+ *
+ * @param opts The options.
+ * @param a The arguments.
+ * @param req The persistent request, unused in the other modes.
+ */
+void RunCollective(const Opts &opts, const CollArgs &a, MPI_Request *req) {
+    int ret = MPI_SUCCESS;
+    if (opts.mode == Mode::kPersistent) {
+        ret = MPI_Start(req);
+    } else {
+        ret = IssueCollective(opts.operation, opts.mode, a, MPI_COMM_WORLD, req);
+    }
+    if (ret == MPI_SUCCESS && opts.mode != Mode::kBlocking) {
+        ret = MPI_Wait(req, MPI_STATUS_IGNORE);
+    }
+    if (ret != MPI_SUCCESS) {
+        fprintf(stderr, "The collective failed with MPI error %d.\n", ret);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+/**
+ * @brief Get the input value of an element, small integers so that float sums are exact.
+ *
+ * @param rank The rank owning the input.
+ * @param index The index of the element in the input.
+ * @return The value.
+ */
+template <typename T> T InputValue(int rank, size_t index) { return static_cast<T>((rank + 1) * (index % 13 + 1)); }
+
+/**
+ * @brief Fill the input of this rank, and poison its output.
+ *
+ * @param input The input.
+ * @param input_count The number of input elements.
+ * @param output The output, may overlap the input which is then filled last.
+ * @param output_count The number of output elements.
+ * @param rank The rank.
+ */
+template <typename T> void InitBuffers(void *input, size_t input_count, void *output, size_t output_count, int rank) {
+    std::fill(static_cast<T *>(output), static_cast<T *>(output) + output_count, static_cast<T>(-1));
+    for (size_t i = 0; i < input_count; i++) {
+        static_cast<T *>(input)[i] = InputValue<T>(rank, i);
+    }
+}
+
+/**
+ * @brief Count the wrong output elements of this rank.
+ *
+ * @param opts The options.
+ * @param output The output.
+ * @param count The count of the collective, as in CollArgs.
+ * @param rank The rank.
+ * @param nranks The number of ranks.
+ * @return The number of wrong elements.
+ */
+template <typename T> uint64_t CountWrong(const Opts &opts, const void *output, size_t count, int rank, int nranks) {
+    const T *recv = static_cast<const T *>(output);
+    uint64_t wrong = 0;
+    auto sum = [nranks](size_t index) { return static_cast<T>(nranks * (nranks + 1) / 2 * (index % 13 + 1)); };
+    switch (opts.operation) {
+    case Operation::kAllReduce:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != sum(i);
+        }
+        break;
+    case Operation::kAllGather:
+        for (size_t i = 0; i < nranks * count; i++) {
+            wrong += recv[i] != InputValue<T>(i / count, i % count);
+        }
+        break;
+    case Operation::kReduceScatter:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != sum(rank * count + i);
+        }
+        break;
+    case Operation::kAllToAll:
+        for (size_t i = 0; i < nranks * count; i++) {
+            wrong += recv[i] != InputValue<T>(i / count, rank * count + i % count);
+        }
+        break;
+    case Operation::kBroadcast:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != InputValue<T>(opts.root, i);
+        }
+        break;
+    case Operation::kReduce:
+        for (size_t i = 0; rank == opts.root && i < count; i++) {
+            wrong += recv[i] != sum(i);
+        }
+        break;
+    }
+    return wrong;
+}
+
+// Result of one variant of one size.
+struct VariantResult {
+    double time_us = 0;
+    double algbw = 0;
+    double busbw = 0;
+    int64_t wrong = -1;
+};
+
+/**
+ * @brief Get the bus bandwidth factor of nccl-tests for an operation.
+ *
+ * @param operation The operation.
+ * @param nranks The number of ranks.
+ * @return The factor from algorithm bandwidth to bus bandwidth.
+ */
+double BusBwFactor(Operation operation, int nranks) {
+    switch (operation) {
+    case Operation::kAllReduce:
+        return 2.0 * (nranks - 1) / nranks;
+    case Operation::kBroadcast:
+    case Operation::kReduce:
+        return 1;
+    default:
+        return static_cast<double>(nranks - 1) / nranks;
+    }
+}
+
+// Buffers and placement of this rank.
+struct Rank {
+    const Opts *opts;
+    char *send;
+    char *recv;
+    int rank;
+    int nranks;
+
+    // Clock alignment and start skew of the iterations, nullptr unless the start skew is reported.
+    host_utils::ClockSync *clock;
+    host_utils::SkewTracker *skew;
+};
+
+/**
+ * @brief Gather the start times of the iterations of all ranks on the timeline of rank 0, and add them to the tracker.
+ *
+ * @param ctx The rank.
+ * @param starts_ns The local start times of the iterations on this rank.
+ */
+void RecordSkew(Rank *ctx, const std::vector<int64_t> &starts_ns) {
+    std::vector<double> global(starts_ns.size());
+    for (size_t i = 0; i < starts_ns.size(); i++) {
+        global[i] = ctx->clock->ToGlobal(starts_ns[i]);
+    }
+    std::vector<double> all(ctx->rank == 0 ? global.size() * ctx->nranks : 0);
+    MPI_Gather(global.data(), static_cast<int>(global.size()), MPI_DOUBLE, all.data(), static_cast<int>(global.size()),
+               MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    std::vector<double> round(ctx->nranks);
+    for (size_t i = 0; ctx->rank == 0 && i < global.size(); i++) {
+        for (int r = 0; r < ctx->nranks; r++) {
+            round[r] = all[r * global.size() + i];
+        }
+        ctx->skew->AddRound(round.data());
+    }
+}
+
+/**
+ * @brief Run one variant of one size on this rank, checking the results first if requested.
+ *
+ * @param ctx The rank.
+ * @param in_place Whether to run the in-place variant.
+ * @param bytes The message size in bytes as printed by nccl-tests.
+ * @param result The result, valid on every rank.
+ */
+template <typename T> void RunVariant(Rank *ctx, bool in_place, size_t bytes, VariantResult *result) {
+    const Opts &opts = *ctx->opts;
+    int n = ctx->nranks;
+    int r = ctx->rank;
+    size_t total = bytes / sizeof(T);
+    bool blocked = opts.operation == Operation::kAllGather || opts.operation == Operation::kReduceScatter ||
+                   opts.operation == Operation::kAllToAll;
+    size_t count = blocked ? total / n : total;
+    size_t input_count = opts.operation == Operation::kAllGather ? count : total;
+    size_t output_count = opts.operation == Operation::kReduceScatter ? count : total;
+
+    // The in-place variants find their input where the output goes, the block of this rank for allgather
+    CollArgs args = {ctx->send, ctx->recv, static_cast<int>(count), MPI_DATATYPE_NULL, opts.root};
+    void *input = ctx->send;
+    if (opts.operation == Operation::kBroadcast) {
+        input = ctx->recv;
+    } else if (in_place) {
+        args.send = MPI_IN_PLACE;
+        input = opts.operation == Operation::kAllGather ? ctx->recv + r * count * sizeof(T) : ctx->recv;
+        if (opts.operation == Operation::kReduce && r != opts.root) {
+            // Only the root of reduce has an output
+            args.send = ctx->recv;
+        }
+    }
+    switch (opts.data_type) {
+    case DataType::kFloat:
+        args.type = MPI_FLOAT;
+        break;
+    case DataType::kDouble:
+        args.type = MPI_DOUBLE;
+        break;
+    case DataType::kInt32:
+        args.type = MPI_INT32_T;
+        break;
+    case DataType::kInt64:
+        args.type = MPI_INT64_T;
+        break;
+    }
+
+    MPI_Request req = MPI_REQUEST_NULL;
+    if (opts.mode == Mode::kPersistent) {
+        int ret = IssueCollective(opts.operation, opts.mode, args, MPI_COMM_WORLD, &req);
+        if (ret != MPI_SUCCESS) {
+            fprintf(stderr, "Failed to initialize the persistent collective with MPI error %d.\n", ret);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    if (opts.check) {
+        bool root_only = opts.operation == Operation::kBroadcast && r != opts.root;
+        InitBuffers<T>(input, root_only ? 0 : input_count, ctx->recv, output_count, r);
+        RunCollective(opts, args, &req);
+        uint64_t wrong = CountWrong<T>(opts, ctx->recv, count, r, n);
+        MPI_Allreduce(MPI_IN_PLACE, &wrong, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+        result->wrong = static_cast<int64_t>(wrong);
+    }
+
+    for (int i = 0; i < opts.warmup_iters; i++) {
+        RunCollective(opts, args, &req);
+    }
+    std::vector<int64_t> starts_ns(ctx->clock != nullptr ? opts.iters : 0);
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = MPI_Wtime();
+    for (int i = 0; i < opts.iters; i++) {
+        if (ctx->clock != nullptr) {
+            starts_ns[i] = host_utils::MonotonicNs();
+        }
+        RunCollective(opts, args, &req);
+    }
+    double seconds = (MPI_Wtime() - start) / std::max(opts.iters, 1);
+    if (req != MPI_REQUEST_NULL) {
+        MPI_Request_free(&req);
+    }
+    if (ctx->clock != nullptr) {
+        RecordSkew(ctx, starts_ns);
+    }
+
+    // Average the time over the ranks, as nccl-tests does
+    MPI_Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    seconds /= n;
+    result->time_us = seconds * 1e6;
+    result->algbw = bytes / seconds / 1e9;
+    result->busbw = result->algbw * BusBwFactor(opts.operation, n);
+}
+
+/**
+ * @brief Format a value in at most width characters with as many decimals as fit, as nccl-tests does.
+ *
+ * @param value The value.
+ * @param width The width.
+ * @return The formatted value.
+ */
+std::string FormatFloat(double value, int width) {
+    char str[32];
+    for (int precision = 2; precision >= 0; precision--) {
+        snprintf(str, sizeof(str), "%*.*f", width, precision, value);
+        if (static_cast<int>(strlen(str)) <= width) {
+            break;
+        }
+    }
+    return str;
+}
+
+/**
+ * @brief Get the nccl-tests name of a data type.
+ *
+ * @param data_type The data type.
+ * @return The name.
+ */
+const char *DataTypeName(DataType data_type) {
+    switch (data_type) {
+    case DataType::kFloat:
+        return "float";
+    case DataType::kDouble:
+        return "double";
+    case DataType::kInt32:
+        return "int32";
+    case DataType::kInt64:
+        return "int64";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the start skew, the stragglers and the accuracy of the clock alignment, collective.
+ *
+ * @param ctx The rank.
+ */
+void PrintSkew(Rank *ctx) {
+    double clock[2] = {ctx->clock->ErrorNs(), std::abs(ctx->clock->DriftPpm())};
+    MPI_Allreduce(MPI_IN_PLACE, clock, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    if (ctx->rank != 0) {
+        return;
+    }
+    printf("# Start skew (us)      : avg %.2f max %.2f over %llu rounds\n", ctx->skew->MeanSkewNs() / 1e3,
+           ctx->skew->MaxSkewNs() / 1e3, static_cast<unsigned long long>(ctx->skew->Rounds()));
+    printf("# Stragglers           :");
+    for (const auto &straggler : ctx->skew->Stragglers(3)) {
+        printf(" rank %d %.1f%%", straggler.first, 100.0 * straggler.second / ctx->skew->Rounds());
+    }
+    printf("\n# Clock error (us)     : %.2f max drift %.3f ppm\n", clock[0] / 1e3, clock[1]);
+}
+
+/**
+ * @brief Sweep the message sizes on this rank, rank 0 prints the table rows.
+ *
+ * @param ctx The rank.
+ * @return The number of wrong elements found.
+ */
+template <typename T> uint64_t RunSweep(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    bool reduce = opts.operation == Operation::kAllReduce || opts.operation == Operation::kReduceScatter ||
+                  opts.operation == Operation::kReduce;
+    bool rooted = opts.operation == Operation::kBroadcast || opts.operation == Operation::kReduce;
+    bool blocked = opts.operation == Operation::kAllGather || opts.operation == Operation::kReduceScatter ||
+                   opts.operation == Operation::kAllToAll;
+    size_t unit = sizeof(T) * (blocked ? ctx->nranks : 1);
+    uint64_t wrong = 0;
+    double busbw_sum = 0;
+    int busbw_num = 0;
+    for (size_t size = opts.min_bytes; size <= opts.max_bytes; size *= opts.step_factor) {
+        // Round down to whole elements for every rank, as nccl-tests does
+        size_t bytes = size / unit * unit;
+        if (ctx->clock != nullptr) {
+            // Follow the drift over the sweep
+            ctx->clock->Estimate();
+        }
+        VariantResult results[2];
+        RunVariant<T>(ctx, false, bytes, &results[0]);
+        RunVariant<T>(ctx, true, bytes, &results[1]);
+        if (ctx->rank == 0) {
+            printf("%12zu  %12zu  %8s  %6s  %6d", bytes, bytes / sizeof(T), DataTypeName(opts.data_type),
+                   reduce ? "sum" : "none", rooted ? opts.root : -1);
+            for (const auto &result : results) {
+                printf("  %7s  %6.2f  %6.2f  %6s", FormatFloat(result.time_us, 7).c_str(), result.algbw, result.busbw,
+                       result.wrong < 0 ? "N/A" : std::to_string(result.wrong).c_str());
+                busbw_sum += result.busbw;
+                busbw_num++;
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        for (const auto &result : results) {
+            wrong += std::max<int64_t>(result.wrong, 0);
+        }
+        if (size * opts.step_factor <= size) {
+            break;
+        }
+    }
+    if (ctx->rank == 0) {
+        printf("# Out of bounds values : %llu %s\n", static_cast<unsigned long long>(wrong),
+               wrong == 0 ? "OK" : "FAILED");
+        printf("# Avg bus bandwidth    : %g \n", busbw_num > 0 ? busbw_sum / busbw_num : 0.0);
+    }
+    if (ctx->clock != nullptr) {
+        PrintSkew(ctx);
+    }
+    if (ctx->rank == 0) {
+        printf("#\n");
+        fflush(stdout);
+    }
+    return wrong;
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    printf("Usage: mpirun -np <ranks> mpi_collective "
+           "[--operation allreduce|allgather|reducescatter|alltoall|broadcast|reduce] "
+           "[--mode blocking|nonblocking|persistent] "
+           "[-b,--minbytes <bytes>] "
+           "[-e,--maxbytes <bytes>] "
+           "[-f,--stepfactor <num>] "
+           "[-n,--iters <num>] "
+           "[-w,--warmup_iters <num>] "
+           "[-c,--check <0|1>] "
+           "[-d,--datatype float|double|int32|int64] "
+           "[-r,--root <rank>] "
+           "[--start_skew <0|1>]\n");
+}
+
+/**
+ * @brief Parse a size with an optional K/M/G suffix in powers of 1024, as nccl-tests does.
+ *
+ * @param str The string to parse.
+ * @param value The parsed size.
+ * @return true if the size is valid.
+ */
+bool ParseBytes(const char *str, size_t *value) {
+    char *end = nullptr;
+    unsigned long long number = strtoull(str, &end, 10);
+    std::map<char, int> shifts = {{'\0', 0}, {'K', 10}, {'k', 10}, {'M', 20}, {'m', 20}, {'G', 30}, {'g', 30}};
+    if (end == str || shifts.count(*end) == 0 || (*end != '\0' && end[1] != '\0')) {
+        return false;
+    }
+    *value = static_cast<size_t>(number) << shifts[*end];
+    return true;
+}
+
+/**
+ * @brief Parses command-line options for the MPI collective benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param nranks The number of ranks.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, int nranks, Opts *opts) {
+    enum class OptIdx { kOperation = 256, kMode, kStartSkew };
+    const struct option options[] = {{"operation", required_argument, nullptr, static_cast<int>(OptIdx::kOperation)},
+                                     {"mode", required_argument, nullptr, static_cast<int>(OptIdx::kMode)},
+                                     {"minbytes", required_argument, nullptr, 'b'},
+                                     {"maxbytes", required_argument, nullptr, 'e'},
+                                     {"stepfactor", required_argument, nullptr, 'f'},
+                                     {"iters", required_argument, nullptr, 'n'},
+                                     {"warmup_iters", required_argument, nullptr, 'w'},
+                                     {"check", required_argument, nullptr, 'c'},
+                                     {"datatype", required_argument, nullptr, 'd'},
+                                     {"root", required_argument, nullptr, 'r'},
+                                     {"start_skew", required_argument, nullptr, static_cast<int>(OptIdx::kStartSkew)},
+                                     {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by option value
+    std::map<int, std::pair<int *, int>> int_opts = {{'f', {&opts->step_factor, 2}},
+                                                     {'n', {&opts->iters, 1}},
+                                                     {'w', {&opts->warmup_iters, 0}},
+                                                     {'c', {&opts->check, 0}},
+                                                     {'r', {&opts->root, 0}},
+                                                     {static_cast<int>(OptIdx::kStartSkew), {&opts->start_skew, 0}}};
+    std::map<std::string, Operation> operations = {{"allreduce", Operation::kAllReduce},
+                                                   {"allgather", Operation::kAllGather},
+                                                   {"reducescatter", Operation::kReduceScatter},
+                                                   {"alltoall", Operation::kAllToAll},
+                                                   {"broadcast", Operation::kBroadcast},
+                                                   {"reduce", Operation::kReduce}};
+    std::map<std::string, Mode> modes = {
+        {"blocking", Mode::kBlocking}, {"nonblocking", Mode::kNonBlocking}, {"persistent", Mode::kPersistent}};
+    std::map<std::string, DataType> data_types = {{"float", DataType::kFloat},
+                                                  {"double", DataType::kDouble},
+                                                  {"int32", DataType::kInt32},
+                                                  {"int64", DataType::kInt64}};
+    int opt = 0;
+    bool parse_err = false;
+
+    while (!parse_err && (opt = getopt_long(argc, argv, "b:e:f:n:w:c:d:r:", options, nullptr)) != -1) {
+        auto int_opt = int_opts.find(opt);
+        if (opt == '?') {
+            parse_err = true;
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt == 'b') {
+            parse_err = !ParseBytes(optarg, &opts->min_bytes) || opts->min_bytes == 0;
+        } else if (opt == 'e') {
+            parse_err = !ParseBytes(optarg, &opts->max_bytes) || opts->max_bytes == 0;
+        } else if (opt == 'd') {
+            parse_err = data_types.count(optarg) == 0;
+            opts->data_type = parse_err ? opts->data_type : data_types[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kOperation)) {
+            parse_err = operations.count(optarg) == 0;
+            opts->operation = parse_err ? opts->operation : operations[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kMode)) {
+            parse_err = modes.count(optarg) == 0;
+            opts->mode = parse_err ? opts->mode : modes[optarg];
+        }
+        if (parse_err && opt != '?') {
+            fprintf(stderr, "Invalid option value: %s\n", optarg);
+        }
+    }
+
+    if (!parse_err && (opts->min_bytes > opts->max_bytes || opts->root >= nranks)) {
+        fprintf(stderr, "The minbytes must not exceed the maxbytes and the root must be a valid rank.\n");
+        parse_err = true;
+    }
+    // MPI counts are int
+    if (!parse_err && opts->max_bytes / 4 > static_cast<size_t>(INT32_MAX)) {
+        fprintf(stderr, "The maxbytes must not exceed %zu.\n", static_cast<size_t>(INT32_MAX) * 4);
+        parse_err = true;
+    }
+    if (!parse_err && opts->mode == Mode::kPersistent && !HAVE_PERSISTENT_COLLECTIVES) {
+        fprintf(stderr, "The MPI library does not support persistent collectives.\n");
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Print the header of the table with the placement of the ranks.
+ *
+ * @param opts The options.
+ * @param nranks The number of ranks.
+ * @param hosts The host names of all ranks.
+ * @param pids The process ids of all ranks.
+ */
+void PrintHeader(const Opts &opts, int nranks, const std::vector<char> &hosts, const std::vector<int> &pids) {
+    const char *op_names[] = {"allreduce", "allgather", "reducescatter", "alltoall", "broadcast", "reduce"};
+    const char *mode_names[] = {"blocking", "nonblocking", "persistent"};
+    char library[MPI_MAX_LIBRARY_VERSION_STRING] = {};
+    int len = 0;
+    MPI_Get_library_version(library, &len);
+    library[strcspn(library, ",\n")] = '\0';
+
+    printf("# nRanks %d minBytes %zu maxBytes %zu step: %d(factor) warmup iters: %d iters: %d validation: %d\n",
+           nranks, opts.min_bytes, opts.max_bytes, opts.step_factor, opts.warmup_iters, opts.iters, opts.check);
+    printf("# Operation: %s, mode: %s, library: %s\n", op_names[static_cast<int>(opts.operation)],
+           mode_names[static_cast<int>(opts.mode)], library);
+    printf("#\n# Using ranks\n");
+    for (int r = 0; r < nranks; r++) {
+        printf("#  Rank %2d Pid %6d on %10s\n", r, pids[r], &hosts[r * MPI_MAX_PROCESSOR_NAME]);
+    }
+    printf("#\n");
+    printf("#%74s%33s\n", "out-of-place", "in-place");
+    printf("#%11s  %12s  %8s  %6s  %6s  %7s  %6s  %6s  %6s  %7s  %6s  %6s  %6s\n", "size", "count", "type", "redop",
+           "root", "time", "algbw", "busbw", "#wrong", "time", "algbw", "busbw", "#wrong");
+    printf("#%11s  %12s  %8s  %6s  %6s  %7s  %6s  %6s  %6s  %7s  %6s  %6s  %6s\n", "(B)", "(elements)", "", "", "",
+           "(us)", "(GB/s)", "(GB/s)", "", "(us)", "(GB/s)", "(GB/s)", "");
+    fflush(stdout);
+}
+
+int main(int argc, char **argv) {
+    MPI_Init(&argc, &argv);
+    int rank = 0, nranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+
+    // Rank 0 parses the options and reports the errors once for the job
+    Opts opts;
+    int ret = rank == 0 ? ParseOpts(argc, argv, nranks, &opts) : 0;
+    MPI_Bcast(&ret, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Bcast(&opts, sizeof(opts), MPI_BYTE, 0, MPI_COMM_WORLD);
+    if (0 != ret) {
+        MPI_Finalize();
+        return ret;
+    }
+
+    char host[MPI_MAX_PROCESSOR_NAME] = {};
+    int len = 0;
+    MPI_Get_processor_name(host, &len);
+    int pid = getpid();
+    std::vector<char> hosts(rank == 0 ? nranks * MPI_MAX_PROCESSOR_NAME : 0);
+    std::vector<int> pids(rank == 0 ? nranks : 0);
+    MPI_Gather(host, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, hosts.data(), MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0,
+               MPI_COMM_WORLD);
+    MPI_Gather(&pid, 1, MPI_INT, pids.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        PrintHeader(opts, nranks, hosts, pids);
+    }
+
+    size_t buf_size = (opts.max_bytes + kBufAlignment - 1) / kBufAlignment * kBufAlignment;
+    char *send = static_cast<char *>(aligned_alloc(kBufAlignment, buf_size));
+    char *recv = static_cast<char *>(aligned_alloc(kBufAlignment, buf_size));
+    if (send == nullptr || recv == nullptr) {
+        fprintf(stderr, "Failed to allocate the buffers of %zu bytes on rank %d.\n", buf_size, rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    // Fault the pages in before the sweep
+    memset(send, 0, buf_size);
+    memset(recv, 0, buf_size);
+
+    host_utils::ClockSync clock(MPI_COMM_WORLD);
+    host_utils::SkewTracker skew(nranks);
+    Rank ctx = {&opts, send, recv, rank, nranks, nullptr, nullptr};
+    if (opts.start_skew) {
+        ctx.clock = &clock;
+        ctx.skew = &skew;
+    }
+    uint64_t wrong = 0;
+    switch (opts.data_type) {
+    case DataType::kFloat:
+        wrong = RunSweep<float>(&ctx);
+        break;
+    case DataType::kDouble:
+        wrong = RunSweep<double>(&ctx);
+        break;
+    case DataType::kInt32:
+        wrong = RunSweep<int32_t>(&ctx);
+        break;
+    case DataType::kInt64:
+        wrong = RunSweep<int64_t>(&ctx);
+        break;
+    }
+
+    free(send);
+    free(recv);
+    MPI_Finalize();
+    return wrong == 0 ? 0 : 1;
+}
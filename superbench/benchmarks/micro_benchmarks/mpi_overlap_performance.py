@@ -0,0 +1,172 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the MPI communication progress and overlap benchmark.
+
+Unlike computation-communication-overlap, the compute kernels and the collectives run natively without a framework,
+so that the progress behavior of the MPI library is isolated.
+It is expected to run in the mpi mode, where every rank runs one process and rank 0 prints the results.
+"""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class MpiOverlapBenchmark(MicroBenchmarkWithInvoke):
+    """The MPI communication progress and overlap benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'mpi_overlap'
+        self._progresses = ['none', 'thread', 'poll', 'async']
+        self._kernels = ['mul', 'matmul']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--progress',
+            type=str,
+            nargs='+',
+            default=self._progresses,
+            help='Progress strategies to test. E.g. {}.'.format(' '.join(self._progresses)),
+        )
+        self._parser.add_argument(
+            '--kernel',
+            type=str,
+            nargs='+',
+            default=self._kernels,
+            help='Computation kernel type. E.g. {}.'.format(' '.join(self._kernels)),
+        )
+        self._parser.add_argument(
+            '--m',
+            type=int,
+            default=256,
+            required=False,
+            help='The M dim of matmul (M, K) * (K, N) or of mul (M, K) * (M, K).',
+        )
+        self._parser.add_argument(
+            '--k',
+            type=int,
+            default=512,
+            required=False,
+            help='The K dim of matmul (M, K) * (K, N) or of mul (M, K) * (M, K).',
+        )
+        self._parser.add_argument(
+            '--n',
+            type=int,
+            default=512,
+            required=False,
+            help='The N dim of matmul (M, K) * (K, N).',
+        )
+        self._parser.add_argument(
+            '--ratio',
+            type=int,
+            default=0,
+            required=False,
+            help='Number of kernel calls per allreduce, 0 to calibrate the compute time to the communication time.',
+        )
+        self._parser.add_argument(
+            '--compute_threads',
+            type=int,
+            default=1,
+            required=False,
+            help='Number of compute threads per rank.',
+        )
+        self._parser.add_argument(
+            '--progress_cpu',
+            type=int,
+            default=-1,
+            required=False,
+            help='CPU to pin the progress thread to, -1 to not pin.',
+        )
+        self._parser.add_argument(
+            '--msg_size',
+            type=str,
+            default='8M',
+            required=False,
+            help='Size of the allreduce, e.g. 64M.',
+        )
+        self._parser.add_argument(
+            '--num_warmup',
+            type=int,
+            default=3,
+            required=False,
+            help='The number of warmup step.',
+        )
+        self._parser.add_argument(
+            '--num_steps',
+            type=int,
+            default=20,
+            required=False,
+            help='The number of test step.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for name, values, choices in [
+            ('progress', self._args.progress, self._progresses),
+            ('kernel', self._args.kernel, self._kernels),
+        ]:
+            for value in values:
+                if value not in choices:
+                    self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                    logger.error('Invalid {} - benchmark: {}, {}: {}.'.format(name, self._name, name, value))
+                    return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = '--kernel %s --m %d --k %d --n %d --ratio %d --compute_threads %d --progress_cpu %d --msg_size %s ' \
+            '--iters %d --warmup %d' % (
+                ','.join(self._args.kernel), self._args.m, self._args.k, self._args.n, self._args.ratio,
+                self._args.compute_threads, self._args.progress_cpu, self._args.msg_size, self._args.num_steps,
+                self._args.num_warmup
+            )
+        # The asynchronous progress settings are read at MPI initialization, so every strategy runs in its own job
+        args += self._result_record_args()
+        self._commands = [
+            '%s --progress %s %s' % (self.__bin_path, progress, args) for progress in self._args.progress
+        ]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        # If it's invoked by MPI and rank is not 0, empty content is expected
+        if os.getenv('OMPI_COMM_WORLD_RANK'):
+            rank = int(os.getenv('OMPI_COMM_WORLD_RANK'))
+            if rank > 0:
+                return True
+
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('mpi-overlap', MpiOverlapBenchmark)
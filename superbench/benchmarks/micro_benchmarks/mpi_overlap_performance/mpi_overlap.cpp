@@ -0,0 +1,564 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// MPI communication progress and overlap benchmark.
+// Compute threads run a calibrated mul or matmul kernel while a non-blocking allreduce is in flight, and the overlapped
+// time is compared with the compute and communication times alone. The collective progresses only inside MPI calls
+// unless a progress strategy drives it: a dedicated thread polling MPI_Test, MPI_Test between kernel calls, or the
+// asynchronous progress of the MPI library. Launch it with mpirun, e.g. mpirun -np 8 mpi_overlap --progress thread.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <getopt.h>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mpi.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../host_utils/result_emitter.h"
+
+// Strategies to progress the collective during compute.
+enum class Progress { kNone, kThread, kPoll, kAsync };
+
+// Compute kernels, named after those of the computation-communication-overlap benchmark.
+enum class Kernel { kMul, kMatmul };
+
+// Options accepted by this program.
+struct Opts {
+    // Progress strategy.
+    Progress progress = Progress::kNone;
+
+    // Compute kernels to test.
+    std::vector<Kernel> kernels = {Kernel::kMul, Kernel::kMatmul};
+
+    // The M, K and N dims of matmul (M, K) * (K, N), and of mul (M, K) * (M, K).
+    int m = 256;
+    int k = 512;
+    int n = 512;
+
+    // Number of kernel calls per collective, 0 to calibrate the compute time to the communication time.
+    int ratio = 0;
+
+    // Number of compute threads.
+    int compute_threads = 1;
+
+    // CPU to pin the progress thread to, -1 to not pin.
+    int progress_cpu = -1;
+
+    // Size of the allreduce in bytes.
+    size_t msg_size = 8 << 20;
+
+    // Number of timed iterations.
+    int iters = 20;
+
+    // Number of warmup iterations.
+    int warmup = 3;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Spin until a flag reaches a value, yielding so that oversubscribed ranks still make progress.
+template <typename T> void SpinUntil(const std::atomic<T> &flag, T value) {
+    for (int spin = 0; flag.load() != value; spin = std::min(spin + 1, 1000)) {
+        if (spin == 1000) {
+            sched_yield();
+        }
+    }
+}
+
+// Compute threads sharing the rows of the kernel, the calling thread being worker 0.
+class ComputePool {
+  public:
+    /**
+     * @brief Start the helper threads.
+     *
+     * @param num_threads The number of compute threads, including the calling one.
+     */
+    explicit ComputePool(int num_threads) : num_threads_(num_threads) {
+        for (int t = 1; t < num_threads; t++) {
+            threads_.emplace_back([this, t]() { Worker(t); });
+        }
+    }
+
+    ~ComputePool() {
+        stop_.store(true);
+        generation_.fetch_add(1);
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    /**
+     * @brief Run a job on all threads and wait for them.
+     *
+     * @param job The job, called with the thread index and the number of threads.
+     */
+    void Run(const std::function<void(int, int)> &job) {
+        job_ = &job;
+        done_.store(0);
+        generation_.fetch_add(1);
+        job(0, num_threads_);
+        SpinUntil(done_, num_threads_ - 1);
+    }
+
+  private:
+    void Worker(int index) {
+        for (uint64_t seen = 0;;) {
+            SpinUntil(generation_, seen + 1);
+            seen++;
+            if (stop_.load()) {
+                return;
+            }
+            (*job_)(index, num_threads_);
+            done_.fetch_add(1);
+        }
+    }
+
+    int num_threads_;
+    std::vector<std::thread> threads_;
+    const std::function<void(int, int)> *job_ = nullptr;
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<int> done_{0};
+    std::atomic<bool> stop_{false};
+};
+
+// Thread polling MPI_Test on the request of the collective while it is active.
+class ProgressThread {
+  public:
+    /**
+     * @brief Start the thread, idle until a request is given.
+     *
+     * @param cpu The CPU to pin the thread to, -1 to not pin.
+     */
+    explicit ProgressThread(int cpu) {
+        thread_ = std::thread([this]() { Loop(); });
+        if (cpu >= 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+            pthread_setaffinity_np(thread_.native_handle(), sizeof(cpus), &cpus);
+        }
+    }
+
+    ~ProgressThread() {
+        state_.store(kStop);
+        thread_.join();
+    }
+
+    /**
+     * @brief Poll a request until it completes or Stop() is called.
+     *
+     * @param req The request, not to be used by the caller until Stop() returns.
+     */
+    void Start(MPI_Request *req) {
+        req_ = req;
+        state_.store(kActive);
+    }
+
+    /**
+     * @brief Stop polling, and wait until the thread leaves MPI.
+     */
+    void Stop() {
+        // The thread is already idle if the request completed
+        int active = kActive;
+        state_.compare_exchange_strong(active, kStopping);
+        SpinUntil(state_, static_cast<int>(kIdle));
+    }
+
+  private:
+    enum State { kIdle, kActive, kStopping, kStop };
+
+    void Loop() {
+        for (;;) {
+            int state = state_.load();
+            if (state == kStop) {
+                return;
+            } else if (state == kIdle) {
+                sched_yield();
+                continue;
+            }
+            int flag = 0;
+            if (state == kActive) {
+                MPI_Test(req_, &flag, MPI_STATUS_IGNORE);
+            }
+            if (flag || state == kStopping) {
+                state_.store(kIdle);
+            }
+        }
+    }
+
+    std::thread thread_;
+    MPI_Request *req_ = nullptr;
+    std::atomic<int> state_{kIdle};
+};
+
+// Buffers and helpers of this rank.
+struct Rank {
+    const Opts *opts;
+    int rank;
+    int nranks;
+    ComputePool *pool;
+    ProgressThread *progress;
+    std::vector<float> a;
+    std::vector<float> b;
+    std::vector<float> c;
+    std::vector<float> send;
+    std::vector<float> recv;
+};
+
+// Kernels compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+/**
+ * @brief Compute rows [row_begin, row_end) of c = a * b of row-major matrices.
+ */
+SIMD_CLONES void Matmul(const float *a, const float *b, float *c, size_t row_begin, size_t row_end, size_t k,
+                        size_t n) {
+    for (size_t i = row_begin; i < row_end; i++) {
+        float *row = c + i * n;
+        std::fill(row, row + n, 0.0f);
+        for (size_t p = 0; p < k; p++) {
+            float aip = a[i * k + p];
+            const float *brow = b + p * n;
+            for (size_t j = 0; j < n; j++) {
+                row[j] += aip * brow[j];
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute elements [begin, end) of c = a * b element-wise.
+ */
+SIMD_CLONES void Mul(const float *a, const float *b, float *c, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        c[i] = a[i] * b[i];
+    }
+}
+
+/**
+ * @brief Run the kernel calls of one iteration on the compute threads.
+ *
+ * @param ctx The rank.
+ * @param kernel The kernel.
+ * @param ratio The number of kernel calls.
+ * @param req The request to test between kernel calls in the poll mode, nullptr otherwise.
+ */
+void Compute(Rank *ctx, Kernel kernel, int ratio, MPI_Request *req) {
+    const Opts &opts = *ctx->opts;
+    size_t m = opts.m, k = opts.k, n = opts.n;
+    ctx->pool->Run([ctx, kernel, req, m, k, n, ratio](int index, int num_threads) {
+        size_t begin = m * index / num_threads;
+        size_t end = m * (index + 1) / num_threads;
+        int flag = req == nullptr;
+        for (int i = 0; i < ratio; i++) {
+            if (kernel == Kernel::kMatmul) {
+                Matmul(ctx->a.data(), ctx->b.data(), ctx->c.data(), begin, end, k, n);
+            } else {
+                Mul(ctx->a.data(), ctx->b.data(), ctx->c.data(), begin * k, end * k);
+            }
+            // Only the calling thread enters MPI
+            if (index == 0 && !flag) {
+                MPI_Test(req, &flag, MPI_STATUS_IGNORE);
+            }
+        }
+    });
+}
+
+/**
+ * @brief Start the allreduce.
+ *
+ * @param ctx The rank.
+ * @param req The request of the allreduce.
+ */
+void StartAllreduce(Rank *ctx, MPI_Request *req) {
+    MPI_Iallreduce(ctx->send.data(), ctx->recv.data(), static_cast<int>(ctx->send.size()), MPI_FLOAT, MPI_SUM,
+                   MPI_COMM_WORLD, req);
+}
+
+// Phases of a measurement, in the order they run.
+enum Phase { kComm, kComp, kOverlap, kNumPhases };
+
+// Times of one kernel in seconds, the maxima over ranks of the averages over iterations.
+struct OverlapTimes {
+    double time[kNumPhases] = {};
+    int ratio = 0;
+};
+
+/**
+ * @brief Time one phase on this rank.
+ *
+ * @param ctx The rank.
+ * @param kernel The kernel.
+ * @param phase The phase.
+ * @param ratio The number of kernel calls.
+ * @return The average time of an iteration in seconds.
+ */
+double TimePhase(Rank *ctx, Kernel kernel, Phase phase, int ratio) {
+    const Opts &opts = *ctx->opts;
+    double elapsed = 0;
+    for (int i = 0; i < opts.warmup + opts.iters; i++) {
+        MPI_Request req = MPI_REQUEST_NULL;
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        if (phase == kComp) {
+            Compute(ctx, kernel, ratio, nullptr);
+        } else if (phase == kComm) {
+            StartAllreduce(ctx, &req);
+            MPI_Wait(&req, MPI_STATUS_IGNORE);
+        } else {
+            StartAllreduce(ctx, &req);
+            if (opts.progress == Progress::kThread) {
+                ctx->progress->Start(&req);
+                Compute(ctx, kernel, ratio, nullptr);
+                ctx->progress->Stop();
+            } else {
+                Compute(ctx, kernel, ratio, opts.progress == Progress::kPoll ? &req : nullptr);
+            }
+            MPI_Wait(&req, MPI_STATUS_IGNORE);
+        }
+        elapsed += i < opts.warmup ? 0 : MPI_Wtime() - start;
+    }
+    return elapsed / opts.iters;
+}
+
+/**
+ * @brief Measure the communication, the compute and the overlapped times of a kernel.
+ *
+ * @param ctx The rank.
+ * @param kernel The kernel.
+ * @param times The times, valid on every rank.
+ */
+void Measure(Rank *ctx, Kernel kernel, OverlapTimes *times) {
+    double local[kNumPhases] = {};
+    local[kComm] = TimePhase(ctx, kernel, kComm, 0);
+    times->ratio = ctx->opts->ratio;
+    if (times->ratio == 0) {
+        // Calibrate the kernel calls on the slowest rank, so that compute and communication take as long
+        double calib[2] = {local[kComm], TimePhase(ctx, kernel, kComp, 1)};
+        MPI_Allreduce(MPI_IN_PLACE, calib, 2, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        times->ratio = std::max(1, static_cast<int>(calib[0] / calib[1] + 0.5));
+    }
+    local[kComp] = TimePhase(ctx, kernel, kComp, times->ratio);
+    local[kOverlap] = TimePhase(ctx, kernel, kOverlap, times->ratio);
+    MPI_Allreduce(local, times->time, kNumPhases, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    printf("Usage: mpirun -np <ranks> mpi_overlap "
+           "[--progress none|thread|poll|async] "
+           "[--kernel mul,matmul] "
+           "[--m <num>] "
+           "[--k <num>] "
+           "[--n <num>] "
+           "[--ratio <num>] "
+           "[--compute_threads <num>] "
+           "[--progress_cpu <cpu>] "
+           "[--msg_size <bytes>] "
+           "[--iters <num>] "
+           "[--warmup <num>] %s\n",
+           host_utils::kResultOptsUsage);
+}
+
+/**
+ * @brief Parse a size with an optional K/M/G suffix in powers of 1024.
+ *
+ * @param str The string to parse.
+ * @param value The parsed size.
+ * @return true if the size is valid.
+ */
+bool ParseBytes(const char *str, size_t *value) {
+    char *end = nullptr;
+    unsigned long long number = strtoull(str, &end, 10);
+    std::map<char, int> shifts = {{'\0', 0}, {'K', 10}, {'k', 10}, {'M', 20}, {'m', 20}, {'G', 30}, {'g', 30}};
+    if (end == str || shifts.count(*end) == 0 || (*end != '\0' && end[1] != '\0')) {
+        return false;
+    }
+    *value = static_cast<size_t>(number) << shifts[*end];
+    return true;
+}
+
+/**
+ * @brief Parses command-line options for the MPI overlap benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kProgress,
+        kKernel,
+        kM,
+        kK,
+        kN,
+        kRatio,
+        kComputeThreads,
+        kProgressCpu,
+        kMsgSize,
+        kIters,
+        kWarmup
+    };
+    const struct option options[] = {
+        {"progress", required_argument, nullptr, static_cast<int>(OptIdx::kProgress)},
+        {"kernel", required_argument, nullptr, static_cast<int>(OptIdx::kKernel)},
+        {"m", required_argument, nullptr, static_cast<int>(OptIdx::kM)},
+        {"k", required_argument, nullptr, static_cast<int>(OptIdx::kK)},
+        {"n", required_argument, nullptr, static_cast<int>(OptIdx::kN)},
+        {"ratio", required_argument, nullptr, static_cast<int>(OptIdx::kRatio)},
+        {"compute_threads", required_argument, nullptr, static_cast<int>(OptIdx::kComputeThreads)},
+        {"progress_cpu", required_argument, nullptr, static_cast<int>(OptIdx::kProgressCpu)},
+        {"msg_size", required_argument, nullptr, static_cast<int>(OptIdx::kMsgSize)},
+        {"iters", required_argument, nullptr, static_cast<int>(OptIdx::kIters)},
+        {"warmup", required_argument, nullptr, static_cast<int>(OptIdx::kWarmup)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by option value
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kM), {&opts->m, 1}},
+        {static_cast<int>(OptIdx::kK), {&opts->k, 1}},
+        {static_cast<int>(OptIdx::kN), {&opts->n, 1}},
+        {static_cast<int>(OptIdx::kRatio), {&opts->ratio, 0}},
+        {static_cast<int>(OptIdx::kComputeThreads), {&opts->compute_threads, 1}},
+        {static_cast<int>(OptIdx::kProgressCpu), {&opts->progress_cpu, -1}},
+        {static_cast<int>(OptIdx::kIters), {&opts->iters, 1}},
+        {static_cast<int>(OptIdx::kWarmup), {&opts->warmup, 0}}};
+    std::map<std::string, Progress> progresses = {{"none", Progress::kNone},
+                                                  {"thread", Progress::kThread},
+                                                  {"poll", Progress::kPoll},
+                                                  {"async", Progress::kAsync}};
+    std::map<std::string, Kernel> kernels = {{"mul", Kernel::kMul}, {"matmul", Kernel::kMatmul}};
+    int opt = 0;
+    bool parse_err = false;
+
+    while (!parse_err && (opt = getopt_long(argc, argv, "", options, nullptr)) != -1) {
+        auto int_opt = int_opts.find(opt);
+        if (opt == '?') {
+            parse_err = true;
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt == static_cast<int>(OptIdx::kMsgSize)) {
+            parse_err = !ParseBytes(optarg, &opts->msg_size) || opts->msg_size < sizeof(float) ||
+                        opts->msg_size / sizeof(float) > static_cast<size_t>(INT32_MAX);
+        } else if (opt == static_cast<int>(OptIdx::kProgress)) {
+            parse_err = progresses.count(optarg) == 0;
+            opts->progress = parse_err ? opts->progress : progresses[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kKernel)) {
+            opts->kernels.clear();
+            std::string list = optarg;
+            for (size_t begin = 0; !parse_err && begin <= list.size();) {
+                size_t end = std::min(list.find(',', begin), list.size());
+                std::string name = list.substr(begin, end - begin);
+                parse_err = kernels.count(name) == 0;
+                opts->kernels.push_back(parse_err ? Kernel::kMul : kernels[name]);
+                begin = end + 1;
+            }
+        } else if (host_utils::IsResultOpt(opt)) {
+            parse_err = !host_utils::ParseResultOpt(opt, optarg, &opts->result);
+        }
+        if (parse_err && opt != '?') {
+            fprintf(stderr, "Invalid option value: %s\n", optarg);
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    // The options are parsed before MPI_Init, which reads the asynchronous progress settings
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+    if (opts.progress == Progress::kAsync) {
+        // Asynchronous progress of MPICH, Intel MPI and the TCP transport of Open MPI, unless set by the user
+        setenv("MPIR_CVAR_ASYNC_PROGRESS", "1", 0);
+        setenv("I_MPI_ASYNC_PROGRESS", "1", 0);
+        setenv("OMPI_MCA_btl_tcp_progress_thread", "1", 0);
+    }
+
+    // MPICH needs multiple thread support for asynchronous progress
+    int required = opts.progress == Progress::kAsync ? MPI_THREAD_MULTIPLE : MPI_THREAD_SERIALIZED;
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, required, &provided);
+    Rank ctx;
+    ctx.opts = &opts;
+    MPI_Comm_rank(MPI_COMM_WORLD, &ctx.rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ctx.nranks);
+    if (opts.progress == Progress::kThread && provided < MPI_THREAD_SERIALIZED) {
+        if (ctx.rank == 0) {
+            fprintf(stderr, "The MPI library does not support calls from a progress thread.\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+
+    size_t m = opts.m, k = opts.k, n = opts.n;
+    ctx.a.assign(m * k, 1.0f);
+    ctx.b.assign(std::max(k * n, m * k), 0.5f);
+    ctx.c.assign(std::max(m * n, m * k), 0.0f);
+    ctx.send.assign(opts.msg_size / sizeof(float), 1.0f);
+    ctx.recv.assign(ctx.send.size(), 0.0f);
+    ComputePool pool(opts.compute_threads);
+    ctx.pool = &pool;
+    ProgressThread *progress = opts.progress == Progress::kThread ? new ProgressThread(opts.progress_cpu) : nullptr;
+    ctx.progress = progress;
+
+    host_utils::ResultEmitter *emitter = ctx.rank == 0 ? new host_utils::ResultEmitter(opts.result) : nullptr;
+    const char *progress_names[] = {"none", "thread", "poll", "async"};
+    const char *kernel_names[] = {"mul", "matmul"};
+    for (Kernel kernel : opts.kernels) {
+        OverlapTimes times;
+        Measure(&ctx, kernel, &times);
+        if (ctx.rank == 0) {
+            // Overlap efficiency: the fraction of the shorter of compute and communication hidden by the other
+            double comp = times.time[kComp], comm = times.time[kComm], overlap = times.time[kOverlap];
+            double efficiency = (comp + comm - overlap) / std::min(comp, comm);
+            std::string prefix = std::string(progress_names[static_cast<int>(opts.progress)]) + "_" +
+                                 kernel_names[static_cast<int>(kernel)];
+            host_utils::ResultTags tags = {{"progress", progress_names[static_cast<int>(opts.progress)]},
+                                           {"kernel", kernel_names[static_cast<int>(kernel)]}};
+            emitter->Metric(prefix + "_ratio", times.ratio, "", tags);
+            emitter->Metric(prefix + "_comp_time_us", comp * 1e6, "us", tags);
+            emitter->Metric(prefix + "_comm_time_us", comm * 1e6, "us", tags);
+            emitter->Metric(prefix + "_overlap_time_us", overlap * 1e6, "us", tags);
+            emitter->Metric(prefix + "_overlap_efficiency", efficiency, "", tags);
+        }
+        // All ranks stop together at a confirmed failure
+        int stop = ctx.rank == 0 && emitter->Stopped();
+        MPI_Bcast(&stop, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (stop) {
+            ret = 1;
+            break;
+        }
+    }
+
+    delete emitter;
+    delete progress;
+    MPI_Finalize();
+    return ret;
+}
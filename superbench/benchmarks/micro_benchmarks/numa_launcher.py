@@ -0,0 +1,154 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the NUMA-partitioned concurrent launcher of CPU benchmarks."""
+
+import os
+import shlex
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class NumaLauncherBenchmark(MicroBenchmarkWithInvoke):
+    """The NUMA-partitioned concurrent launcher class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'numa_launcher'
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--jobs',
+            type=str,
+            nargs='+',
+            default=[],
+            help='Job lines, each "<label> [nodes=<n>|cores=<n>] [membw=shared|exclusive] [timeout=<s>] -- <command>", '
+            'where {cpus}, {nodes} and {ncpus} in the command are replaced by the placement of the job.',
+        )
+        self._parser.add_argument(
+            '--job_file',
+            type=str,
+            default=None,
+            required=False,
+            help='Job file with one job line per benchmark, read before --jobs.',
+        )
+        self._parser.add_argument(
+            '--cpus',
+            type=str,
+            default=None,
+            required=False,
+            help='Cpus to place the jobs on, e.g. 0-63. All the cpus of the affinity if not specified.',
+        )
+        self._parser.add_argument(
+            '--isolation',
+            type=str,
+            default='affinity',
+            choices=['affinity', 'cgroup'],
+            required=False,
+            help='Confine the jobs with sched_setaffinity and the memory policy, or with cgroup v2 cpusets.',
+        )
+        self._parser.add_argument(
+            '--cgroup_root',
+            type=str,
+            default=None,
+            required=False,
+            help='Writable cgroup v2 hierarchy to create the cpusets under, /sys/fs/cgroup if not specified.',
+        )
+        self._parser.add_argument(
+            '--log_dir',
+            type=str,
+            default=None,
+            required=False,
+            help='Directory of the job logs, the current directory if not specified.',
+        )
+        self._parser.add_argument(
+            '--calibrate',
+            action='store_true',
+            default=False,
+            help='Run every job alone first to report its slowdown when sharing the host.',
+        )
+        self._parser.add_argument(
+            '--interference_threshold',
+            type=float,
+            default=0.1,
+            required=False,
+            help='Fraction of slowdown, or of samples with foreign threads on the cpus of a job, reported as '
+            'interference.',
+        )
+        self._parser.add_argument(
+            '--sample_interval',
+            type=int,
+            default=100,
+            required=False,
+            help='Interval between the samples of the threads of the host in milliseconds.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        if not self._args.jobs and not self._args.job_file:
+            self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+            logger.error('No job given - benchmark: {}, set --jobs or --job_file.'.format(self._name))
+            return False
+        for line in self._args.jobs:
+            if ' -- ' not in line:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid job line - benchmark: {}, job line: {}.'.format(self._name, line))
+                return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ''
+        if self._args.job_file:
+            args += ' --jobs %s' % self._args.job_file
+        args += ''.join(' --run %s' % shlex.quote(line) for line in self._args.jobs)
+        if self._args.cpus:
+            args += ' --cpus %s' % self._args.cpus
+        args += ' --isolation %s' % self._args.isolation
+        if self._args.cgroup_root:
+            args += ' --cgroup_root %s' % self._args.cgroup_root
+        if self._args.log_dir:
+            args += ' --log_dir %s' % self._args.log_dir
+        if self._args.calibrate:
+            args += ' --calibrate'
+        args += ' --threshold %s --sample_ms %d' % (self._args.interference_threshold, self._args.sample_interval)
+        args += self._result_record_args()
+
+        self._commands = ['%s%s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('numa-launcher', NumaLauncherBenchmark)
@@ -0,0 +1,1052 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// NUMA-partitioned concurrent launcher of CPU benchmarks.
+// The launcher reads jobs, one benchmark command per line as "<label> [key=value ...] -- <command>" with the NUMA
+// nodes or cores they need and whether they need the memory bandwidth of their nodes alone, packs them onto disjoint
+// cpusets of the topology in waves, and runs the jobs of a wave concurrently, each confined to its cpus and memory
+// nodes by sched_setaffinity and the memory policy, or by a cgroup v2 cpuset. While a wave runs, the threads of the
+// host are sampled to detect jobs running outside of their cpus and foreign threads running on them, and with
+// --calibrate every job first runs alone on the same cpus so that its slowdown when sharing the host is reported.
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <numa.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../host_utils/cpu_utils.h"
+#include "../host_utils/result_emitter.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Flag of the kernel threads in /proc/<pid>/stat, which run on every cpu by design.
+constexpr unsigned long kKernelThreadFlag = 0x00200000;
+
+// One benchmark invocation.
+struct Job {
+    // Label, the prefix of the metrics and the name of the log file.
+    std::string label;
+
+    // Number of whole NUMA nodes, 0 to request cores instead.
+    int nodes = 0;
+
+    // Number of cores if no whole node is requested.
+    int cores = 1;
+
+    // Whether no other job may run on the nodes of this job, to have their memory bandwidth alone.
+    bool exclusive = false;
+
+    // Time limit in seconds, 0 for none.
+    double timeout = 0;
+
+    // Shell command, with {cpus}, {nodes} and {ncpus} replaced by the placement.
+    std::string command;
+
+    // Wave the job runs in.
+    int wave = -1;
+
+    // Cpus of the job, ascending.
+    std::vector<int> cpus;
+
+    // Nodes of the cpus of the job, ascending.
+    std::vector<int> nodes_used;
+
+    // Nodes with memory among them, the memory of the job is bound to.
+    std::vector<int> mem_nodes;
+
+    // Wall time of the run alone, of the concurrent run, in seconds.
+    double solo_time = 0;
+    double wall_time = 0;
+
+    // Exit code of the concurrent run, 128 + the signal number if killed.
+    int return_code = 0;
+
+    // Samples of the threads of the job, and those on a cpu not of the job.
+    uint64_t thread_samples = 0;
+    uint64_t escaped_samples = 0;
+
+    // Sampling rounds, and those with a foreign runnable thread on a cpu of the job.
+    uint64_t rounds = 0;
+    uint64_t intruded_rounds = 0;
+};
+
+// Options accepted by this program.
+struct Opts {
+    // Job files.
+    std::vector<std::string> job_files;
+
+    // Job lines given on the command line, after those of the files.
+    std::vector<std::string> runs;
+
+    // Cpus to place the jobs on, all the cpus of the affinity if empty.
+    std::vector<int> cpus;
+
+    // Isolation of the jobs, "affinity" or "cgroup".
+    std::string isolation = "affinity";
+
+    // Mounted cgroup v2 hierarchy to create the cpusets under.
+    std::string cgroup_root = "/sys/fs/cgroup";
+
+    // Directory of the job logs.
+    std::string log_dir = ".";
+
+    // Whether to run every job alone first to measure its slowdown.
+    bool calibrate = false;
+
+    // Fraction of slowdown or of intruded sampling rounds reported as interference.
+    double threshold = 0.1;
+
+    // Interval between the samples of the threads in milliseconds.
+    int sample_ms = 100;
+
+    // Whether to print the placement and exit.
+    bool dry_run = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: numa_launcher "
+              << "[--jobs <file>] "
+              << "[--run \"<label> [nodes=<n>|cores=<n>] [membw=shared|exclusive] [timeout=<s>] -- <command>\"] "
+              << "[--cpus <list>] "
+              << "[--isolation affinity|cgroup] "
+              << "[--cgroup_root <dir>] "
+              << "[--log_dir <dir>] "
+              << "[--calibrate] "
+              << "[--threshold <fraction>] "
+              << "[--sample_ms <ms>] "
+              << "[--dry_run] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the launcher.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kJobs,
+        kRun,
+        kCpus,
+        kIsolation,
+        kCgroupRoot,
+        kLogDir,
+        kCalibrate,
+        kThreshold,
+        kSampleMs,
+        kDryRun
+    };
+    const struct option options[] = {
+        {"jobs", required_argument, nullptr, static_cast<int>(OptIdx::kJobs)},
+        {"run", required_argument, nullptr, static_cast<int>(OptIdx::kRun)},
+        {"cpus", required_argument, nullptr, static_cast<int>(OptIdx::kCpus)},
+        {"isolation", required_argument, nullptr, static_cast<int>(OptIdx::kIsolation)},
+        {"cgroup_root", required_argument, nullptr, static_cast<int>(OptIdx::kCgroupRoot)},
+        {"log_dir", required_argument, nullptr, static_cast<int>(OptIdx::kLogDir)},
+        {"calibrate", no_argument, nullptr, static_cast<int>(OptIdx::kCalibrate)},
+        {"threshold", required_argument, nullptr, static_cast<int>(OptIdx::kThreshold)},
+        {"sample_ms", required_argument, nullptr, static_cast<int>(OptIdx::kSampleMs)},
+        {"dry_run", no_argument, nullptr, static_cast<int>(OptIdx::kDryRun)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kJobs)) {
+            opts->job_files.push_back(optarg);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kRun)) {
+            opts->runs.push_back(optarg);
+        } else if (getopt_ret == static_cast<int>(OptIdx::kCpus)) {
+            try {
+                opts->cpus = host_utils::ParseCpuList(optarg);
+            } catch (const std::exception &e) {
+                parse_err = true;
+            }
+            parse_err = parse_err || opts->cpus.empty();
+        } else if (getopt_ret == static_cast<int>(OptIdx::kIsolation)) {
+            opts->isolation = optarg;
+            parse_err = opts->isolation != "affinity" && opts->isolation != "cgroup";
+        } else if (getopt_ret == static_cast<int>(OptIdx::kCgroupRoot)) {
+            opts->cgroup_root = optarg;
+        } else if (getopt_ret == static_cast<int>(OptIdx::kLogDir)) {
+            opts->log_dir = optarg;
+        } else if (getopt_ret == static_cast<int>(OptIdx::kCalibrate)) {
+            opts->calibrate = true;
+        } else if (getopt_ret == static_cast<int>(OptIdx::kThreshold)) {
+            parse_err = 1 != sscanf(optarg, "%lf", &opts->threshold) || opts->threshold < 0;
+        } else if (getopt_ret == static_cast<int>(OptIdx::kSampleMs)) {
+            parse_err = 1 != sscanf(optarg, "%d", &opts->sample_ms) || opts->sample_ms <= 0;
+        } else if (getopt_ret == static_cast<int>(OptIdx::kDryRun)) {
+            opts->dry_run = true;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (!parse_err && opts->job_files.empty() && opts->runs.empty()) {
+        std::cerr << "No job given." << std::endl;
+        parse_err = true;
+    }
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Parse a job line, skipping blank lines and comments.
+ *
+ * @param line The line.
+ * @param where The location of the line for error messages.
+ * @param jobs The jobs to append to.
+ * @return true on success.
+ */
+bool AddJobLine(const std::string &line, const std::string &where, std::vector<Job> *jobs) {
+    size_t separator = line.find(" -- ");
+    std::istringstream tokens(line.substr(0, separator));
+    Job job;
+    if (!(tokens >> job.label) || job.label[0] == '#') {
+        return true;
+    }
+    // The label names the log file and the cgroup of the job
+    if (job.label.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_.-") !=
+            std::string::npos ||
+        job.label[0] == '.') {
+        std::cerr << where << ": invalid label " << job.label << "." << std::endl;
+        return false;
+    }
+    for (const auto &other : *jobs) {
+        if (other.label == job.label) {
+            std::cerr << where << ": label " << job.label << " is already used." << std::endl;
+            return false;
+        }
+    }
+    bool cores_given = false;
+    for (std::string token; tokens >> token;) {
+        size_t eq = token.find('=');
+        std::string key = token.substr(0, eq), value = eq == std::string::npos ? "" : token.substr(eq + 1);
+        char extra = 0;
+        bool ok = false;
+        if (key == "nodes") {
+            ok = 1 == sscanf(value.c_str(), "%d%c", &job.nodes, &extra) && job.nodes > 0;
+        } else if (key == "cores") {
+            ok = 1 == sscanf(value.c_str(), "%d%c", &job.cores, &extra) && job.cores > 0;
+            cores_given = true;
+        } else if (key == "membw") {
+            ok = value == "shared" || value == "exclusive";
+            job.exclusive = value == "exclusive";
+        } else if (key == "timeout") {
+            ok = 1 == sscanf(value.c_str(), "%lf%c", &job.timeout, &extra) && job.timeout >= 0;
+        }
+        if (!ok) {
+            std::cerr << where << ": invalid option " << token << " of " << job.label << "." << std::endl;
+            return false;
+        }
+    }
+    if (job.nodes > 0 && cores_given) {
+        std::cerr << where << ": nodes= and cores= of " << job.label << " are exclusive." << std::endl;
+        return false;
+    }
+    if (separator != std::string::npos) {
+        job.command = line.substr(separator + 4);
+    }
+    if (job.command.find_first_not_of(' ') == std::string::npos) {
+        std::cerr << where << ": no command of " << job.label << ", give it after \" -- \"." << std::endl;
+        return false;
+    }
+    jobs->push_back(job);
+    return true;
+}
+
+/**
+ * @brief Read the jobs from the files and the command line.
+ *
+ * @param opts The launcher options.
+ * @param jobs The jobs.
+ * @return true on success.
+ */
+bool ReadJobs(const Opts &opts, std::vector<Job> *jobs) {
+    for (const auto &file : opts.job_files) {
+        std::ifstream in(file);
+        if (!in) {
+            std::cerr << "Failed to open jobs " << file << "." << std::endl;
+            return false;
+        }
+        int line_no = 0;
+        for (std::string line; std::getline(in, line);) {
+            if (!AddJobLine(line, file + ":" + std::to_string(++line_no), jobs)) {
+                return false;
+            }
+        }
+    }
+    for (const auto &run : opts.runs) {
+        if (!AddJobLine(run, "--run", jobs)) {
+            return false;
+        }
+    }
+    if (jobs->empty()) {
+        std::cerr << "No job to run." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Cpus and memory of the NUMA nodes the jobs are placed on.
+struct Topology {
+    // Cpus of every node, ascending.
+    std::map<int, std::vector<int>> node_cpus;
+
+    // Nodes with memory.
+    std::set<int> mem_nodes;
+
+    /**
+     * @brief Discover the nodes of the cpus.
+     *
+     * @param requested The cpus, those of the affinity if empty.
+     * @return true on success.
+     */
+    bool Discover(const std::vector<int> &requested) {
+        std::vector<int> cpus = requested;
+        if (cpus.empty()) {
+            cpu_set_t affinity;
+            CPU_ZERO(&affinity);
+            if (sched_getaffinity(0, sizeof(affinity), &affinity) != 0) {
+                std::cerr << "Failed to get the cpu affinity. ERROR: " << strerror(errno) << std::endl;
+                return false;
+            }
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &affinity)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+        bool numa = numa_available() >= 0;
+        for (int cpu : cpus) {
+            if (cpu < 0 || cpu >= CPU_SETSIZE) {
+                std::cerr << "Invalid cpu " << cpu << "." << std::endl;
+                return false;
+            }
+            node_cpus[numa ? std::max(numa_node_of_cpu(cpu), 0) : 0].push_back(cpu);
+        }
+        for (auto &node : node_cpus) {
+            std::sort(node.second.begin(), node.second.end());
+            node.second.erase(std::unique(node.second.begin(), node.second.end()), node.second.end());
+            if (!numa || numa_node_size64(node.first, nullptr) > 0) {
+                mem_nodes.insert(node.first);
+            }
+        }
+        if (node_cpus.empty()) {
+            std::cerr << "No cpu to run on." << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+// Packing of the jobs onto disjoint cpusets, in waves of jobs running concurrently.
+class Packer {
+  public:
+    /**
+     * @brief Construct a packer.
+     *
+     * @param topology The topology.
+     */
+    explicit Packer(const Topology *topology) : topology_(topology) {}
+
+    /**
+     * @brief Place a job in the first wave it fits in, a new wave if none.
+     *
+     * @param job The job, its wave and cpus are set.
+     * @return true on success, false if the job does not fit even alone.
+     */
+    bool Place(Job *job) {
+        for (size_t wave = 0;; wave++) {
+            bool fresh = wave == waves_.size();
+            if (fresh) {
+                waves_.emplace_back();
+                for (const auto &node : topology_->node_cpus) {
+                    waves_.back()[node.first].free = node.second;
+                }
+            }
+            if (Fit(&waves_[wave], job)) {
+                job->wave = static_cast<int>(wave);
+                return true;
+            }
+            if (fresh) {
+                waves_.pop_back();
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of waves.
+     */
+    int Waves() const { return static_cast<int>(waves_.size()); }
+
+  private:
+    // Placement state of a node in a wave.
+    struct NodeState {
+        // Cpus not given to any job.
+        std::vector<int> free;
+
+        // Whether a job runs on the node.
+        bool touched = false;
+
+        // Whether a job has the memory bandwidth of the node alone.
+        bool exclusive = false;
+    };
+    using Wave = std::map<int, NodeState>;
+
+    /**
+     * @brief Place a job in a wave if it fits.
+     *
+     * Whole nodes are taken lowest first. Cores are taken from the node with the fewest free cpus that has enough of
+     * them, to keep whole nodes for the others, else from the nodes with the most free cpus. A job with exclusive
+     * memory bandwidth only goes to nodes without job and reserves their remaining cpus.
+     *
+     * @param wave The wave.
+     * @param job The job.
+     * @return true if the job fits.
+     */
+    bool Fit(Wave *wave, Job *job) {
+        std::vector<int> picked;
+        if (job->nodes > 0) {
+            for (auto &node : *wave) {
+                if (!node.second.touched && static_cast<int>(picked.size()) < job->nodes) {
+                    picked.push_back(node.first);
+                }
+            }
+            if (static_cast<int>(picked.size()) < job->nodes) {
+                return false;
+            }
+        } else {
+            std::vector<int> candidates;
+            for (auto &node : *wave) {
+                if (!node.second.exclusive && !node.second.free.empty() && !(job->exclusive && node.second.touched)) {
+                    candidates.push_back(node.first);
+                }
+            }
+            int best = -1;
+            for (int node : candidates) {
+                size_t free = (*wave)[node].free.size();
+                if (free >= static_cast<size_t>(job->cores) && (best < 0 || free < (*wave)[best].free.size())) {
+                    best = node;
+                }
+            }
+            if (best >= 0) {
+                picked.push_back(best);
+            } else {
+                std::stable_sort(candidates.begin(), candidates.end(),
+                                 [wave](int a, int b) { return (*wave)[a].free.size() > (*wave)[b].free.size(); });
+                size_t total = 0;
+                for (int node : candidates) {
+                    if (total < static_cast<size_t>(job->cores)) {
+                        picked.push_back(node);
+                        total += (*wave)[node].free.size();
+                    }
+                }
+                if (total < static_cast<size_t>(job->cores)) {
+                    return false;
+                }
+            }
+        }
+
+        std::sort(picked.begin(), picked.end());
+        job->cpus.clear();
+        job->nodes_used = picked;
+        job->mem_nodes.clear();
+        for (int node : picked) {
+            NodeState &state = (*wave)[node];
+            size_t take = state.free.size();
+            if (job->nodes == 0) {
+                take = std::min(take, job->cores - job->cpus.size());
+            }
+            job->cpus.insert(job->cpus.end(), state.free.begin(), state.free.begin() + take);
+            state.free.erase(state.free.begin(), state.free.begin() + take);
+            state.touched = true;
+            if (job->exclusive) {
+                state.exclusive = true;
+                state.free.clear();
+            }
+            if (topology_->mem_nodes.count(node)) {
+                job->mem_nodes.push_back(node);
+            }
+        }
+        std::sort(job->cpus.begin(), job->cpus.end());
+        return true;
+    }
+
+    const Topology *topology_;
+    std::vector<Wave> waves_;
+};
+
+/**
+ * @brief Write a string to a file.
+ *
+ * @param path The path.
+ * @param value The string.
+ * @return true on success.
+ */
+bool WriteFile(const std::string &path, const std::string &value) {
+    int fd = open(path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, value.data(), value.size()) == static_cast<ssize_t>(value.size());
+    close(fd);
+    return ok;
+}
+
+// Cgroup v2 cpusets of the jobs, under a cgroup of the launcher removed at exit.
+class CgroupCpusets {
+  public:
+    ~CgroupCpusets() {
+        for (const auto &child : children_) {
+            // The killed leftovers of a job may take a moment to leave
+            for (int retry = 0; retry < 100 && rmdir(child.c_str()) != 0 && errno == EBUSY; retry++) {
+                usleep(10000);
+            }
+        }
+        if (!dir_.empty()) {
+            rmdir(dir_.c_str());
+        }
+    }
+
+    /**
+     * @brief Create the cgroup of the launcher with the cpuset controller enabled for its children.
+     *
+     * @param root The mounted cgroup v2 hierarchy, writable by the launcher.
+     * @return true on success.
+     */
+    bool Setup(const std::string &root) {
+        std::ifstream controllers(root + "/cgroup.controllers");
+        std::string controller;
+        while (controllers >> controller && controller != "cpuset") {
+        }
+        if (controller != "cpuset") {
+            std::cerr << "No cpuset controller in the cgroup v2 hierarchy " << root << "." << std::endl;
+            return false;
+        }
+        // The controller may be enabled already, the write to the new cgroup tells whether it is
+        WriteFile(root + "/cgroup.subtree_control", "+cpuset");
+        dir_ = root + "/sb_numa_launcher." + std::to_string(getpid());
+        if (mkdir(dir_.c_str(), 0755) != 0) {
+            std::cerr << "Failed to create cgroup " << dir_ << ". ERROR: " << strerror(errno) << std::endl;
+            dir_.clear();
+            return false;
+        }
+        if (!WriteFile(dir_ + "/cgroup.subtree_control", "+cpuset")) {
+            std::cerr << "Failed to enable the cpuset controller in " << dir_ << ". ERROR: " << strerror(errno)
+                      << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Create the cgroup of a job with its cpus and memory nodes.
+     *
+     * @param job The job.
+     * @param procs The cgroup.procs file the job joins by writing its pid.
+     * @return true on success.
+     */
+    bool Add(const Job &job, std::string *procs) {
+        std::string child = dir_ + "/" + job.label;
+        if (mkdir(child.c_str(), 0755) != 0) {
+            std::cerr << "Failed to create cgroup " << child << ". ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        children_.push_back(child);
+        if (!WriteFile(child + "/cpuset.cpus", host_utils::FormatCpuList(job.cpus)) ||
+            (!job.mem_nodes.empty() && !WriteFile(child + "/cpuset.mems", host_utils::FormatCpuList(job.mem_nodes)))) {
+            std::cerr << "Failed to set the cpuset of " << child << ". ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        *procs = child + "/cgroup.procs";
+        return true;
+    }
+
+  private:
+    std::string dir_;
+    std::vector<std::string> children_;
+};
+
+/**
+ * @brief Replace the placement placeholders of a job command.
+ *
+ * @param job The placed job.
+ * @return The command.
+ */
+std::string ExpandCommand(const Job &job) {
+    const std::pair<std::string, std::string> placeholders[] = {
+        {"{cpus}", host_utils::FormatCpuList(job.cpus)},
+        {"{nodes}", host_utils::FormatCpuList(job.nodes_used)},
+        {"{ncpus}", std::to_string(job.cpus.size())}};
+    std::string command = job.command;
+    for (const auto &placeholder : placeholders) {
+        for (size_t pos = command.find(placeholder.first); pos != std::string::npos;
+             pos = command.find(placeholder.first, pos + placeholder.second.size())) {
+            command.replace(pos, placeholder.first.size(), placeholder.second);
+        }
+    }
+    return command;
+}
+
+/**
+ * @brief Start a job in its own process group, confined to its cpus and memory nodes.
+ *
+ * @param job The placed job.
+ * @param log The log file of its output.
+ * @param procs The cgroup.procs file to join, empty to confine it with sched_setaffinity and the memory policy.
+ * @param mask The signal mask to restore in the job.
+ * @return The pid of the job, -1 on failure.
+ */
+pid_t Launch(const Job &job, const std::string &log, const std::string &procs, const sigset_t &mask) {
+    std::string command = ExpandCommand(job);
+    int log_fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (log_fd < 0) {
+        std::cerr << "Failed to open log " << log << ". ERROR: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (int cpu : job.cpus) {
+        CPU_SET(cpu, &cpuset);
+    }
+    struct bitmask *membind = nullptr;
+    if (numa_available() >= 0 && !job.mem_nodes.empty()) {
+        membind = numa_allocate_nodemask();
+        for (int node : job.mem_nodes) {
+            numa_bitmask_setbit(membind, node);
+        }
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        setpgid(0, 0);
+        sigprocmask(SIG_SETMASK, &mask, nullptr);
+        if (!procs.empty()) {
+            if (!WriteFile(procs, std::to_string(getpid()))) {
+                _exit(126);
+            }
+        } else {
+            if (sched_setaffinity(0, sizeof(cpuset), &cpuset) != 0) {
+                _exit(126);
+            }
+            // The memory policy is kept across exec, unlike the allocations of this process
+            if (membind != nullptr) {
+                numa_set_membind(membind);
+            }
+        }
+        int null_fd = open("/dev/null", O_RDONLY);
+        dup2(null_fd, STDIN_FILENO);
+        dup2(log_fd, STDOUT_FILENO);
+        dup2(log_fd, STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+        _exit(127);
+    }
+    if (pid > 0) {
+        // Also set here so that the group exists before the job is sampled
+        setpgid(pid, pid);
+    } else {
+        std::cerr << "Failed to fork " << job.label << ". ERROR: " << strerror(errno) << std::endl;
+    }
+    if (membind != nullptr) {
+        numa_free_nodemask(membind);
+    }
+    close(log_fd);
+    return pid;
+}
+
+// State of a thread read from /proc/<pid>/task/<tid>/stat.
+struct TaskStat {
+    char state = 0;
+    int pgrp = 0;
+    unsigned long flags = 0;
+    int cpu = -1;
+};
+
+/**
+ * @brief Read the state of a thread.
+ *
+ * @param path The stat file.
+ * @param stat The state.
+ * @return true on success, false if the thread is gone.
+ */
+bool ReadTaskStat(const std::string &path, TaskStat *stat) {
+    char buf[2048];
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) {
+        return false;
+    }
+    buf[n] = 0;
+    // The command name may contain spaces and parentheses, the fields follow its last ')'
+    const char *fields = strrchr(buf, ')');
+    if (fields == nullptr) {
+        return false;
+    }
+    std::istringstream in(fields + 1);
+    std::string field;
+    // Numbered as in proc(5), from the state
+    for (int index = 3; in >> field; index++) {
+        if (index == 3) {
+            stat->state = field[0];
+        } else if (index == 5) {
+            stat->pgrp = std::atoi(field.c_str());
+        } else if (index == 9) {
+            stat->flags = std::strtoul(field.c_str(), nullptr, 10);
+        } else if (index == 39) {
+            stat->cpu = std::atoi(field.c_str());
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sample the threads of the host once and attribute them to the running jobs.
+ *
+ * @param running The running jobs and their pids, which are their process groups.
+ * @param owners The index in running of the job of every cpu, -1 for none.
+ */
+void SampleThreads(const std::vector<std::pair<Job *, pid_t>> &running, const std::vector<int> &owners) {
+    std::map<int, int> groups;
+    for (size_t i = 0; i < running.size(); i++) {
+        groups[running[i].second] = static_cast<int>(i);
+    }
+    std::vector<bool> intruded(running.size(), false);
+    DIR *proc = opendir("/proc");
+    if (proc == nullptr) {
+        return;
+    }
+    for (struct dirent *pid = readdir(proc); pid != nullptr; pid = readdir(proc)) {
+        if (!isdigit(pid->d_name[0]) || std::atoi(pid->d_name) == getpid()) {
+            continue;
+        }
+        std::string tasks_dir = std::string("/proc/") + pid->d_name + "/task";
+        DIR *tasks = opendir(tasks_dir.c_str());
+        if (tasks == nullptr) {
+            continue;
+        }
+        for (struct dirent *tid = readdir(tasks); tid != nullptr; tid = readdir(tasks)) {
+            TaskStat stat;
+            if (!isdigit(tid->d_name[0]) || !ReadTaskStat(tasks_dir + "/" + tid->d_name + "/stat", &stat) ||
+                stat.cpu < 0) {
+                continue;
+            }
+            int owner = stat.cpu < static_cast<int>(owners.size()) ? owners[stat.cpu] : -1;
+            auto group = groups.find(stat.pgrp);
+            if (group != groups.end()) {
+                Job *job = running[group->second].first;
+                job->thread_samples++;
+                if (owner != group->second) {
+                    job->escaped_samples++;
+                }
+            }
+            if (owner >= 0 && stat.state == 'R' && !(stat.flags & kKernelThreadFlag) &&
+                (group == groups.end() || owner != group->second)) {
+                intruded[owner] = true;
+            }
+        }
+        closedir(tasks);
+    }
+    closedir(proc);
+    for (size_t i = 0; i < running.size(); i++) {
+        running[i].first->rounds++;
+        running[i].first->intruded_rounds += intruded[i] ? 1 : 0;
+    }
+}
+
+/**
+ * @brief Run jobs concurrently and wait for all of them.
+ *
+ * @param jobs The jobs.
+ * @param solo Whether it is a calibration run alone, whose time is the solo time and whose threads are not sampled.
+ * @param opts The launcher options.
+ * @param cgroup_procs The cgroup.procs files of the jobs by label, empty to confine them with sched_setaffinity.
+ * @param mask The signal mask to restore in the jobs.
+ * @return The number of jobs that failed to start.
+ */
+int RunConcurrently(const std::vector<Job *> &jobs, bool solo, const Opts &opts,
+                    const std::map<std::string, std::string> &cgroup_procs, const sigset_t &mask) {
+    std::vector<std::pair<Job *, pid_t>> running;
+    std::vector<Clock::time_point> starts;
+    std::vector<bool> killed;
+    std::vector<int> owners;
+    int failures = 0;
+    for (Job *job : jobs) {
+        auto procs = cgroup_procs.find(job->label);
+        std::string log = opts.log_dir + "/" + job->label + (solo ? ".solo.log" : ".log");
+        pid_t pid = Launch(*job, log, procs == cgroup_procs.end() ? "" : procs->second, mask);
+        if (pid < 0) {
+            job->return_code = 127;
+            failures++;
+            continue;
+        }
+        for (int cpu : job->cpus) {
+            owners.resize(std::max<size_t>(owners.size(), cpu + 1), -1);
+            owners[cpu] = static_cast<int>(running.size());
+        }
+        running.emplace_back(job, pid);
+        starts.push_back(Clock::now());
+        killed.push_back(false);
+    }
+
+    sigset_t sigchld;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    auto interval = std::chrono::milliseconds(opts.sample_ms);
+    auto next_sample = Clock::now() + interval;
+    size_t left = running.size();
+    while (left > 0) {
+        auto wait = std::max(next_sample - Clock::now(), Clock::duration::zero());
+        auto wait_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+        timespec timeout = {static_cast<time_t>(wait_ns / 1000000000), static_cast<long>(wait_ns % 1000000000)};
+        sigtimedwait(&sigchld, nullptr, &timeout);
+
+        int status = 0;
+        for (pid_t pid = waitpid(-1, &status, WNOHANG); pid > 0; pid = waitpid(-1, &status, WNOHANG)) {
+            for (size_t i = 0; i < running.size(); i++) {
+                if (running[i].second != pid) {
+                    continue;
+                }
+                Job *job = running[i].first;
+                double elapsed = std::chrono::duration<double>(Clock::now() - starts[i]).count();
+                int code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                if (solo) {
+                    job->solo_time = elapsed;
+                } else {
+                    job->wall_time = elapsed;
+                    job->return_code = code;
+                }
+                // Leftovers of the job in the background would interfere with the next waves
+                kill(-pid, SIGKILL);
+                running[i].second = -pid;
+                left--;
+            }
+        }
+
+        if (Clock::now() >= next_sample) {
+            std::vector<std::pair<Job *, pid_t>> alive;
+            std::vector<int> alive_owners(owners.size(), -1);
+            for (size_t i = 0; i < running.size(); i++) {
+                if (running[i].second > 0) {
+                    for (int cpu : running[i].first->cpus) {
+                        alive_owners[cpu] = static_cast<int>(alive.size());
+                    }
+                    alive.push_back(running[i]);
+                }
+            }
+            if (!solo && !alive.empty()) {
+                SampleThreads(alive, alive_owners);
+            }
+            next_sample += interval;
+        }
+
+        for (size_t i = 0; i < running.size(); i++) {
+            Job *job = running[i].first;
+            if (running[i].second > 0 && !killed[i] && job->timeout > 0 &&
+                std::chrono::duration<double>(Clock::now() - starts[i]).count() > job->timeout) {
+                std::cerr << "Job " << job->label << " timed out after " << job->timeout << " s." << std::endl;
+                kill(-running[i].second, SIGKILL);
+                killed[i] = true;
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief Print the placement of the jobs.
+ *
+ * @param jobs The placed jobs.
+ * @param waves The number of waves.
+ */
+void PrintPlacement(const std::vector<Job> &jobs, int waves) {
+    for (int wave = 0; wave < waves; wave++) {
+        std::cout << "# Wave " << wave << ":" << std::endl;
+        for (const auto &job : jobs) {
+            if (job.wave == wave) {
+                std::cout << "#   " << job.label << " cpus " << host_utils::FormatCpuList(job.cpus) << " nodes "
+                          << host_utils::FormatCpuList(job.nodes_used) << " memory "
+                          << (job.mem_nodes.empty() ? "any" : host_utils::FormatCpuList(job.mem_nodes))
+                          << (job.exclusive ? " exclusive" : "") << std::endl;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+    std::vector<Job> jobs;
+    if (!ReadJobs(opts, &jobs)) {
+        return 1;
+    }
+    Topology topology;
+    if (!topology.Discover(opts.cpus)) {
+        return 1;
+    }
+
+    // The largest jobs first, so that the small ones fill the gaps they leave
+    std::vector<Job *> order;
+    for (auto &job : jobs) {
+        order.push_back(&job);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Job *a, const Job *b) {
+        return std::make_tuple(a->nodes, a->exclusive, a->cores) > std::make_tuple(b->nodes, b->exclusive, b->cores);
+    });
+    Packer packer(&topology);
+    for (Job *job : order) {
+        if (!packer.Place(job)) {
+            std::cerr << "Job " << job->label << " does not fit the cpus even alone." << std::endl;
+            return 1;
+        }
+    }
+    PrintPlacement(jobs, packer.Waves());
+    if (opts.dry_run) {
+        return 0;
+    }
+
+    CgroupCpusets cgroups;
+    std::map<std::string, std::string> cgroup_procs;
+    if (opts.isolation == "cgroup") {
+        if (!cgroups.Setup(opts.cgroup_root)) {
+            return 1;
+        }
+        for (const auto &job : jobs) {
+            if (!cgroups.Add(job, &cgroup_procs[job.label])) {
+                return 1;
+            }
+        }
+    }
+
+    // SIGCHLD is waited for synchronously, to time the jobs when they exit rather than at the next sample
+    sigset_t mask, sigchld;
+    sigemptyset(&sigchld);
+    sigaddset(&sigchld, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &sigchld, &mask);
+
+    int failures = 0;
+    auto start = Clock::now();
+    if (opts.calibrate) {
+        for (auto &job : jobs) {
+            failures += RunConcurrently({&job}, true, opts, cgroup_procs, mask);
+        }
+    }
+    auto calibrated = Clock::now();
+    for (int wave = 0; wave < packer.Waves(); wave++) {
+        std::vector<Job *> wave_jobs;
+        for (auto &job : jobs) {
+            if (job.wave == wave) {
+                wave_jobs.push_back(&job);
+            }
+        }
+        failures += RunConcurrently(wave_jobs, false, opts, cgroup_procs, mask);
+    }
+    double wall_time = std::chrono::duration<double>(Clock::now() - calibrated).count();
+
+    host_utils::ResultEmitter emitter(opts.result);
+    double serial_time = 0;
+    int interfered = 0;
+    for (const auto &job : jobs) {
+        host_utils::ResultTags tags = {{"job", job.label}};
+        emitter.Metric(job.label + "_wall_time", job.wall_time, "s", tags);
+        emitter.Metric(job.label + "_return_code", job.return_code, "", tags);
+        emitter.Metric(job.label + "_wave", job.wave, "", tags);
+        emitter.Metric(job.label + "_cpus", static_cast<double>(job.cpus.size()), "", tags);
+        double escaped = job.thread_samples > 0 ? static_cast<double>(job.escaped_samples) / job.thread_samples : 0;
+        double intruded = job.rounds > 0 ? static_cast<double>(job.intruded_rounds) / job.rounds : 0;
+        emitter.Metric(job.label + "_escaped_ratio", escaped, "", tags);
+        emitter.Metric(job.label + "_intruded_ratio", intruded, "", tags);
+        std::vector<std::string> reasons;
+        if (escaped > 0) {
+            reasons.push_back("ran outside of its cpus in " + std::to_string(job.escaped_samples) + " of " +
+                              std::to_string(job.thread_samples) + " thread samples");
+        }
+        if (intruded > opts.threshold) {
+            reasons.push_back("shared its cpus with foreign threads in " + std::to_string(job.intruded_rounds) +
+                              " of " + std::to_string(job.rounds) + " samples");
+        }
+        if (opts.calibrate) {
+            emitter.Metric(job.label + "_solo_time", job.solo_time, "s", tags);
+            double slowdown = job.solo_time > 0 ? job.wall_time / job.solo_time : 0;
+            emitter.Metric(job.label + "_slowdown", slowdown, "", tags);
+            if (slowdown > 1 + opts.threshold) {
+                reasons.push_back("ran " + std::to_string(slowdown) + "x slower than alone");
+            }
+        }
+        for (const auto &reason : reasons) {
+            std::cout << "# Interference: " << job.label << " " << reason << std::endl;
+        }
+        interfered += reasons.empty() ? 0 : 1;
+        if (job.return_code != 0) {
+            std::cerr << "Job " << job.label << " failed with " << job.return_code << ", see its log in "
+                      << opts.log_dir << "." << std::endl;
+            failures++;
+        }
+        serial_time += opts.calibrate ? job.solo_time : job.wall_time;
+    }
+    emitter.Metric("launcher_waves", packer.Waves());
+    emitter.Metric("launcher_wall_time", wall_time, "s");
+    emitter.Metric("launcher_serial_time", serial_time, "s");
+    if (opts.calibrate) {
+        emitter.Metric("launcher_calibration_time", std::chrono::duration<double>(calibrated - start).count(), "s");
+    }
+    emitter.Metric("launcher_interfered_jobs", interfered);
+    return failures == 0 && !emitter.Stopped() ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Decoder of the result records written by host_utils/result_emitter.h."""
+
+import json
+import math
+import struct
+import sys
+from array import array
+
+# Version of the records this decoder understands.
+RECORD_VERSION = 1
+
+_BINARY_MAGIC = b'SBRR'
+_BINARY_KINDS = {1: 'metric', 2: 'samples'}
+
+
+def _check_record(record):
+    """Check one decoded record and replace nulls, which stand for non-finite numbers, with nan.
+
+    Args:
+        record (dict): the record.
+
+    Return:
+        dict: the record.
+    """
+    if record.get('v') != RECORD_VERSION:
+        raise ValueError('unsupported record version {}'.format(record.get('v')))
+    if record.get('kind') == 'metric':
+        if record['value'] is None:
+            record['value'] = math.nan
+    elif record.get('kind') == 'samples':
+        record['samples'] = [math.nan if x is None else x for x in record['samples']]
+    else:
+        raise ValueError('unknown record kind {}'.format(record.get('kind')))
+    return record
+
+
+def decode_jsonl(raw_output):
+    """Decode the records in JSON Lines.
+
+    Lines that are not JSON objects, e.g. messages of the launcher, are skipped.
+
+    Args:
+        raw_output (str): the output of the benchmark.
+
+    Return:
+        list[dict]: the records, each with kind, name, unit, tags and value or samples.
+    """
+    records = []
+    for line in raw_output.splitlines():
+        line = line.strip()
+        if line.startswith('{'):
+            records.append(_check_record(json.loads(line)))
+    return records
+
+
+def decode_binary(data):
+    """Decode the records in the binary framing.
+
+    Args:
+        data (bytes): the output of the benchmark.
+
+    Return:
+        list[dict]: the records, each with kind, name, unit, tags and value or samples.
+    """
+    if data[:4] != _BINARY_MAGIC:
+        raise ValueError('missing magic of the binary records')
+    if data[4] != RECORD_VERSION:
+        raise ValueError('unsupported record version {}'.format(data[4]))
+
+    def read_str(offset):
+        length, = struct.unpack_from('<H', data, offset)
+        return data[offset + 2:offset + 2 + length].decode(), offset + 2 + length
+
+    records = []
+    offset = 5
+    while offset < len(data):
+        length, kind = struct.unpack_from('<IB', data, offset)
+        end = offset + 4 + length
+        if end > len(data):
+            raise ValueError('truncated binary record at offset {}'.format(offset))
+        if kind not in _BINARY_KINDS:
+            raise ValueError('unknown record kind {}'.format(kind))
+        record = {'v': RECORD_VERSION, 'kind': _BINARY_KINDS[kind]}
+        record['name'], offset = read_str(offset + 5)
+        record['unit'], offset = read_str(offset)
+        num_tags, = struct.unpack_from('<H', data, offset)
+        offset += 2
+        record['tags'] = {}
+        for _ in range(num_tags):
+            key, offset = read_str(offset)
+            record['tags'][key], offset = read_str(offset)
+        if record['kind'] == 'metric':
+            record['value'], = struct.unpack_from('<d', data, offset)
+        else:
+            count, = struct.unpack_from('<Q', data, offset)
+            samples = array('d')
+            samples.frombytes(data[offset + 8:offset + 8 + count * 8])
+            if sys.byteorder == 'big':
+                samples.byteswap()
+            record['samples'] = samples.tolist()
+        records.append(record)
+        offset = end
+    return records
@@ -0,0 +1,93 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the shared-memory intra-node collective benchmark.
+
+The benchmark prints the same table as nccl-tests, so the result parsing is inherited from the NCCL benchmark.
+"""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+from superbench.benchmarks.micro_benchmarks.cuda_nccl_bw_performance import CudaNcclBwBenchmark
+
+
+class ShmCollectiveBenchmark(CudaNcclBwBenchmark):
+    """The shared-memory collective bus bandwidth benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'shm_collective'
+        self._operations = ['allreduce', 'allgather', 'reducescatter', 'broadcast', 'alltoall']
+        self._algos = ['ring', 'rd', 'rsag']
+        self._data_types = ['float', 'double', 'int32', 'int64']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+
+        # Every rank holds three buffers of the largest size in host memory
+        self._parser.set_defaults(maxbytes='128M')
+        self._parser.add_argument(
+            '--nranks',
+            type=int,
+            default=8,
+            help='Number of ranks, each a process attached to the shared-memory arena.',
+        )
+        self._parser.add_argument(
+            '--algo',
+            type=str,
+            default='rsag',
+            help='Allreduce algorithm, e.g., {}.'.format(' '.join(self._algos)),
+        )
+        self._parser.add_argument(
+            '--no_numa',
+            action='store_true',
+            help='Do not place the ranks and their buffers on NUMA nodes.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        # Skip the nccl-tests binary selection of the parent class
+        if not MicroBenchmarkWithInvoke._preprocess(self):
+            return False
+
+        self._args.operation = self._args.operation.lower()
+        for name, value, choices in [
+            ('operation', self._args.operation, self._operations),
+            ('algo', self._args.algo, self._algos),
+            ('data_type', self._args.data_type, self._data_types),
+        ]:
+            if value not in choices:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error(
+                    'Unsupported {} - benchmark: {}, {}: {}, expected: {}.'.format(
+                        name, self._name, name, value, ' '.join(choices)
+                    )
+                )
+                return False
+
+        command = os.path.join(self._args.bin_dir, self._bin_name)
+        command += ' --operation {} --algo {} -g {} -b {} -e {} -f {} -c {} -n {} -w {} -d {} --numa {}'.format(
+            self._args.operation, self._args.algo, self._args.nranks, self._args.minbytes, self._args.maxbytes,
+            self._args.stepfactor, self._args.check, self._args.iters, self._args.warmup_iters, self._args.data_type,
+            0 if self._args.no_numa else 1
+        )
+        self._commands = [command]
+
+        return True
+
+
+BenchmarkRegistry.register_benchmark('shm-collective', ShmCollectiveBenchmark)
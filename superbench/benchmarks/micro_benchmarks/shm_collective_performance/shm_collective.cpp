@@ -0,0 +1,875 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Shared-memory intra-node collective benchmark.
+// The ranks are processes forked on one node and attached to a shared-memory arena holding the buffers of every rank,
+// so a rank reads its peers' buffers directly. Allreduce (ring, recursive doubling, or reduce-scatter followed by
+// allgather), allgather, reducescatter, broadcast and alltoall are swept over message sizes and printed in the same
+// table as nccl-tests, so that the output is parsed by the nccl-bw benchmark.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <getopt.h>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <numa.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+// Collective operations.
+enum class Operation { kAllReduce, kAllGather, kReduceScatter, kBroadcast, kAllToAll };
+
+// Allreduce algorithms.
+enum class Algo { kRing, kRecursiveDoubling, kReduceScatterAllGather };
+
+// Element types.
+enum class DataType { kFloat, kDouble, kInt32, kInt64 };
+
+// Alignment of the buffers of every rank, a huge page so that they can be placed on NUMA nodes independently.
+constexpr size_t kBufAlignment = 2 << 20;
+
+// Options accepted by this program, named after their nccl-tests counterparts.
+struct Opts {
+    // Collective operation.
+    Operation operation = Operation::kAllReduce;
+
+    // Allreduce algorithm.
+    Algo algo = Algo::kReduceScatterAllGather;
+
+    // Element type.
+    DataType data_type = DataType::kFloat;
+
+    // Number of ranks.
+    int nranks = 8;
+
+    // Smallest message size in bytes.
+    size_t min_bytes = 8;
+
+    // Largest message size in bytes.
+    size_t max_bytes = 32 << 20;
+
+    // Multiplication factor between sizes.
+    int step_factor = 2;
+
+    // Number of timed iterations.
+    int iters = 20;
+
+    // Number of warmup iterations.
+    int warmup_iters = 5;
+
+    // Whether to check the results.
+    int check = 0;
+
+    // Root rank of broadcast.
+    int root = 0;
+
+    // Whether to place every rank and its buffers on a NUMA node.
+    int numa = 1;
+};
+
+// State shared by all ranks at the start of the arena.
+struct ShmHeader {
+    // Sense-reversing barrier.
+    alignas(64) std::atomic<uint32_t> barrier_count;
+    alignas(64) std::atomic<uint32_t> barrier_sense;
+
+    // Number of wrong elements found by every rank in the last check.
+    alignas(64) std::atomic<uint64_t> wrong;
+
+    // Set by a rank that failed, so that the others stop.
+    std::atomic<int> error;
+};
+
+// Buffer views of a collective, as offsets in the region of a rank. A view of rank r starts at offset + r * stride,
+// which lets the in-place variants point the input into the output.
+struct Views {
+    size_t send;
+    size_t send_stride;
+    size_t recv;
+    size_t recv_stride;
+};
+
+// Context of a rank.
+struct Rank {
+    const Opts *opts;
+    ShmHeader *header;
+    char *base;
+    size_t region;
+    size_t buf_size;
+    int rank;
+    int nranks;
+    bool sense = false;
+
+    // Get the address of an offset in the region of a rank.
+    char *Ptr(int r, size_t offset) { return base + r * region + offset; }
+
+    // Get the send buffer of a rank.
+    template <typename T> T *Send(int r, const Views &v) {
+        return reinterpret_cast<T *>(Ptr(r, v.send + r * v.send_stride));
+    }
+
+    // Get the recv buffer of a rank.
+    template <typename T> T *Recv(int r, const Views &v) {
+        return reinterpret_cast<T *>(Ptr(r, v.recv + r * v.recv_stride));
+    }
+
+    // Get the scratch buffer of a rank.
+    template <typename T> T *Scratch(int r) { return reinterpret_cast<T *>(Ptr(r, 2 * buf_size)); }
+
+    // Wait until every rank arrives.
+    void Barrier() {
+        sense = !sense;
+        if (header->barrier_count.fetch_add(1) + 1 == static_cast<uint32_t>(nranks)) {
+            header->barrier_count.store(0);
+            header->barrier_sense.store(sense);
+            return;
+        }
+        // Spin briefly, then yield so that oversubscribed ranks still make progress
+        for (int spin = 0; header->barrier_sense.load() != sense; spin = std::min(spin + 1, 1000)) {
+            if (spin == 1000) {
+                sched_yield();
+            }
+        }
+    }
+};
+
+// Sum reductions compiled for several instruction sets and dispatched at load time.
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SIMD_CLONES
+#endif
+
+#define DEFINE_REDUCE_SUM(T)                                                                                           \
+    SIMD_CLONES void ReduceSum(T *dst, const T *a, const T *b, size_t n) {                                             \
+        for (size_t i = 0; i < n; i++) {                                                                               \
+            dst[i] = a[i] + b[i];                                                                                      \
+        }                                                                                                              \
+    }
+DEFINE_REDUCE_SUM(float)
+DEFINE_REDUCE_SUM(double)
+DEFINE_REDUCE_SUM(int32_t)
+DEFINE_REDUCE_SUM(int64_t)
+#undef DEFINE_REDUCE_SUM
+
+/**
+ * @brief Get the range of a chunk when splitting count elements into nchunks chunks.
+ *
+ * @param count The number of elements.
+ * @param nchunks The number of chunks.
+ * @param chunk The index of the chunk.
+ * @param begin The first element of the chunk.
+ * @param len The number of elements of the chunk.
+ */
+void ChunkRange(size_t count, int nchunks, int chunk, size_t *begin, size_t *len) {
+    *begin = count * chunk / nchunks;
+    *len = count * (chunk + 1) / nchunks - *begin;
+}
+
+/**
+ * @brief Allreduce by reducing one chunk per rank from all inputs, then gathering the reduced chunks.
+ */
+template <typename T> void AllReduceRsag(Rank *ctx, const Views &v, size_t count) {
+    int r = ctx->rank;
+    size_t begin = 0, len = 0;
+    ChunkRange(count, ctx->nranks, r, &begin, &len);
+    T *recv = ctx->Recv<T>(r, v);
+    ctx->Barrier();
+    if (ctx->nranks == 1) {
+        memmove(recv, ctx->Send<T>(r, v), count * sizeof(T));
+        return;
+    }
+    // Start from the own input, which the output overwrites in place
+    int n = ctx->nranks;
+    ReduceSum(recv + begin, ctx->Send<T>(r, v) + begin, ctx->Send<T>((r + 1) % n, v) + begin, len);
+    for (int j = 2; j < n; j++) {
+        ReduceSum(recv + begin, recv + begin, ctx->Send<T>((r + j) % n, v) + begin, len);
+    }
+    ctx->Barrier();
+    for (int j = 1; j < n; j++) {
+        int peer = (r + j) % n;
+        ChunkRange(count, n, peer, &begin, &len);
+        memcpy(recv + begin, ctx->Recv<T>(peer, v) + begin, len * sizeof(T));
+    }
+}
+
+/**
+ * @brief Allreduce with a ring, a reduce-scatter then an allgather of n - 1 steps each between neighbors.
+ */
+template <typename T> void AllReduceRing(Rank *ctx, const Views &v, size_t count) {
+    int n = ctx->nranks;
+    int r = ctx->rank;
+    int prev = (r + n - 1) % n;
+    T *recv = ctx->Recv<T>(r, v);
+    size_t begin = 0, len = 0;
+    ctx->Barrier();
+    if (n == 1) {
+        memmove(recv, ctx->Send<T>(r, v), count * sizeof(T));
+        return;
+    }
+    // After step s, chunk (r - s - 1) of this rank holds the sum of s + 2 inputs
+    for (int s = 0; s < n - 1; s++) {
+        int chunk = ((r - s - 1) % n + n) % n;
+        ChunkRange(count, n, chunk, &begin, &len);
+        const T *partial = s == 0 ? ctx->Send<T>(prev, v) : ctx->Recv<T>(prev, v);
+        ReduceSum(recv + begin, ctx->Send<T>(r, v) + begin, partial + begin, len);
+        ctx->Barrier();
+    }
+    // This rank holds the full sum of chunk (r + 1), forward the chunks around the ring
+    for (int s = 0; s < n - 1; s++) {
+        int chunk = ((r - s) % n + n) % n;
+        ChunkRange(count, n, chunk, &begin, &len);
+        memcpy(recv + begin, ctx->Recv<T>(prev, v) + begin, len * sizeof(T));
+        if (s < n - 2) {
+            ctx->Barrier();
+        }
+    }
+}
+
+/**
+ * @brief Allreduce with recursive doubling, log2(n) steps exchanging the whole vector with a partner.
+ *
+ * The partial sums alternate between the scratch and the recv buffer, so that a step never overwrites what a
+ * partner still reads. The number of ranks must be a power of two.
+ */
+template <typename T> void AllReduceRd(Rank *ctx, const Views &v, size_t count) {
+    int r = ctx->rank;
+    T *recv = ctx->Recv<T>(r, v);
+    ctx->Barrier();
+    bool in_scratch = false;
+    for (int mask = 1; mask < ctx->nranks; mask <<= 1) {
+        int peer = r ^ mask;
+        const T *mine = mask == 1 ? ctx->Send<T>(r, v) : (in_scratch ? ctx->Scratch<T>(r) : recv);
+        const T *theirs =
+            mask == 1 ? ctx->Send<T>(peer, v) : (in_scratch ? ctx->Scratch<T>(peer) : ctx->Recv<T>(peer, v));
+        T *out = in_scratch ? recv : ctx->Scratch<T>(r);
+        ReduceSum(out, mine, theirs, count);
+        in_scratch = !in_scratch;
+        ctx->Barrier();
+    }
+    if (ctx->nranks == 1) {
+        memmove(recv, ctx->Send<T>(r, v), count * sizeof(T));
+    } else if (in_scratch) {
+        memcpy(recv, ctx->Scratch<T>(r), count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Allgather, every rank copies the input of every peer, count elements each.
+ */
+template <typename T> void AllGather(Rank *ctx, const Views &v, size_t count) {
+    int r = ctx->rank;
+    T *recv = ctx->Recv<T>(r, v);
+    ctx->Barrier();
+    for (int j = 0; j < ctx->nranks; j++) {
+        int peer = (r + j) % ctx->nranks;
+        memmove(recv + peer * count, ctx->Send<T>(peer, v), count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Reducescatter, every rank reduces its own block of count elements from the inputs of all peers.
+ */
+template <typename T> void ReduceScatter(Rank *ctx, const Views &v, size_t count) {
+    int r = ctx->rank;
+    T *recv = ctx->Recv<T>(r, v);
+    size_t offset = r * count;
+    ctx->Barrier();
+    if (ctx->nranks == 1) {
+        memmove(recv, ctx->Send<T>(r, v), count * sizeof(T));
+        return;
+    }
+    // Start from the own input, which the output overwrites in place
+    int n = ctx->nranks;
+    ReduceSum(recv, ctx->Send<T>(r, v) + offset, ctx->Send<T>((r + 1) % n, v) + offset, count);
+    for (int j = 2; j < n; j++) {
+        ReduceSum(recv, recv, ctx->Send<T>((r + j) % n, v) + offset, count);
+    }
+}
+
+/**
+ * @brief Broadcast, every rank copies the input of the root, except the root itself in place.
+ */
+template <typename T> void Broadcast(Rank *ctx, const Views &v, size_t count) {
+    T *recv = ctx->Recv<T>(ctx->rank, v);
+    const T *send = ctx->Send<T>(ctx->opts->root, v);
+    ctx->Barrier();
+    if (recv != send) {
+        memcpy(recv, send, count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Alltoall, every rank copies its block of count elements from the input of every peer.
+ *
+ * The in-place variant gathers into the scratch buffer first, since the peers still read the blocks it replaces.
+ */
+template <typename T> void AllToAll(Rank *ctx, const Views &v, size_t count) {
+    int r = ctx->rank;
+    bool in_place = v.send == v.recv && v.send_stride == v.recv_stride;
+    T *out = in_place ? ctx->Scratch<T>(r) : ctx->Recv<T>(r, v);
+    ctx->Barrier();
+    for (int j = 0; j < ctx->nranks; j++) {
+        int peer = (r + j) % ctx->nranks;
+        memcpy(out + peer * count, ctx->Send<T>(peer, v) + r * count, count * sizeof(T));
+    }
+    if (in_place) {
+        ctx->Barrier();
+        memcpy(ctx->Recv<T>(r, v), out, ctx->nranks * count * sizeof(T));
+    }
+}
+
+/**
+ * @brief Run the collective of the options once.
+ *
+ * @param ctx The rank.
+ * @param v The buffer views.
+ * @param count The number of elements per rank, i.e. the input of allreduce and broadcast, a block otherwise.
+ */
+template <typename T> void RunCollective(Rank *ctx, const Views &v, size_t count) {
+    switch (ctx->opts->operation) {
+    case Operation::kAllReduce:
+        if (ctx->opts->algo == Algo::kRing) {
+            AllReduceRing<T>(ctx, v, count);
+        } else if (ctx->opts->algo == Algo::kRecursiveDoubling) {
+            AllReduceRd<T>(ctx, v, count);
+        } else {
+            AllReduceRsag<T>(ctx, v, count);
+        }
+        break;
+    case Operation::kAllGather:
+        AllGather<T>(ctx, v, count);
+        break;
+    case Operation::kReduceScatter:
+        ReduceScatter<T>(ctx, v, count);
+        break;
+    case Operation::kBroadcast:
+        Broadcast<T>(ctx, v, count);
+        break;
+    case Operation::kAllToAll:
+        AllToAll<T>(ctx, v, count);
+        break;
+    }
+}
+
+/**
+ * @brief Get the input value of an element, small integers so that float sums are exact.
+ *
+ * @param rank The rank owning the input.
+ * @param index The index of the element in the input.
+ * @return The value.
+ */
+template <typename T> T InputValue(int rank, size_t index) { return static_cast<T>((rank + 1) * (index % 13 + 1)); }
+
+/**
+ * @brief Fill the input of this rank, and poison its output.
+ *
+ * @param ctx The rank.
+ * @param v The buffer views.
+ * @param send_count The number of input elements.
+ * @param recv_count The number of output elements.
+ */
+template <typename T> void InitBuffers(Rank *ctx, const Views &v, size_t send_count, size_t recv_count) {
+    T *recv = ctx->Recv<T>(ctx->rank, v);
+    std::fill(recv, recv + recv_count, static_cast<T>(-1));
+    T *send = ctx->Send<T>(ctx->rank, v);
+    for (size_t i = 0; i < send_count; i++) {
+        send[i] = InputValue<T>(ctx->rank, i);
+    }
+}
+
+/**
+ * @brief Count the wrong output elements of this rank.
+ *
+ * @param ctx The rank.
+ * @param v The buffer views.
+ * @param count The number of elements per rank, as in RunCollective().
+ * @return The number of wrong elements.
+ */
+template <typename T> uint64_t CountWrong(Rank *ctx, const Views &v, size_t count) {
+    int n = ctx->nranks;
+    int r = ctx->rank;
+    const T *recv = ctx->Recv<T>(r, v);
+    uint64_t wrong = 0;
+    auto sum = [n](size_t index) { return static_cast<T>(n * (n + 1) / 2 * (index % 13 + 1)); };
+    switch (ctx->opts->operation) {
+    case Operation::kAllReduce:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != sum(i);
+        }
+        break;
+    case Operation::kAllGather:
+        for (size_t i = 0; i < n * count; i++) {
+            wrong += recv[i] != InputValue<T>(i / count, i % count);
+        }
+        break;
+    case Operation::kReduceScatter:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != sum(r * count + i);
+        }
+        break;
+    case Operation::kBroadcast:
+        for (size_t i = 0; i < count; i++) {
+            wrong += recv[i] != InputValue<T>(ctx->opts->root, i);
+        }
+        break;
+    case Operation::kAllToAll:
+        for (size_t i = 0; i < n * count; i++) {
+            wrong += recv[i] != InputValue<T>(i / count, r * count + i % count);
+        }
+        break;
+    }
+    return wrong;
+}
+
+// Result of one variant of one size.
+struct VariantResult {
+    double time_us = 0;
+    double algbw = 0;
+    double busbw = 0;
+    int64_t wrong = -1;
+};
+
+/**
+ * @brief Get the bus bandwidth factor of nccl-tests for an operation.
+ *
+ * @param operation The operation.
+ * @param nranks The number of ranks.
+ * @return The factor from algorithm bandwidth to bus bandwidth.
+ */
+double BusBwFactor(Operation operation, int nranks) {
+    switch (operation) {
+    case Operation::kAllReduce:
+        return 2.0 * (nranks - 1) / nranks;
+    case Operation::kBroadcast:
+        return 1;
+    default:
+        return static_cast<double>(nranks - 1) / nranks;
+    }
+}
+
+/**
+ * @brief Run one variant of one size on this rank, checking the results first if requested.
+ *
+ * @param ctx The rank.
+ * @param in_place Whether to run the in-place variant.
+ * @param bytes The message size in bytes as printed by nccl-tests.
+ * @param result The result, valid on rank 0.
+ */
+template <typename T> void RunVariant(Rank *ctx, bool in_place, size_t bytes, VariantResult *result) {
+    const Opts &opts = *ctx->opts;
+    int n = ctx->nranks;
+    size_t total = bytes / sizeof(T);
+    bool blocked = opts.operation != Operation::kAllReduce && opts.operation != Operation::kBroadcast;
+    size_t count = blocked ? total / n : total;
+    size_t send_count = opts.operation == Operation::kAllGather ? count : total;
+    size_t recv_count = opts.operation == Operation::kReduceScatter ? count : total;
+    size_t block = count * sizeof(T);
+
+    Views v = {0, 0, ctx->buf_size, 0};
+    if (in_place) {
+        if (opts.operation == Operation::kAllGather) {
+            v = {ctx->buf_size, block, ctx->buf_size, 0};
+        } else if (opts.operation == Operation::kReduceScatter) {
+            v = {0, 0, 0, block};
+        } else {
+            v = {ctx->buf_size, 0, ctx->buf_size, 0};
+        }
+    }
+
+    if (opts.check) {
+        InitBuffers<T>(ctx, v, send_count, recv_count);
+        if (ctx->rank == 0) {
+            ctx->header->wrong.store(0);
+        }
+        ctx->Barrier();
+        RunCollective<T>(ctx, v, count);
+        ctx->header->wrong.fetch_add(CountWrong<T>(ctx, v, count));
+        ctx->Barrier();
+        result->wrong = static_cast<int64_t>(ctx->header->wrong.load());
+    }
+
+    for (int i = 0; i < opts.warmup_iters; i++) {
+        RunCollective<T>(ctx, v, count);
+    }
+    ctx->Barrier();
+    auto start = Clock::now();
+    for (int i = 0; i < opts.iters; i++) {
+        RunCollective<T>(ctx, v, count);
+    }
+    ctx->Barrier();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count() / std::max(opts.iters, 1);
+
+    result->time_us = seconds * 1e6;
+    result->algbw = bytes / seconds / 1e9;
+    result->busbw = result->algbw * BusBwFactor(opts.operation, n);
+}
+
+/**
+ * @brief Format a value in at most width characters with as many decimals as fit, as nccl-tests does.
+ *
+ * @param value The value.
+ * @param width The width.
+ * @return The formatted value.
+ */
+std::string FormatFloat(double value, int width) {
+    char str[32];
+    for (int precision = 2; precision >= 0; precision--) {
+        snprintf(str, sizeof(str), "%*.*f", width, precision, value);
+        if (static_cast<int>(strlen(str)) <= width) {
+            break;
+        }
+    }
+    return str;
+}
+
+/**
+ * @brief Get the nccl-tests name of a data type.
+ *
+ * @param data_type The data type.
+ * @return The name.
+ */
+const char *DataTypeName(DataType data_type) {
+    switch (data_type) {
+    case DataType::kFloat:
+        return "float";
+    case DataType::kDouble:
+        return "double";
+    case DataType::kInt32:
+        return "int32";
+    case DataType::kInt64:
+        return "int64";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Get the size of an element of a data type.
+ *
+ * @param data_type The data type.
+ * @return The size in bytes.
+ */
+size_t DataTypeSize(DataType data_type) {
+    return data_type == DataType::kFloat || data_type == DataType::kInt32 ? 4 : 8;
+}
+
+/**
+ * @brief Sweep the message sizes on this rank, rank 0 prints the table rows.
+ *
+ * @param ctx The rank.
+ * @return The number of wrong elements found.
+ */
+template <typename T> uint64_t RunSweep(Rank *ctx) {
+    const Opts &opts = *ctx->opts;
+    bool reduce = opts.operation == Operation::kAllReduce || opts.operation == Operation::kReduceScatter;
+    bool blocked = opts.operation != Operation::kAllReduce && opts.operation != Operation::kBroadcast;
+    size_t unit = sizeof(T) * (blocked ? ctx->nranks : 1);
+    uint64_t wrong = 0;
+    double busbw_sum = 0;
+    int busbw_num = 0;
+    for (size_t size = opts.min_bytes; size <= opts.max_bytes; size *= opts.step_factor) {
+        // Round down to whole elements for every rank, as nccl-tests does
+        size_t bytes = size / unit * unit;
+        VariantResult results[2];
+        RunVariant<T>(ctx, false, bytes, &results[0]);
+        RunVariant<T>(ctx, true, bytes, &results[1]);
+        if (ctx->header->error.load() != 0) {
+            break;
+        }
+        if (ctx->rank == 0) {
+            printf("%12zu  %12zu  %8s  %6s  %6d", bytes, bytes / sizeof(T), DataTypeName(opts.data_type),
+                   reduce ? "sum" : "none", opts.operation == Operation::kBroadcast ? opts.root : -1);
+            for (const auto &result : results) {
+                printf("  %7s  %6.2f  %6.2f  %6s", FormatFloat(result.time_us, 7).c_str(), result.algbw, result.busbw,
+                       result.wrong < 0 ? "N/A" : std::to_string(result.wrong).c_str());
+                wrong += std::max<int64_t>(result.wrong, 0);
+                busbw_sum += result.busbw;
+                busbw_num++;
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        if (size * opts.step_factor <= size) {
+            break;
+        }
+    }
+    if (ctx->rank == 0) {
+        printf("# Out of bounds values : %llu %s\n", static_cast<unsigned long long>(wrong),
+               wrong == 0 ? "OK" : "FAILED");
+        printf("# Avg bus bandwidth    : %g \n", busbw_num > 0 ? busbw_sum / busbw_num : 0.0);
+        printf("#\n");
+        fflush(stdout);
+    }
+    return wrong;
+}
+
+/**
+ * @brief Get the NUMA node of a rank, spreading the ranks in contiguous groups over the nodes with CPUs.
+ *
+ * @param rank The rank.
+ * @param nranks The number of ranks.
+ * @return The node, -1 if NUMA is not available.
+ */
+int RankNumaNode(int rank, int nranks) {
+    if (numa_available() < 0) {
+        return -1;
+    }
+    std::vector<int> nodes;
+    struct bitmask *cpus = numa_allocate_cpumask();
+    for (int node = 0; node <= numa_max_node(); node++) {
+        if (numa_node_to_cpus(node, cpus) == 0 && numa_bitmask_weight(cpus) > 0) {
+            nodes.push_back(node);
+        }
+    }
+    numa_free_cpumask(cpus);
+    return nodes.empty() ? -1 : nodes[static_cast<size_t>(rank) * nodes.size() / nranks];
+}
+
+/**
+ * @brief Body of a rank: place itself and its buffers, then run the sweep.
+ *
+ * @param ctx The rank.
+ * @return 0 on success, non-zero value on failure.
+ */
+int RunRank(Rank *ctx) {
+    if (ctx->opts->numa) {
+        int node = RankNumaNode(ctx->rank, ctx->nranks);
+        if (node >= 0) {
+            numa_run_on_node(node);
+            numa_tonode_memory(ctx->Ptr(ctx->rank, 0), ctx->region, node);
+        }
+    }
+    // First touch by the owner, after the placement policy is set
+    memset(ctx->Ptr(ctx->rank, 0), 0, ctx->region);
+    ctx->Barrier();
+
+    uint64_t wrong = 0;
+    switch (ctx->opts->data_type) {
+    case DataType::kFloat:
+        wrong = RunSweep<float>(ctx);
+        break;
+    case DataType::kDouble:
+        wrong = RunSweep<double>(ctx);
+        break;
+    case DataType::kInt32:
+        wrong = RunSweep<int32_t>(ctx);
+        break;
+    case DataType::kInt64:
+        wrong = RunSweep<int64_t>(ctx);
+        break;
+    }
+    return wrong == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    printf("Usage: shm_collective "
+           "[--operation allreduce|allgather|reducescatter|broadcast|alltoall] "
+           "[--algo ring|rd|rsag] "
+           "[-g,--nranks <num>] "
+           "[-b,--minbytes <bytes>] "
+           "[-e,--maxbytes <bytes>] "
+           "[-f,--stepfactor <num>] "
+           "[-n,--iters <num>] "
+           "[-w,--warmup_iters <num>] "
+           "[-c,--check <0|1>] "
+           "[-d,--datatype float|double|int32|int64] "
+           "[-r,--root <rank>] "
+           "[--numa <0|1>]\n");
+}
+
+/**
+ * @brief Parse a size with an optional K/M/G suffix in powers of 1024, as nccl-tests does.
+ *
+ * @param str The string to parse.
+ * @param value The parsed size.
+ * @return true if the size is valid.
+ */
+bool ParseBytes(const char *str, size_t *value) {
+    char *end = nullptr;
+    unsigned long long number = strtoull(str, &end, 10);
+    std::map<char, int> shifts = {{'\0', 0}, {'K', 10}, {'k', 10}, {'M', 20}, {'m', 20}, {'G', 30}, {'g', 30}};
+    if (end == str || shifts.count(*end) == 0 || (*end != '\0' && end[1] != '\0')) {
+        return false;
+    }
+    *value = static_cast<size_t>(number) << shifts[*end];
+    return true;
+}
+
+/**
+ * @brief Parses command-line options for the shared-memory collective benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx { kOperation = 256, kAlgo, kNuma };
+    const struct option options[] = {{"operation", required_argument, nullptr, static_cast<int>(OptIdx::kOperation)},
+                                     {"algo", required_argument, nullptr, static_cast<int>(OptIdx::kAlgo)},
+                                     {"numa", required_argument, nullptr, static_cast<int>(OptIdx::kNuma)},
+                                     {"nranks", required_argument, nullptr, 'g'},
+                                     {"minbytes", required_argument, nullptr, 'b'},
+                                     {"maxbytes", required_argument, nullptr, 'e'},
+                                     {"stepfactor", required_argument, nullptr, 'f'},
+                                     {"iters", required_argument, nullptr, 'n'},
+                                     {"warmup_iters", required_argument, nullptr, 'w'},
+                                     {"check", required_argument, nullptr, 'c'},
+                                     {"datatype", required_argument, nullptr, 'd'},
+                                     {"root", required_argument, nullptr, 'r'},
+                                     {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by option value
+    std::map<int, std::pair<int *, int>> int_opts = {{'g', {&opts->nranks, 1}},
+                                                     {'f', {&opts->step_factor, 2}},
+                                                     {'n', {&opts->iters, 1}},
+                                                     {'w', {&opts->warmup_iters, 0}},
+                                                     {'c', {&opts->check, 0}},
+                                                     {'r', {&opts->root, 0}},
+                                                     {static_cast<int>(OptIdx::kNuma), {&opts->numa, 0}}};
+    std::map<std::string, Operation> operations = {{"allreduce", Operation::kAllReduce},
+                                                   {"allgather", Operation::kAllGather},
+                                                   {"reducescatter", Operation::kReduceScatter},
+                                                   {"broadcast", Operation::kBroadcast},
+                                                   {"alltoall", Operation::kAllToAll}};
+    std::map<std::string, Algo> algos = {
+        {"ring", Algo::kRing}, {"rd", Algo::kRecursiveDoubling}, {"rsag", Algo::kReduceScatterAllGather}};
+    std::map<std::string, DataType> data_types = {{"float", DataType::kFloat},
+                                                  {"double", DataType::kDouble},
+                                                  {"int32", DataType::kInt32},
+                                                  {"int64", DataType::kInt64}};
+    int opt = 0;
+    bool parse_err = false;
+
+    while (!parse_err && (opt = getopt_long(argc, argv, "g:b:e:f:n:w:c:d:r:", options, nullptr)) != -1) {
+        auto int_opt = int_opts.find(opt);
+        if (opt == '?') {
+            parse_err = true;
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (opt == 'b') {
+            parse_err = !ParseBytes(optarg, &opts->min_bytes) || opts->min_bytes == 0;
+        } else if (opt == 'e') {
+            parse_err = !ParseBytes(optarg, &opts->max_bytes) || opts->max_bytes == 0;
+        } else if (opt == 'd') {
+            parse_err = data_types.count(optarg) == 0;
+            opts->data_type = parse_err ? opts->data_type : data_types[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kOperation)) {
+            parse_err = operations.count(optarg) == 0;
+            opts->operation = parse_err ? opts->operation : operations[optarg];
+        } else if (opt == static_cast<int>(OptIdx::kAlgo)) {
+            parse_err = algos.count(optarg) == 0;
+            opts->algo = parse_err ? opts->algo : algos[optarg];
+        }
+        if (parse_err && opt != '?') {
+            fprintf(stderr, "Invalid option value: %s\n", optarg);
+        }
+    }
+
+    if (!parse_err && (opts->min_bytes > opts->max_bytes || opts->root >= opts->nranks)) {
+        fprintf(stderr, "The minbytes must not exceed the maxbytes and the root must be a valid rank.\n");
+        parse_err = true;
+    }
+    if (!parse_err && opts->operation == Operation::kAllReduce && opts->algo == Algo::kRecursiveDoubling &&
+        (opts->nranks & (opts->nranks - 1)) != 0) {
+        fprintf(stderr, "Recursive doubling needs a power of two ranks.\n");
+        parse_err = true;
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    // Every rank owns a send, a recv and a scratch buffer of the largest size in the arena
+    size_t buf_size = (opts.max_bytes + kBufAlignment - 1) / kBufAlignment * kBufAlignment;
+    size_t region = 3 * buf_size;
+    size_t arena_size = kBufAlignment + opts.nranks * region;
+    void *arena = mmap(nullptr, arena_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (arena == MAP_FAILED) {
+        fprintf(stderr, "Failed to map the shared-memory arena of %zu bytes. ERROR: %s\n", arena_size,
+                strerror(errno));
+        return 1;
+    }
+    ShmHeader *header = new (arena) ShmHeader();
+    header->barrier_count.store(0);
+    header->barrier_sense.store(0);
+    header->wrong.store(0);
+    header->error.store(0);
+
+    const char *algo_names[] = {"ring", "rd", "rsag"};
+    const char *op_names[] = {"allreduce", "allgather", "reducescatter", "broadcast", "alltoall"};
+    printf("# nRanks %d minBytes %zu maxBytes %zu step: %d(factor) warmup iters: %d iters: %d validation: %d\n",
+           opts.nranks, opts.min_bytes, opts.max_bytes, opts.step_factor, opts.warmup_iters, opts.iters, opts.check);
+    printf("# Operation: %s, algorithm: %s, transport: shared memory\n", op_names[static_cast<int>(opts.operation)],
+           opts.operation == Operation::kAllReduce ? algo_names[static_cast<int>(opts.algo)] : "direct");
+    printf("#\n# Using ranks\n");
+    for (int r = 0; r < opts.nranks; r++) {
+        printf("#  Rank %2d on numa node %2d\n", r, opts.numa ? RankNumaNode(r, opts.nranks) : -1);
+    }
+    printf("#\n");
+    printf("#%74s%33s\n", "out-of-place", "in-place");
+    printf("#%11s  %12s  %8s  %6s  %6s  %7s  %6s  %6s  %6s  %7s  %6s  %6s  %6s\n", "size", "count", "type", "redop",
+           "root", "time", "algbw", "busbw", "#wrong", "time", "algbw", "busbw", "#wrong");
+    printf("#%11s  %12s  %8s  %6s  %6s  %7s  %6s  %6s  %6s  %7s  %6s  %6s  %6s\n", "(B)", "(elements)", "", "", "",
+           "(us)", "(GB/s)", "(GB/s)", "", "(us)", "(GB/s)", "(GB/s)", "");
+    fflush(stdout);
+
+    std::vector<pid_t> children;
+    int rank_ret = 0;
+    for (int r = 0; r < opts.nranks; r++) {
+        Rank ctx = {&opts, header, static_cast<char *>(arena) + kBufAlignment, region, buf_size, r, opts.nranks};
+        if (r == opts.nranks - 1) {
+            // The launcher itself runs the last rank, rank 0 is a child that prints the table
+            rank_ret = RunRank(&ctx);
+            break;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(RunRank(&ctx));
+        } else if (pid < 0) {
+            fprintf(stderr, "Failed to fork rank %d. ERROR: %s\n", r, strerror(errno));
+            header->error.store(1);
+            // The forked ranks would wait in the barrier forever
+            for (pid_t child : children) {
+                kill(child, SIGKILL);
+            }
+            rank_ret = 1;
+            break;
+        }
+        children.push_back(pid);
+    }
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        rank_ret = rank_ret != 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ? 1 : 0;
+    }
+    munmap(arena, arena_size);
+    return rank_ret;
+}
@@ -0,0 +1,148 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the TCP connection-establishment storm benchmark."""
+
+import os
+
+from superbench.benchmarks import BenchmarkRegistry
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class TcpConnectionStormBenchmark(MicroBenchmarkWithInvoke):
+    """The TCP connection-establishment storm benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'tcp_connection_storm'
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--client_threads',
+            type=int,
+            default=16,
+            required=False,
+            help='Number of client threads.',
+        )
+        self._parser.add_argument(
+            '--connections_per_thread',
+            type=int,
+            default=256,
+            required=False,
+            help='Number of connections opened by each client thread.',
+        )
+        self._parser.add_argument(
+            '--listeners',
+            type=int,
+            default=1,
+            required=False,
+            help='Number of listener sockets sharing the port through SO_REUSEPORT.',
+        )
+        self._parser.add_argument(
+            '--accept_threads',
+            type=int,
+            default=1,
+            required=False,
+            help='Number of accept threads per listener socket.',
+        )
+        self._parser.add_argument(
+            '--backlog',
+            type=int,
+            default=128,
+            required=False,
+            help='Listen backlog of each listener socket, capped by net.core.somaxconn.',
+        )
+        self._parser.add_argument(
+            '--connect_timeout',
+            type=int,
+            default=1000,
+            required=False,
+            help='Timeout in milliseconds of each connect attempt.',
+        )
+        self._parser.add_argument(
+            '--max_retries',
+            type=int,
+            default=3,
+            required=False,
+            help='Number of retries after a failed connect attempt.',
+        )
+        self._parser.add_argument(
+            '--retry_backoff',
+            type=int,
+            default=10,
+            required=False,
+            help='Base backoff in milliseconds between retries, doubled on every retry.',
+        )
+        self._parser.add_argument(
+            '--hold_connections',
+            action='store_true',
+            help='Keep every connection open until all clients finish.',
+        )
+        self._parser.add_argument(
+            '--server_addr',
+            type=str,
+            default='127.0.0.1',
+            required=False,
+            help='IPv4 address of the server.',
+        )
+        self._parser.add_argument(
+            '--port',
+            type=int,
+            default=23457,
+            required=False,
+            help='TCP port of the server.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = '--client_threads %d --connections_per_thread %d --listeners %d --accept_threads %d --backlog %d' % (
+            self._args.client_threads, self._args.connections_per_thread, self._args.listeners,
+            self._args.accept_threads, self._args.backlog
+        )
+        args += ' --connect_timeout %d --max_retries %d --retry_backoff %d --server_addr %s --port %d' % (
+            self._args.connect_timeout, self._args.max_retries, self._args.retry_backoff, self._args.server_addr,
+            self._args.port
+        )
+        if self._args.hold_connections:
+            args += ' --hold_connections'
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('tcp-connection-storm', TcpConnectionStormBenchmark)
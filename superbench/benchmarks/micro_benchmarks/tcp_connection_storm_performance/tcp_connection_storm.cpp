@@ -0,0 +1,443 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// TCP connection-establishment storm benchmark.
+// N client threads each open M connections to a server with configurable listen backlog, SO_REUSEPORT listener
+// sharding and accept thread count, emulating the all-to-all socket wire-up at large job start (NCCL bootstrap,
+// MPI wire-up). Connect latency, connection rate, failures and retries are reported together with the kernel
+// listen queue overflow counters, so SYN backlog drops can be told apart from slow accept loops.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../host_utils/net_utils.h"
+#include "../host_utils/result_emitter.h"
+#include "../host_utils/stats_utils.h"
+
+// Options accepted by this program.
+struct Opts {
+    // Number of client threads.
+    int client_threads = 16;
+
+    // Number of connections opened by each client thread.
+    int connections_per_thread = 256;
+
+    // Number of listener sockets sharing the port through SO_REUSEPORT.
+    int listeners = 1;
+
+    // Number of accept threads per listener socket.
+    int accept_threads = 1;
+
+    // Listen backlog of each listener socket.
+    int backlog = 128;
+
+    // Timeout in milliseconds of each connect attempt.
+    int connect_timeout = 1000;
+
+    // Number of retries after a failed connect attempt.
+    int max_retries = 3;
+
+    // Base backoff in milliseconds between retries, doubled on every retry.
+    int retry_backoff = 10;
+
+    // Whether to keep every connection open until all clients finish.
+    bool hold_connections = false;
+
+    // Address of the server.
+    std::string server_addr = "127.0.0.1";
+
+    // Port of the server.
+    int port = 23457;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Counters of one client thread.
+struct ClientStats {
+    std::vector<double> latencies_us;
+    uint64_t failures = 0;
+    uint64_t retries = 0;
+    uint64_t timeouts = 0;
+};
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: tcp_connection_storm "
+              << "[--client_threads <num>] "
+              << "[--connections_per_thread <num>] "
+              << "[--listeners <num>] "
+              << "[--accept_threads <num>] "
+              << "[--backlog <num>] "
+              << "[--connect_timeout <ms>] "
+              << "[--max_retries <num>] "
+              << "[--retry_backoff <ms>] "
+              << "[--hold_connections] "
+              << "[--server_addr <ip>] "
+              << "[--port <port>] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the TCP connection storm benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kClientThreads,
+        kConnectionsPerThread,
+        kListeners,
+        kAcceptThreads,
+        kBacklog,
+        kConnectTimeout,
+        kMaxRetries,
+        kRetryBackoff,
+        kHoldConnections,
+        kServerAddr,
+        kPort
+    };
+    const struct option options[] = {
+        {"client_threads", required_argument, nullptr, static_cast<int>(OptIdx::kClientThreads)},
+        {"connections_per_thread", required_argument, nullptr, static_cast<int>(OptIdx::kConnectionsPerThread)},
+        {"listeners", required_argument, nullptr, static_cast<int>(OptIdx::kListeners)},
+        {"accept_threads", required_argument, nullptr, static_cast<int>(OptIdx::kAcceptThreads)},
+        {"backlog", required_argument, nullptr, static_cast<int>(OptIdx::kBacklog)},
+        {"connect_timeout", required_argument, nullptr, static_cast<int>(OptIdx::kConnectTimeout)},
+        {"max_retries", required_argument, nullptr, static_cast<int>(OptIdx::kMaxRetries)},
+        {"retry_backoff", required_argument, nullptr, static_cast<int>(OptIdx::kRetryBackoff)},
+        {"hold_connections", no_argument, nullptr, static_cast<int>(OptIdx::kHoldConnections)},
+        {"server_addr", required_argument, nullptr, static_cast<int>(OptIdx::kServerAddr)},
+        {"port", required_argument, nullptr, static_cast<int>(OptIdx::kPort)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kClientThreads), {&opts->client_threads, 1}},
+        {static_cast<int>(OptIdx::kConnectionsPerThread), {&opts->connections_per_thread, 1}},
+        {static_cast<int>(OptIdx::kListeners), {&opts->listeners, 1}},
+        {static_cast<int>(OptIdx::kAcceptThreads), {&opts->accept_threads, 1}},
+        {static_cast<int>(OptIdx::kBacklog), {&opts->backlog, 1}},
+        {static_cast<int>(OptIdx::kConnectTimeout), {&opts->connect_timeout, 1}},
+        {static_cast<int>(OptIdx::kMaxRetries), {&opts->max_retries, 0}},
+        {static_cast<int>(OptIdx::kRetryBackoff), {&opts->retry_backoff, 0}},
+        {static_cast<int>(OptIdx::kPort), {&opts->port, 1}}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (int_opt != int_opts.end()) {
+            if (1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (opt_idx == static_cast<int>(OptIdx::kHoldConnections)) {
+            opts->hold_connections = true;
+        } else if (opt_idx == static_cast<int>(OptIdx::kServerAddr)) {
+            opts->server_addr = optarg;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            break;
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Raise the soft limit of open files to the hard limit, needed when connections are held open.
+ */
+void RaiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+/**
+ * @brief Open the listener sockets, sharing the port through SO_REUSEPORT.
+ *
+ * @param opts The benchmark options.
+ * @param fds The listening sockets.
+ * @return true on success.
+ */
+bool OpenListeners(const Opts &opts, std::vector<int> *fds) {
+    sockaddr_in addr;
+    if (!host_utils::FillSockAddr(opts.server_addr, opts.port, &addr)) {
+        std::cerr << "Invalid server address: " << opts.server_addr << std::endl;
+        return false;
+    }
+    for (int i = 0; i < opts.listeners; i++) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (fd < 0) {
+            std::cerr << "Failed to open listener socket. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        fds->push_back(fd);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (opts.listeners > 1 && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+            std::cerr << "Failed to set SO_REUSEPORT. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, opts.backlog) != 0) {
+            std::cerr << "Failed to listen on " << opts.server_addr << ":" << opts.port
+                      << ". ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Accept thread body, accepts connections from one listener until stopped.
+ *
+ * @param opts The benchmark options.
+ * @param listen_fd The listening socket shared by the accept threads of this listener.
+ * @param stop The flag to stop accepting.
+ * @param accepted The number of accepted connections of all accept threads.
+ * @param held The mutex protecting held_fds.
+ * @param held_fds The accepted sockets kept open until the end when holding connections.
+ */
+void AcceptThread(const Opts &opts, int listen_fd, const std::atomic<bool> *stop, std::atomic<uint64_t> *accepted,
+                  std::mutex *held, std::vector<int> *held_fds) {
+    pollfd pfd = {listen_fd, POLLIN, 0};
+    std::vector<int> local_fds;
+    while (!stop->load(std::memory_order_relaxed)) {
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        while (true) {
+            int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) {
+                break;
+            }
+            accepted->fetch_add(1, std::memory_order_relaxed);
+            if (opts.hold_connections) {
+                local_fds.push_back(fd);
+            } else {
+                close(fd);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(*held);
+    held_fds->insert(held_fds->end(), local_fds.begin(), local_fds.end());
+}
+
+/**
+ * @brief Try to establish one connection.
+ *
+ * @param addr The server address.
+ * @param timeout_ms The connect timeout in milliseconds.
+ * @param timed_out Set to true if the attempt timed out.
+ * @return The connected socket, -1 on failure.
+ */
+int ConnectOnce(const sockaddr_in &addr, int timeout_ms, bool *timed_out) {
+    *timed_out = false;
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) == 0) {
+        return fd;
+    }
+    if (errno == EINPROGRESS) {
+        pollfd pfd = {fd, POLLOUT, 0};
+        int ready = poll(&pfd, 1, timeout_ms);
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (ready > 0 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+            return fd;
+        }
+        *timed_out = ready == 0;
+    }
+    close(fd);
+    return -1;
+}
+
+/**
+ * @brief Close a client socket with an abortive close, so storms do not exhaust ephemeral ports in TIME_WAIT.
+ *
+ * @param fd The socket to close.
+ */
+void ResetClose(int fd) {
+    linger lin = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+    close(fd);
+}
+
+/**
+ * @brief Client thread body, opens connections one after another with retries.
+ *
+ * @param opts The benchmark options.
+ * @param start The flag all clients wait on to start the storm together.
+ * @param stats The counters of this client.
+ */
+void ClientThread(const Opts &opts, const std::atomic<bool> *start, ClientStats *stats) {
+    sockaddr_in addr;
+    host_utils::FillSockAddr(opts.server_addr, opts.port, &addr);
+    std::vector<int> held_fds;
+    stats->latencies_us.reserve(opts.connections_per_thread);
+    while (!start->load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    for (int i = 0; i < opts.connections_per_thread; i++) {
+        int fd = -1;
+        for (int attempt = 0; attempt <= opts.max_retries; attempt++) {
+            if (attempt > 0) {
+                stats->retries++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(opts.retry_backoff << (attempt - 1)));
+            }
+            bool timed_out = false;
+            auto begin = std::chrono::steady_clock::now();
+            fd = ConnectOnce(addr, opts.connect_timeout, &timed_out);
+            auto end = std::chrono::steady_clock::now();
+            if (fd >= 0) {
+                stats->latencies_us.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                break;
+            }
+            stats->timeouts += timed_out ? 1 : 0;
+        }
+        if (fd < 0) {
+            stats->failures++;
+        } else if (opts.hold_connections) {
+            held_fds.push_back(fd);
+        } else {
+            ResetClose(fd);
+        }
+    }
+    for (int fd : held_fds) {
+        ResetClose(fd);
+    }
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+    RaiseFileLimit();
+
+    std::vector<int> listen_fds;
+    if (!OpenListeners(opts, &listen_fds)) {
+        return 1;
+    }
+
+    std::atomic<bool> stop_accept(false);
+    std::atomic<uint64_t> accepted(0);
+    std::mutex held;
+    std::vector<int> held_fds;
+    std::vector<std::thread> accept_threads;
+    for (int fd : listen_fds) {
+        for (int i = 0; i < opts.accept_threads; i++) {
+            accept_threads.emplace_back(AcceptThread, std::cref(opts), fd, &stop_accept, &accepted, &held, &held_fds);
+        }
+    }
+
+    auto counters_begin = host_utils::ReadTcpExtCounters();
+    std::atomic<bool> start(false);
+    std::vector<ClientStats> stats(opts.client_threads);
+    std::vector<std::thread> client_threads;
+    for (int i = 0; i < opts.client_threads; i++) {
+        client_threads.emplace_back(ClientThread, std::cref(opts), &start, &stats[i]);
+    }
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto &thread : client_threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    auto counters_end = host_utils::ReadTcpExtCounters();
+
+    // Give the accept threads time to drain connections still in the accept queue
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop_accept = true;
+    for (auto &thread : accept_threads) {
+        thread.join();
+    }
+    for (int fd : held_fds) {
+        close(fd);
+    }
+    for (int fd : listen_fds) {
+        close(fd);
+    }
+
+    std::vector<double> latencies;
+    uint64_t failures = 0, retries = 0, timeouts = 0;
+    for (const auto &stat : stats) {
+        latencies.insert(latencies.end(), stat.latencies_us.begin(), stat.latencies_us.end());
+        failures += stat.failures;
+        retries += stat.retries;
+        timeouts += stat.timeouts;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    int64_t somaxconn = host_utils::ReadSysctl("net/core/somaxconn", opts.backlog);
+    host_utils::ResultEmitter emitter(opts.result);
+    emitter.Metric("conn_rate", elapsed > 0 ? latencies.size() / elapsed : 0, "connections/s");
+    emitter.Metric("connected", latencies.size());
+    emitter.Metric("accepted", accepted.load());
+    emitter.Metric("failures", failures);
+    emitter.Metric("retries", retries);
+    emitter.Metric("timeouts", timeouts);
+    emitter.Metric("effective_backlog", std::min<int64_t>(opts.backlog, somaxconn));
+    emitter.Metric("connect_lat_us_avg", host_utils::Mean(latencies), "us");
+    for (double percentile : host_utils::kLatencyPercentiles) {
+        emitter.Metric("connect_lat_us_" + host_utils::PercentileName(percentile),
+                       host_utils::Percentile(latencies, percentile), "us");
+    }
+    emitter.Metric("connect_lat_us_max", latencies.empty() ? 0 : latencies.back(), "us");
+    emitter.Samples("connect_lat_us", latencies, "us");
+    for (const char *counter : {"ListenOverflows", "ListenDrops", "TCPReqQFullDrop", "SyncookiesSent"}) {
+        std::string name(counter);
+        uint64_t delta = counters_end[name] - counters_begin[name];
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        emitter.Metric(name, delta, "", {{"counter", counter}});
+    }
+
+    return emitter.Stopped() ? 1 : 0;
+}
@@ -0,0 +1,153 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the TCP loaded-latency benchmark."""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class TcpLoadedLatencyBenchmark(MicroBenchmarkWithInvoke):
+    """The TCP loaded-latency benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'tcp_loaded_latency'
+        self._roles = ['both', 'server', 'client']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--bulk_streams',
+            type=int,
+            default=4,
+            required=False,
+            help='Number of bulk TCP streams.',
+        )
+        self._parser.add_argument(
+            '--loads',
+            type=int,
+            nargs='+',
+            default=[0, 25, 50, 75, 100],
+            required=False,
+            help='Offered bulk loads in percent of the peak bulk bandwidth.',
+        )
+        self._parser.add_argument(
+            '--bulk_msg_size',
+            type=int,
+            default=128 * 1024,
+            required=False,
+            help='Size in bytes of each bulk send.',
+        )
+        self._parser.add_argument(
+            '--ping_size',
+            type=int,
+            default=64,
+            required=False,
+            help='Size in bytes of each ping-pong message.',
+        )
+        self._parser.add_argument(
+            '--runtime',
+            type=float,
+            default=5,
+            required=False,
+            help='Duration in seconds of each load level.',
+        )
+        self._parser.add_argument(
+            '--peak_bw',
+            type=float,
+            default=0,
+            required=False,
+            help='Peak bulk bandwidth in Gbps, 0 to calibrate with unpaced bulk streams.',
+        )
+        self._parser.add_argument(
+            '--server_addr',
+            type=str,
+            default='127.0.0.1',
+            required=False,
+            help='IPv4 address of the server.',
+        )
+        self._parser.add_argument(
+            '--bind_addr',
+            type=str,
+            default='0.0.0.0',
+            required=False,
+            help='IPv4 address the server binds to.',
+        )
+        self._parser.add_argument(
+            '--port',
+            type=int,
+            default=23458,
+            required=False,
+            help='TCP port of the server.',
+        )
+        self._parser.add_argument(
+            '--role',
+            type=str,
+            default='both',
+            required=False,
+            help='Role of this node. Possible values are {}.'.format(' '.join(self._roles)),
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for load in self._args.loads:
+            if load < 0 or load > 100:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid load - benchmark: {}, load: {}.'.format(self._name, load))
+                return False
+        if self._args.role not in self._roles:
+            self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+            logger.error('Invalid role - benchmark: {}, role: {}.'.format(self._name, self._args.role))
+            return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = '--bulk_streams %d --loads %s --bulk_msg_size %d --ping_size %d --runtime %g --peak_bw %g' % (
+            self._args.bulk_streams, ','.join(str(load) for load in self._args.loads), self._args.bulk_msg_size,
+            self._args.ping_size, self._args.runtime, self._args.peak_bw
+        )
+        args += ' --server_addr %s --bind_addr %s --port %d --role %s' % (
+            self._args.server_addr, self._args.bind_addr, self._args.port, self._args.role
+        )
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('tcp-loaded-latency', TcpLoadedLatencyBenchmark)
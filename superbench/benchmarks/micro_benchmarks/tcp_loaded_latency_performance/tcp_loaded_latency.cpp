@@ -0,0 +1,553 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// TCP loaded-latency benchmark.
+// K bulk TCP streams are paced to a fraction of the peak bulk bandwidth while a separate connection measures
+// small-message ping-pong round trip time, so that the RTT percentiles can be plotted against the offered load.
+// The curve exposes bufferbloat and head-of-line blocking that standalone bandwidth and latency tests miss.
+// The peak bandwidth is either given or calibrated with unpaced bulk streams before the sweep.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../host_utils/cpu_utils.h"
+#include "../host_utils/net_utils.h"
+#include "../host_utils/result_emitter.h"
+#include "../host_utils/stats_utils.h"
+
+// First byte sent on every connection to tell the server what the connection is for.
+constexpr char kBulkConnection = 'B';
+constexpr char kPingConnection = 'P';
+constexpr char kQuitConnection = 'Q';
+
+// Time to let the bulk streams ramp up before measuring.
+constexpr std::chrono::milliseconds kWarmup(500);
+
+// Roles of this process.
+enum class Role { kBoth, kServer, kClient };
+
+// Options accepted by this program.
+struct Opts {
+    // Number of bulk streams.
+    int bulk_streams = 4;
+
+    // Offered bulk loads in percent of the peak bandwidth to sweep.
+    std::vector<int> loads = {0, 25, 50, 75, 100};
+
+    // Size in bytes of each bulk send.
+    int bulk_msg_size = 128 * 1024;
+
+    // Size in bytes of each ping and pong message.
+    int ping_size = 64;
+
+    // Duration in seconds of each load level.
+    double runtime = 5;
+
+    // Peak bulk bandwidth in Gbps, 0 to calibrate with unpaced streams.
+    double peak_bw = 0;
+
+    // Address of the server.
+    std::string server_addr = "127.0.0.1";
+
+    // Address the server binds to.
+    std::string bind_addr = "0.0.0.0";
+
+    // Port of the server.
+    int port = 23458;
+
+    // Role of this process.
+    Role role = Role::kBoth;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Result of one load level.
+struct Result {
+    double bulk_bw = 0;
+    std::vector<double> rtts_us;
+};
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: tcp_loaded_latency "
+              << "[--bulk_streams <num>] "
+              << "[--loads <percent,...>] "
+              << "[--bulk_msg_size <bytes>] "
+              << "[--ping_size <bytes>] "
+              << "[--runtime <seconds>] "
+              << "[--peak_bw <Gbps>] "
+              << "[--server_addr <ip>] "
+              << "[--bind_addr <ip>] "
+              << "[--port <port>] "
+              << "[--role <both|server|client>] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the TCP loaded-latency benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kBulkStreams,
+        kLoads,
+        kBulkMsgSize,
+        kPingSize,
+        kRuntime,
+        kPeakBw,
+        kServerAddr,
+        kBindAddr,
+        kPort,
+        kRole
+    };
+    const struct option options[] = {
+        {"bulk_streams", required_argument, nullptr, static_cast<int>(OptIdx::kBulkStreams)},
+        {"loads", required_argument, nullptr, static_cast<int>(OptIdx::kLoads)},
+        {"bulk_msg_size", required_argument, nullptr, static_cast<int>(OptIdx::kBulkMsgSize)},
+        {"ping_size", required_argument, nullptr, static_cast<int>(OptIdx::kPingSize)},
+        {"runtime", required_argument, nullptr, static_cast<int>(OptIdx::kRuntime)},
+        {"peak_bw", required_argument, nullptr, static_cast<int>(OptIdx::kPeakBw)},
+        {"server_addr", required_argument, nullptr, static_cast<int>(OptIdx::kServerAddr)},
+        {"bind_addr", required_argument, nullptr, static_cast<int>(OptIdx::kBindAddr)},
+        {"port", required_argument, nullptr, static_cast<int>(OptIdx::kPort)},
+        {"role", required_argument, nullptr, static_cast<int>(OptIdx::kRole)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {
+        {static_cast<int>(OptIdx::kBulkStreams), {&opts->bulk_streams, 1}},
+        {static_cast<int>(OptIdx::kBulkMsgSize), {&opts->bulk_msg_size, 1}},
+        {static_cast<int>(OptIdx::kPingSize), {&opts->ping_size, 1}},
+        {static_cast<int>(OptIdx::kPort), {&opts->port, 1}}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (int_opt != int_opts.end()) {
+            if (1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second) {
+                std::cerr << "Invalid " << options[opt_idx].name << ": " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (opt_idx == static_cast<int>(OptIdx::kLoads)) {
+            if (!host_utils::ParseIntList(optarg, &opts->loads) ||
+                std::any_of(opts->loads.begin(), opts->loads.end(), [](int load) { return load < 0 || load > 100; })) {
+                std::cerr << "Invalid loads, must be percentages in [0, 100]: " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (opt_idx == static_cast<int>(OptIdx::kRuntime)) {
+            if (1 != sscanf(optarg, "%lf", &opts->runtime) || opts->runtime <= 0) {
+                std::cerr << "Invalid runtime: " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (opt_idx == static_cast<int>(OptIdx::kPeakBw)) {
+            if (1 != sscanf(optarg, "%lf", &opts->peak_bw) || opts->peak_bw < 0) {
+                std::cerr << "Invalid peak_bw: " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else if (opt_idx == static_cast<int>(OptIdx::kServerAddr)) {
+            opts->server_addr = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kBindAddr)) {
+            opts->bind_addr = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kRole)) {
+            if (strcmp(optarg, "both") == 0) {
+                opts->role = Role::kBoth;
+            } else if (strcmp(optarg, "server") == 0) {
+                opts->role = Role::kServer;
+            } else if (strcmp(optarg, "client") == 0) {
+                opts->role = Role::kClient;
+            } else {
+                std::cerr << "Invalid role: " << optarg << std::endl;
+                parse_err = true;
+            }
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            break;
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Send a whole buffer on a blocking socket.
+ *
+ * @param fd The socket.
+ * @param buffer The buffer to send.
+ * @param len The number of bytes to send.
+ * @return true if every byte is sent.
+ */
+bool SendAll(int fd, const char *buffer, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(fd, buffer, len, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        buffer += sent;
+        len -= sent;
+    }
+    return true;
+}
+
+/**
+ * @brief Receive a whole buffer on a blocking socket.
+ *
+ * @param fd The socket.
+ * @param buffer The buffer to fill.
+ * @param len The number of bytes to receive.
+ * @return true if every byte is received.
+ */
+bool RecvAll(int fd, char *buffer, size_t len) {
+    while (len > 0) {
+        ssize_t received = recv(fd, buffer, len, 0);
+        if (received <= 0) {
+            return false;
+        }
+        buffer += received;
+        len -= received;
+    }
+    return true;
+}
+
+/**
+ * @brief Open a connection to the server and announce its type.
+ *
+ * @param opts The benchmark options.
+ * @param type The connection type sent as the first byte.
+ * @return The connected socket, -1 on failure.
+ */
+int Connect(const Opts &opts, char type) {
+    sockaddr_in addr;
+    if (!host_utils::FillSockAddr(opts.server_addr, opts.port, &addr)) {
+        std::cerr << "Invalid server address: " << opts.server_addr << std::endl;
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open TCP socket. ERROR: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (type == kPingConnection) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    if (connect(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || !SendAll(fd, &type, 1)) {
+        std::cerr << "Failed to connect " << opts.server_addr << ":" << opts.port << ". ERROR: " << strerror(errno)
+                  << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Serve one accepted connection: discard bulk data or echo pings until the peer closes.
+ *
+ * @param opts The benchmark options.
+ * @param fd The accepted socket.
+ * @param quit Set to true when the peer asks the server to quit.
+ */
+void ServeConnection(const Opts &opts, int fd, std::atomic<bool> *quit) {
+    char type = 0;
+    if (RecvAll(fd, &type, 1)) {
+        if (type == kBulkConnection) {
+            std::vector<char> buffer(opts.bulk_msg_size);
+            while (recv(fd, buffer.data(), buffer.size(), 0) > 0) {
+            }
+        } else if (type == kPingConnection) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            std::vector<char> buffer(opts.ping_size);
+            while (RecvAll(fd, buffer.data(), buffer.size()) && SendAll(fd, buffer.data(), buffer.size())) {
+            }
+        } else if (type == kQuitConnection) {
+            *quit = true;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * @brief Open the listening socket of the server.
+ *
+ * @param opts The benchmark options.
+ * @return The listening socket, -1 on failure.
+ */
+int Listen(const Opts &opts) {
+    sockaddr_in addr;
+    if (!host_utils::FillSockAddr(opts.bind_addr, opts.port, &addr)) {
+        std::cerr << "Invalid bind address: " << opts.bind_addr << std::endl;
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open TCP socket. ERROR: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on " << opts.bind_addr << ":" << opts.port << ". ERROR: " << strerror(errno)
+                  << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Server loop, serves every connection in its own thread until a quit connection arrives.
+ *
+ * @param opts The benchmark options.
+ * @param listen_fd The listening socket.
+ */
+void RunServer(const Opts &opts, int listen_fd) {
+    std::atomic<bool> quit(false);
+    std::vector<std::thread> threads;
+    while (!quit) {
+        // Wake up periodically to check the quit flag
+        pollfd pfd = {listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd >= 0) {
+            threads.emplace_back(ServeConnection, std::cref(opts), fd, &quit);
+        }
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    close(listen_fd);
+}
+
+/**
+ * @brief Bulk stream body, sends paced bulk data until stopped.
+ *
+ * @param opts The benchmark options.
+ * @param rate The target rate in bytes per second, 0 for unpaced.
+ * @param stop The flag to stop sending.
+ * @param bytes The number of bytes sent so far.
+ * @param ok Set to false if the stream failed.
+ */
+void BulkThread(const Opts &opts, double rate, const std::atomic<bool> *stop, std::atomic<uint64_t> *bytes,
+                std::atomic<bool> *ok) {
+    int fd = Connect(opts, kBulkConnection);
+    if (fd < 0) {
+        *ok = false;
+        return;
+    }
+    std::vector<char> buffer(opts.bulk_msg_size, 0x5a);
+    uint64_t sent = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (!stop->load(std::memory_order_relaxed)) {
+        if (!SendAll(fd, buffer.data(), buffer.size())) {
+            *ok = false;
+            break;
+        }
+        sent += buffer.size();
+        bytes->store(sent, std::memory_order_relaxed);
+        if (rate > 0) {
+            // Sleep until the bytes sent so far are due at the target rate
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<double>(sent / rate)));
+        }
+    }
+    close(fd);
+}
+
+/**
+ * @brief Run one load level: start the bulk streams, then measure ping-pong RTT for the runtime.
+ *
+ * @param opts The benchmark options.
+ * @param load The offered bulk load in percent of the peak bandwidth, 100 for unpaced streams.
+ * @param peak_bw The peak bulk bandwidth in Gbps.
+ * @param ping Whether to measure ping-pong RTT.
+ * @param result The result of this load level.
+ * @return true on success.
+ */
+bool RunLoadLevel(const Opts &opts, int load, double peak_bw, bool ping, Result *result) {
+    std::atomic<bool> stop(false);
+    std::atomic<bool> ok(true);
+    int num_streams = load > 0 ? opts.bulk_streams : 0;
+    double rate = load < 100 ? load / 100.0 * peak_bw * 1e9 / 8 / num_streams : 0;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> bytes;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_streams; i++) {
+        bytes.emplace_back(new std::atomic<uint64_t>(0));
+        threads.emplace_back(BulkThread, std::cref(opts), rate, &stop, bytes.back().get(), &ok);
+    }
+
+    int ping_fd = ping ? Connect(opts, kPingConnection) : -1;
+    bool ret = !ping || ping_fd >= 0;
+    std::this_thread::sleep_for(kWarmup);
+
+    uint64_t bytes_begin = 0;
+    for (const auto &count : bytes) {
+        bytes_begin += count->load();
+    }
+    auto begin = std::chrono::steady_clock::now();
+    auto end = begin + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                           std::chrono::duration<double>(opts.runtime));
+    std::vector<char> buffer(opts.ping_size, 0x5a);
+    auto now = begin;
+    while (now < end) {
+        if (ping_fd < 0) {
+            std::this_thread::sleep_until(end);
+            now = std::chrono::steady_clock::now();
+            break;
+        }
+        if (!SendAll(ping_fd, buffer.data(), buffer.size()) || !RecvAll(ping_fd, buffer.data(), buffer.size())) {
+            std::cerr << "Ping-pong failed. ERROR: " << strerror(errno) << std::endl;
+            ret = false;
+            break;
+        }
+        auto pong = std::chrono::steady_clock::now();
+        result->rtts_us.push_back(std::chrono::duration<double, std::micro>(pong - now).count());
+        now = pong;
+    }
+    uint64_t bytes_end = 0;
+    for (const auto &count : bytes) {
+        bytes_end += count->load();
+    }
+    double seconds = std::chrono::duration<double>(now - begin).count();
+    result->bulk_bw = seconds > 0 ? (bytes_end - bytes_begin) * 8 / seconds / 1e9 : 0;
+
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    if (ping_fd >= 0) {
+        close(ping_fd);
+    }
+    return ret && ok;
+}
+
+/**
+ * @brief Emit the metrics and the round-trip time samples of one load level.
+ *
+ * @param emitter The result emitter.
+ * @param load The offered bulk load in percent of the peak bandwidth.
+ * @param peak_bw The peak bulk bandwidth in Gbps.
+ * @param result The result of this load level.
+ */
+void EmitResult(host_utils::ResultEmitter *emitter, int load, double peak_bw, Result *result) {
+    std::string tag = "load" + std::to_string(load);
+    host_utils::ResultTags tags = {{"load", std::to_string(load)}};
+    std::sort(result->rtts_us.begin(), result->rtts_us.end());
+    emitter->Metric(tag + "_offered_bw", load / 100.0 * peak_bw, "Gbit/s", tags);
+    emitter->Metric(tag + "_bulk_bw", result->bulk_bw, "Gbit/s", tags);
+    emitter->Metric(tag + "_pings", result->rtts_us.size(), "", tags);
+    emitter->Metric(tag + "_rtt_us_avg", host_utils::Mean(result->rtts_us), "us", tags);
+    for (double percentile : host_utils::kLatencyPercentiles) {
+        emitter->Metric(tag + "_rtt_us_" + host_utils::PercentileName(percentile),
+                        host_utils::Percentile(result->rtts_us, percentile), "us", tags);
+    }
+    emitter->Metric(tag + "_rtt_us_max", result->rtts_us.empty() ? 0 : result->rtts_us.back(), "us", tags);
+    emitter->Samples(tag + "_rtt_us", result->rtts_us, "us", tags);
+}
+
+/**
+ * @brief Client side of the benchmark: calibrate the peak bandwidth if needed and sweep the load levels.
+ *
+ * @param opts The benchmark options.
+ * @return true on success.
+ */
+bool RunClient(const Opts &opts) {
+    double peak_bw = opts.peak_bw;
+    if (peak_bw == 0) {
+        Result calibration;
+        if (!RunLoadLevel(opts, 100, 0, false, &calibration)) {
+            std::cerr << "Failed to calibrate the peak bulk bandwidth." << std::endl;
+            return false;
+        }
+        peak_bw = calibration.bulk_bw;
+    }
+    host_utils::ResultEmitter emitter(opts.result);
+    emitter.Metric("peak_bulk_bw", peak_bw, "Gbit/s");
+
+    for (int load : opts.loads) {
+        if (emitter.Stopped()) {
+            return false;
+        }
+        Result result;
+        if (!RunLoadLevel(opts, load, peak_bw, true, &result)) {
+            std::cerr << "Load level failed - load: " << load << std::endl;
+            return false;
+        }
+        EmitResult(&emitter, load, peak_bw, &result);
+    }
+    return !emitter.Stopped();
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    if (opts.role == Role::kClient) {
+        return RunClient(opts) ? 0 : 1;
+    }
+
+    int listen_fd = Listen(opts);
+    if (listen_fd < 0) {
+        return 1;
+    }
+    if (opts.role == Role::kServer) {
+        RunServer(opts, listen_fd);
+        return 0;
+    }
+
+    std::thread server(RunServer, std::cref(opts), listen_fd);
+    bool ok = RunClient(opts);
+    // Ask the server to quit, it exits once every connection is closed
+    int quit_fd = Connect(opts, kQuitConnection);
+    if (quit_fd >= 0) {
+        close(quit_fd);
+    }
+    server.join();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the UDP packet rate benchmark."""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class UdpPacketRateBenchmark(MicroBenchmarkWithInvoke):
+    """The UDP packet rate benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'udp_packet_rate'
+        self._modes = ['sendto', 'mmsg', 'gso']
+        self._roles = ['both', 'tx', 'rx']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--modes',
+            type=str,
+            nargs='+',
+            default=self._modes,
+            help='Send/receive paths to test. E.g. {}.'.format(' '.join(self._modes)),
+        )
+        self._parser.add_argument(
+            '--payload_sizes',
+            type=int,
+            nargs='+',
+            default=[64, 256, 1024, 1472, 4096, 9000],
+            required=False,
+            help='UDP payload sizes in bytes.',
+        )
+        self._parser.add_argument(
+            '--tx_threads',
+            type=int,
+            default=1,
+            required=False,
+            help='Number of sender threads, each sends one flow.',
+        )
+        self._parser.add_argument(
+            '--rx_threads',
+            type=int,
+            default=1,
+            required=False,
+            help='Number of receiver threads, more than one enables SO_REUSEPORT fan-out.',
+        )
+        self._parser.add_argument(
+            '--tx_cpus',
+            type=str,
+            default=None,
+            required=False,
+            help='Cpu list to pin sender threads to, e.g. 0-3.',
+        )
+        self._parser.add_argument(
+            '--rx_cpus',
+            type=str,
+            default=None,
+            required=False,
+            help='Cpu list to pin receiver threads to, e.g. 4-7.',
+        )
+        self._parser.add_argument(
+            '--batch_size',
+            type=int,
+            default=32,
+            required=False,
+            help='Number of datagrams per sendmmsg/recvmmsg call or GSO send.',
+        )
+        self._parser.add_argument(
+            '--runtime',
+            type=float,
+            default=5,
+            required=False,
+            help='Duration in seconds of each test.',
+        )
+        self._parser.add_argument(
+            '--dst_addr',
+            type=str,
+            default='127.0.0.1',
+            required=False,
+            help='Destination IPv4 address of the senders.',
+        )
+        self._parser.add_argument(
+            '--bind_addr',
+            type=str,
+            default='0.0.0.0',
+            required=False,
+            help='IPv4 address the receivers bind to.',
+        )
+        self._parser.add_argument(
+            '--port',
+            type=int,
+            default=23456,
+            required=False,
+            help='UDP port of the receivers.',
+        )
+        self._parser.add_argument(
+            '--socket_buffer',
+            type=int,
+            default=4 * 1024**2,
+            required=False,
+            help='Socket send/receive buffer size in bytes, 0 to keep the system default.',
+        )
+        self._parser.add_argument(
+            '--role',
+            type=str,
+            default='both',
+            required=False,
+            help='Role of this node. Possible values are {}.'.format(' '.join(self._roles)),
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for mode in self._args.modes:
+            if mode not in self._modes:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid mode - benchmark: {}, mode: {}.'.format(self._name, mode))
+                return False
+        if self._args.role not in self._roles:
+            self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+            logger.error('Invalid role - benchmark: {}, role: {}.'.format(self._name, self._args.role))
+            return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ' '.join('--%s' % mode for mode in self._args.modes)
+        args += ' --payload_sizes %s' % ','.join(str(size) for size in self._args.payload_sizes)
+        args += ' --tx_threads %d --rx_threads %d --batch_size %d --runtime %g' % (
+            self._args.tx_threads, self._args.rx_threads, self._args.batch_size, self._args.runtime
+        )
+        args += ' --dst_addr %s --bind_addr %s --port %d --socket_buffer %d --role %s' % (
+            self._args.dst_addr, self._args.bind_addr, self._args.port, self._args.socket_buffer, self._args.role
+        )
+        if self._args.tx_cpus:
+            args += ' --tx_cpus %s' % self._args.tx_cpus
+        if self._args.rx_cpus:
+            args += ' --rx_cpus %s' % self._args.rx_cpus
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('udp-packet-rate', UdpPacketRateBenchmark)
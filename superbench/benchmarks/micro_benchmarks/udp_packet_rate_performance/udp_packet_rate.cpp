@@ -0,0 +1,754 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// UDP packet rate benchmark.
+// Sender and receiver threads are pinned per TX/RX queue and exchange small datagrams over loopback or a real NIC,
+// comparing the per-packet sendto/recvfrom path with sendmmsg/recvmmsg batching and UDP GSO/GRO offload.
+// When more than one receiver thread is used, receiver sockets share the port through SO_REUSEPORT fan-out.
+// Each datagram carries a flow id and a sequence number so a receiver-only run on a remote node can still
+// derive the drop rate.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../host_utils/cpu_utils.h"
+#include "../host_utils/net_utils.h"
+#include "../host_utils/result_emitter.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+// Largest UDP payload over IPv4.
+constexpr int kMaxUdpPayload = 65507;
+// Largest number of segments the kernel accepts in one GSO send.
+constexpr int kMaxGsoSegments = 64;
+// Number of flows tracked by each receiver for sequence based drop accounting.
+constexpr int kMaxFlows = 1024;
+// Magic number marking datagrams generated by this benchmark.
+constexpr uint32_t kPacketMagic = 0x53425544;
+
+// Header written at the beginning of every datagram.
+struct PacketHeader {
+    uint32_t magic;
+    uint32_t flow;
+    uint64_t seq;
+};
+
+// Send/receive paths supported by this benchmark.
+enum class Mode { kSendto, kMmsg, kGso };
+
+// Roles of this process.
+enum class Role { kBoth, kTx, kRx };
+
+// Options accepted by this program.
+struct Opts {
+    // Send/receive paths to test.
+    std::vector<Mode> modes;
+
+    // Payload sizes in bytes to sweep.
+    std::vector<int> payload_sizes = {64, 256, 1024, 1472, 4096, 9000};
+
+    // Number of sender threads, each owns one socket and one flow.
+    int tx_threads = 1;
+
+    // Number of receiver threads, more than one enables SO_REUSEPORT fan-out.
+    int rx_threads = 1;
+
+    // Cpus to pin sender threads to, assigned round robin.
+    std::vector<int> tx_cpus;
+
+    // Cpus to pin receiver threads to, assigned round robin.
+    std::vector<int> rx_cpus;
+
+    // Number of datagrams per sendmmsg/recvmmsg call or GSO send.
+    int batch_size = 32;
+
+    // Duration in seconds of each test.
+    double runtime = 5;
+
+    // Destination address of the senders.
+    std::string dst_addr = "127.0.0.1";
+
+    // Address the receivers bind to.
+    std::string bind_addr = "0.0.0.0";
+
+    // UDP port of the receivers.
+    int port = 23456;
+
+    // Socket send/receive buffer size in bytes, 0 to keep the system default.
+    int socket_buffer = 4 * 1024 * 1024;
+
+    // Role of this process.
+    Role role = Role::kBoth;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+// Result of one (mode, payload size) test.
+struct Result {
+    uint64_t tx_packets = 0;
+    uint64_t rx_packets = 0;
+    uint64_t rx_expected = 0;
+    double tx_seconds = 0;
+    double rx_seconds = 0;
+    std::map<int, double> cpu_util;
+    double avg_cpu_util = 0;
+};
+
+// State shared by the receiver threads of one test.
+struct RxState {
+    std::atomic<bool> stop{false};
+    std::mutex mutex;
+    uint64_t packets = 0;
+    std::vector<uint64_t> flow_next_seq = std::vector<uint64_t>(kMaxFlows, 0);
+    std::chrono::steady_clock::time_point first;
+    std::chrono::steady_clock::time_point last;
+    bool has_packet = false;
+};
+
+/**
+ * @brief Get the name of a send/receive path used in metric names.
+ *
+ * @param mode The send/receive path.
+ * @return The name of the path.
+ */
+const char *ModeName(Mode mode) {
+    switch (mode) {
+    case Mode::kSendto:
+        return "sendto";
+    case Mode::kMmsg:
+        return "mmsg";
+    case Mode::kGso:
+        return "gso";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: udp_packet_rate "
+              << "[--sendto] [--mmsg] [--gso] "
+              << "[--payload_sizes <size,...>] "
+              << "[--tx_threads <num>] "
+              << "[--rx_threads <num>] "
+              << "[--tx_cpus <cpu_list>] "
+              << "[--rx_cpus <cpu_list>] "
+              << "[--batch_size <num>] "
+              << "[--runtime <seconds>] "
+              << "[--dst_addr <ip>] "
+              << "[--bind_addr <ip>] "
+              << "[--port <port>] "
+              << "[--socket_buffer <bytes>] "
+              << "[--role <both|tx|rx>] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the UDP packet rate benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kSendto,
+        kMmsg,
+        kGso,
+        kPayloadSizes,
+        kTxThreads,
+        kRxThreads,
+        kTxCpus,
+        kRxCpus,
+        kBatchSize,
+        kRuntime,
+        kDstAddr,
+        kBindAddr,
+        kPort,
+        kSocketBuffer,
+        kRole
+    };
+    const struct option options[] = {
+        {"sendto", no_argument, nullptr, static_cast<int>(OptIdx::kSendto)},
+        {"mmsg", no_argument, nullptr, static_cast<int>(OptIdx::kMmsg)},
+        {"gso", no_argument, nullptr, static_cast<int>(OptIdx::kGso)},
+        {"payload_sizes", required_argument, nullptr, static_cast<int>(OptIdx::kPayloadSizes)},
+        {"tx_threads", required_argument, nullptr, static_cast<int>(OptIdx::kTxThreads)},
+        {"rx_threads", required_argument, nullptr, static_cast<int>(OptIdx::kRxThreads)},
+        {"tx_cpus", required_argument, nullptr, static_cast<int>(OptIdx::kTxCpus)},
+        {"rx_cpus", required_argument, nullptr, static_cast<int>(OptIdx::kRxCpus)},
+        {"batch_size", required_argument, nullptr, static_cast<int>(OptIdx::kBatchSize)},
+        {"runtime", required_argument, nullptr, static_cast<int>(OptIdx::kRuntime)},
+        {"dst_addr", required_argument, nullptr, static_cast<int>(OptIdx::kDstAddr)},
+        {"bind_addr", required_argument, nullptr, static_cast<int>(OptIdx::kBindAddr)},
+        {"port", required_argument, nullptr, static_cast<int>(OptIdx::kPort)},
+        {"socket_buffer", required_argument, nullptr, static_cast<int>(OptIdx::kSocketBuffer)},
+        {"role", required_argument, nullptr, static_cast<int>(OptIdx::kRole)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        try {
+            switch (getopt_ret) {
+            case static_cast<int>(OptIdx::kSendto):
+                opts->modes.push_back(Mode::kSendto);
+                break;
+            case static_cast<int>(OptIdx::kMmsg):
+                opts->modes.push_back(Mode::kMmsg);
+                break;
+            case static_cast<int>(OptIdx::kGso):
+                opts->modes.push_back(Mode::kGso);
+                break;
+            case static_cast<int>(OptIdx::kPayloadSizes):
+                if (!host_utils::ParseIntList(optarg, &opts->payload_sizes)) {
+                    std::cerr << "Invalid payload_sizes: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kTxThreads):
+                if (1 != sscanf(optarg, "%d", &opts->tx_threads) || opts->tx_threads <= 0) {
+                    std::cerr << "Invalid tx_threads: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kRxThreads):
+                if (1 != sscanf(optarg, "%d", &opts->rx_threads) || opts->rx_threads <= 0) {
+                    std::cerr << "Invalid rx_threads: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kTxCpus):
+                opts->tx_cpus = host_utils::ParseCpuList(optarg);
+                break;
+            case static_cast<int>(OptIdx::kRxCpus):
+                opts->rx_cpus = host_utils::ParseCpuList(optarg);
+                break;
+            case static_cast<int>(OptIdx::kBatchSize):
+                if (1 != sscanf(optarg, "%d", &opts->batch_size) || opts->batch_size <= 0) {
+                    std::cerr << "Invalid batch_size: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kRuntime):
+                if (1 != sscanf(optarg, "%lf", &opts->runtime) || opts->runtime <= 0) {
+                    std::cerr << "Invalid runtime: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kDstAddr):
+                opts->dst_addr = optarg;
+                break;
+            case static_cast<int>(OptIdx::kBindAddr):
+                opts->bind_addr = optarg;
+                break;
+            case static_cast<int>(OptIdx::kPort):
+                if (1 != sscanf(optarg, "%d", &opts->port) || opts->port <= 0 || opts->port > 65535) {
+                    std::cerr << "Invalid port: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kSocketBuffer):
+                if (1 != sscanf(optarg, "%d", &opts->socket_buffer) || opts->socket_buffer < 0) {
+                    std::cerr << "Invalid socket_buffer: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case static_cast<int>(OptIdx::kRole):
+                if (strcmp(optarg, "both") == 0) {
+                    opts->role = Role::kBoth;
+                } else if (strcmp(optarg, "tx") == 0) {
+                    opts->role = Role::kTx;
+                } else if (strcmp(optarg, "rx") == 0) {
+                    opts->role = Role::kRx;
+                } else {
+                    std::cerr << "Invalid role: " << optarg << std::endl;
+                    parse_err = true;
+                }
+                break;
+            case host_utils::kResultFormatOpt:
+            case host_utils::kResultFdOpt:
+            case host_utils::kBaselineOpt:
+            case host_utils::kBaselineConfidenceOpt:
+            case host_utils::kFailFastOpt:
+                if (!host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result)) {
+                    std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+                    parse_err = true;
+                }
+                break;
+            default:
+                parse_err = true;
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Invalid argument: " << optarg << ". ERROR: " << e.what() << std::endl;
+            parse_err = true;
+        }
+        if (parse_err) {
+            break;
+        }
+    }
+
+    for (int size : opts->payload_sizes) {
+        if (size < static_cast<int>(sizeof(PacketHeader)) || size > kMaxUdpPayload) {
+            std::cerr << "Payload size must be in [" << sizeof(PacketHeader) << ", " << kMaxUdpPayload
+                      << "]: " << size << std::endl;
+            parse_err = true;
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    if (opts->modes.empty()) {
+        opts->modes = {Mode::kSendto, Mode::kMmsg, Mode::kGso};
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Open a UDP socket with the configured buffer sizes.
+ *
+ * @param opts The benchmark options.
+ * @return The socket fd, -1 on failure.
+ */
+int OpenUdpSocket(const Opts &opts) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        std::cerr << "Failed to open UDP socket. ERROR: " << strerror(errno) << std::endl;
+        return -1;
+    }
+    if (opts.socket_buffer > 0) {
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &opts.socket_buffer, sizeof(opts.socket_buffer));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &opts.socket_buffer, sizeof(opts.socket_buffer));
+    }
+    return fd;
+}
+
+/**
+ * @brief Stamp the benchmark header into a datagram.
+ *
+ * @param packet The start of the datagram.
+ * @param flow The flow id of the sender.
+ * @param seq The sequence number of the datagram.
+ */
+inline void StampPacket(char *packet, uint32_t flow, uint64_t seq) {
+    PacketHeader header = {kPacketMagic, flow, seq};
+    memcpy(packet, &header, sizeof(header));
+}
+
+/**
+ * @brief Sender thread body, sends datagrams of one flow until stopped.
+ *
+ * @param opts The benchmark options.
+ * @param mode The send path.
+ * @param size The payload size in bytes.
+ * @param flow The flow id of this sender.
+ * @param stop The flag to stop sending.
+ * @param sent The number of datagrams sent.
+ * @param ok Set to false if the send path failed.
+ */
+void SenderThread(const Opts &opts, Mode mode, int size, uint32_t flow, const std::atomic<bool> *stop, uint64_t *sent,
+                  std::atomic<bool> *ok) {
+    if (!opts.tx_cpus.empty()) {
+        host_utils::PinThreadToCpu(opts.tx_cpus[flow % opts.tx_cpus.size()]);
+    }
+    sockaddr_in dst;
+    host_utils::FillSockAddr(opts.dst_addr, opts.port, &dst);
+    int fd = OpenUdpSocket(opts);
+    if (fd < 0) {
+        *ok = false;
+        return;
+    }
+
+    int batch = opts.batch_size;
+    if (mode == Mode::kSendto) {
+        batch = 1;
+    } else if (mode == Mode::kGso) {
+        batch = std::min({batch, kMaxGsoSegments, kMaxUdpPayload / size});
+    }
+    std::vector<char> buffer(static_cast<size_t>(batch) * size, 0x5a);
+    std::vector<iovec> iovs(batch);
+    std::vector<mmsghdr> msgs(batch);
+    for (int i = 0; i < batch; i++) {
+        iovs[i].iov_base = buffer.data() + static_cast<size_t>(i) * size;
+        iovs[i].iov_len = size;
+        memset(&msgs[i], 0, sizeof(mmsghdr));
+        msgs[i].msg_hdr.msg_name = &dst;
+        msgs[i].msg_hdr.msg_namelen = sizeof(dst);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Single iovec covering the whole batch, segmented by the kernel through UDP_SEGMENT
+    iovec gso_iov = {buffer.data(), buffer.size()};
+    char control[CMSG_SPACE(sizeof(uint16_t))] = {};
+    msghdr gso_msg = {};
+    gso_msg.msg_name = &dst;
+    gso_msg.msg_namelen = sizeof(dst);
+    gso_msg.msg_iov = &gso_iov;
+    gso_msg.msg_iovlen = 1;
+    gso_msg.msg_control = control;
+    gso_msg.msg_controllen = sizeof(control);
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&gso_msg);
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    uint16_t gso_size = static_cast<uint16_t>(size);
+    memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+
+    uint64_t seq = 0;
+    while (!stop->load(std::memory_order_relaxed)) {
+        for (int i = 0; i < batch; i++) {
+            StampPacket(buffer.data() + static_cast<size_t>(i) * size, flow, seq + i);
+        }
+        int num_sent = 0;
+        if (mode == Mode::kSendto) {
+            num_sent = sendto(fd, buffer.data(), size, 0, reinterpret_cast<sockaddr *>(&dst), sizeof(dst)) < 0 ? 0 : 1;
+        } else if (mode == Mode::kMmsg) {
+            num_sent = std::max(sendmmsg(fd, msgs.data(), batch, 0), 0);
+        } else {
+            ssize_t bytes = sendmsg(fd, &gso_msg, 0);
+            if (bytes < 0 && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+                std::cerr << "UDP GSO is not supported. ERROR: " << strerror(errno) << std::endl;
+                *ok = false;
+                break;
+            }
+            num_sent = bytes < 0 ? 0 : static_cast<int>(bytes / size);
+        }
+        seq += num_sent;
+    }
+    *sent = seq;
+    close(fd);
+}
+
+/**
+ * @brief Account the datagrams of one received buffer.
+ *
+ * @param data The received buffer, possibly holding several GRO coalesced segments.
+ * @param len The number of bytes received.
+ * @param segment_size The size of every segment, equal to len if not coalesced.
+ * @param flow_next_seq The next expected sequence number of each flow.
+ * @return The number of datagrams in the buffer.
+ */
+uint64_t AccountDatagrams(const char *data, size_t len, size_t segment_size, std::vector<uint64_t> *flow_next_seq) {
+    uint64_t count = 0;
+    for (size_t offset = 0; offset < len; offset += segment_size) {
+        count++;
+        if (len - offset < sizeof(PacketHeader)) {
+            continue;
+        }
+        PacketHeader header;
+        memcpy(&header, data + offset, sizeof(header));
+        if (header.magic == kPacketMagic) {
+            uint64_t &next = (*flow_next_seq)[header.flow % kMaxFlows];
+            next = std::max(next, header.seq + 1);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Receiver thread body, receives datagrams on a reuseport socket until stopped.
+ *
+ * @param opts The benchmark options.
+ * @param mode The receive path.
+ * @param fd The bound socket to receive from.
+ * @param index The index of this receiver.
+ * @param state The state shared by all receivers.
+ */
+void ReceiverThread(const Opts &opts, Mode mode, int fd, int index, RxState *state) {
+    if (!opts.rx_cpus.empty()) {
+        host_utils::PinThreadToCpu(opts.rx_cpus[index % opts.rx_cpus.size()]);
+    }
+    int batch = mode == Mode::kMmsg ? opts.batch_size : 1;
+    // GRO may coalesce up to 64KiB into a single receive
+    size_t buffer_size = mode == Mode::kGso ? 65536 : kMaxUdpPayload;
+    std::vector<char> buffer(static_cast<size_t>(batch) * buffer_size);
+    std::vector<iovec> iovs(batch);
+    std::vector<mmsghdr> msgs(batch);
+    for (int i = 0; i < batch; i++) {
+        iovs[i].iov_base = buffer.data() + static_cast<size_t>(i) * buffer_size;
+        iovs[i].iov_len = buffer_size;
+        memset(&msgs[i], 0, sizeof(mmsghdr));
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    char control[CMSG_SPACE(sizeof(int))] = {};
+
+    uint64_t packets = 0;
+    std::vector<uint64_t> flow_next_seq(kMaxFlows, 0);
+    std::chrono::steady_clock::time_point first, last;
+    bool has_packet = false;
+    while (!state->stop.load(std::memory_order_relaxed)) {
+        uint64_t count = 0;
+        if (mode == Mode::kSendto) {
+            ssize_t len = recvfrom(fd, buffer.data(), buffer_size, 0, nullptr, nullptr);
+            if (len > 0) {
+                count = AccountDatagrams(buffer.data(), len, len, &flow_next_seq);
+            }
+        } else if (mode == Mode::kMmsg) {
+            int num_recv = recvmmsg(fd, msgs.data(), batch, MSG_WAITFORONE, nullptr);
+            for (int i = 0; i < num_recv; i++) {
+                count += AccountDatagrams(buffer.data() + static_cast<size_t>(i) * buffer_size, msgs[i].msg_len,
+                                          msgs[i].msg_len, &flow_next_seq);
+            }
+        } else {
+            msghdr msg = {};
+            msg.msg_iov = iovs.data();
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            ssize_t len = recvmsg(fd, &msg, 0);
+            if (len > 0) {
+                size_t segment_size = len;
+                for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+                        int gso_size = 0;
+                        memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+                        segment_size = gso_size > 0 ? gso_size : len;
+                    }
+                }
+                count = AccountDatagrams(buffer.data(), len, segment_size, &flow_next_seq);
+            }
+        }
+        if (count > 0) {
+            last = std::chrono::steady_clock::now();
+            if (!has_packet) {
+                first = last;
+                has_packet = true;
+            }
+            packets += count;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->packets += packets;
+    for (int flow = 0; flow < kMaxFlows; flow++) {
+        state->flow_next_seq[flow] = std::max(state->flow_next_seq[flow], flow_next_seq[flow]);
+    }
+    if (has_packet) {
+        state->first = state->has_packet ? std::min(state->first, first) : first;
+        state->last = state->has_packet ? std::max(state->last, last) : last;
+        state->has_packet = true;
+    }
+}
+
+/**
+ * @brief Open and bind the receiver sockets, sharing the port through SO_REUSEPORT.
+ *
+ * @param opts The benchmark options.
+ * @param mode The receive path, GSO mode enables UDP_GRO on the sockets.
+ * @param fds The bound sockets.
+ * @return true on success.
+ */
+bool OpenReceiverSockets(const Opts &opts, Mode mode, std::vector<int> *fds) {
+    sockaddr_in addr;
+    if (!host_utils::FillSockAddr(opts.bind_addr, opts.port, &addr)) {
+        std::cerr << "Invalid bind address: " << opts.bind_addr << std::endl;
+        return false;
+    }
+    for (int i = 0; i < opts.rx_threads; i++) {
+        int fd = OpenUdpSocket(opts);
+        if (fd < 0) {
+            return false;
+        }
+        fds->push_back(fd);
+        int one = 1;
+        if (opts.rx_threads > 1 && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) != 0) {
+            std::cerr << "Failed to set SO_REUSEPORT. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        if (mode == Mode::kGso && setsockopt(fd, SOL_UDP, UDP_GRO, &one, sizeof(one)) != 0) {
+            std::cerr << "UDP GRO is not supported. ERROR: " << strerror(errno) << std::endl;
+            return false;
+        }
+        // Wake up periodically to check the stop flag
+        timeval timeout = {0, 100000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0) {
+            std::cerr << "Failed to bind " << opts.bind_addr << ":" << opts.port << ". ERROR: " << strerror(errno)
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Run one (mode, payload size) test.
+ *
+ * @param opts The benchmark options.
+ * @param mode The send/receive path.
+ * @param size The payload size in bytes.
+ * @param result The result of the test.
+ * @return true on success.
+ */
+bool RunUdpTest(const Opts &opts, Mode mode, int size, Result *result) {
+    RxState rx_state;
+    std::vector<int> rx_fds;
+    std::vector<std::thread> rx_threads;
+    bool ret = true;
+
+    if (opts.role != Role::kTx) {
+        ret = OpenReceiverSockets(opts, mode, &rx_fds);
+        if (ret) {
+            for (int i = 0; i < opts.rx_threads; i++) {
+                rx_threads.emplace_back(ReceiverThread, std::cref(opts), mode, rx_fds[i], i, &rx_state);
+            }
+        }
+    }
+
+    auto cpu_begin = host_utils::ReadCpuTimes();
+    auto start = std::chrono::steady_clock::now();
+    if (ret && opts.role != Role::kRx) {
+        std::atomic<bool> stop_tx(false);
+        std::atomic<bool> tx_ok(true);
+        std::vector<uint64_t> sent(opts.tx_threads, 0);
+        std::vector<std::thread> tx_threads;
+        for (int i = 0; i < opts.tx_threads; i++) {
+            tx_threads.emplace_back(SenderThread, std::cref(opts), mode, size, static_cast<uint32_t>(i), &stop_tx,
+                                    &sent[i], &tx_ok);
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(opts.runtime));
+        stop_tx = true;
+        for (auto &thread : tx_threads) {
+            thread.join();
+        }
+        result->tx_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (uint64_t count : sent) {
+            result->tx_packets += count;
+        }
+        ret = tx_ok;
+        // Let the receivers drain the socket buffers
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    } else if (ret) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(opts.runtime));
+    }
+    auto cpu_end = host_utils::ReadCpuTimes();
+
+    rx_state.stop = true;
+    for (auto &thread : rx_threads) {
+        thread.join();
+    }
+    for (int fd : rx_fds) {
+        close(fd);
+    }
+
+    result->rx_packets = rx_state.packets;
+    for (uint64_t next : rx_state.flow_next_seq) {
+        result->rx_expected += next;
+    }
+    if (rx_state.has_packet) {
+        result->rx_seconds = std::chrono::duration<double>(rx_state.last - rx_state.first).count();
+    }
+
+    // Per-core utilization of the pinned cores, plus the average of all cores
+    std::set<int> cpus(opts.tx_cpus.begin(), opts.tx_cpus.end());
+    cpus.insert(opts.rx_cpus.begin(), opts.rx_cpus.end());
+    for (int cpu : cpus) {
+        if (cpu_begin.count(cpu) && cpu_end.count(cpu)) {
+            result->cpu_util[cpu] = host_utils::CpuUtilization(cpu_begin[cpu], cpu_end[cpu]);
+        }
+    }
+    if (!cpu_end.empty()) {
+        double total_util = 0;
+        for (const auto &it : cpu_end) {
+            total_util += host_utils::CpuUtilization(cpu_begin[it.first], it.second);
+        }
+        result->avg_cpu_util = total_util / cpu_end.size();
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Emit the metrics of one test.
+ *
+ * @param emitter The result emitter.
+ * @param opts The benchmark options.
+ * @param mode The send/receive path.
+ * @param size The payload size in bytes.
+ * @param result The result of the test.
+ */
+void EmitResult(host_utils::ResultEmitter *emitter, const Opts &opts, Mode mode, int size, const Result &result) {
+    std::string tag = std::string(ModeName(mode)) + "_" + std::to_string(size);
+    host_utils::ResultTags tags = {{"mode", ModeName(mode)}, {"payload_size", std::to_string(size)}};
+    if (opts.role != Role::kRx) {
+        double tx_pps = result.tx_seconds > 0 ? result.tx_packets / result.tx_seconds : 0;
+        emitter->Metric(tag + "_tx_pps", tx_pps, "packets/s", tags);
+    }
+    if (opts.role != Role::kTx) {
+        double rx_pps = result.rx_seconds > 0 ? result.rx_packets / result.rx_seconds : 0;
+        emitter->Metric(tag + "_rx_pps", rx_pps, "packets/s", tags);
+        emitter->Metric(tag + "_rx_bw", rx_pps * size * 8 / 1e9, "Gbit/s", tags);
+        // The exact sent count is only known when both sides run in this process
+        uint64_t expected = opts.role == Role::kBoth ? result.tx_packets : result.rx_expected;
+        double drop_rate = expected > 0 ? 1.0 - std::min<double>(result.rx_packets, expected) / expected : 0;
+        emitter->Metric(tag + "_drop_rate", drop_rate, "", tags);
+    }
+    for (const auto &it : result.cpu_util) {
+        host_utils::ResultTags cpu_tags = tags;
+        cpu_tags.emplace_back("cpu", std::to_string(it.first));
+        emitter->Metric(tag + "_cpu" + std::to_string(it.first) + "_util", it.second, "%", cpu_tags);
+    }
+    emitter->Metric(tag + "_cpu_util", result.avg_cpu_util, "%", tags);
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+
+    host_utils::ResultEmitter emitter(opts.result);
+    for (Mode mode : opts.modes) {
+        for (int size : opts.payload_sizes) {
+            Result result;
+            if (!RunUdpTest(opts, mode, size, &result)) {
+                std::cerr << "UDP test failed - mode: " << ModeName(mode) << ", payload size: " << size << std::endl;
+                return 1;
+            }
+            EmitResult(&emitter, opts, mode, size, result);
+            if (emitter.Stopped()) {
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
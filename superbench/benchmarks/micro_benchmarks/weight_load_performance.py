@@ -0,0 +1,137 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT license.
+
+"""Module of the model weight loading benchmark."""
+
+import os
+
+from superbench.common.utils import logger
+from superbench.benchmarks import BenchmarkRegistry, ReturnCode
+from superbench.benchmarks.micro_benchmarks import MicroBenchmarkWithInvoke
+
+
+class WeightLoadBenchmark(MicroBenchmarkWithInvoke):
+    """The model weight loading benchmark class."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name (str): benchmark name.
+            parameters (str): benchmark parameters.
+        """
+        super().__init__(name, parameters)
+
+        self._bin_name = 'weight_load'
+        self._methods = ['mmap', 'pread', 'direct', 'io_uring']
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+        self._parser.add_argument(
+            '--methods',
+            type=str,
+            nargs='+',
+            default=self._methods,
+            help='Load methods to test. E.g. {}.'.format(' '.join(self._methods)),
+        )
+        self._parser.add_argument(
+            '--file',
+            type=str,
+            default=None,
+            required=False,
+            help='Weight file to load. A file of --size is generated in the working directory if not specified.',
+        )
+        self._parser.add_argument(
+            '--size',
+            type=str,
+            default='4G',
+            required=False,
+            help='Size of the generated weight file, e.g. 64G.',
+        )
+        self._parser.add_argument(
+            '--threads',
+            type=int,
+            nargs='+',
+            default=[1, 4, 8],
+            required=False,
+            help='Thread counts to test. E.g. 1 4 8.',
+        )
+        self._parser.add_argument(
+            '--chunk_size',
+            type=str,
+            default='16M',
+            required=False,
+            help='Size of each read, must be a multiple of 4KiB, e.g. 16M.',
+        )
+        self._parser.add_argument(
+            '--iodepth',
+            type=int,
+            default=8,
+            required=False,
+            help='Number of reads in flight per thread with io_uring.',
+        )
+        self._parser.add_argument(
+            '--numa_node',
+            type=int,
+            default=-1,
+            required=False,
+            help='NUMA node to place the loaded weights and run the threads on, -1 to not bind.',
+        )
+        self._parser.add_argument(
+            '--pinned_staging',
+            action='store_true',
+            help='Pin the loaded weights for DMA as a final step, as the host buffers of gpu-copy are.',
+        )
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        for method in self._args.methods:
+            if method not in self._methods:
+                self._result.set_return_code(ReturnCode.INVALID_ARGUMENT)
+                logger.error('Invalid method - benchmark: {}, method: {}.'.format(self._name, method))
+                return False
+
+        self.__bin_path = os.path.join(self._args.bin_dir, self._bin_name)
+
+        args = ' '.join('--%s' % method for method in self._args.methods)
+        if self._args.file:
+            args += ' --file %s' % self._args.file
+        else:
+            args += ' --size %s' % self._args.size
+        args += ' --threads %s --chunk_size %s --iodepth %d --numa_node %d' % (
+            ','.join(str(t) for t in self._args.threads), self._args.chunk_size, self._args.iodepth,
+            self._args.numa_node
+        )
+        if self._args.pinned_staging:
+            args += ' --pinned_staging'
+        args += self._result_record_args()
+
+        self._commands = ['%s %s' % (self.__bin_path, args)]
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to parse raw results and save the summarized results.
+
+          self._result.add_raw_data() and self._result.add_result() need to be called to save the results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
+BenchmarkRegistry.register_benchmark('weight-load', WeightLoadBenchmark)
@@ -0,0 +1,601 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+
+// Model weight loading benchmark.
+// A large weight file is loaded from a cold page cache into memory placed on a NUMA node, with mmap, parallel chunked
+// pread into pre-faulted buffers, O_DIRECT pread into aligned buffers, and O_DIRECT io_uring reads into registered
+// fixed buffers, each across a list of thread counts. An optional final step pins the loaded weights for DMA, using
+// the host registration of gpu_copy when built with a GPU runtime, or mlock otherwise.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <getopt.h>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <numa.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(USE_CUDA)
+#include <cuda_runtime.h>
+#elif defined(USE_HIP)
+#include <hip/hip_runtime.h>
+#endif
+
+#include "../host_utils/cpu_utils.h"
+#include "../host_utils/io_uring_utils.h"
+#include "../host_utils/io_utils.h"
+#include "../host_utils/result_emitter.h"
+
+using Clock = std::chrono::steady_clock;
+
+// Ways to load the weights.
+enum class Method { kMmap, kPread, kDirect, kIoUring };
+
+// Largest buffer io_uring accepts for registration.
+constexpr uint64_t kMaxFixedBufSize = 1ULL << 30;
+
+// Options accepted by this program.
+struct Opts {
+    // Load methods to test.
+    std::vector<Method> methods;
+
+    // Weight file to load, generated with the given size if empty.
+    std::string file;
+
+    // Size of the generated weight file in bytes.
+    uint64_t size = 4ULL << 30;
+
+    // Thread counts to test.
+    std::vector<int> threads = {1, 4, 8};
+
+    // Size of each read in bytes, a multiple of 4KiB.
+    uint64_t chunk_size = 16ULL << 20;
+
+    // Number of reads in flight per thread with io_uring.
+    int iodepth = 8;
+
+    // NUMA node to place the loaded weights and run the threads on, -1 to not bind.
+    int numa_node = -1;
+
+    // Whether to pin the loaded weights for DMA as a final step.
+    bool pinned_staging = false;
+
+    // Whether to keep the generated weight file.
+    bool keep_file = false;
+
+    // Format and file descriptor of the results.
+    host_utils::ResultOpts result;
+};
+
+/**
+ * @brief Get the name of a load method used in metric names.
+ *
+ * @param method The load method.
+ * @return The name of the method.
+ */
+const char *MethodName(Method method) {
+    switch (method) {
+    case Method::kMmap:
+        return "mmap";
+    case Method::kPread:
+        return "pread";
+    case Method::kDirect:
+        return "direct";
+    case Method::kIoUring:
+        return "io_uring";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Print the usage instructions for this program.
+ */
+void PrintUsage() {
+    std::cout << "Usage: weight_load "
+              << "[--mmap] [--pread] [--direct] [--io_uring] "
+              << "[--file <path>] "
+              << "[--size <bytes>] "
+              << "[--threads <list>] "
+              << "[--chunk_size <bytes>] "
+              << "[--iodepth <num>] "
+              << "[--numa_node <node>] "
+              << "[--pinned_staging] "
+              << "[--keep_file] " << host_utils::kResultOptsUsage << std::endl;
+}
+
+/**
+ * @brief Parses command-line options for the weight loading benchmark.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line arguments.
+ * @param opts The parsed options.
+ * @return 0 on success, non-zero value on failure.
+ */
+int ParseOpts(int argc, char **argv, Opts *opts) {
+    enum class OptIdx {
+        kMmap,
+        kPread,
+        kDirect,
+        kIoUring,
+        kFile,
+        kSize,
+        kThreads,
+        kChunkSize,
+        kIodepth,
+        kNumaNode,
+        kPinnedStaging,
+        kKeepFile
+    };
+    const struct option options[] = {
+        {"mmap", no_argument, nullptr, static_cast<int>(OptIdx::kMmap)},
+        {"pread", no_argument, nullptr, static_cast<int>(OptIdx::kPread)},
+        {"direct", no_argument, nullptr, static_cast<int>(OptIdx::kDirect)},
+        {"io_uring", no_argument, nullptr, static_cast<int>(OptIdx::kIoUring)},
+        {"file", required_argument, nullptr, static_cast<int>(OptIdx::kFile)},
+        {"size", required_argument, nullptr, static_cast<int>(OptIdx::kSize)},
+        {"threads", required_argument, nullptr, static_cast<int>(OptIdx::kThreads)},
+        {"chunk_size", required_argument, nullptr, static_cast<int>(OptIdx::kChunkSize)},
+        {"iodepth", required_argument, nullptr, static_cast<int>(OptIdx::kIodepth)},
+        {"numa_node", required_argument, nullptr, static_cast<int>(OptIdx::kNumaNode)},
+        {"pinned_staging", no_argument, nullptr, static_cast<int>(OptIdx::kPinnedStaging)},
+        {"keep_file", no_argument, nullptr, static_cast<int>(OptIdx::kKeepFile)},
+        RESULT_LONG_OPTIONS,
+        {nullptr, 0, nullptr, 0}};
+    // Integer options and their lower bounds, indexed by OptIdx
+    std::map<int, std::pair<int *, int>> int_opts = {{static_cast<int>(OptIdx::kIodepth), {&opts->iodepth, 1}},
+                                                     {static_cast<int>(OptIdx::kNumaNode), {&opts->numa_node, -1}}};
+    // Flag options, indexed by OptIdx
+    std::map<int, bool *> flag_opts = {{static_cast<int>(OptIdx::kPinnedStaging), &opts->pinned_staging},
+                                       {static_cast<int>(OptIdx::kKeepFile), &opts->keep_file}};
+    // Method options, indexed by OptIdx
+    std::map<int, Method> method_opts = {{static_cast<int>(OptIdx::kMmap), Method::kMmap},
+                                         {static_cast<int>(OptIdx::kPread), Method::kPread},
+                                         {static_cast<int>(OptIdx::kDirect), Method::kDirect},
+                                         {static_cast<int>(OptIdx::kIoUring), Method::kIoUring}};
+    int getopt_ret = 0;
+    int opt_idx = 0;
+    bool parse_err = false;
+
+    while (true) {
+        getopt_ret = getopt_long(argc, argv, "", options, &opt_idx);
+        if (getopt_ret == -1) {
+            break;
+        } else if (getopt_ret == '?') {
+            parse_err = true;
+            break;
+        }
+        auto int_opt = int_opts.find(opt_idx);
+        if (host_utils::IsResultOpt(getopt_ret)) {
+            parse_err = !host_utils::ParseResultOpt(getopt_ret, optarg, &opts->result);
+        } else if (int_opt != int_opts.end()) {
+            parse_err =
+                1 != sscanf(optarg, "%d", int_opt->second.first) || *int_opt->second.first < int_opt->second.second;
+        } else if (flag_opts.count(opt_idx) > 0) {
+            *flag_opts[opt_idx] = true;
+        } else if (method_opts.count(opt_idx) > 0) {
+            opts->methods.push_back(method_opts[opt_idx]);
+        } else if (opt_idx == static_cast<int>(OptIdx::kFile)) {
+            opts->file = optarg;
+        } else if (opt_idx == static_cast<int>(OptIdx::kSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->size) || opts->size == 0;
+        } else if (opt_idx == static_cast<int>(OptIdx::kThreads)) {
+            parse_err = !host_utils::ParseIntList(optarg, &opts->threads) ||
+                        *std::min_element(opts->threads.begin(), opts->threads.end()) < 1;
+        } else if (opt_idx == static_cast<int>(OptIdx::kChunkSize)) {
+            parse_err = !host_utils::ParseSize(optarg, &opts->chunk_size) || opts->chunk_size == 0 ||
+                        opts->chunk_size % host_utils::kDirectAlignment != 0 || opts->chunk_size > kMaxFixedBufSize;
+        } else {
+            parse_err = true;
+        }
+        if (parse_err) {
+            std::cerr << "Invalid " << options[opt_idx].name << ": " << (optarg ? optarg : "") << std::endl;
+            break;
+        }
+    }
+
+    if (parse_err) {
+        PrintUsage();
+        return -1;
+    }
+
+    if (opts->methods.empty()) {
+        opts->methods = {Method::kMmap, Method::kPread, Method::kDirect, Method::kIoUring};
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Pin a loaded buffer for DMA, with the same host registration as gpu_copy, or mlock without a GPU runtime.
+ *
+ * @param buf The buffer.
+ * @param size The buffer size.
+ * @param read_only Whether the buffer is mapped read-only.
+ * @return true on success.
+ */
+bool PinBuffer(void *buf, size_t size, bool read_only) {
+#if defined(USE_CUDA)
+    unsigned flags = cudaHostRegisterMapped | (read_only ? cudaHostRegisterReadOnly : 0);
+    return cudaHostRegister(buf, size, flags) == cudaSuccess;
+#elif defined(USE_HIP)
+    unsigned flags = hipHostRegisterMapped | (read_only ? hipHostRegisterReadOnly : 0);
+    return hipHostRegister(buf, size, flags) == hipSuccess;
+#else
+    // Lock a read-only buffer without write access, as the read-only registration does not map it writable
+    if (read_only && mprotect(buf, size, PROT_READ) != 0) {
+        return false;
+    }
+    return mlock(buf, size) == 0;
+#endif
+}
+
+/**
+ * @brief Unpin a buffer pinned by PinBuffer().
+ *
+ * @param buf The buffer.
+ * @param size The buffer size.
+ */
+void UnpinBuffer(void *buf, size_t size) {
+#if defined(USE_CUDA)
+    cudaHostUnregister(buf);
+#elif defined(USE_HIP)
+    hipHostUnregister(buf);
+#else
+    munlock(buf, size);
+#endif
+}
+
+/**
+ * @brief Bind the calling thread and its allocations to the NUMA node of the options.
+ *
+ * @param opts The benchmark options.
+ */
+void BindToNumaNode(const Opts &opts) {
+    if (opts.numa_node >= 0) {
+        numa_run_on_node(opts.numa_node);
+        numa_set_preferred(opts.numa_node);
+    }
+}
+
+/**
+ * @brief Generate the weight file with random content.
+ *
+ * @param opts The benchmark options.
+ * @return true on success.
+ */
+bool GenerateFile(const Opts &opts) {
+    int fd = open(opts.file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Failed to create " << opts.file << ". ERROR: " << strerror(errno) << std::endl;
+        return false;
+    }
+    std::vector<uint64_t> chunk(opts.chunk_size / sizeof(uint64_t));
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    for (auto &word : chunk) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        word = seed;
+    }
+    bool ok = true;
+    for (uint64_t offset = 0; ok && offset < opts.size; offset += opts.chunk_size) {
+        size_t len = std::min<uint64_t>(opts.chunk_size, opts.size - offset);
+        chunk[0] = offset;
+        ok = write(fd, chunk.data(), len) == static_cast<ssize_t>(len);
+    }
+    ok = ok && fsync(fd) == 0;
+    if (!ok) {
+        std::cerr << "Failed to write " << opts.file << ". ERROR: " << strerror(errno) << std::endl;
+    }
+    close(fd);
+    return ok;
+}
+
+/**
+ * @brief Load chunks with pread into the destination buffer until all chunks are taken.
+ *
+ * @param opts The benchmark options.
+ * @param fd The file.
+ * @param file_size The file size.
+ * @param buf The destination buffer.
+ * @param next The index of the next chunk, shared by all threads.
+ * @return 0 on success, errno on failure.
+ */
+int PreadChunks(const Opts &opts, int fd, uint64_t file_size, char *buf, std::atomic<uint64_t> *next) {
+    for (uint64_t offset = (*next)++ * opts.chunk_size; offset < file_size; offset = (*next)++ * opts.chunk_size) {
+        uint64_t expected = std::min(opts.chunk_size, file_size - offset);
+        // O_DIRECT needs the length aligned, the read stops at the end of the file
+        uint64_t len = (expected + host_utils::kDirectAlignment - 1) / host_utils::kDirectAlignment *
+                       host_utils::kDirectAlignment;
+        ssize_t ret = pread(fd, buf + offset, len, offset);
+        if (ret < static_cast<ssize_t>(expected)) {
+            return ret < 0 ? errno : EIO;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Make chunks of a mapping resident with madvise(WILLNEED) and a touch of every page.
+ *
+ * @param opts The benchmark options.
+ * @param file_size The file size.
+ * @param buf The mapping.
+ * @param next The index of the next chunk, shared by all threads.
+ * @return 0 on success, errno on failure.
+ */
+int TouchChunks(const Opts &opts, uint64_t file_size, char *buf, std::atomic<uint64_t> *next) {
+    for (uint64_t offset = (*next)++ * opts.chunk_size; offset < file_size; offset = (*next)++ * opts.chunk_size) {
+        uint64_t len = std::min(opts.chunk_size, file_size - offset);
+        if (madvise(buf + offset, len, MADV_WILLNEED) != 0) {
+            return errno;
+        }
+        for (uint64_t i = 0; i < len; i += host_utils::kDirectAlignment) {
+            (void)*reinterpret_cast<volatile char *>(buf + offset + i);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Get the size of the pieces the destination buffer is registered in, the whole chunks fitting in 1GiB.
+ *
+ * @param opts The benchmark options.
+ * @return The piece size.
+ */
+uint64_t FixedBufPieceSize(const Opts &opts) { return kMaxFixedBufSize / opts.chunk_size * opts.chunk_size; }
+
+/**
+ * @brief Load chunks with O_DIRECT io_uring reads into fixed buffers until all chunks are taken.
+ *
+ * @param opts The benchmark options.
+ * @param ring The ring of this thread, with the file at index 0 and the destination buffer registered in pieces.
+ * @param file_size The file size.
+ * @param buf The destination buffer.
+ * @param next The index of the next chunk, shared by all threads.
+ * @return 0 on success, errno on failure.
+ */
+int IoUringChunks(const Opts &opts, host_utils::IoUring *ring, uint64_t file_size, char *buf,
+                  std::atomic<uint64_t> *next) {
+    int inflight = 0;
+    bool done = false;
+    while (true) {
+        while (!done && inflight < opts.iodepth) {
+            uint64_t offset = (*next)++ * opts.chunk_size;
+            if (offset >= file_size) {
+                done = true;
+                break;
+            }
+            uint64_t expected = std::min(opts.chunk_size, file_size - offset);
+            uint64_t len = (expected + host_utils::kDirectAlignment - 1) / host_utils::kDirectAlignment *
+                           host_utils::kDirectAlignment;
+            io_uring_sqe *sqe = ring->GetSqe();
+            host_utils::PrepRw(sqe, IORING_OP_READ_FIXED, 0, buf + offset, len, offset, expected);
+            sqe->flags = IOSQE_FIXED_FILE;
+            sqe->buf_index = offset / FixedBufPieceSize(opts);
+            inflight++;
+        }
+        if (inflight == 0) {
+            return 0;
+        }
+        int ret = ring->Submit(1);
+        io_uring_cqe *cqe = nullptr;
+        if ((ret < 0 && ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) || (ret = ring->WaitCqe(&cqe)) != 0) {
+            return -ret;
+        }
+        for (; cqe != nullptr; cqe = ring->PeekCqe()) {
+            int res = cqe->res;
+            uint64_t expected = cqe->user_data;
+            ring->SeenCqe();
+            inflight--;
+            if (res < static_cast<int64_t>(expected)) {
+                return res < 0 ? -res : EIO;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Create the ring of a thread and register the file and the destination buffer to it.
+ *
+ * @param opts The benchmark options.
+ * @param ring The ring.
+ * @param fd The file.
+ * @param buf The destination buffer.
+ * @param buf_size The buffer size.
+ * @return 0 on success, negative errno on failure.
+ */
+int SetupRing(const Opts &opts, host_utils::IoUring *ring, int fd, char *buf, uint64_t buf_size) {
+    uint64_t piece = FixedBufPieceSize(opts);
+    std::vector<iovec> iovs;
+    for (uint64_t offset = 0; offset < buf_size; offset += piece) {
+        iovs.push_back({buf + offset, static_cast<size_t>(std::min(piece, buf_size - offset))});
+    }
+    int ret = ring->Init(opts.iodepth);
+    if (ret == 0) {
+        ret = ring->RegisterBuffers(iovs.data(), iovs.size());
+    }
+    if (ret == 0) {
+        ret = ring->RegisterFiles(&fd, 1);
+    }
+    return ret;
+}
+
+/**
+ * @brief Load the weight file once with a method and a thread count from a cold page cache, and emit the metrics.
+ *
+ * @param emitter The result emitter.
+ * @param opts The benchmark options.
+ * @param method The load method.
+ * @param num_threads The number of threads.
+ * @param file_size The file size.
+ * @return 0 on success, errno on failure.
+ */
+int RunLoad(host_utils::ResultEmitter *emitter, const Opts &opts, Method method, int num_threads, uint64_t file_size) {
+    host_utils::DropFileCache(opts.file.c_str());
+    bool direct = method == Method::kDirect || method == Method::kIoUring;
+    int fd = open(opts.file.c_str(), O_RDONLY | (direct ? O_DIRECT : 0));
+    if (fd < 0) {
+        std::cerr << "Failed to open " << opts.file << ". ERROR: " << strerror(errno) << std::endl;
+        return errno;
+    }
+
+    // The destination buffer is placed on the NUMA node and pre-faulted before the clock starts
+    uint64_t buf_size =
+        (file_size + host_utils::kDirectAlignment - 1) / host_utils::kDirectAlignment * host_utils::kDirectAlignment;
+    char *buf = nullptr;
+    if (method != Method::kMmap) {
+        buf = static_cast<char *>(opts.numa_node >= 0 ? numa_alloc_onnode(buf_size, opts.numa_node)
+                                                      : numa_alloc_local(buf_size));
+        if (buf == nullptr) {
+            std::cerr << "Failed to allocate " << buf_size << " bytes." << std::endl;
+            close(fd);
+            return ENOMEM;
+        }
+        memset(buf, 0, buf_size);
+    }
+
+    std::atomic<uint64_t> next(0);
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<int> errors(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            BindToNumaNode(opts);
+            host_utils::IoUring ring;
+            if (method == Method::kIoUring) {
+                errors[t] = -SetupRing(opts, &ring, fd, buf, buf_size);
+            }
+            ready++;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            if (errors[t] != 0) {
+                return;
+            }
+            if (method == Method::kMmap) {
+                errors[t] = TouchChunks(opts, file_size, buf, &next);
+            } else if (method == Method::kIoUring) {
+                errors[t] = IoUringChunks(opts, &ring, file_size, buf, &next);
+            } else {
+                errors[t] = PreadChunks(opts, fd, file_size, buf, &next);
+            }
+        });
+    }
+    while (ready.load() < num_threads) {
+        std::this_thread::yield();
+    }
+
+    auto start = Clock::now();
+    if (method == Method::kMmap) {
+        // A single thread populates the whole mapping in the kernel, more threads fault it in parallel
+        int flags = MAP_PRIVATE | (num_threads == 1 ? MAP_POPULATE : 0);
+        void *addr = mmap(nullptr, file_size, PROT_READ, flags, fd, 0);
+        buf = addr == MAP_FAILED ? nullptr : static_cast<char *>(addr);
+        if (buf == nullptr) {
+            errors[0] = errno;
+        }
+        next = num_threads == 1 || buf == nullptr ? file_size / opts.chunk_size + 1 : 0;
+    }
+    go = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    int ret = 0;
+    for (int error : errors) {
+        ret = ret != 0 ? ret : error;
+    }
+    std::string tag = std::string(MethodName(method)) + "_t" + std::to_string(num_threads);
+    host_utils::ResultTags tags = {{"method", MethodName(method)}, {"threads", std::to_string(num_threads)}};
+    if (ret != 0) {
+        std::cerr << "Failed to load with " << tag << ". ERROR: " << strerror(ret) << std::endl;
+    } else {
+        emitter->Metric(tag + "_time_to_ready", seconds, "s", tags);
+        emitter->Metric(tag + "_bw", file_size / seconds / 1e9, "GB/s", tags);
+    }
+
+    if (ret == 0 && opts.pinned_staging) {
+        start = Clock::now();
+        bool pinned = PinBuffer(buf, method == Method::kMmap ? file_size : buf_size, method == Method::kMmap);
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (pinned) {
+            emitter->Metric(tag + "_staging_time", seconds, "s", tags);
+            UnpinBuffer(buf, method == Method::kMmap ? file_size : buf_size);
+        } else {
+            std::cerr << "Failed to pin the loaded weights of " << tag << "." << std::endl;
+            ret = EIO;
+        }
+    }
+
+    if (method == Method::kMmap) {
+        if (buf != nullptr) {
+            munmap(buf, file_size);
+        }
+    } else {
+        numa_free(buf, buf_size);
+    }
+    close(fd);
+    return ret;
+}
+
+int main(int argc, char **argv) {
+    Opts opts;
+    int ret = ParseOpts(argc, argv, &opts);
+    if (0 != ret) {
+        return ret;
+    }
+    if (numa_available() < 0) {
+        opts.numa_node = -1;
+    } else if (opts.numa_node > numa_max_node()) {
+        std::cerr << "Invalid numa_node: " << opts.numa_node << std::endl;
+        return 1;
+    }
+
+    bool generated = opts.file.empty();
+    if (generated) {
+        opts.file = "sb_weights.bin";
+        if (!GenerateFile(opts)) {
+            unlink(opts.file.c_str());
+            return 1;
+        }
+    }
+    struct stat st;
+    if (stat(opts.file.c_str(), &st) != 0 || st.st_size == 0) {
+        std::cerr << "Invalid weight file " << opts.file << "." << std::endl;
+        return 1;
+    }
+
+    host_utils::ResultEmitter emitter(opts.result);
+    for (Method method : opts.methods) {
+        for (int num_threads : opts.threads) {
+            ret = RunLoad(&emitter, opts, method, num_threads, st.st_size);
+            if (ret == 0 && emitter.Stopped()) {
+                ret = ECANCELED;
+            }
+            if (ret != 0) {
+                break;
+            }
+        }
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    if (generated && !opts.keep_file) {
+        unlink(opts.file.c_str());
+    }
+    return ret == 0 ? 0 : 1;
+}
@@ -31,6 +31,7 @@ class ReturnCode(Enum):
     MICROBENCHMARK_UNSUPPORTED_ARCHITECTURE = 34
     MICROBENCHMARK_DEVICE_GETTING_FAILURE = 35
     MICROBENCHMARK_MPI_INIT_FAILURE = 36
+    MICROBENCHMARK_BASELINE_FAILURE = 37
     # Return codes related to docker benchmarks.
     DOCKERBENCHMARK_IMAGE_NOT_SET = 50
     DOCKERBENCHMARK_CONTAINER_NOT_SET = 51
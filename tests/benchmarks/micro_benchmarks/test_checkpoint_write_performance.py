@@ -0,0 +1,88 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for checkpoint-write benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class CheckpointWriteBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for checkpoint-write benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/checkpoint_write'])
+
+    def test_checkpoint_write_command_generation(self):
+        """Test checkpoint-write benchmark command generation."""
+        benchmark_name = 'checkpoint-write'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--methods direct io_uring --dir /mnt/ckpt --writers 8 --shard_size 4G --chunk_size 16M ' \
+            '--iodepth 8 --serialize --processes'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.methods == ['direct', 'io_uring'])
+        assert (benchmark._args.writers == 8)
+        assert (benchmark._args.serialize)
+        assert (benchmark._args.processes)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._CheckpointWriteBenchmark__bin_path))
+        for option in [
+            '--direct --io_uring', '--dir /mnt/ckpt', '--writers 8', '--shard_size 4G', '--chunk_size 16M',
+            '--iodepth 8', '--serialize', '--processes'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+        assert ('--buffered' not in benchmark._commands[0])
+
+        # Negative case - invalid method.
+        benchmark = benchmark_class(benchmark_name, parameters='--methods mmap')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/checkpoint_write.log')
+    def test_checkpoint_write_result_parsing(self, test_raw_output):
+        """Test checkpoint-write benchmark result parsing."""
+        benchmark_name = 'checkpoint-write'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--writers 2')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 3 methods * (2 shards + avg + max + fsync + bw)
+        assert (18 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['buffered_shard1_time_to_durable'][0] == 0.900673975)
+        assert (benchmark.result['direct_fsync_time_avg'][0] == 0.0022790745)
+        assert (benchmark.result['io_uring_bw'][0] == 1.76195693)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -171,4 +171,42 @@ def test_preprocess_non_x86(self, mock_platform_machine):
         assert (ret is True)
         assert (benchmark.return_code == ReturnCode.SUCCESS)
         assert (len(benchmark._commands) == 1)
-        assert ('cpu_copy --size 1024 --num_warm_up 10 --num_loops 50 --check_data' in benchmark._commands[0])
+        assert (
+            'cpu_copy --size 1024 --num_warm_up 10 --num_loops 50 --check_data --result_format jsonl'
+            in benchmark._commands[0]
+        )
+
+        # Check command with the executing node swept.
+        benchmark = benchmark_class(benchmark_name, parameters='--size 1024 --sweep_exec_node')
+        benchmark._bin_name = 'cpu_copy'
+        benchmark._commands = []
+        assert (benchmark._preprocess() is True)
+        assert ('cpu_copy --size 1024 --num_warm_up 20 --num_loops 100 --sweep_exec_node' in benchmark._commands[0])
+
+    @mock.patch('platform.machine')
+    def test_result_parsing_non_x86(self, mock_platform_machine):
+        """Test result parsing for general CPU copy benchmark."""
+        mock_platform_machine.return_value = 'arm64'
+
+        benchmark_name = 'cpu-memory-bw-latency'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        benchmark = benchmark_class(benchmark_name, parameters='--sweep_exec_node')
+        benchmark._bin_name = 'cpu_copy'
+        assert (benchmark._preprocess() is True)
+
+        raw_output = '\n'.join(
+            [
+                '{"v":1,"kind":"metric","name":"mem_bandwidth_matrix_numa_0_1_by_numa_2_bw","unit":"MB/s",'
+                '"tags":{"src":"0","dst":"1","exec":"2"},"value":12049.2}',
+                '{"v":1,"kind":"metric","name":"mem_bandwidth_matrix_numa_0_1_by_numa_2_lat","unit":"ns/byte",'
+                '"tags":{"src":"0","dst":"1","exec":"2"},"value":0.083}',
+            ]
+        )
+        assert (benchmark._process_raw_result(0, raw_output))
+        assert (benchmark.result['mem_bandwidth_matrix_numa_0_1_by_numa_2_bw'] == [12049.2])
+        assert (benchmark.result['mem_bandwidth_matrix_numa_0_1_by_numa_2_lat'] == [0.083])
+
+        # Negative case - the text output.
+        assert (benchmark._process_raw_result(1, 'mem_bandwidth_matrix_numa_0_1_bw: 12049.2') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -4,8 +4,10 @@
 """Tests for cublas-functions benchmark."""
 
 import numbers
+import unittest
 
 from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
 from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
 
 
@@ -150,3 +152,48 @@ def test_cublas_functions_correctness():
         if 'correctness' in metric or 'error_rate' in metric:
             assert (len(benchmark.result[metric]) == 1)
             assert (isinstance(benchmark.result[metric][0], numbers.Number))
+
+
+class CublasFunctionResultTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for the results of cublas-function benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/cublas_benchmark'])
+
+    def test_cublas_functions_result_parsing(self):
+        """Test cublas-function benchmark result parsing."""
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark('cublas-function', Platform.CUDA)
+        benchmark = benchmark_class('cublas-function', parameters='--num_steps 3 --correctness')
+        assert (benchmark._preprocess() is True)
+        assert ('--correctness --result_format jsonl --config_json' in benchmark._commands[0])
+
+        metric = 'name_cublassgemm_k_32_m_64_n_64_transa_1_transb_0'
+        raw_output = '\n'.join(
+            [
+                '[function config]: { k :32, m :64, n :64, name : cublasSgemm , transa :1, transb :0}',
+                '{"v":1,"kind":"samples","name":"%s_time","unit":"us","tags":{"function":"cublasSgemm"},'
+                '"samples":[4.5,5.5,5]}' % metric,
+                '{"v":1,"kind":"metric","name":"%s_time","unit":"us","tags":{"function":"cublasSgemm"},'
+                '"value":5}' % metric,
+                '{"v":1,"kind":"metric","name":"%s_correctness","unit":"","tags":{"function":"cublasSgemm"},'
+                '"value":1}' % metric,
+                '{"v":1,"kind":"metric","name":"%s_error_rate","unit":"","tags":{"function":"cublasSgemm"},'
+                '"value":0}' % metric,
+            ]
+        )
+        assert (benchmark._process_raw_result(0, raw_output))
+        assert (benchmark.result[metric + '_time'] == [5])
+        assert (benchmark.result[metric + '_correctness'] == [1])
+        assert (benchmark.result[metric + '_error_rate'] == [0])
+        assert (benchmark.raw_data[metric + '_time'] == [[4.5, 5.5, 5]])
+
+        # Negative case - error of the binary.
+        assert (benchmark._process_raw_result(1, 'Error: invalid input function name') is False)
+
+        # Negative case - the text output.
+        assert (benchmark._process_raw_result(2, '[raw_data]: 4.5,5.5,5,') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
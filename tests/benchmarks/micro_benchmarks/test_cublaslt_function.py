@@ -3,6 +3,7 @@
 
 """Tests for cublaslt-gemm benchmark."""
 
+import json
 import unittest
 from types import GeneratorType, SimpleNamespace
 
@@ -73,7 +74,8 @@ def test_cublaslt_gemm_command_generation(self):
         self.assertEqual(4 * (2 * 2 * 3 + 2) * len(benchmark._args.in_types), len(benchmark._commands))
 
         def cmd(t, b, m, n, k):
-            return f'{benchmark._CublasLtBenchmark__bin_path} -m {m} -n {n} -k {k} -b {b} -w 20 -i 50 -t {t}'
+            return f'{benchmark._CublasLtBenchmark__bin_path} -m {m} -n {n} -k {k} -b {b} -w 20 -i 50 -t {t}' + \
+                ' --result_format jsonl'
 
         for _t in ['fp16', 'fp32', 'fp64', 'int8']:
             for _b in [2, 4, 8, 16]:
@@ -94,9 +96,27 @@ def test_cublaslt_gemm_result_parsing(self, raw_output):
         )
         benchmark._result = BenchmarkResult(self.benchmark_name, BenchmarkType.MICRO, ReturnCode.SUCCESS, run_count=1)
 
+        def record(m, n, k):
+            return json.dumps(
+                {
+                    'v': 1,
+                    'kind': 'metric',
+                    'name': f'fp8e4m3_0_{m}_{n}_{k}_flops',
+                    'unit': 'TFLOPS',
+                    'tags': {
+                        'in_type': 'fp8e4m3',
+                        'batch': '0',
+                        'm': str(m),
+                        'n': str(n),
+                        'k': str(k)
+                    },
+                    'value': 2.222
+                }
+            )
+
         # Positive case - valid raw output
-        self.assertTrue(benchmark._process_raw_result(0, '16   16    16    0       1.111      2.222'))
-        self.assertTrue(benchmark._process_raw_result(1, '32   64    128    0       1.111      2.222'))
+        self.assertTrue(benchmark._process_raw_result(0, record(16, 16, 16)))
+        self.assertTrue(benchmark._process_raw_result(1, record(32, 64, 128)))
         self.assertEqual(ReturnCode.SUCCESS, benchmark.return_code)
 
         self.assertEqual(3, len(benchmark.result))
@@ -105,6 +125,8 @@ def test_cublaslt_gemm_result_parsing(self, raw_output):
 
         # Negative case - invalid raw output
         self.assertFalse(benchmark._process_raw_result(1, 'cuBLAS API failed'))
+        # Negative case - text output without --result_format jsonl
+        self.assertFalse(benchmark._process_raw_result(1, '16\t16\t16\t0\t1.111\t2.222'))
 
         # Positive case - valid ncu raw output
         benchmark._args = SimpleNamespace(
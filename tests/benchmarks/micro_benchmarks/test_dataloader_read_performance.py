@@ -0,0 +1,88 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for dataloader-read benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class DataLoaderReadBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for dataloader-read benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/dataloader_read'])
+
+    def test_dataloader_read_command_generation(self):
+        """Test dataloader-read benchmark command generation."""
+        benchmark_name = 'dataloader-read'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--methods sync io_uring --dir /mnt/data --num_files 10000 --files_per_dir 500 ' \
+            '--min_size 64K --max_size 2M --threads 16 --batch 32 --keep_dataset'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.methods == ['sync', 'io_uring'])
+        assert (benchmark._args.num_files == 10000)
+        assert (benchmark._args.threads == 16)
+        assert (benchmark._args.keep_dataset)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._DataLoaderReadBenchmark__bin_path))
+        for option in [
+            '--sync --io_uring', '--dir /mnt/data', '--num_files 10000', '--files_per_dir 500', '--min_size 64K',
+            '--max_size 2M', '--threads 16', '--batch 32', '--keep_dataset'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+        assert ('--fadvise' not in benchmark._commands[0])
+
+        # Negative case - invalid method.
+        benchmark = benchmark_class(benchmark_name, parameters='--methods mmap')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/dataloader_read.log')
+    def test_dataloader_read_result_parsing(self, test_raw_output):
+        """Test dataloader-read benchmark result parsing."""
+        benchmark_name = 'dataloader-read'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--num_files 600 --threads 4 --batch 8')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 3 methods * 2 cache states * (samples/s + bw + avg + 5 percentiles + max)
+        assert (54 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['sync_cold_samples_per_sec'][0] == 1508.87797)
+        assert (benchmark.result['fadvise_warm_lat_us_99'][0] == 13074.432)
+        assert (benchmark.result['io_uring_cold_bw'][0] == 0.988874926)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -20,7 +20,7 @@ def setUpClass(cls):
         """Hook method for setting up class fixture before running tests in the class."""
         super().setUpClass()
         cls.createMockEnvs(cls)
-        cls.createMockFiles(cls, ['bin/fio'])
+        cls.createMockFiles(cls, ['bin/fio', 'bin/io_uring_disk'])
 
     def test_disk_performance_empty_param(self):
         """Test disk-performance benchmark command generation with empty parameter."""
@@ -179,6 +179,43 @@ def test_disk_performance_benchmark_enabled(self, mock_is_block_device):
                     assert ('--verify=md5' in benchmark._commands[command_idx])
                     command_idx += 1
 
+    @mock.patch('pathlib.Path.is_block_device')
+    def test_disk_performance_io_uring_engine(self, mock_is_block_device):
+        """Test disk-performance benchmark command generation with io_uring engine."""
+        mock_is_block_device.return_value = True
+
+        benchmark_name = 'disk-benchmark'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        param_str = '--engine io_uring --io_uring_sqpoll --block_devices /dev/nvme0n1 ' \
+            '--files /mnt/data/disk.bin --file_size 4G --rand_read_runtime 0'
+        benchmark = benchmark_class(benchmark_name, parameters=param_str)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark._bin_name == 'io_uring_disk')
+
+        # Check command list
+        # 2 files * seq read = 2 commands
+        assert (2 == len(benchmark._commands))
+        for command in benchmark._commands:
+            assert (command.startswith(os.path.join(benchmark._args.bin_dir, 'io_uring_disk')))
+            assert ('--fixedbufs=1 --registerfiles=1 --sqthread_poll=1' in command)
+            assert ('--rw=read' in command)
+        assert ('--filename=/dev/nvme0n1 ' in benchmark._commands[0])
+        assert ('--filename=/mnt/data/disk.bin --size=4G' in benchmark._commands[1])
+
+        # Negative case - invalid engine and verify with io_uring engine.
+        for param_str in ['--engine spdk', '--engine io_uring --verify=md5']:
+            benchmark = benchmark_class(benchmark_name, parameters=param_str)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
     @mock.patch('pathlib.Path.is_block_device')
     def test_disk_performance_env_parsing(self, mock_is_block_device):
         """Test disk-performance benchmark env parsing."""
@@ -282,3 +319,29 @@ def test_disk_performance_result_parsing(self, test_raw_output):
         # Negative case - invalid raw output.
         assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
         assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+
+    @decorator.load_data('tests/data/disk_io_uring_performance.log')
+    def test_disk_performance_io_uring_result_parsing(self, test_raw_output):
+        """Test disk-performance benchmark result parsing with io_uring engine."""
+        benchmark_name = 'disk-benchmark'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--engine io_uring')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output in the same format as fio.
+        jobname_prefix = 'disktest.bin_rand_read_write'
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # bs + <read, write> x <iops, 95th, 99th, 99.9th>
+        assert (9 + benchmark.default_metric_count == len(benchmark.result.keys()))
+        assert (4096 == benchmark.result[jobname_prefix + '_bs'][0])
+        assert (54820 == benchmark.result[jobname_prefix + '_read_iops'][0])
+        assert (13734 == benchmark.result[jobname_prefix + '_write_iops'][0])
+        assert (11436032 == benchmark.result[jobname_prefix + '_read_lat_ns_99.0'][0])
+        assert (16154624 == benchmark.result[jobname_prefix + '_write_lat_ns_99.9'][0])
@@ -0,0 +1,87 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for fs-metadata benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class FsMetadataBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for fs-metadata benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/fs_metadata'])
+
+    def test_fs_metadata_command_generation(self):
+        """Test fs-metadata benchmark command generation."""
+        benchmark_name = 'fs-metadata'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--dir /mnt/shared --threads 16 --files 4000 --shared_dir --io_uring --iodepth 32'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.threads == 16)
+        assert (benchmark._args.files == 4000)
+        assert (benchmark._args.shared_dir)
+        assert (benchmark._args.io_uring)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._FsMetadataBenchmark__bin_path))
+        for option in [
+            '--dir /mnt/shared', '--threads 16', '--files 4000', '--iodepth 32', '--shared_dir', '--io_uring'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+
+        # Check command with private directories and blocking calls.
+        benchmark = benchmark_class(benchmark_name, parameters='')
+        assert (benchmark._preprocess() is True)
+        assert ('--shared_dir' not in benchmark._commands[0])
+        assert ('--io_uring' not in benchmark._commands[0])
+
+    @decorator.load_data('tests/data/fs_metadata.log')
+    def test_fs_metadata_result_parsing(self, test_raw_output):
+        """Test fs-metadata benchmark result parsing."""
+        benchmark_name = 'fs-metadata'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--threads 2')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 6 phases * (ops/s + avg + 5 percentiles + max)
+        assert (48 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['create_ops_per_sec'][0] == 3304.92221)
+        assert (benchmark.result['stat_lat_us_99'][0] == 2.264)
+        assert (benchmark.result['readdir_ops_per_sec'][0] == 3461462.73)
+        assert (benchmark.result['unlink_lat_us_max'][0] == 4219.962)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -3,6 +3,7 @@
 
 """Tests for gpu-copy-bw benchmark."""
 
+import json
 import numbers
 import unittest
 
@@ -78,6 +79,7 @@ def _test_gpu_copy_bw_performance_command_generation(self, platform):
         assert ('--all_to_all_thread_block_size %d' % all_to_all_thread_block_size in benchmark._commands[0])
         assert ('--bidirectional' in benchmark._commands[0])
         assert ('--check_data' in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
 
     @decorator.cuda_test
     def test_gpu_copy_bw_performance_command_generation_cuda(self):
@@ -109,8 +111,10 @@ def _test_gpu_copy_bw_performance_result_parsing(self, platform, test_raw_output
         assert (benchmark.return_code == ReturnCode.SUCCESS)
 
         assert (1 == len(benchmark.raw_data))
-        print(test_raw_output.splitlines())
-        test_raw_output_dict = {x.split()[0]: float(x.split()[1]) for x in test_raw_output.strip().splitlines()}
+        test_raw_output_dict = {}
+        for line in test_raw_output.strip().splitlines():
+            record = json.loads(line)
+            test_raw_output_dict[record['name']] = record['value']
         assert (len(test_raw_output_dict) + benchmark.default_metric_count == len(benchmark.result))
         for output_key in benchmark.result:
             if output_key == 'return_code':
@@ -118,13 +122,17 @@ def _test_gpu_copy_bw_performance_result_parsing(self, platform, test_raw_output
             else:
                 assert (len(benchmark.result[output_key]) == 1)
                 assert (isinstance(benchmark.result[output_key][0], numbers.Number))
-                assert (output_key.strip('_bw') in test_raw_output_dict)
-                assert (test_raw_output_dict[output_key.strip('_bw')] == benchmark.result[output_key][0])
+                assert (output_key in test_raw_output_dict)
+                assert (test_raw_output_dict[output_key] == benchmark.result[output_key][0])
 
         # Negative case - invalid raw output.
         assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
         assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
 
+        # Negative case - the text output.
+        assert (benchmark._process_raw_result(2, 'cpu_to_gpu0_by_sm_under_numa0 26.2409') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+
     @decorator.cuda_test
     def test_gpu_copy_bw_performance_result_parsing_cuda(self):
         """Test gpu-copy benchmark result parsing, CUDA case."""
@@ -3,6 +3,7 @@
 
 """Tests for gpu_stream benchmark."""
 
+import json
 import numbers
 import unittest
 
@@ -57,6 +58,7 @@ def _test_gpu_stream_command_generation(self, platform):
         assert ('--num_warm_up %d' % num_warm_up in benchmark._commands[0])
         assert ('--num_loops %d' % num_loops in benchmark._commands[0])
         assert ('--check_data' in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
 
     @decorator.cuda_test
     def test_gpu_stream_command_generation_cuda(self):
@@ -83,29 +85,30 @@ def _test_gpu_stream_result_parsing(self, platform, test_raw_output):
         assert (benchmark.return_code == ReturnCode.SUCCESS)
 
         assert (1 == len(benchmark.raw_data))
-        # print(test_raw_output.splitlines())
-        test_raw_output_dict = {
-            x.split()[0]: [float(x.split()[1]), float(x.split()[2])]
-            for x in test_raw_output.strip().splitlines() if x.startswith('STREAM_')
-        }
-        assert (len(test_raw_output_dict) * 2 + benchmark.default_metric_count == len(benchmark.result))
+        test_raw_output_dict = {}
+        for line in test_raw_output.strip().splitlines():
+            if line.startswith('{'):
+                record = json.loads(line)
+                test_raw_output_dict[record['name']] = record['value']
+        assert (len(test_raw_output_dict) + benchmark.default_metric_count == len(benchmark.result))
         for output_key in benchmark.result:
             if output_key == 'return_code':
                 assert (benchmark.result[output_key] == [0])
             else:
                 assert (len(benchmark.result[output_key]) == 1)
                 assert (isinstance(benchmark.result[output_key][0], numbers.Number))
-                if output_key.endswith('_bw'):
-                    assert (output_key.strip('_bw') in test_raw_output_dict)
-                    assert (test_raw_output_dict[output_key.strip('_bw')][0] == benchmark.result[output_key][0])
-                else:
-                    assert (output_key.strip('_ratio') in test_raw_output_dict)
-                    assert (test_raw_output_dict[output_key.strip('_ratio')][1] == benchmark.result[output_key][0])
+                assert (output_key.endswith('_bw') or output_key.endswith('_ratio'))
+                assert (test_raw_output_dict[output_key] == benchmark.result[output_key][0])
 
         # Negative case - invalid raw output.
         assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
         assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
 
+        # Negative case - the text output.
+        text_output = 'STREAM_COPY_double_gpu_0_buffer_4294967296_block_128\t6711.67\t83.9'
+        assert (benchmark._process_raw_result(2, text_output) is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+
     @decorator.cuda_test
     def test_gpu_stream_result_parsing_cuda(self):
         """Test gpu-stream benchmark result parsing, CUDA case."""
@@ -0,0 +1,154 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for host-runner benchmark."""
+
+import re
+import unittest
+from pathlib import Path
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class HostRunnerBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for host-runner benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/host_runner'])
+
+    def test_host_runner_command_generation(self):
+        """Test host-runner benchmark command generation."""
+        benchmark_name = 'host-runner'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--benchmarks "stream size=1G" "gemm m=2048 n=2048 k=2048" dispatch --cpus 0-15'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.benchmarks == ['stream size=1G', 'gemm m=2048 n=2048 k=2048', 'dispatch'])
+        assert (benchmark._args.cpus == '0-15')
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._HostRunnerBenchmark__bin_path))
+        for option in [
+            "--run 'stream size=1G' --run 'gemm m=2048 n=2048 k=2048' --run dispatch", '--cpus 0-15',
+            '--result_format jsonl'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--plan' not in benchmark._commands[0])
+
+        # Check command with a plan file, which replaces the default plugins.
+        benchmark = benchmark_class(benchmark_name, parameters='--plan /opt/plans/node.plan')
+        assert (benchmark._preprocess() is True)
+        assert ('--plan /opt/plans/node.plan' in benchmark._commands[0])
+        assert ('--run' not in benchmark._commands[0])
+        assert ('--pages' not in benchmark._commands[0])
+
+        # Check command with huge pages and the memory locking plugin, which only runs when given.
+        benchmark = benchmark_class(
+            benchmark_name, parameters='--benchmarks stream "mem_lock size=4G pages=small,hugetlb" --pages hugetlb'
+        )
+        assert (benchmark._preprocess() is True)
+        assert ("--run stream --run 'mem_lock size=4G pages=small,hugetlb'" in benchmark._commands[0])
+        assert ('--pages hugetlb' in benchmark._commands[0])
+
+        # Check command with the all-to-all copies of some workers.
+        benchmark = benchmark_class(
+            benchmark_name, parameters='--benchmarks "all_to_all workers=16 slice=1M modes=all_to_all"'
+        )
+        assert (benchmark._preprocess() is True)
+        assert ("--run 'all_to_all workers=16 slice=1M modes=all_to_all'" in benchmark._commands[0])
+
+        # Check command with the memory test, which only runs when given.
+        benchmark = benchmark_class(benchmark_name, parameters='--benchmarks "mem_test percent=80 seconds=600"')
+        assert (benchmark._preprocess() is True)
+        assert ("--run 'mem_test percent=80 seconds=600'" in benchmark._commands[0])
+
+        # Check command with the contention of some primitives on given thread counts.
+        benchmark = benchmark_class(
+            benchmark_name, parameters='--benchmarks "sync threads=1,8,64 primitives=ticket,mcs placements=scatter"'
+        )
+        assert (benchmark._preprocess() is True)
+        assert ("--run 'sync threads=1,8,64 primitives=ticket,mcs placements=scatter'" in benchmark._commands[0])
+
+        # Check command with the default plugins.
+        benchmark = benchmark_class(benchmark_name)
+        assert (benchmark._preprocess() is True)
+        assert (
+            '--run numa_copy --run stream --run gemm --run dispatch --run all_to_all --run sync'
+            in benchmark._commands[0]
+        )
+        assert ('--baseline' not in benchmark._commands[0])
+
+        # Check command with a baseline to stop at the first failure.
+        benchmark = benchmark_class(benchmark_name, parameters='--baseline /opt/baselines/node.rules --fail_fast')
+        assert (benchmark._preprocess() is True)
+        assert (
+            '--result_format jsonl --baseline /opt/baselines/node.rules --baseline_confidence 0.99 --fail_fast'
+            in benchmark._commands[0]
+        )
+
+        # Negative case - invalid plugin.
+        benchmark = benchmark_class(benchmark_name, parameters='--benchmarks "hpl size=1G"')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    def test_host_runner_plugins(self):
+        """Test the plugins of host-runner benchmark against those registered by the host runner."""
+        (benchmark_class, _) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark('host-runner', Platform.CPU)
+        benchmark = benchmark_class('host-runner')
+        registered = set()
+        for source in Path('superbench/benchmarks/micro_benchmarks/host_runner').glob('*.cpp'):
+            registered.update(re.findall(r'^REGISTER_HOST_BENCHMARK\("(\w+)"', source.read_text(), re.MULTILINE))
+        assert (sorted(benchmark._plugins) == sorted(registered))
+        assert (set(benchmark._default_plugins) <= registered)
+
+    @decorator.load_data('tests/data/host_runner.log')
+    def test_host_runner_result_parsing(self, test_raw_output):
+        """Test host-runner benchmark result parsing."""
+        benchmark_name = 'host-runner'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name)
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        # Raw output and the dispatch latency samples of hot and parked members
+        assert (3 == len(benchmark.raw_data))
+        assert (len(benchmark.raw_data['dispatch_t1_hot_latency'][0]) == 10000)
+        # 2 runner metrics + 6 benchmarks * (wall time + return code) + 2 copy within the single node + 4 stream
+        # + 2 gemm + 6 dispatch + 2 placements * (6 primitives * 3 + 2 barriers) sync, all-to-all skipped on 1 cpu
+        assert (68 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['stream_triad_bw'][0] == 11.811906072489123)
+        assert (benchmark.result['gemm_gflops'][0] == 34.13862668881536)
+        assert (benchmark.result['numa_copy_mem_bandwidth_matrix_numa_0_0_bw'][0] == 6936.152268059672)
+        assert (benchmark.result['dispatch_t1_parked_latency_p99'][0] == 121.895)
+        assert (benchmark.result['sync_mcs_scatter_t1_throughput'][0] == 44.49878064303042)
+        for plugin in benchmark._default_plugins:
+            assert (benchmark.result[plugin + '_return_code'][0] == 0)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
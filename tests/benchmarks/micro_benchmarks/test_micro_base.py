@@ -6,6 +6,8 @@
 import os
 import re
 import shutil
+import subprocess
+from unittest import mock
 
 from superbench.benchmarks import BenchmarkType, ReturnCode
 from superbench.benchmarks.micro_benchmarks import MicroBenchmark, MicroBenchmarkWithInvoke
@@ -86,6 +88,49 @@ def _process_raw_result(self, cmd_idx, raw_output):
         return True
 
 
+class FakeResultRecordBenchmark(MicroBenchmarkWithInvoke):
+    """Fake benchmark of a binary writing result records checked against a baseline."""
+    def __init__(self, name, parameters=''):
+        """Constructor.
+
+        Args:
+            name: benchmark name.
+            parameters: benchmark parameters.
+        """
+        super().__init__(name, parameters)
+        self._bin_name = 'echo'
+
+    def add_parser_arguments(self):
+        """Add the specified arguments."""
+        super().add_parser_arguments()
+        self._add_result_record_arguments()
+
+    def _preprocess(self):
+        """Preprocess/preparation operations before the benchmarking.
+
+        Return:
+            True if _preprocess() succeed.
+        """
+        if not super()._preprocess():
+            return False
+
+        self._commands.append(os.path.join(self._args.bin_dir, self._bin_name) + self._result_record_args())
+
+        return True
+
+    def _process_raw_result(self, cmd_idx, raw_output):
+        """Function to process raw results and save the summarized results.
+
+        Args:
+            cmd_idx (int): the index of command corresponding with the raw_output.
+            raw_output (str): raw output string of the micro-benchmark.
+
+        Return:
+            True if the raw output string is valid and result can be extracted.
+        """
+        return self._process_result_records(cmd_idx, raw_output)
+
+
 def test_micro_benchmark_base():
     """Test MicroBenchmark."""
     benchmark = FakeMicroBenchmark('fake')
@@ -132,3 +177,67 @@ def test_micro_benchmark_with_invoke_base():
     assert (benchmark.raw_data['raw_output_0'] == ['cost1: 10.2, cost2: 20.2'])
     assert (benchmark.result['cost1'] == [10.2])
     assert (benchmark.result['cost2'] == [20.2])
+
+
+def test_micro_benchmark_with_invoke_result_records():
+    """Test MicroBenchmarkWithInvoke parsing the result records."""
+    benchmark = FakeMicroBenchmarkWithInvoke('fake')
+    benchmark._bin_name = 'echo'
+    assert (benchmark._preprocess())
+    raw_output = '\n'.join(
+        [
+            '{"v":1,"kind":"metric","name":"lat_us_avg","unit":"us","tags":{"load":"0"},"value":8.5}',
+            '{"v":1,"kind":"samples","name":"lat_us","unit":"us","tags":{},"samples":[7.5,9.5]}',
+            '{"v":1,"kind":"metric","name":"drop_rate","unit":"","tags":{},"value":null}',
+        ]
+    )
+    assert (benchmark._process_result_records(0, raw_output, prefix='tcp_'))
+    assert (benchmark.result['tcp_lat_us_avg'] == [8.5])
+    assert (benchmark.raw_data['tcp_lat_us'] == [[7.5, 9.5]])
+    assert (benchmark.result['tcp_drop_rate'][0] != benchmark.result['tcp_drop_rate'][0])
+
+    # Negative cases - text output and unknown record versions.
+    assert (benchmark._process_result_records(1, 'lat_us_avg: 8.5') is False)
+    assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+    assert (benchmark._process_result_records(2, '{"v":2,"kind":"metric","name":"a","value":1}') is False)
+
+
+@mock.patch('superbench.benchmarks.micro_benchmarks.micro_base.run_command')
+def test_micro_benchmark_with_invoke_baseline_failure(mock_run_command):
+    """Test MicroBenchmarkWithInvoke keeping the results of a binary stopped at a baseline failure."""
+    raw_output = '\n'.join(
+        [
+            '{"v":1,"kind":"metric","name":"bw","unit":"GB/s","tags":{},"value":8.5}',
+            '{"v":1,"kind":"metric","name":"baseline_failures","unit":"","tags":{},"value":1}',
+        ]
+    )
+    mock_run_command.return_value = subprocess.CompletedProcess('', 1, stdout=raw_output)
+    benchmark = FakeResultRecordBenchmark('fake', parameters='--baseline node.rules --fail_fast')
+    assert (benchmark.run() is False)
+    assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_BASELINE_FAILURE)
+    assert (benchmark.result['bw'] == [8.5])
+    assert (benchmark.result['baseline_failures'] == [1])
+
+    # Negative case - a failure without baseline failures is an execution failure, without partial results.
+    mock_run_command.return_value = subprocess.CompletedProcess(
+        '', 1, stdout=raw_output.replace('"value":1}', '"value":0}')
+    )
+    benchmark = FakeResultRecordBenchmark('fake', parameters='--baseline node.rules --fail_fast')
+    assert (benchmark.run() is False)
+    assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_EXECUTION_FAILURE)
+    assert ('bw' not in benchmark.result)
+    assert ('baseline_failures' not in benchmark.result)
+
+    # Negative case - a crash with unparsable output is an execution failure.
+    mock_run_command.return_value = subprocess.CompletedProcess('', 139, stdout='Segmentation fault')
+    benchmark = FakeResultRecordBenchmark('fake', parameters='--baseline node.rules --fail_fast')
+    assert (benchmark.run() is False)
+    assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_EXECUTION_FAILURE)
+    assert ('raw_output_0' not in benchmark.raw_data)
+
+    # Negative case - without --fail_fast the output of a failed run is not parsed.
+    mock_run_command.return_value = subprocess.CompletedProcess('', 1, stdout=raw_output)
+    benchmark = FakeResultRecordBenchmark('fake', parameters='--baseline node.rules')
+    assert (benchmark.run() is False)
+    assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_EXECUTION_FAILURE)
+    assert ('bw' not in benchmark.result)
@@ -0,0 +1,87 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for moe-alltoallv benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class MoeAlltoallvBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for moe-alltoallv benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/moe_alltoallv'])
+
+    def test_moe_alltoallv_command_generation(self):
+        """Test moe-alltoallv benchmark command generation."""
+        benchmark_name = 'moe-alltoallv'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--transports mpi shm --dist zipf --zipf_alpha 1.5 --tokens 4096 --hidden 1024 --ffn 0 ' \
+            '--experts_per_rank 4 --topk 8 --steps 10 --warmup 2 --seed 7 --check'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.transports == ['mpi', 'shm'])
+        assert (benchmark._args.dist == 'zipf')
+        assert (benchmark._args.zipf_alpha == 1.5)
+        assert (benchmark._args.topk == 8)
+
+        # Check command, one per transport
+        assert (2 == len(benchmark._commands))
+        args = '--dist zipf --zipf_alpha 1.5 --tokens 4096 --hidden 1024 --ffn 0 --experts_per_rank 4 --topk 8 ' \
+            '--steps 10 --warmup 2 --seed 7 --check 1 --result_format jsonl'
+        for command, transport in zip(benchmark._commands, ['mpi', 'shm']):
+            assert (command.startswith(benchmark._args.bin_dir))
+            assert (command.endswith('moe_alltoallv --transport %s %s' % (transport, args)))
+
+        # Negative cases - unsupported transport and distribution.
+        for parameters in ['--transports nvlink', '--dist normal']:
+            benchmark = benchmark_class(benchmark_name, parameters=parameters)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/moe_alltoallv.log')
+    def test_moe_alltoallv_result_parsing(self, test_raw_output):
+        """Test moe-alltoallv benchmark result parsing."""
+        benchmark_name = 'moe-alltoallv'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--dist zipf --check')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 5 phase times + tokens rate + 2 bandwidths + gflops + 2 imbalances + check
+        assert (12 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['mpi_dispatch_time_us'][0] == 17054.589)
+        assert (benchmark.result['mpi_combine_bw'][0] == 1.031212871)
+        assert (benchmark.result['mpi_rank_imbalance'][0] == 3.801465)
+        assert (benchmark.result['mpi_check_wrong'][0] == 0)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
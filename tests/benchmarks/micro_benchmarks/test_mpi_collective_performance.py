@@ -0,0 +1,129 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for mpi-collective benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class MpiCollectiveBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for mpi-collective benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/mpi_collective'])
+
+    def test_mpi_collective_command_generation(self):
+        """Test mpi-collective benchmark command generation."""
+        benchmark_name = 'mpi-collective'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--operation Reduce --mode persistent --minbytes 1K --maxbytes 1G --check 1 --data_type int64 ' \
+            '--root 3'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.operation == 'reduce')
+        assert (benchmark._args.mode == 'persistent')
+        assert (benchmark._args.root == 3)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._args.bin_dir))
+        expected = 'mpi_collective --operation reduce --mode persistent -b 1K -e 1G -f 2 -c 1 -n 20 -w 5 -d int64 -r 3'
+        assert (benchmark._commands[0].endswith(expected))
+
+        # Check the default size range fits in host memory.
+        benchmark = benchmark_class(benchmark_name, parameters='')
+        assert (benchmark._preprocess() is True)
+        assert ('--mode blocking -b 8 -e 128M' in benchmark._commands[0])
+        assert ('--start_skew' not in benchmark._commands[0])
+
+        # Check the start skew option.
+        benchmark = benchmark_class(benchmark_name, parameters='--start_skew')
+        assert (benchmark._preprocess() is True)
+        assert (benchmark._commands[0].endswith('-r 0 --start_skew 1'))
+
+        # Negative cases - unsupported operation, mode and data type.
+        for parameters in ['--operation sendrecv', '--mode graph', '--data_type half']:
+            benchmark = benchmark_class(benchmark_name, parameters=parameters)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/mpi_collective.log')
+    def test_mpi_collective_result_parsing(self, test_raw_output):
+        """Test mpi-collective benchmark result parsing with the nccl-tests parser."""
+        benchmark_name = 'mpi-collective'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 21 sizes * (busbw + algbw + time)
+        assert (63 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['allreduce_1048576_busbw'][0] == 0.46)
+        assert (benchmark.result['allreduce_1048576_time'][0] == 4028.94)
+        assert (benchmark.result['allreduce_8388608_algbw'][0] == 0.16)
+
+        # In-place columns.
+        benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M --in_place')
+        assert (benchmark._preprocess() is True)
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.result['allreduce_4194304_time'][0] == 14660.0)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+
+        # Start skew footer.
+        benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M --start_skew')
+        assert (benchmark._preprocess() is True)
+        assert (benchmark._process_raw_result(0, test_raw_output) is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
+        skew_raw_output = test_raw_output.replace(
+            '# Avg bus bandwidth    : 0.196931 \n', '# Avg bus bandwidth    : 0.196931 \n'
+            '# Start skew (us)      : avg 8.88 max 43.36 over 1400 rounds\n'
+            '# Stragglers           : rank 3 78.6% rank 0 21.4%\n'
+            '# Clock error (us)     : 2.12 max drift 0.000 ppm\n'
+        )
+        assert (benchmark._process_raw_result(0, skew_raw_output))
+        assert (benchmark.result['allreduce_start_skew_avg'][0] == 8.88)
+        assert (benchmark.result['allreduce_start_skew_max'][0] == 43.36)
+        assert (benchmark.result['allreduce_clock_error'][0] == 2.12)
+        assert (benchmark.result['allreduce_top_straggler_rank'][0] == 3)
+
+        # Negative case - truncated start skew footer.
+        for truncated in [
+            '# Start skew (us)      : avg 8.88 max 43.36 over 1400 rounds\n# Stragglers           : rank 3 78.6%',
+            '# Start skew (us)      : avg 8.88 max 4',
+        ]:
+            benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M --start_skew')
+            assert (benchmark._preprocess() is True)
+            truncated_raw_output = test_raw_output.replace(
+                '# Avg bus bandwidth    : 0.196931 \n', '# Avg bus bandwidth    : 0.196931 \n' + truncated
+            )
+            assert (benchmark._process_raw_result(0, truncated_raw_output) is False)
+            assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -0,0 +1,93 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for mpi-overlap benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class MpiOverlapBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for mpi-overlap benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/mpi_overlap'])
+
+    def test_mpi_overlap_command_generation(self):
+        """Test mpi-overlap benchmark command generation."""
+        benchmark_name = 'mpi-overlap'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--progress thread async --kernel matmul --m 128 --k 256 --n 1024 --ratio 10 ' \
+            '--compute_threads 4 --progress_cpu 7 --msg_size 64M --num_warmup 1 --num_steps 5'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.progress == ['thread', 'async'])
+        assert (benchmark._args.kernel == ['matmul'])
+        assert (benchmark._args.compute_threads == 4)
+
+        # Check command, one job per progress strategy
+        assert (2 == len(benchmark._commands))
+        args = '--kernel matmul --m 128 --k 256 --n 1024 --ratio 10 --compute_threads 4 --progress_cpu 7 ' \
+            '--msg_size 64M --iters 5 --warmup 1 --result_format jsonl'
+        for command, progress in zip(benchmark._commands, ['thread', 'async']):
+            assert (command.startswith(benchmark._args.bin_dir))
+            assert (command.endswith('mpi_overlap --progress %s %s' % (progress, args)))
+
+        # Check the defaults test every strategy and kernel with a calibrated ratio.
+        benchmark = benchmark_class(benchmark_name, parameters='')
+        assert (benchmark._preprocess() is True)
+        assert (4 == len(benchmark._commands))
+        assert ('--kernel mul,matmul' in benchmark._commands[0])
+        assert ('--ratio 0' in benchmark._commands[0])
+
+        # Negative cases - unsupported progress strategy and kernel.
+        for parameters in ['--progress spin', '--kernel conv']:
+            benchmark = benchmark_class(benchmark_name, parameters=parameters)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/mpi_overlap.log')
+    def test_mpi_overlap_result_parsing(self, test_raw_output):
+        """Test mpi-overlap benchmark result parsing."""
+        benchmark_name = 'mpi-overlap'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--progress thread')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 2 kernels * (ratio + 3 times + efficiency)
+        assert (10 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['thread_mul_ratio'][0] == 233)
+        assert (benchmark.result['thread_mul_comm_time_us'][0] == 14776.296)
+        assert (benchmark.result['thread_matmul_overlap_time_us'][0] == 35432.509)
+        assert (benchmark.result['thread_matmul_overlap_efficiency'][0] == -0.108285)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
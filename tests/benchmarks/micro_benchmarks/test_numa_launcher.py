@@ -0,0 +1,106 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for numa-launcher benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class NumaLauncherBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for numa-launcher benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/numa_launcher'])
+
+    def test_numa_launcher_command_generation(self):
+        """Test numa-launcher benchmark command generation."""
+        benchmark_name = 'numa-launcher'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--jobs "stream nodes=1 membw=exclusive -- stream_bin --cpus {cpus}" "gemm cores=8 -- gemm_bin" ' \
+            '--cpus 0-63 --calibrate --log_dir /tmp/launcher'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (
+            benchmark._args.jobs ==
+            ['stream nodes=1 membw=exclusive -- stream_bin --cpus {cpus}', 'gemm cores=8 -- gemm_bin']
+        )
+        assert (benchmark._args.cpus == '0-63')
+        assert (benchmark._args.isolation == 'affinity')
+        assert (benchmark._args.calibrate is True)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._NumaLauncherBenchmark__bin_path))
+        for option in [
+            "--run 'stream nodes=1 membw=exclusive -- stream_bin --cpus {cpus}' --run 'gemm cores=8 -- gemm_bin'",
+            '--cpus 0-63', '--isolation affinity', '--log_dir /tmp/launcher', '--calibrate',
+            '--threshold 0.1 --sample_ms 100', '--result_format jsonl'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--cgroup_root' not in benchmark._commands[0])
+
+        # Check command with a job file and cgroup isolation.
+        benchmark = benchmark_class(
+            benchmark_name,
+            parameters='--job_file /opt/jobs/node.jobs --isolation cgroup --cgroup_root /sys/fs/cgroup/sb'
+        )
+        assert (benchmark._preprocess() is True)
+        for option in ['--jobs /opt/jobs/node.jobs', '--isolation cgroup', '--cgroup_root /sys/fs/cgroup/sb']:
+            assert (option in benchmark._commands[0])
+        assert ('--run' not in benchmark._commands[0])
+        assert ('--calibrate' not in benchmark._commands[0])
+
+        # Negative case - no job.
+        benchmark = benchmark_class(benchmark_name)
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+        # Negative case - job line without command.
+        benchmark = benchmark_class(benchmark_name, parameters='--jobs "stream nodes=1"')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/numa_launcher.log')
+    def test_numa_launcher_result_parsing(self, test_raw_output):
+        """Test numa-launcher benchmark result parsing."""
+        benchmark_name = 'numa-launcher'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--jobs "a -- true"')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        # 2 jobs * 8 metrics + 5 launcher metrics
+        assert (21 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['gemm_slowdown'][0] == 1.1832744016218943)
+        assert (benchmark.result['stream_cpus'][0] == 32)
+        assert (benchmark.result['launcher_interfered_jobs'][0] == 1)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -0,0 +1,66 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for the result records decoder."""
+
+import math
+import struct
+
+import pytest
+
+from superbench.benchmarks.micro_benchmarks import result_records
+
+
+def _binary_str(value):
+    """Frame a string as in the binary records."""
+    data = value.encode()
+    return struct.pack('<H', len(data)) + data
+
+
+def _binary_record(kind, name, unit, tags, payload):
+    """Frame a record as in the binary records."""
+    body = struct.pack('<B', kind) + _binary_str(name) + _binary_str(unit) + struct.pack('<H', len(tags))
+    for key, value in tags.items():
+        body += _binary_str(key) + _binary_str(value)
+    body += payload
+    return struct.pack('<I', len(body)) + body
+
+
+def test_decode_jsonl():
+    """Test decoding the records in JSON Lines."""
+    raw_output = '\n'.join(
+        [
+            'Warning: a launcher message',
+            '{"v":1,"kind":"metric","name":"bw","unit":"GB/s","tags":{"method":"sync"},"value":1.5}',
+            '{"v":1,"kind":"samples","name":"lat","unit":"us","tags":{},"samples":[1,null,3]}',
+        ]
+    )
+    records = result_records.decode_jsonl(raw_output)
+    assert (len(records) == 2)
+    assert (records[0]['name'] == 'bw')
+    assert (records[0]['unit'] == 'GB/s')
+    assert (records[0]['tags'] == {'method': 'sync'})
+    assert (records[0]['value'] == 1.5)
+    assert (records[1]['samples'][0] == 1 and math.isnan(records[1]['samples'][1]))
+
+    with pytest.raises(ValueError):
+        result_records.decode_jsonl('{"v":1,"kind":"histogram","name":"lat"}')
+
+
+def test_decode_binary():
+    """Test decoding the records in the binary framing."""
+    data = b'SBRR' + struct.pack('<B', 1)
+    data += _binary_record(1, 'bw', 'GB/s', {'method': 'sync'}, struct.pack('<d', 1.5))
+    data += _binary_record(2, 'lat', 'us', {}, struct.pack('<Q3d', 3, 1.0, 2.0, 3.0))
+    records = result_records.decode_binary(data)
+    assert (len(records) == 2)
+    assert (records[0] == {'v': 1, 'kind': 'metric', 'name': 'bw', 'unit': 'GB/s', 'tags': {'method': 'sync'},
+                           'value': 1.5})
+    assert (records[1]['kind'] == 'samples')
+    assert (records[1]['samples'] == [1.0, 2.0, 3.0])
+
+    # Negative cases - missing magic and truncated record.
+    with pytest.raises(ValueError):
+        result_records.decode_binary(b'XXXX\x01')
+    with pytest.raises(ValueError):
+        result_records.decode_binary(data[:-8])
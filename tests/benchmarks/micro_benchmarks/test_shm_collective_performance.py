@@ -0,0 +1,96 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for shm-collective benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class ShmCollectiveBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for shm-collective benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/shm_collective'])
+
+    def test_shm_collective_command_generation(self):
+        """Test shm-collective benchmark command generation."""
+        benchmark_name = 'shm-collective'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--operation AllGather --nranks 16 --minbytes 1K --maxbytes 1G --check 1 --data_type double ' \
+            '--no_numa'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.operation == 'allgather')
+        assert (benchmark._args.nranks == 16)
+        assert (benchmark._args.algo == 'rsag')
+        assert (benchmark._args.no_numa)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._args.bin_dir))
+        expected = 'shm_collective --operation allgather --algo rsag -g 16 -b 1K -e 1G -f 2 -c 1 -n 20 -w 5 ' \
+            '-d double --numa 0'
+        assert (benchmark._commands[0].endswith(expected))
+
+        # Check the default size range fits in host memory.
+        benchmark = benchmark_class(benchmark_name, parameters='--algo ring')
+        assert (benchmark._preprocess() is True)
+        assert ('-e 128M' in benchmark._commands[0])
+        assert ('--numa 1' in benchmark._commands[0])
+
+        # Negative cases - unsupported operation, algorithm and data type.
+        for parameters in ['--operation reduce', '--algo tree', '--data_type half']:
+            benchmark = benchmark_class(benchmark_name, parameters=parameters)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/shm_collective.log')
+    def test_shm_collective_result_parsing(self, test_raw_output):
+        """Test shm-collective benchmark result parsing with the nccl-tests parser."""
+        benchmark_name = 'shm-collective'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 21 sizes * (busbw + algbw + time)
+        assert (63 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['allreduce_1048576_busbw'][0] == 1.41)
+        assert (benchmark.result['allreduce_1048576_time'][0] == 1305.28)
+        assert (benchmark.result['allreduce_8388608_algbw'][0] == 0.51)
+
+        # In-place columns.
+        benchmark = benchmark_class(benchmark_name, parameters='--maxbytes 8M --in_place')
+        assert (benchmark._preprocess() is True)
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.result['allreduce_8388608_time'][0] == 12420.9)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
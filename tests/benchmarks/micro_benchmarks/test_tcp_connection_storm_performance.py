@@ -0,0 +1,87 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for tcp-connection-storm benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class TcpConnectionStormBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for tcp-connection-storm benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/tcp_connection_storm'])
+
+    def test_tcp_connection_storm_command_generation(self):
+        """Test tcp-connection-storm benchmark command generation."""
+        benchmark_name = 'tcp-connection-storm'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--client_threads 64 --connections_per_thread 128 --listeners 4 --accept_threads 2 ' \
+            '--backlog 4096 --connect_timeout 500 --max_retries 5 --retry_backoff 20 --hold_connections'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.client_threads == 64)
+        assert (benchmark._args.connections_per_thread == 128)
+        assert (benchmark._args.listeners == 4)
+        assert (benchmark._args.accept_threads == 2)
+        assert (benchmark._args.backlog == 4096)
+        assert (benchmark._args.hold_connections)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._TcpConnectionStormBenchmark__bin_path))
+        for option in [
+            '--client_threads 64', '--connections_per_thread 128', '--listeners 4', '--accept_threads 2',
+            '--backlog 4096', '--connect_timeout 500', '--max_retries 5', '--retry_backoff 20',
+            '--server_addr 127.0.0.1', '--port 23457', '--hold_connections'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+
+    @decorator.load_data('tests/data/tcp_connection_storm.log')
+    def test_tcp_connection_storm_result_parsing(self, test_raw_output):
+        """Test tcp-connection-storm benchmark result parsing."""
+        benchmark_name = 'tcp-connection-storm'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        assert (18 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['conn_rate'][0] == 780.752146)
+        assert (benchmark.result['connected'][0] == 1600)
+        assert (benchmark.result['failures'][0] == 0)
+        assert (benchmark.result['retries'][0] == 12)
+        assert (benchmark.result['connect_lat_us_99.9'][0] == 8359.498)
+        assert (benchmark.result['listenoverflows'][0] == 12)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
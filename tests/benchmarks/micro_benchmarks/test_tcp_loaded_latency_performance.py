@@ -0,0 +1,88 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for tcp-loaded-latency benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class TcpLoadedLatencyBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for tcp-loaded-latency benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/tcp_loaded_latency'])
+
+    def test_tcp_loaded_latency_command_generation(self):
+        """Test tcp-loaded-latency benchmark command generation."""
+        benchmark_name = 'tcp-loaded-latency'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--bulk_streams 8 --loads 0 50 100 --bulk_msg_size 65536 --ping_size 256 --runtime 2 ' \
+            '--peak_bw 100 --server_addr 10.0.0.2 --role client'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.bulk_streams == 8)
+        assert (benchmark._args.loads == [0, 50, 100])
+        assert (benchmark._args.peak_bw == 100)
+        assert (benchmark._args.role == 'client')
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._TcpLoadedLatencyBenchmark__bin_path))
+        for option in [
+            '--bulk_streams 8', '--loads 0,50,100', '--bulk_msg_size 65536', '--ping_size 256', '--runtime 2',
+            '--peak_bw 100', '--server_addr 10.0.0.2', '--bind_addr 0.0.0.0', '--port 23458', '--role client'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+
+        # Negative case - invalid load and role.
+        for parameters in ['--loads 0 120', '--role tx']:
+            benchmark = benchmark_class(benchmark_name, parameters=parameters)
+            assert (benchmark._preprocess() is False)
+            assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/tcp_loaded_latency.log')
+    def test_tcp_loaded_latency_result_parsing(self, test_raw_output):
+        """Test tcp-loaded-latency benchmark result parsing."""
+        benchmark_name = 'tcp-loaded-latency'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--loads 0 100')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        assert (21 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['peak_bulk_bw'][0] == 29.8764505)
+        assert (benchmark.result['load0_rtt_us_50'][0] == 7.489)
+        assert (benchmark.result['load100_bulk_bw'][0] == 21.3280314)
+        assert (benchmark.result['load100_rtt_us_99.9'][0] == 3505.509)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
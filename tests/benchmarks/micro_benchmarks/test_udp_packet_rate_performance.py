@@ -0,0 +1,105 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for udp-packet-rate benchmark."""
+
+import json
+import numbers
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class UdpPacketRateBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for udp-packet-rate benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/udp_packet_rate'])
+
+    def test_udp_packet_rate_command_generation(self):
+        """Test udp-packet-rate benchmark command generation."""
+        benchmark_name = 'udp-packet-rate'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--modes sendto mmsg --payload_sizes 64 9000 --tx_threads 2 --rx_threads 4 ' \
+            '--tx_cpus 0-1 --rx_cpus 2-5 --batch_size 64 --runtime 2 --dst_addr 10.0.0.2 --role tx'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.modes == ['sendto', 'mmsg'])
+        assert (benchmark._args.payload_sizes == [64, 9000])
+        assert (benchmark._args.tx_threads == 2)
+        assert (benchmark._args.rx_threads == 4)
+        assert (benchmark._args.batch_size == 64)
+        assert (benchmark._args.runtime == 2)
+        assert (benchmark._args.role == 'tx')
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._UdpPacketRateBenchmark__bin_path))
+        assert ('--sendto --mmsg' in benchmark._commands[0])
+        assert ('--gso' not in benchmark._commands[0])
+        assert ('--payload_sizes 64,9000' in benchmark._commands[0])
+        assert ('--tx_threads 2 --rx_threads 4 --batch_size 64 --runtime 2' in benchmark._commands[0])
+        assert ('--dst_addr 10.0.0.2' in benchmark._commands[0])
+        assert ('--role tx' in benchmark._commands[0])
+        assert ('--tx_cpus 0-1' in benchmark._commands[0])
+        assert ('--rx_cpus 2-5' in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+
+        # Negative case - invalid mode.
+        benchmark = benchmark_class(benchmark_name, parameters='--modes sendfile')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/udp_packet_rate.log')
+    def test_udp_packet_rate_result_parsing(self, test_raw_output):
+        """Test udp-packet-rate benchmark result parsing."""
+        benchmark_name = 'udp-packet-rate'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        assert (1 == len(benchmark.raw_data))
+        test_raw_output_dict = {
+            record['name']: record['value']
+            for record in map(json.loads, test_raw_output.strip().splitlines())
+        }
+        assert (len(test_raw_output_dict) + benchmark.default_metric_count == len(benchmark.result))
+        for output_key in benchmark.result:
+            if output_key == 'return_code':
+                assert (benchmark.result[output_key] == [0])
+            else:
+                assert (len(benchmark.result[output_key]) == 1)
+                assert (isinstance(benchmark.result[output_key][0], numbers.Number))
+                assert (test_raw_output_dict[output_key] == benchmark.result[output_key][0])
+        assert (benchmark.result['mmsg_64_tx_pps'][0] == 2823328.86)
+        assert (benchmark.result['gso_64_cpu1_util'][0] == 91.4166667)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)
@@ -0,0 +1,94 @@
+# Copyright (c) Microsoft Corporation.
+# Licensed under the MIT License.
+
+"""Tests for weight-load benchmark."""
+
+import unittest
+
+from tests.helper import decorator
+from tests.helper.testcase import BenchmarkTestCase
+from superbench.benchmarks import BenchmarkRegistry, BenchmarkType, ReturnCode, Platform
+
+
+class WeightLoadBenchmarkTest(BenchmarkTestCase, unittest.TestCase):
+    """Test class for weight-load benchmark."""
+    @classmethod
+    def setUpClass(cls):
+        """Hook method for setting up class fixture before running tests in the class."""
+        super().setUpClass()
+        cls.createMockEnvs(cls)
+        cls.createMockFiles(cls, ['bin/weight_load'])
+
+    def test_weight_load_command_generation(self):
+        """Test weight-load benchmark command generation."""
+        benchmark_name = 'weight-load'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+
+        parameters = '--methods mmap io_uring --file /mnt/model/weights.bin --threads 1 8 16 --chunk_size 64M ' \
+            '--iodepth 16 --numa_node 1 --pinned_staging'
+        benchmark = benchmark_class(benchmark_name, parameters=parameters)
+
+        # Check basic information
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (benchmark.name == benchmark_name)
+        assert (benchmark.type == BenchmarkType.MICRO)
+
+        # Check parameters specified in BenchmarkContext.
+        assert (benchmark._args.methods == ['mmap', 'io_uring'])
+        assert (benchmark._args.threads == [1, 8, 16])
+        assert (benchmark._args.numa_node == 1)
+        assert (benchmark._args.pinned_staging)
+
+        # Check command
+        assert (1 == len(benchmark._commands))
+        assert (benchmark._commands[0].startswith(benchmark._WeightLoadBenchmark__bin_path))
+        for option in [
+            '--mmap --io_uring', '--file /mnt/model/weights.bin', '--threads 1,8,16', '--chunk_size 64M',
+            '--iodepth 16', '--numa_node 1', '--pinned_staging'
+        ]:
+            assert (option in benchmark._commands[0])
+        assert ('--result_format jsonl' in benchmark._commands[0])
+        assert ('--size' not in benchmark._commands[0])
+
+        # Check command with a generated file.
+        benchmark = benchmark_class(benchmark_name, parameters='--size 64G')
+        assert (benchmark._preprocess() is True)
+        assert ('--size 64G' in benchmark._commands[0])
+        assert ('--file' not in benchmark._commands[0])
+
+        # Negative case - invalid method.
+        benchmark = benchmark_class(benchmark_name, parameters='--methods aio')
+        assert (benchmark._preprocess() is False)
+        assert (benchmark.return_code == ReturnCode.INVALID_ARGUMENT)
+
+    @decorator.load_data('tests/data/weight_load.log')
+    def test_weight_load_result_parsing(self, test_raw_output):
+        """Test weight-load benchmark result parsing."""
+        benchmark_name = 'weight-load'
+        (benchmark_class,
+         predefine_params) = BenchmarkRegistry._BenchmarkRegistry__select_benchmark(benchmark_name, Platform.CPU)
+        assert (benchmark_class)
+        benchmark = benchmark_class(benchmark_name, parameters='--threads 1 4 --pinned_staging')
+        assert (benchmark)
+        ret = benchmark._preprocess()
+        assert (ret is True)
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+
+        # Positive case - valid raw output.
+        assert (benchmark._process_raw_result(0, test_raw_output))
+        assert (benchmark.return_code == ReturnCode.SUCCESS)
+        assert (1 == len(benchmark.raw_data))
+        # 4 methods * 2 thread counts * (time to ready + bw + staging time)
+        assert (24 + benchmark.default_metric_count == len(benchmark.result))
+        assert (benchmark.result['pread_t4_bw'][0] == 2.77119796)
+        assert (benchmark.result['io_uring_t1_time_to_ready'][0] == 0.226127805)
+        assert (benchmark.result['direct_t1_staging_time'][0] == 0.026070361)
+
+        # Negative case - invalid raw output.
+        assert (benchmark._process_raw_result(1, 'Invalid raw output') is False)
+        assert (benchmark.return_code == ReturnCode.MICROBENCHMARK_RESULT_PARSING_FAILURE)